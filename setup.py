@@ -50,6 +50,15 @@ Use "HEADLESS=True pip install ." to build in headless mode with pip""",
         action="store_true",
         help="""Build with Bullet simulation engine.""",
     )
+    parser.add_argument(
+        "--bullet-mt",
+        "--with-bullet-multithreading",
+        dest="with_bullet_mt",
+        action="store_true",
+        help="""Build the bundled Bullet thread safe, so that physics can step
+        with several threads. Adds locking overhead to single-threaded
+        stepping.""",
+    )
     parser.add_argument(
         "--cmake",
         "--force-cmake",
@@ -254,6 +263,11 @@ class CMakeBuild(build_ext):
         cmake_args += [
             "-DBUILD_WITH_BULLET={}".format("ON" if args.with_bullet else "OFF")
         ]
+        cmake_args += [
+            "-DBUILD_BULLET_MULTITHREADING={}".format(
+                "ON" if args.with_bullet_mt else "OFF"
+            )
+        ]
         cmake_args += [
             "-DBUILD_DATATOOL={}".format("ON" if args.build_datatool else "OFF")
         ]
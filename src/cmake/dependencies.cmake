@@ -141,6 +141,10 @@ if(BUILD_WITH_BULLET AND NOT USE_SYSTEM_BULLET)
   set(BUILD_CLSOCKET OFF CACHE BOOL "" FORCE)
   set(BUILD_EXTRAS OFF CACHE BOOL "" FORCE)
   set(BUILD_BULLET3 OFF CACHE BOOL "" FORCE)
+  # Needed for the multithreaded world, see BulletPhysicsManager. Off by
+  # default: a thread safe Bullet also takes its locks when stepping with a
+  # single thread.
+  set(BULLET2_MULTITHREADING ${BUILD_BULLET_MULTITHREADING} CACHE BOOL "" FORCE)
   # This is needed in case BUILD_EXTRAS is enabled, as you'd get a CMake syntax
   # error otherwise
   set(PKGCONFIG_INSTALL_PREFIX "lib${LIB_SUFFIX}/pkgconfig/")
@@ -35,6 +35,8 @@
 #include <Magnum/Trade/SceneData.h>
 #include <Magnum/Trade/TextureData.h>
 
+#include <algorithm>
+
 #include "esp/geo/geo.h"
 #include "esp/gfx/GenericDrawable.h"
 #include "esp/gfx/MaterialUtil.h"
@@ -110,6 +112,51 @@ void ResourceManager::buildImporters() {
 
 }  // buildImporters
 
+void ResourceManager::setNumLoadingThreads(int numThreads) {
+  const bool useSharedPool = numThreads <= 0;
+  if (useSharedPool) {
+    numThreads = core::ThreadPool::defaultNumThreads();
+  }
+  if (numThreads == getNumLoadingThreads() &&
+      (numThreads == 1 || useSharedPool == !ownedLoadingPool_)) {
+    return;
+  }
+
+  loadingImporters_.clear();
+  loadingImporterManagers_.clear();
+  loadingPool_ = nullptr;
+  ownedLoadingPool_ = nullptr;
+  if (numThreads == 1) {
+    return;
+  }
+
+  if (useSharedPool) {
+    loadingPool_ = &core::ThreadPool::shared();
+  } else {
+    ownedLoadingPool_ = std::make_unique<core::ThreadPool>(numThreads);
+    loadingPool_ = ownedLoadingPool_.get();
+  }
+  // worker 0 is the calling thread, which uses fileImporter_
+  for (int i = 1; i < loadingPool_->numThreads(); ++i) {
+#ifdef MAGNUM_BUILD_STATIC
+    // avoid using plugins that might depend on different library versions
+    loadingImporterManagers_.emplace_back(
+        std::make_unique<Cr::PluginManager::Manager<Importer>>("nonexistent"));
+#else
+    loadingImporterManagers_.emplace_back(
+        std::make_unique<Cr::PluginManager::Manager<Importer>>());
+#endif
+    Cr::Containers::Pointer<Importer> importer =
+        loadingImporterManagers_.back()->loadAndInstantiate("AnySceneImporter");
+    CORRADE_INTERNAL_ASSERT(importer);
+    loadingImporters_.emplace_back(std::move(importer));
+  }
+}
+
+int ResourceManager::getNumLoadingThreads() const {
+  return loadingPool_ ? loadingPool_->numThreads() : 1;
+}
+
 void ResourceManager::initDefaultPrimAttributes() {
   // by this point, we should have a GL::Context so load the bb primitive.
   // TODO: replace this completely with standard mesh (i.e. treat the bb
@@ -1093,20 +1140,16 @@ scene::SceneNode* ResourceManager::createRenderAssetInstanceIMesh(
   return instanceRoot;
 }
 
-bool ResourceManager::loadRenderAssetGeneral(const AssetInfo& info) {
-  ASSERT(isRenderAssetGeneral(info.type));
-
-  const std::string& filename = info.filepath;
-  CHECK(resourceDict_.count(filename) == 0);
-
+void ResourceManager::configureImporterManager(
+    Cr::PluginManager::Manager<Importer>& manager) {
   // Preferred plugins, Basis target GPU format
-  importerManager_.setPreferredPlugins("GltfImporter", {"TinyGltfImporter"});
+  manager.setPreferredPlugins("GltfImporter", {"TinyGltfImporter"});
 #ifdef ESP_BUILD_ASSIMP_SUPPORT
-  importerManager_.setPreferredPlugins("ObjImporter", {"AssimpImporter"});
+  manager.setPreferredPlugins("ObjImporter", {"AssimpImporter"});
 #endif
   {
     Cr::PluginManager::PluginMetadata* const metadata =
-        importerManager_.metadata("BasisImporter");
+        manager.metadata("BasisImporter");
     Mn::GL::Context& context = Mn::GL::Context::current();
 #ifdef MAGNUM_TARGET_WEBGL
     if (context.isExtensionSupported<
@@ -1177,6 +1220,64 @@ bool ResourceManager::loadRenderAssetGeneral(const AssetInfo& info) {
     }
 #endif
   }
+}  // configureImporterManager
+
+std::vector<ResourceManager::Importer*> ResourceManager::openLoadingImporters(
+    const std::string& filename,
+    size_t numTasks) {
+  std::vector<Importer*> importers{fileImporter_.get()};
+  if (!loadingPool_ || numTasks < 2) {
+    return importers;
+  }
+
+  for (auto& manager : loadingImporterManagers_) {
+    configureImporterManager(*manager);
+  }
+  // AnySceneImporter::openFile loads the plugin for the file format, and
+  // plugin loading isn't documented as thread-safe, so open them serially
+  for (auto& importer : loadingImporters_) {
+    if (!importer->openFile(filename)) {
+      LOG(WARNING) << "Cannot open " << filename
+                   << " on all loading threads, loading it on one thread";
+      closeLoadingImporters();
+      return {fileImporter_.get()};
+    }
+    importers.push_back(importer.get());
+  }
+  return importers;
+}
+
+void ResourceManager::closeLoadingImporters() {
+  for (auto& importer : loadingImporters_) {
+    importer->close();
+  }
+}
+
+void ResourceManager::runLoadingTasks(
+    const std::vector<Importer*>& importers,
+    size_t count,
+    const std::function<void(Importer&, size_t)>& task) {
+  if (importers.size() == 1) {
+    for (size_t i = 0; i < count; ++i) {
+      task(*importers[0], i);
+    }
+    return;
+  }
+  CORRADE_INTERNAL_ASSERT(loadingPool_ &&
+                          importers.size() ==
+                              size_t(loadingPool_->numThreads()));
+  loadingPool_->parallelFor(count, [&](int workerIndex, size_t i) {
+    task(*importers[workerIndex], i);
+  });
+}
+
+bool ResourceManager::loadRenderAssetGeneral(const AssetInfo& info) {
+  ASSERT(isRenderAssetGeneral(info.type));
+
+  const std::string& filename = info.filepath;
+  CHECK(resourceDict_.count(filename) == 0);
+
+  configureImporterManager(importerManager_);
 
   if (!fileImporter_->openFile(filename)) {
     LOG(ERROR) << "Cannot open file " << filename;
@@ -1185,11 +1286,17 @@ bool ResourceManager::loadRenderAssetGeneral(const AssetInfo& info) {
 
   // load file and add it to the dictionary
   LoadedAssetData loadedAssetData{info};
+  const size_t numTasks =
+      (requiresTextures_ ? fileImporter_->textureCount() : 0) +
+      fileImporter_->meshCount();
+  const std::vector<Importer*> importers =
+      openLoadingImporters(filename, numTasks);
   if (requiresTextures_) {
-    loadTextures(*fileImporter_, loadedAssetData);
+    loadTextures(importers, loadedAssetData);
     loadMaterials(*fileImporter_, loadedAssetData);
   }
-  loadMeshes(*fileImporter_, loadedAssetData);
+  loadMeshes(importers, loadedAssetData);
+  closeLoadingImporters();
   auto inserted = resourceDict_.emplace(filename, std::move(loadedAssetData));
   MeshMetaData& meshMetaData = inserted.first->second.meshMetaData;
 
@@ -1651,24 +1758,32 @@ gfx::PbrMaterialData::uptr ResourceManager::buildPbrShadedMaterialData(
   return finalMaterial;
 }
 
-void ResourceManager::loadMeshes(Importer& importer,
+void ResourceManager::loadMeshes(const std::vector<Importer*>& importers,
                                  LoadedAssetData& loadedAssetData) {
+  Importer& importer = *importers[0];
   int meshStart = nextMeshID_;
   int meshEnd = meshStart + importer.meshCount() - 1;
   nextMeshID_ = meshEnd + 1;
   loadedAssetData.meshMetaData.setMeshIndices(meshStart, meshEnd);
 
-  for (int iMesh = 0; iMesh < importer.meshCount(); ++iMesh) {
-    // don't need normals if we aren't using lighting
-    auto gltfMeshData = std::make_unique<GenericMeshData>(
-        loadedAssetData.assetInfo.requiresLighting);
-    gltfMeshData->importAndSetMeshData(importer, iMesh);
-
-    // compute the mesh bounding box
-    gltfMeshData->BB = computeMeshBB(gltfMeshData.get());
-
-    gltfMeshData->uploadBuffersToGPU(false);
-    meshes_.emplace(meshStart + iMesh, std::move(gltfMeshData));
+  // import the meshes and extract their collision data on the loading threads
+  std::vector<std::unique_ptr<GenericMeshData>> meshes(importer.meshCount());
+  const bool requiresLighting = loadedAssetData.assetInfo.requiresLighting;
+  runLoadingTasks(importers, meshes.size(),
+                  [&](Importer& workerImporter, size_t iMesh) {
+                    // don't need normals if we aren't using lighting
+                    auto gltfMeshData =
+                        std::make_unique<GenericMeshData>(requiresLighting);
+                    gltfMeshData->importAndSetMeshData(workerImporter, iMesh);
+
+                    // compute the mesh bounding box
+                    gltfMeshData->BB = computeMeshBB(gltfMeshData.get());
+                    meshes[iMesh] = std::move(gltfMeshData);
+                  });
+
+  for (size_t iMesh = 0; iMesh < meshes.size(); ++iMesh) {
+    meshes[iMesh]->uploadBuffersToGPU(false);
+    meshes_.emplace(meshStart + int(iMesh), std::move(meshes[iMesh]));
   }
 }
 
@@ -1711,13 +1826,23 @@ void ResourceManager::loadMeshHierarchy(Importer& importer,
   }
 }
 
-void ResourceManager::loadTextures(Importer& importer,
+void ResourceManager::loadTextures(const std::vector<Importer*>& importers,
                                    LoadedAssetData& loadedAssetData) {
+  Importer& importer = *importers[0];
   int textureStart = nextTextureID_;
   int textureEnd = textureStart + importer.textureCount() - 1;
   nextTextureID_ = textureEnd + 1;
   loadedAssetData.meshMetaData.setTextureIndices(textureStart, textureEnd);
 
+  // a mip level of a texture's image, to decode and upload
+  struct TextureLevel {
+    int textureID;
+    Mn::UnsignedInt image;
+    Mn::UnsignedInt level;
+    Mn::UnsignedInt levelCount;
+  };
+  std::vector<TextureLevel> textureLevels;
+
   for (int iTexture = 0; iTexture < importer.textureCount(); ++iTexture) {
     auto currentTextureID = textureStart + iTexture;
     textures_.emplace(currentTextureID,
@@ -1742,19 +1867,49 @@ void ResourceManager::loadTextures(Importer& importer,
     // Load all mip levels
     const std::uint32_t levelCount =
         importer.image2DLevelCount(textureData->image());
-    bool generateMipmap = false;
     for (std::uint32_t level = 0; level != levelCount; ++level) {
-      // TODO:
-      // it seems we have a way to just load the image once in this case,
-      // as long as the image2DName include the full path to the image
-      Cr::Containers::Optional<Mn::Trade::ImageData2D> image =
-          importer.image2D(textureData->image(), level);
+      textureLevels.push_back(
+          {currentTextureID, textureData->image(), level, levelCount});
+    }
+  }
+
+  // Decode the images on the loading threads a batch at a time, so that only
+  // a few decoded images are held in memory, and upload them here in order
+  const size_t batchSize = 4 * importers.size();
+  std::vector<Cr::Containers::Optional<Mn::Trade::ImageData2D>> images;
+  for (size_t batchStart = 0; batchStart < textureLevels.size();
+       batchStart += batchSize) {
+    const size_t batchEnd =
+        std::min(batchStart + batchSize, textureLevels.size());
+    images.clear();
+    images.resize(batchEnd - batchStart);
+    runLoadingTasks(importers, images.size(),
+                    [&](Importer& workerImporter, size_t i) {
+                      const TextureLevel& textureLevel =
+                          textureLevels[batchStart + i];
+                      // TODO:
+                      // it seems we have a way to just load the image once in
+                      // this case, as long as the image2DName include the full
+                      // path to the image
+                      images[i] = workerImporter.image2D(textureLevel.image,
+                                                         textureLevel.level);
+                    });
+
+    for (size_t i = 0; i < images.size(); ++i) {
+      const TextureLevel& textureLevel = textureLevels[batchStart + i];
+      auto& currentTexture = textures_.at(textureLevel.textureID);
+      // Mip level loading failed, the whole texture already failed
+      if (currentTexture == nullptr) {
+        continue;
+      }
+      Cr::Containers::Optional<Mn::Trade::ImageData2D>& image = images[i];
       if (!image) {
         LOG(ERROR) << "Cannot load texture image, skipping";
         currentTexture = nullptr;
-        break;
+        continue;
       }
 
+      Mn::GL::Texture2D& texture = *currentTexture;
       Mn::GL::TextureFormat format;
       if (image->isCompressed()) {
         format = Mn::GL::textureFormat(image->compressedFormat());
@@ -1762,10 +1917,13 @@ void ResourceManager::loadTextures(Importer& importer,
         format = Mn::GL::textureFormat(image->format());
       }
 
+      const std::uint32_t level = textureLevel.level;
+      const std::uint32_t levelCount = textureLevel.levelCount;
       int adjustedLevel = level - mipLevelsToSkip;
       int adjustedLevelCount = levelCount - mipLevelsToSkip;
 
       // For the very first level, allocate the texture
+      bool generateMipmap = false;
       if (level == 0) {
         // If there is just one level and the image is not compressed, we'll
         // generate mips ourselves
@@ -1780,23 +1938,19 @@ void ResourceManager::loadTextures(Importer& importer,
         }
       }
 
-      if (adjustedLevel < 0) {
-        continue;
+      if (adjustedLevel >= 0) {
+        if (image->isCompressed())
+          texture.setCompressedSubImage(adjustedLevel, {}, *image);
+        else
+          texture.setSubImage(adjustedLevel, {}, *image);
       }
 
-      if (image->isCompressed())
-        texture.setCompressedSubImage(adjustedLevel, {}, *image);
-      else
-        texture.setSubImage(adjustedLevel, {}, *image);
-    }
+      // Generate a mipmap if requested, the image was the only level
+      if (generateMipmap)
+        texture.generateMipmap();
 
-    // Mip level loading failed, fail the whole texture
-    if (currentTexture == nullptr)
-      continue;
-
-    // Generate a mipmap if requested
-    if (generateMipmap)
-      texture.generateMipmap();
+      image = Cr::Containers::NullOpt;
+    }
   }
 }  // ResourceManager::loadTextures
 
@@ -10,6 +10,7 @@
  * esp::assets::ResourceManager::ShaderType
  */
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -31,6 +32,7 @@
 #include "MeshData.h"
 #include "MeshMetaData.h"
 #include "RenderAssetInstanceCreationInfo.h"
+#include "esp/core/ThreadPool.h"
 #include "esp/gfx/Drawable.h"
 #include "esp/gfx/DrawableGroup.h"
 #include "esp/gfx/MaterialData.h"
@@ -284,6 +286,18 @@ class ResourceManager {
     return resourceDict_.at(metaDataName).meshMetaData;
   }
 
+  /**
+   * @brief Retrieve a loaded texture.
+   *
+   * @param textureID The texture's index, in the range of
+   * @ref MeshMetaData::textureIndex of the asset it belongs to.
+   * @return The texture, or nullptr if it failed to load.
+   */
+  std::shared_ptr<Mn::GL::Texture2D> getTexture(int textureID) const {
+    CHECK(textures_.count(textureID) > 0);
+    return textures_.at(textureID);
+  }
+
   /**
    * @brief Get a named @ref LightSetup
    */
@@ -467,6 +481,25 @@ class ResourceManager {
    */
   inline void setRequiresTextures(bool newVal) { requiresTextures_ = newVal; }
 
+  /**
+   * @brief Sets the number of threads used to load general render assets
+   * (glTF, OBJ, ...).
+   *
+   * Texture images are decoded and meshes are imported and processed on these
+   * threads, each with its own importer. GL uploads stay on the calling
+   * thread, which must have the GL context current. Loading still returns
+   * once the asset is ready.
+   *
+   * @param numThreads The number of threads, including the calling one.
+   * Values <= 0 use the process-wide @ref core::ThreadPool::shared() pool.
+   */
+  void setNumLoadingThreads(int numThreads);
+
+  /**
+   * @return The number of threads used to load general render assets.
+   */
+  int getNumLoadingThreads() const;
+
   /**
    * @brief Load a render asset (if not already loaded) and create a render
    * asset instance.
@@ -581,26 +614,73 @@ class ResourceManager {
                     bool computeAbsoluteAABBs,
                     std::vector<StaticDrawableInfo>& staticDrawableInfo);
 
+  /**
+   * @brief Set the preferred importer plugins and the Basis transcoding
+   * target for the GPU of the current GL context.
+   */
+  void configureImporterManager(
+      Corrade::PluginManager::Manager<Importer>& manager);
+
+  /**
+   * @brief Get the importers to load an asset with, one per loading thread.
+   *
+   * The first is @ref fileImporter_, which must already be open. The importers
+   * of the other loading threads are opened on @p filename, one after the
+   * other, if there are at least two tasks to spread over them. If any of
+   * them fails to open, only @ref fileImporter_ is returned.
+   *
+   * @param filename The file @ref fileImporter_ is open on.
+   * @param numTasks The number of textures and meshes to load.
+   */
+  std::vector<Importer*> openLoadingImporters(const std::string& filename,
+                                              size_t numTasks);
+
+  /**
+   * @brief Close the importers opened by @ref openLoadingImporters, except
+   * @ref fileImporter_.
+   */
+  void closeLoadingImporters();
+
+  /**
+   * @brief Run @p task for every item in [0, @p count), on the loading
+   * threads if @p importers has one importer per thread.
+   *
+   * @param importers The importers from @ref openLoadingImporters. Each task
+   * gets the importer of the thread running it.
+   * @param count The number of items.
+   * @param task The task to run.
+   */
+  void runLoadingTasks(
+      const std::vector<Importer*>& importers,
+      size_t count,
+      const std::function<void(Importer&, size_t)>& task);
+
   /**
    * @brief Load textures from importer into assets, and update metaData for
    * an asset to link textures to that asset.
    *
-   * @param importer The importer already loaded with information for the
-   * asset.
+   * Images are decoded by the loading threads and uploaded to the GPU on the
+   * calling thread, a batch at a time.
+   *
+   * @param importers The importers from @ref openLoadingImporters, already
+   * loaded with information for the asset.
    * @param loadedAssetData The asset's @ref LoadedAssetData object.
    */
-  void loadTextures(Importer& importer, LoadedAssetData& loadedAssetData);
+  void loadTextures(const std::vector<Importer*>& importers,
+                    LoadedAssetData& loadedAssetData);
 
   /**
    * @brief Load meshes from importer into assets.
    *
-   * Compute bounding boxes, upload mesh data to GPU, and update metaData for
-   * an asset to link meshes to that asset.
-   * @param importer The importer already loaded with information for the
+   * Import meshes and compute bounding boxes on the loading threads, upload
+   * mesh data to GPU, and update metaData for an asset to link meshes to that
    * asset.
+   * @param importers The importers from @ref openLoadingImporters, already
+   * loaded with information for the asset.
    * @param loadedAssetData The asset's @ref LoadedAssetData object.
    */
-  void loadMeshes(Importer& importer, LoadedAssetData& loadedAssetData);
+  void loadMeshes(const std::vector<Importer*>& importers,
+                  LoadedAssetData& loadedAssetData);
 
   /**
    * @brief Recursively parse the mesh component transformation heirarchy for
@@ -979,6 +1059,31 @@ class ResourceManager {
    */
   Corrade::Containers::Pointer<Importer> fileImporter_;
 
+  /**
+   * @brief Threads loading general render assets, or nullptr when loading on
+   * the calling thread only. Either @ref ownedLoadingPool_ or the shared pool.
+   * See @ref setNumLoadingThreads.
+   */
+  core::ThreadPool* loadingPool_ = nullptr;
+
+  /**
+   * @brief Pool created for an explicit number of loading threads.
+   */
+  std::unique_ptr<core::ThreadPool> ownedLoadingPool_ = nullptr;
+
+  /**
+   * @brief Plugin managers of the loading threads other than the calling one.
+   * Plugin managers aren't thread-safe, so each thread gets its own.
+   */
+  std::vector<std::unique_ptr<Corrade::PluginManager::Manager<Importer>>>
+      loadingImporterManagers_;
+
+  /**
+   * @brief Importers (AnySceneImporter) of the loading threads other than the
+   * calling one. Entry i belongs to worker i + 1 of @ref loadingPool_.
+   */
+  std::vector<Corrade::Containers::Pointer<Importer>> loadingImporters_;
+
   // ======== Physical parameter data ========
 
   //! tracks primitive mesh ids
@@ -199,6 +199,13 @@ void initAttributesBindings(py::module& m) {
           &ObjectAttributes::setJoinCollisionMeshes,
           R"(Whether collision meshes for objects constructed from this
           template should be joined into a convex hull or kept separate.)")
+      .def_property(
+          "collision_hull_max_vertices",
+          &ObjectAttributes::getCollisionHullMaxVertices,
+          &ObjectAttributes::setCollisionHullMaxVertices,
+          R"(Maximum number of vertices kept in each convex collision hull of
+          objects constructed from this template. 0 keeps the exact hull,
+          values below 6 are raised to 6.)")
       .def_property(
           "is_visibile", &ObjectAttributes::getIsVisible,
           &ObjectAttributes::setIsVisible,
@@ -318,7 +325,18 @@ void initAttributesBindings(py::module& m) {
           &PhysicsManagerAttributes::getRestitutionCoefficient,
           &PhysicsManagerAttributes::setRestitutionCoefficient,
           R"(Default restitution coefficient for contact modeling.  Can be overridden by
-          stage and object values.)");
+          stage and object values.)")
+      .def_property(
+          "collision_cache_directory",
+          &PhysicsManagerAttributes::getCollisionCacheDirectory,
+          &PhysicsManagerAttributes::setCollisionCacheDirectory,
+          R"(Directory in which reduced collision hulls are cached across
+          processes. Empty disables the on-disk cache.)")
+      .def_property(
+          "num_threads", &PhysicsManagerAttributes::getNumThreads,
+          &PhysicsManagerAttributes::setNumThreads,
+          R"(Number of threads stepping the simulation. Values above 1 use
+          Bullet's multithreaded world, if Bullet was built with it.)");
 
   // ==== AbstractPrimitiveAttributes ====
   py::class_<AbstractPrimitiveAttributes, AbstractAttributes,
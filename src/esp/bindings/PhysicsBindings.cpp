@@ -48,6 +48,11 @@ void initPhysicsBindings(py::module& m) {
       .def_readonly("hits", &RaycastResults::hits)
       .def_readonly("ray", &RaycastResults::ray)
       .def("has_hits", &RaycastResults::hasHits);
+
+  // ==== class object PhysicsState ====
+  py::class_<PhysicsState, PhysicsState::ptr>(m, "PhysicsState")
+      .def_property_readonly("world_time", &PhysicsState::getWorldTime)
+      .def_property_readonly("object_ids", &PhysicsState::getObjectIds);
 }
 
 }  // namespace physics
@@ -47,6 +47,12 @@ void initShortestPathBindings(py::module& m) {
       .def_readwrite("geodesic_distance",
                      &MultiGoalShortestPath::geodesicDistance);
 
+  py::class_<GeodesicDistanceField, GeodesicDistanceField::ptr>(
+      m, "GeodesicDistanceField")
+      .def(py::init(&GeodesicDistanceField::create<>))
+      .def_property("goals", &GeodesicDistanceField::getGoals,
+                    &GeodesicDistanceField::setGoals);
+
   py::class_<NavMeshSettings, NavMeshSettings::ptr>(m, "NavMeshSettings")
       .def(py::init(&NavMeshSettings::create<>))
       .def_readwrite("cell_size", &NavMeshSettings::cellSize)
@@ -69,6 +75,9 @@ void initShortestPathBindings(py::module& m) {
       .def_readwrite("filter_ledge_spans", &NavMeshSettings::filterLedgeSpans)
       .def_readwrite("filter_walkable_low_height_spans",
                      &NavMeshSettings::filterWalkableLowHeightSpans)
+      .def_readwrite("tiled", &NavMeshSettings::tiled)
+      .def_readwrite("tile_size", &NavMeshSettings::tileSize)
+      .def_readwrite("max_tiles", &NavMeshSettings::maxTiles)
       .def("set_defaults", &NavMeshSettings::setDefaults);
 
   py::class_<PathFinder, PathFinder::ptr>(m, "PathFinder")
@@ -78,12 +87,49 @@ void initShortestPathBindings(py::module& m) {
       .def("get_topdown_view", &PathFinder::getTopDownView,
            R"(Returns the topdown view of the PathFinder's navmesh.)",
            "meters_per_pixel"_a, "height"_a)
+      .def("get_topdown_views", &PathFinder::getTopDownViews,
+           R"(Returns one topdown view of the PathFinder's navmesh per height,
+          e.g. one per floor.)",
+           "meters_per_pixel"_a, "heights"_a, "max_y_delta"_a = 0.5)
       .def("get_random_navigable_point", &PathFinder::getRandomNavigablePoint)
+      .def("get_random_navigable_points",
+           &PathFinder::getRandomNavigablePoints,
+           R"(Returns num_points random navigable points, distributed uniformly
+          over the navigable area. Optionally restricted to the island with
+          index island_index, see get_island_index.)",
+           "num_points"_a, "island_index"_a = ID_UNDEFINED)
+      .def("get_random_navigable_points_min_island_radius",
+           &PathFinder::getRandomNavigablePointsMinIslandRadius,
+           R"(Returns num_points random navigable points, distributed uniformly
+          over the islands with an island_radius of at least
+          min_island_radius.)",
+           "num_points"_a, "min_island_radius"_a)
+      .def("get_island_index", &PathFinder::getIslandIndex,
+           R"(Returns the index of the island pt belongs to, -1 if pt is not
+          on the navmesh.)",
+           "pt"_a)
       .def("find_path", py::overload_cast<ShortestPath&>(&PathFinder::findPath),
            "path"_a)
       .def("find_path",
            py::overload_cast<MultiGoalShortestPath&>(&PathFinder::findPath),
            "path"_a)
+      .def("geodesic_distance", &PathFinder::geodesicDistance,
+           R"(Returns the geodesic distance from pt to the closest goal of the
+          distance field. The field is computed on first use and cached.)",
+           "field"_a, "pt"_a)
+      .def("find_paths",
+           py::overload_cast<const std::vector<ShortestPath::ptr>&>(
+               &PathFinder::findPaths),
+           R"(Finds the shortest paths for a list of queries in parallel.
+          Returns whether or not a path was found for each query.)",
+           "paths"_a, py::call_guard<py::gil_scoped_release>())
+      .def("find_paths",
+           py::overload_cast<const std::vector<MultiGoalShortestPath::ptr>&>(
+               &PathFinder::findPaths),
+           "paths"_a, py::call_guard<py::gil_scoped_release>())
+      .def_property("num_threads", &PathFinder::getNumThreads,
+                    &PathFinder::setNumThreads,
+                    R"(Number of threads used by batched queries.)")
       .def("try_step", &PathFinder::tryStep<Magnum::Vector3>, "start"_a,
            "end"_a)
       .def("try_step", &PathFinder::tryStep<vec3f>, "start"_a, "end"_a)
@@ -109,7 +155,22 @@ void initShortestPathBindings(py::module& m) {
            "pt"_a, "max_search_radius"_a = 2.0)
       .def("is_navigable", &PathFinder::isNavigable,
            R"(Checks to see if the agent can stand at the specified point.)",
-           "pt"_a, "max_y_delta"_a = 0.5);
+           "pt"_a, "max_y_delta"_a = 0.5)
+      .def("try_step_batch", &PathFinder::tryStepBatch,
+           R"(Steps a batch of agents at once. starts and ends are N x 3 arrays,
+          out is a preallocated, writeable C-contiguous float32 N x 3 array
+          receiving the end locations. Returns whether or not the batch ran.)",
+           "starts"_a, "ends"_a, "out"_a, "allow_sliding"_a = true,
+           py::call_guard<py::gil_scoped_release>())
+      .def("snap_point_batch", &PathFinder::snapPointBatch,
+           R"(Snaps an N x 3 array of points into the preallocated, writeable
+          C-contiguous float32 N x 3 array out.)",
+           "points"_a, "out"_a, py::call_guard<py::gil_scoped_release>())
+      .def("is_navigable_batch", &PathFinder::isNavigableBatch,
+           R"(Checks an N x 3 array of points, writing the results into the
+          preallocated bool array out of length N.)",
+           "points"_a, "out"_a, "max_y_delta"_a = 0.5,
+           py::call_guard<py::gil_scoped_release>());
 
   // this enum is used by GreedyGeodesicFollowerImpl so it needs to be defined
   // before it
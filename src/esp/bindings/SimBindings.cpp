@@ -43,6 +43,10 @@ void initSimBindings(py::module& m) {
           "texture_downsample_factor",
           &SimulatorConfiguration::textureDownsampleFactor,
           R"(Set to 0 by default. Set to 1 to get 2x downsampled textures. 2 for 4x, etc.)")
+      .def_readwrite(
+          "num_asset_loading_threads",
+          &SimulatorConfiguration::numAssetLoadingThreads,
+          R"(Threads decoding textures and importing meshes while loading assets. Set to 1 by default, <= 0 to use all hardware threads.)")
       .def_readwrite("physics_config_file",
                      &SimulatorConfiguration::physicsConfigFile)
       .def_readwrite("scene_light_setup",
@@ -140,6 +144,13 @@ void initSimBindings(py::module& m) {
               metadata::MetadataMediator::DEFAULT_LIGHTING_KEY,
           "scene_id"_a = 0,
           R"(Instance an object into the scene via a template referenced by its handle. Optionally attach the object to an existing SceneNode and assign its initial LightSetup key.)")
+      .def(
+          "preallocate_objects", &Simulator::preallocateObjects,
+          "object_lib_handle"_a, "capacity"_a,
+          "light_setup_key"_a =
+              metadata::MetadataMediator::DEFAULT_LIGHTING_KEY,
+          "scene_id"_a = 0,
+          R"(Pre-instantiate capacity objects of a template into a pool. While pooled, removed objects of the template wait hidden in the pool, and add_object_by_handle with the same LightSetup key reuses them instead of instancing new ones.)")
       .def("remove_object", &Simulator::removeObject, "object_id"_a,
            "delete_object_node"_a = true, "delete_visual_node"_a = true,
            "scene_id"_a = 0, R"(
@@ -177,6 +188,10 @@ void initSimBindings(py::module& m) {
           R"(Step the physics simulation by a desired timestep (dt). Note that resulting world time after step may not be exactly t+dt. Use get_world_time to query current simulation time.)")
       .def("get_world_time", &Simulator::getWorldTime,
            R"(Query the current simualtion world time.)")
+      .def(
+          "get_moved_object_ids", &Simulator::getMovedObjectIds,
+          "scene_id"_a = 0,
+          R"(Query the IDs of the objects moved by the last step_world. Objects asleep for the whole step are left out, so renderers and recorders can update only what moved.)")
       .def("get_gravity", &Simulator::getGravity, "scene_id"_a = 0,
            R"(Query the gravity vector for a scene.)")
       .def("set_gravity", &Simulator::setGravity, "gravity"_a, "scene_id"_a = 0,
@@ -235,6 +250,34 @@ void initSimBindings(py::module& m) {
           "get_angular_velocity", &Simulator::getAngularVelocity, "object_id"_a,
           "scene_id"_a = 0,
           R"(Get the angular component of an object's velocity. Only non-zero for MotionType::DYNAMIC objects.)")
+      .def(
+          "get_rigid_states", &Simulator::getRigidStates, "object_ids"_a,
+          "states"_a, "scene_id"_a = 0,
+          R"(Write the rigid states of N objects into the preallocated, writeable C-contiguous float32 array states (N x 7), one row of translation and rotation quaternion (x, y, z, qx, qy, qz, qw) per object. object_ids is an int32 array. Writes nothing and returns False if any ID is invalid.)",
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "set_rigid_states", &Simulator::setRigidStates, "object_ids"_a,
+          "states"_a, "scene_id"_a = 0,
+          R"(Set the rigid states of N objects from a float32 array (N x 7) laid out as in get_rigid_states. MotionType::STATIC objects are skipped. Sets nothing and returns False if any ID is invalid.)",
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "get_velocities", &Simulator::getVelocities, "object_ids"_a,
+          "velocities"_a, "scene_id"_a = 0,
+          R"(Write the linear and angular velocities of N objects into the preallocated, writeable C-contiguous float32 array velocities (N x 6). Only non-zero for MotionType::DYNAMIC objects. Writes nothing and returns False if any ID is invalid.)",
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "set_velocities", &Simulator::setVelocities, "object_ids"_a,
+          "velocities"_a, "scene_id"_a = 0,
+          R"(Set the linear and angular velocities of N objects from a float32 array (N x 6). Only affects MotionType::DYNAMIC objects. Sets nothing and returns False if any ID is invalid.)",
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "save_physics_state", &Simulator::savePhysicsState, "scene_id"_a = 0,
+          R"(Capture the transforms, velocities, sleeping states and MotionTypes of all objects and the world time into an in-memory PhysicsState. Returns None if the scene has no physics.)")
+      .def(
+          "restore_physics_state", &Simulator::restorePhysicsState, "state"_a,
+          "scene_id"_a = 0,
+          R"(Restore a PhysicsState captured by save_physics_state in place, without re-creating objects. Objects added since are left untouched. Restores nothing and returns False if any captured object has been removed since.)",
+          py::call_guard<py::gil_scoped_release>())
       .def(
           "apply_force", &Simulator::applyForce, "force"_a,
           "relative_position"_a, "object_id"_a, "scene_id"_a = 0,
@@ -261,6 +304,12 @@ void initSimBindings(py::module& m) {
           "cast_ray", &Simulator::castRay, "ray"_a, "max_distance"_a = 100.0,
           "scene_id"_a = 0,
           R"(Cast a ray into the collidable scene and return hit results. Physics must be enabled. max_distance in units of ray length.)")
+      .def(
+          "cast_rays", &Simulator::castRays, "origins"_a, "directions"_a,
+          "max_distance"_a, "hit_distances"_a, "hit_normals"_a,
+          "hit_object_ids"_a, "scene_id"_a = 0,
+          R"(Cast N rays given as N x 3 float32 arrays of origins and directions and write the closest hit of each into the preallocated, writeable arrays hit_distances (float32, N), hit_normals (C-contiguous float32, N x 3) and hit_object_ids (int32, N). Missed rays report an infinite distance. Physics must be enabled. Returns whether or not the batch ran.)",
+          py::call_guard<py::gil_scoped_release>())
       .def("set_object_bb_draw", &Simulator::setObjectBBDraw, "draw_bb"_a,
            "object_id"_a, "scene_id"_a = 0,
            R"(Enable or disable bounding box visualization for an object.)")
@@ -272,6 +321,10 @@ void initSimBindings(py::module& m) {
           "recompute_navmesh", &Simulator::recomputeNavMesh, "pathfinder"_a,
           "navmesh_settings"_a, "include_static_objects"_a = false,
           R"(Recompute the NavMesh for a given PathFinder instance using configured NavMeshSettings. Optionally include all MotionType::STATIC objects in the navigability constraints.)")
+      .def(
+          "update_navmesh", &Simulator::updateNavMesh, "pathfinder"_a,
+          "region"_a, "include_static_objects"_a = false,
+          R"(Incrementally rebuild the tiles of a tiled NavMesh overlapping a world space region after geometry inside it changed, e.g. a MotionType::STATIC object was added, moved or removed. The NavMesh must have been recomputed in this process, NavMeshes loaded from a file can't be updated.)")
       .def("add_trajectory_object", &Simulator::addTrajectoryObject,
            "traj_vis_name"_a, "points"_a, "num_segments"_a = 3,
            "radius"_a = .001, "color"_a = Mn::Color4{0.9, 0.1, 0.1, 1.0},
@@ -334,6 +387,12 @@ void initSimBindings(py::module& m) {
           "translation"_a, "rotation"_a, "isNavigationTest"_a = false,
           "scene_id"_a = 0,
           R"(Run collision detection and return a binary indicator of penetration between the specified object and any other collision object. Physics must be enabled.)")
+      .def(
+          "pre_add_contact_test_batch", &Simulator::preAddContactTestBatch,
+          "object_handle"_a, "translations"_a,
+          "rotations"_a = std::vector<Magnum::Quaternion>{},
+          "filter_group"_a = 1, "filter_mask"_a = -1, "scene_id"_a = 0,
+          R"(Test a contact test object at K candidate translations (and optionally K rotations) in one call. Only objects whose bounds overlap a candidate are narrowphase tested. Returns a list of K booleans, True where the candidate is in contact. Physics must be enabled.)")
       .def("update_drop_point_node", &Simulator::updateDropPointNode,
            "position"_a, R"(Update drop point node)")
       .def("get_object_bb_y_coord", &Simulator::getObjectBBYCoord,
@@ -0,0 +1,151 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+#include <Corrade/Corrade.h>
+
+namespace esp {
+namespace core {
+
+namespace {
+
+// The pool whose work this thread is currently doing, and as which worker, so
+// that nested parallelFor calls keep the worker's index
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local int currentWorkerIndex = 0;
+
+struct CurrentWorkerScope {
+  CurrentWorkerScope(const ThreadPool* pool, int workerIndex)
+      : previousPool{currentPool}, previousWorkerIndex{currentWorkerIndex} {
+    currentPool = pool;
+    currentWorkerIndex = workerIndex;
+  }
+  ~CurrentWorkerScope() {
+    currentPool = previousPool;
+    currentWorkerIndex = previousWorkerIndex;
+  }
+
+  const ThreadPool* previousPool;
+  int previousWorkerIndex;
+};
+
+}  // namespace
+
+int ThreadPool::defaultNumThreads() {
+#ifdef CORRADE_TARGET_EMSCRIPTEN
+  return 1;
+#else
+  return std::max(1u, std::thread::hardware_concurrency());
+#endif
+}
+
+ThreadPool& ThreadPool::shared() {
+  static ThreadPool pool;
+  return pool;
+}
+
+ThreadPool::ThreadPool(int numThreads) {
+  numThreads_ = numThreads > 0 ? numThreads : defaultNumThreads();
+#ifdef CORRADE_TARGET_EMSCRIPTEN
+  numThreads_ = 1;
+#endif
+  workers_.reserve(numThreads_ - 1);
+  for (int iWorker = 1; iWorker < numThreads_; ++iWorker) {
+    workers_.emplace_back(&ThreadPool::workerLoop, this, iWorker);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(jobMutex_);
+    shutdown_ = true;
+  }
+  jobStarted_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::parallelFor(size_t count, const Task& task, size_t grainSize) {
+  if (count == 0)
+    return;
+
+  // nested in one of our own tasks, whose call holds the dispatch lock
+  if (currentPool == this) {
+    const int workerIndex = currentWorkerIndex;
+    for (size_t iItem = 0; iItem < count; ++iItem) {
+      task(workerIndex, iItem);
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> dispatchLock(dispatchMutex_);
+  CurrentWorkerScope workerScope{this, 0};
+  if (workers_.empty() || count == 1) {
+    for (size_t iItem = 0; iItem < count; ++iItem) {
+      task(0, iItem);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(jobMutex_);
+    task_ = &task;
+    count_ = count;
+    grainSize_ = std::max<size_t>(grainSize, 1);
+    nextItem_ = 0;
+    busyWorkers_ = static_cast<int>(workers_.size());
+    ++jobGeneration_;
+  }
+  jobStarted_.notify_all();
+
+  runChunks(0);
+
+  std::unique_lock<std::mutex> lock(jobMutex_);
+  jobFinished_.wait(lock, [this]() { return busyWorkers_ == 0; });
+  task_ = nullptr;
+}
+
+void ThreadPool::workerLoop(int workerIndex) {
+  CurrentWorkerScope workerScope{this, workerIndex};
+  uint64_t lastGeneration = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(jobMutex_);
+      jobStarted_.wait(lock, [this, lastGeneration]() {
+        return shutdown_ || jobGeneration_ != lastGeneration;
+      });
+      if (shutdown_)
+        return;
+      lastGeneration = jobGeneration_;
+    }
+
+    runChunks(workerIndex);
+
+    {
+      std::lock_guard<std::mutex> lock(jobMutex_);
+      --busyWorkers_;
+    }
+    jobFinished_.notify_one();
+  }
+}
+
+void ThreadPool::runChunks(int workerIndex) {
+  const Task& task = *task_;
+  while (true) {
+    const size_t begin = nextItem_.fetch_add(grainSize_);
+    if (begin >= count_)
+      break;
+    const size_t end = std::min(begin + grainSize_, count_);
+    for (size_t iItem = begin; iItem < end; ++iItem) {
+      task(workerIndex, iItem);
+    }
+  }
+}
+
+}  // namespace core
+}  // namespace esp
@@ -0,0 +1,124 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_CORE_THREADPOOL_H_
+#define ESP_CORE_THREADPOOL_H_
+
+/** @file */
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "esp/core/esp.h"
+
+namespace esp {
+namespace core {
+
+/**
+ * @brief Small persistent pool of worker threads used to spread independent
+ * work items (path queries, raycasts, tile builds, ...) across cores.
+ *
+ * Work is handed out in small chunks from a shared atomic counter, so idle
+ * workers keep pulling items until the range is exhausted and uneven item
+ * costs are balanced automatically. The calling thread participates as worker
+ * 0, so a pool of N threads spawns N - 1 background threads.
+ *
+ * A pool runs one @ref parallelFor at a time. Calls from other threads block
+ * until the running one finishes, so for the duration of a call worker index 0
+ * belongs to the calling thread alone. Calls nested in a task of the same pool
+ * run serially on the thread executing the task, under that worker's index.
+ *
+ * Components that aren't given an explicit thread count should use @ref
+ * shared() rather than starting their own thread per core.
+ *
+ * On platforms without thread support (Emscripten) the pool always runs
+ * serially on the calling thread.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @brief Task signature: receives the index of the worker executing it (in
+   * [0, @ref numThreads())) and the index of the item to process.
+   *
+   * The worker index is stable for the duration of a @ref parallelFor call and
+   * can be used to address per-worker scratch state without locking.
+   */
+  typedef std::function<void(int workerIndex, size_t itemIndex)> Task;
+
+  /**
+   * @brief Constructor.
+   *
+   * @param numThreads Total number of workers including the calling thread.
+   * Values <= 0 select @ref defaultNumThreads().
+   */
+  explicit ThreadPool(int numThreads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @return The total number of workers, including the calling thread.
+   */
+  int numThreads() const { return numThreads_; }
+
+  /**
+   * @brief Runs @p task for every item in [0, @p count) and blocks until all
+   * of them have finished.
+   *
+   * Concurrent calls from other threads wait for this one to finish. Nested
+   * calls from within @p task run serially with the index of the worker
+   * making them.
+   *
+   * @param count Number of items to process.
+   * @param task Callable invoked once per item.
+   * @param grainSize Number of consecutive items claimed by a worker at once.
+   */
+  void parallelFor(size_t count, const Task& task, size_t grainSize = 1);
+
+  /**
+   * @return The number of hardware threads, or 1 if threads are unavailable
+   */
+  static int defaultNumThreads();
+
+  /**
+   * @brief The process-wide pool with @ref defaultNumThreads() workers,
+   * created on first use.
+   */
+  static ThreadPool& shared();
+
+ private:
+  void workerLoop(int workerIndex);
+  void runChunks(int workerIndex);
+
+  int numThreads_ = 1;
+  std::vector<std::thread> workers_;
+
+  //! Serializes @ref parallelFor calls from different threads.
+  std::mutex dispatchMutex_;
+
+  //! Guards the job description and wakes/joins the workers.
+  std::mutex jobMutex_;
+  std::condition_variable jobStarted_;
+  std::condition_variable jobFinished_;
+  uint64_t jobGeneration_ = 0;
+  int busyWorkers_ = 0;
+  bool shutdown_ = false;
+
+  const Task* task_ = nullptr;
+  size_t count_ = 0;
+  size_t grainSize_ = 1;
+  std::atomic<size_t> nextItem_{0};
+
+  ESP_SMART_POINTERS(ThreadPool)
+};
+
+}  // namespace core
+}  // namespace esp
+
+#endif  // ESP_CORE_THREADPOOL_H_
@@ -44,7 +44,7 @@ struct WindowlessContext::Impl {
 #ifdef ESP_BUILD_EGL_SUPPORT
     config.setCudaDevice(device);
 #else  // NO ESP_BUILD_EGL_SUPPORT
-    if (device != 0)
+    if (device > 0)
       Mn::Fatal{} << "GLX context does not support multiple GPUs. Please "
                      "compile with --headless for multi-gpu support via EGL";
 
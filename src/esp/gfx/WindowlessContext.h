@@ -12,6 +12,10 @@ namespace gfx {
 
 class WindowlessContext {
  public:
+  /**
+   * @brief Create a context on a GPU. With EGL, pass -1 to use the default
+   * device instead, which can be a software renderer on machines without one.
+   */
   explicit WindowlessContext(int gpuDevice = 0);
 
   ~WindowlessContext() { LOG(INFO) << "Deconstructing WindowlessContext"; }
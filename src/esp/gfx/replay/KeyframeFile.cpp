@@ -0,0 +1,521 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "KeyframeFile.h"
+
+#include <Corrade/Utility/Endianness.h>
+#include <Magnum/Math/Functions.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace gfx {
+namespace replay {
+
+namespace {
+
+constexpr char kFileMagic[4] = {'H', 'S', 'R', 'P'};
+constexpr char kChunkMagic[4] = {'C', 'H', 'N', 'K'};
+constexpr uint32_t kFormatVersion = 1;
+
+// translations are stored in 16.16 fixed point
+constexpr float kTranslationScale = 65536.0f;
+constexpr float kMaxTranslation = 32767.0f;
+
+// rotations keep 20 bits for each of their three smallest components
+constexpr int kRotationBits = 20;
+constexpr uint32_t kRotationMask = (1u << kRotationBits) - 1;
+constexpr float kRotationRange = 0.70710678f;  // 1/sqrt(2)
+
+//! Appends little-endian values to a byte buffer
+class BufferWriter {
+ public:
+  explicit BufferWriter(std::string& buffer) : buffer_(buffer) {}
+
+  template <class T>
+  void write(T value) {
+    static_assert(std::is_integral<T>::value, "use writeFloat for floats");
+    value = Cr::Utility::Endianness::littleEndian(value);
+    buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void writeByte(uint8_t value) { buffer_.push_back(char(value)); }
+
+  void writeFloat(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    write(bits);
+  }
+
+  void writeVector3(const Mn::Vector3& value) {
+    writeFloat(value.x());
+    writeFloat(value.y());
+    writeFloat(value.z());
+  }
+
+  void writeVector3(const vec3f& value) {
+    writeFloat(value.x());
+    writeFloat(value.y());
+    writeFloat(value.z());
+  }
+
+  void writeBytes(const char* data, size_t size) {
+    buffer_.append(data, size);
+  }
+
+ private:
+  std::string& buffer_;
+};
+
+//! Reads little-endian values from a byte range, failing on overrun
+class BufferReader {
+ public:
+  BufferReader(const char* data, size_t size) : data_(data), size_(size) {}
+
+  bool ok() const { return ok_; }
+  size_t position() const { return position_; }
+  bool atEnd() const { return position_ == size_; }
+
+  template <class T>
+  T read() {
+    static_assert(std::is_integral<T>::value, "use readFloat for floats");
+    T value{};
+    if (const char* bytes = advance(sizeof(T))) {
+      std::memcpy(&value, bytes, sizeof(T));
+    }
+    return Cr::Utility::Endianness::littleEndian(value);
+  }
+
+  uint8_t readByte() {
+    const char* bytes = advance(1);
+    return bytes ? uint8_t(*bytes) : 0;
+  }
+
+  float readFloat() {
+    const uint32_t bits = read<uint32_t>();
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  Mn::Vector3 readVector3() {
+    const float x = readFloat();
+    const float y = readFloat();
+    const float z = readFloat();
+    return {x, y, z};
+  }
+
+  void fail() { ok_ = false; }
+
+  //! Returns the next @p size bytes, or nullptr if there are fewer left
+  const char* advance(size_t size) {
+    if (!ok_ || size > size_ - position_) {
+      ok_ = false;
+      return nullptr;
+    }
+    const char* bytes = data_ + position_;
+    position_ += size;
+    return bytes;
+  }
+
+  //! Reads a count and checks that its records can fit in the rest
+  uint32_t readCount(size_t minRecordSize) {
+    const uint32_t count = read<uint32_t>();
+    if (ok_ && count > (size_ - position_) / minRecordSize) {
+      ok_ = false;
+      return 0;
+    }
+    return count;
+  }
+
+ private:
+  const char* data_;
+  size_t size_;
+  size_t position_ = 0;
+  bool ok_ = true;
+};
+
+// minimum encoded sizes of the keyframe records, used to reject bogus counts
+constexpr size_t kLoadRecordSize = 4 + 4 + 9 * 4 + 4 + 2;
+constexpr size_t kCreationRecordSize = 4 + 4 + 1 + 3 * 4 + 4 + 4;
+constexpr size_t kDeletionRecordSize = 4;
+constexpr size_t kStateUpdateRecordSize = 4 + 3 * 4 + 8 + 4;
+constexpr size_t kUserTransformRecordSize = 4 + 7 * 4;
+
+}  // namespace
+
+void quantizeTranslation(const Mn::Vector3& translation, int32_t* out) {
+  for (int i = 0; i < 3; ++i) {
+    const float clamped =
+        Mn::Math::clamp(translation[i], -kMaxTranslation, kMaxTranslation);
+    out[i] = int32_t(std::lround(clamped * kTranslationScale));
+  }
+}
+
+Mn::Vector3 dequantizeTranslation(const int32_t* quantized) {
+  return {quantized[0] / kTranslationScale, quantized[1] / kTranslationScale,
+          quantized[2] / kTranslationScale};
+}
+
+uint64_t packRotation(const Mn::Quaternion& rotation) {
+  const Mn::Vector4 q{rotation.vector(), rotation.scalar()};
+  int largest = 0;
+  for (int i = 1; i < 4; ++i) {
+    if (std::abs(q[i]) > std::abs(q[largest])) {
+      largest = i;
+    }
+  }
+  // q and -q are the same rotation; flip so the dropped component is positive
+  const float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+
+  uint64_t packed = uint64_t(largest);
+  int shift = 2;
+  for (int i = 0; i < 4; ++i) {
+    if (i == largest) {
+      continue;
+    }
+    const float normalized =
+        Mn::Math::clamp((sign * q[i] / kRotationRange + 1.0f) * 0.5f, 0.0f,
+                        1.0f);
+    packed |= uint64_t(std::lround(normalized * kRotationMask)) << shift;
+    shift += kRotationBits;
+  }
+  return packed;
+}
+
+Mn::Quaternion unpackRotation(uint64_t packed) {
+  const int largest = int(packed & 3);
+  Mn::Vector4 q;
+  float sumSquared = 0.0f;
+  int shift = 2;
+  for (int i = 0; i < 4; ++i) {
+    if (i == largest) {
+      continue;
+    }
+    const uint32_t bits = uint32_t(packed >> shift) & kRotationMask;
+    q[i] = (float(bits) / kRotationMask * 2.0f - 1.0f) * kRotationRange;
+    sumSquared += q[i] * q[i];
+    shift += kRotationBits;
+  }
+  q[largest] = std::sqrt(std::max(0.0f, 1.0f - sumSquared));
+  return Mn::Quaternion{q.xyz(), q.w()}.normalized();
+}
+
+KeyframeWriter::KeyframeWriter(const std::string& filepath)
+    : file_(filepath, std::ios::binary | std::ios::trunc) {
+  if (!file_) {
+    LOG(ERROR) << "KeyframeWriter: unable to open " << filepath;
+    return;
+  }
+  buffer_.clear();
+  BufferWriter writer{buffer_};
+  writer.writeBytes(kFileMagic, sizeof(kFileMagic));
+  writer.write(kFormatVersion);
+  file_.write(buffer_.data(), buffer_.size());
+}
+
+uint32_t KeyframeWriter::getStringId(const std::string& string) {
+  auto it = stringIds_.find(string);
+  if (it == stringIds_.end()) {
+    it = stringIds_.emplace(string, uint32_t(stringIds_.size())).first;
+    newStrings_.push_back(&it->first);
+  }
+  return it->second;
+}
+
+bool KeyframeWriter::writeChunk(std::vector<Keyframe>::const_iterator begin,
+                                std::vector<Keyframe>::const_iterator end) {
+  if (!file_.good()) {
+    LOG(ERROR) << "KeyframeWriter::writeChunk: file is not writable";
+    return false;
+  }
+  if (begin == end) {
+    return true;
+  }
+
+  // encode the keyframes first to find the strings they introduce
+  newStrings_.clear();
+  std::string keyframeBuffer;
+  BufferWriter writer{keyframeBuffer};
+  for (auto it = begin; it != end; ++it) {
+    const Keyframe& keyframe = *it;
+
+    writer.write(uint32_t(keyframe.loads.size()));
+    for (const auto& load : keyframe.loads) {
+      writer.write(uint32_t(load.type));
+      writer.write(getStringId(load.filepath));
+      writer.writeVector3(load.frame.up());
+      writer.writeVector3(load.frame.front());
+      writer.writeVector3(load.frame.origin());
+      writer.writeFloat(load.virtualUnitToMeters);
+      writer.writeByte(load.requiresLighting);
+      writer.writeByte(load.splitInstanceMesh);
+    }
+
+    writer.write(uint32_t(keyframe.creations.size()));
+    for (const auto& pair : keyframe.creations) {
+      const auto& creation = pair.second;
+      writer.write(int32_t(pair.first));
+      writer.write(getStringId(creation.filepath));
+      writer.writeByte(bool(creation.scale));
+      writer.writeVector3(creation.scale ? *creation.scale : Mn::Vector3{});
+      writer.write(uint32_t(
+          esp::assets::RenderAssetInstanceCreationInfo::Flags::UnderlyingType(
+              creation.flags)));
+      writer.write(getStringId(creation.lightSetupKey));
+    }
+
+    writer.write(uint32_t(keyframe.deletions.size()));
+    for (const auto key : keyframe.deletions) {
+      writer.write(int32_t(key));
+    }
+
+    writer.write(uint32_t(keyframe.stateUpdates.size()));
+    int32_t translation[3];
+    for (const auto& pair : keyframe.stateUpdates) {
+      const auto& state = pair.second;
+      writer.write(int32_t(pair.first));
+      quantizeTranslation(state.absTransform.translation, translation);
+      for (const int32_t component : translation) {
+        writer.write(component);
+      }
+      writer.write(packRotation(state.absTransform.rotation));
+      writer.write(int32_t(state.semanticId));
+    }
+
+    writer.write(uint32_t(keyframe.userTransforms.size()));
+    for (const auto& pair : keyframe.userTransforms) {
+      const auto& transform = pair.second;
+      writer.write(getStringId(pair.first));
+      writer.writeVector3(transform.translation);
+      writer.writeVector3(transform.rotation.vector());
+      writer.writeFloat(transform.rotation.scalar());
+    }
+  }
+
+  buffer_.clear();
+  BufferWriter stringWriter{buffer_};
+  for (const std::string* string : newStrings_) {
+    stringWriter.write(uint32_t(string->size()));
+    stringWriter.writeBytes(string->data(), string->size());
+  }
+  const uint64_t bodySize = buffer_.size() + keyframeBuffer.size();
+
+  std::string header;
+  BufferWriter headerWriter{header};
+  headerWriter.writeBytes(kChunkMagic, sizeof(kChunkMagic));
+  headerWriter.write(uint32_t(end - begin));
+  headerWriter.write(uint32_t(newStrings_.size()));
+  headerWriter.write(uint32_t(0));
+  headerWriter.write(bodySize);
+
+  file_.write(header.data(), header.size());
+  file_.write(buffer_.data(), buffer_.size());
+  file_.write(keyframeBuffer.data(), keyframeBuffer.size());
+  file_.flush();
+  newStrings_.clear();
+
+  if (!file_.good()) {
+    LOG(ERROR) << "KeyframeWriter::writeChunk: write failed";
+    return false;
+  }
+  return true;
+}
+
+void KeyframeWriter::close() {
+  if (file_.is_open()) {
+    file_.close();
+  }
+}
+
+KeyframeReader::KeyframeReader(const std::string& filepath) {
+  data_ = Cr::Utility::Directory::mapRead(filepath);
+  if (!data_) {
+    LOG(ERROR) << "KeyframeReader: unable to read " << filepath;
+    return;
+  }
+
+  BufferReader reader{data_.data(), data_.size()};
+  const char* magic = reader.advance(sizeof(kFileMagic));
+  const uint32_t version = reader.read<uint32_t>();
+  if (!reader.ok() ||
+      std::memcmp(magic, kFileMagic, sizeof(kFileMagic)) != 0) {
+    LOG(ERROR) << "KeyframeReader: " << filepath
+               << " is not a replay keyframe file";
+    return;
+  }
+  if (version != kFormatVersion) {
+    LOG(ERROR) << "KeyframeReader: " << filepath << " has format version "
+               << version << ", expected " << kFormatVersion;
+    return;
+  }
+
+  // index the chunks, reading their strings and skipping their keyframes
+  while (!reader.atEnd()) {
+    const size_t chunkStart = reader.position();
+    magic = reader.advance(sizeof(kChunkMagic));
+    const uint32_t numKeyframes = reader.read<uint32_t>();
+    const uint32_t numStrings = reader.read<uint32_t>();
+    reader.read<uint32_t>();
+    const uint64_t bodySize = reader.read<uint64_t>();
+    if (!reader.ok() ||
+        std::memcmp(magic, kChunkMagic, sizeof(kChunkMagic)) != 0 ||
+        bodySize > data_.size() - reader.position()) {
+      // a recording interrupted mid-chunk leaves a truncated last chunk
+      LOG(WARNING) << "KeyframeReader: ignoring truncated or corrupt data at "
+                      "byte "
+                   << chunkStart << " of " << filepath;
+      break;
+    }
+
+    BufferReader body{data_.data() + reader.position(), size_t(bodySize)};
+    for (uint32_t i = 0; i < numStrings && body.ok(); ++i) {
+      const uint32_t length = body.read<uint32_t>();
+      if (const char* bytes = body.advance(length)) {
+        strings_.emplace_back(bytes, length);
+      }
+    }
+    if (!body.ok()) {
+      LOG(ERROR) << "KeyframeReader: corrupt string table at byte "
+                 << chunkStart << " of " << filepath;
+      return;
+    }
+
+    chunks_.push_back(Chunk{numKeyframes_, int(numKeyframes),
+                            reader.position() + body.position(),
+                            size_t(bodySize) - body.position()});
+    numKeyframes_ += numKeyframes;
+    reader.advance(bodySize);
+  }
+
+  valid_ = true;
+}
+
+int KeyframeReader::getChunkOfKeyframe(int keyframeIndex) const {
+  ASSERT(keyframeIndex >= 0 && keyframeIndex < numKeyframes_);
+  auto it = std::upper_bound(chunks_.begin(), chunks_.end(), keyframeIndex,
+                             [](int index, const Chunk& chunk) {
+                               return index < chunk.firstKeyframe;
+                             });
+  return int(it - chunks_.begin()) - 1;
+}
+
+bool KeyframeReader::readChunk(int chunkIndex,
+                               std::vector<Keyframe>& keyframes) const {
+  ASSERT(chunkIndex >= 0 && chunkIndex < getNumChunks());
+  const Chunk& chunk = chunks_[chunkIndex];
+  keyframes.clear();
+  keyframes.resize(chunk.numKeyframes);
+
+  BufferReader reader{data_.data() + chunk.offset, chunk.size};
+  auto readString = [&]() -> const std::string* {
+    const uint32_t id = reader.read<uint32_t>();
+    if (!reader.ok() || id >= strings_.size()) {
+      reader.fail();
+      return nullptr;
+    }
+    return &strings_[id];
+  };
+
+  for (Keyframe& keyframe : keyframes) {
+    uint32_t count = reader.readCount(kLoadRecordSize);
+    keyframe.loads.resize(count);
+    for (auto& load : keyframe.loads) {
+      load.type = esp::assets::AssetType(reader.read<uint32_t>());
+      const std::string* filepath = readString();
+      const Mn::Vector3 up = reader.readVector3();
+      const Mn::Vector3 front = reader.readVector3();
+      const Mn::Vector3 origin = reader.readVector3();
+      load.virtualUnitToMeters = reader.readFloat();
+      load.requiresLighting = reader.readByte() != 0;
+      load.splitInstanceMesh = reader.readByte() != 0;
+      if (!filepath) {
+        break;
+      }
+      load.filepath = *filepath;
+      load.frame = geo::CoordinateFrame{
+          vec3f{up.x(), up.y(), up.z()}, vec3f{front.x(), front.y(), front.z()},
+          vec3f{origin.x(), origin.y(), origin.z()}};
+    }
+
+    count = reader.readCount(kCreationRecordSize);
+    keyframe.creations.reserve(count);
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+      const auto key = RenderAssetInstanceKey(reader.read<int32_t>());
+      const std::string* filepath = readString();
+      const bool hasScale = reader.readByte() != 0;
+      const Mn::Vector3 scaleVector = reader.readVector3();
+      const uint32_t flags = reader.read<uint32_t>();
+      const std::string* lightSetupKey = readString();
+      if (!filepath || !lightSetupKey) {
+        break;
+      }
+      Cr::Containers::Optional<Mn::Vector3> scale;
+      if (hasScale) {
+        scale = scaleVector;
+      }
+      using CreationInfo = esp::assets::RenderAssetInstanceCreationInfo;
+      keyframe.creations.emplace_back(
+          key, CreationInfo{*filepath, scale,
+                            CreationInfo::Flags{CreationInfo::Flag(flags)},
+                            *lightSetupKey});
+    }
+
+    count = reader.readCount(kDeletionRecordSize);
+    keyframe.deletions.resize(count);
+    for (auto& key : keyframe.deletions) {
+      key = RenderAssetInstanceKey(reader.read<int32_t>());
+    }
+
+    count = reader.readCount(kStateUpdateRecordSize);
+    keyframe.stateUpdates.resize(count);
+    int32_t translation[3];
+    for (auto& pair : keyframe.stateUpdates) {
+      pair.first = RenderAssetInstanceKey(reader.read<int32_t>());
+      for (int32_t& component : translation) {
+        component = reader.read<int32_t>();
+      }
+      auto& state = pair.second;
+      state.absTransform.translation = dequantizeTranslation(translation);
+      state.absTransform.rotation = unpackRotation(reader.read<uint64_t>());
+      state.semanticId = reader.read<int32_t>();
+    }
+
+    count = reader.readCount(kUserTransformRecordSize);
+    keyframe.userTransforms.reserve(count);
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+      const std::string* name = readString();
+      const Mn::Vector3 translation = reader.readVector3();
+      const Mn::Vector3 rotationVector = reader.readVector3();
+      const float rotationScalar = reader.readFloat();
+      if (!name) {
+        break;
+      }
+      keyframe.userTransforms[*name] = Transform{
+          translation, Mn::Quaternion{rotationVector, rotationScalar}};
+    }
+
+    if (!reader.ok()) {
+      break;
+    }
+  }
+
+  if (!reader.ok() || !reader.atEnd()) {
+    LOG(ERROR) << "KeyframeReader::readChunk: chunk " << chunkIndex
+               << " is corrupt";
+    keyframes.clear();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace replay
+}  // namespace gfx
+}  // namespace esp
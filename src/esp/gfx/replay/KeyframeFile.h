@@ -0,0 +1,169 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GFX_REPLAY_KEYFRAMEFILE_H_
+#define ESP_GFX_REPLAY_KEYFRAMEFILE_H_
+
+/** @file
+ * @brief Classes @ref esp::gfx::replay::KeyframeWriter and @ref
+ * esp::gfx::replay::KeyframeReader
+ */
+
+#include "Keyframe.h"
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Utility/Directory.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace esp {
+namespace gfx {
+namespace replay {
+
+/**
+@brief Writes render keyframes in the binary replay format, one chunk at a
+time.
+
+A file starts with an 8 byte header, the magic `HSRP` and a 32-bit format
+version, followed by any number of chunks. Each chunk holds a 24 byte header
+(magic `CHNK`, keyframe count, string count, reserved, 64-bit byte size of the
+strings and keyframes), the strings first used by the chunk, then its
+keyframes. All values are little-endian.
+
+Asset filepaths, light setup keys and user transform names are stored once
+in a string table spread over the chunks and referenced by index. Instance
+state updates are fixed-width 28 byte records: the key, the translation
+quantized to 1/65536 units, the rotation packed to 64 bits as its three
+smallest components, and the semantic id. User transforms are stored at full
+precision since they typically hold cameras.
+
+Chunks are appended and flushed as they are written, so a recording's memory
+stays bounded by one chunk. See @ref KeyframeReader.
+*/
+class KeyframeWriter {
+ public:
+  /**
+   * @brief Create or truncate a file and write the file header.
+   * @param filepath The file to write.
+   */
+  explicit KeyframeWriter(const std::string& filepath);
+
+  /** @brief Whether the file was opened and all writes succeeded. */
+  bool isValid() const { return file_.good(); }
+
+  /**
+   * @brief Append one chunk holding a range of keyframes and flush it.
+   * Empty ranges write nothing.
+   * @return Whether or not the chunk was written.
+   */
+  bool writeChunk(std::vector<Keyframe>::const_iterator begin,
+                  std::vector<Keyframe>::const_iterator end);
+
+  /** @brief Flush and close the file. */
+  void close();
+
+ private:
+  uint32_t getStringId(const std::string& string);
+
+  std::ofstream file_;
+  std::unordered_map<std::string, uint32_t> stringIds_;
+  //! Strings first used by the chunk being encoded
+  std::vector<const std::string*> newStrings_;
+  //! Reused encoding buffer
+  std::string buffer_;
+
+  ESP_SMART_POINTERS(KeyframeWriter)
+};
+
+/**
+@brief Reads files written by @ref KeyframeWriter.
+
+The file is memory-mapped and indexed on construction, reading only the chunk
+headers and string table. Keyframes are decoded a chunk at a time with
+@ref readChunk.
+*/
+class KeyframeReader {
+ public:
+  /**
+   * @brief Map and index a file. Check @ref isValid afterwards.
+   * @param filepath The file to read.
+   */
+  explicit KeyframeReader(const std::string& filepath);
+
+  /** @brief Whether the file was mapped and indexed successfully. */
+  bool isValid() const { return valid_; }
+
+  int getNumKeyframes() const { return numKeyframes_; }
+
+  int getNumChunks() const { return chunks_.size(); }
+
+  /** @brief The index of the chunk holding a keyframe. */
+  int getChunkOfKeyframe(int keyframeIndex) const;
+
+  /** @brief The index of the first keyframe of a chunk. */
+  int getFirstKeyframeOfChunk(int chunkIndex) const {
+    return chunks_[chunkIndex].firstKeyframe;
+  }
+
+  int getNumKeyframesOfChunk(int chunkIndex) const {
+    return chunks_[chunkIndex].numKeyframes;
+  }
+
+  /**
+   * @brief Decode the keyframes of one chunk.
+   * @param chunkIndex The chunk to decode.
+   * @param[out] keyframes The decoded keyframes, replacing any previous
+   * contents.
+   * @return Whether or not the chunk was decoded. Fails on corrupt data.
+   */
+  bool readChunk(int chunkIndex, std::vector<Keyframe>& keyframes) const;
+
+ private:
+  struct Chunk {
+    int firstKeyframe;
+    int numKeyframes;
+    //! Offset and size of the chunk's keyframe records in the file
+    size_t offset;
+    size_t size;
+  };
+
+  Corrade::Containers::Array<const char,
+                             Corrade::Utility::Directory::MapDeleter>
+      data_;
+  std::vector<Chunk> chunks_;
+  std::vector<std::string> strings_;
+  int numKeyframes_ = 0;
+  bool valid_ = false;
+
+  ESP_SMART_POINTERS(KeyframeReader)
+};
+
+/**
+ * @brief Quantize a translation to fixed-point 1/65536 units, as stored by
+ * @ref KeyframeWriter. Components outside +-32767 units are clamped.
+ */
+void quantizeTranslation(const Magnum::Vector3& translation, int32_t* out);
+
+/** @brief Inverse of @ref quantizeTranslation. */
+Magnum::Vector3 dequantizeTranslation(const int32_t* quantized);
+
+/**
+ * @brief Pack a unit quaternion to 64 bits by dropping its largest component
+ * and storing the other three with 20 bits each, as stored by @ref
+ * KeyframeWriter.
+ */
+uint64_t packRotation(const Magnum::Quaternion& rotation);
+
+/** @brief Inverse of @ref packRotation. */
+Magnum::Quaternion unpackRotation(uint64_t packed);
+
+}  // namespace replay
+}  // namespace gfx
+}  // namespace esp
+
+#endif  // ESP_GFX_REPLAY_KEYFRAMEFILE_H_
@@ -7,29 +7,29 @@
 #include "esp/assets/ResourceManager.h"
 #include "esp/core/esp.h"
 
-#include <rapidjson/document.h>
+#include <algorithm>
 
 namespace esp {
 namespace gfx {
 namespace replay {
 
-void Player::readKeyframesFromJsonDocument(const rapidjson::Document&) {
-  LOG(WARNING) << "Player::readKeyframesFromJsonDocument: not implemented";
-#if 0  // coming soon
-  ASSERT(keyframes_.empty());
-  esp::io::ReadMember(d, "keyframes", keyframes_);
-#endif
-}
-
 Player::Player(const LoadAndCreateRenderAssetInstanceCallback& callback)
     : loadAndCreateRenderAssetInstanceCallback(callback) {}
 
-void Player::readKeyframesFromFile(const std::string& filepath) {
+bool Player::readKeyframesFromFile(const std::string& filepath) {
   clearFrame();
   keyframes_.clear();
+  snapshots_.clear();
+  chunkKeyframes_.clear();
+  chunkIndex_ = ID_UNDEFINED;
 
-  auto newDoc = esp::io::parseJsonFile(filepath);
-  readKeyframesFromJsonDocument(newDoc);
+  reader_ = KeyframeReader::create(filepath);
+  if (!reader_->isValid()) {
+    LOG(ERROR) << "Player::readKeyframesFromFile: unable to read " << filepath;
+    reader_ = nullptr;
+    return false;
+  }
+  return true;
 }
 
 int Player::getKeyframeIndex() const {
@@ -37,20 +37,72 @@ int Player::getKeyframeIndex() const {
 }
 
 int Player::getNumKeyframes() const {
-  return keyframes_.size();
+  return reader_ ? reader_->getNumKeyframes() : keyframes_.size();
+}
+
+const Keyframe& Player::getKeyframe(int frameIndex) const {
+  if (!reader_) {
+    return keyframes_[frameIndex];
+  }
+  const int chunkIndex = reader_->getChunkOfKeyframe(frameIndex);
+  if (chunkIndex != chunkIndex_) {
+    chunkIndex_ = chunkIndex;
+    if (!reader_->readChunk(chunkIndex, chunkKeyframes_)) {
+      // play the corrupt chunk's keyframes as empty ones
+      chunkKeyframes_.resize(reader_->getNumKeyframesOfChunk(chunkIndex));
+    }
+  }
+  return chunkKeyframes_[frameIndex -
+                         reader_->getFirstKeyframeOfChunk(chunkIndex)];
 }
 
 void Player::setKeyframeIndex(int frameIndex) {
   ASSERT(frameIndex == -1 ||
          (frameIndex >= 0 && frameIndex < getNumKeyframes()));
 
-  if (frameIndex < frameIndex_) {
+  if (frameIndex == frameIndex_) {
+    return;
+  }
+  if (frameIndex == -1) {
     clearFrame();
+    return;
   }
 
-  while (frameIndex_ < frameIndex) {
-    applyKeyframe(keyframes_[++frameIndex_]);
+  // the nearest kept snapshot at or before frameIndex, or -1 for none
+  int snapshotFrameIndex = ID_UNDEFINED;
+  if (!snapshots_.empty()) {
+    snapshotFrameIndex = std::min(frameIndex / snapshotInterval_,
+                                  int(snapshots_.size()) - 1) *
+                         snapshotInterval_;
   }
+
+  if (frameIndex > frameIndex_ && frameIndex_ >= snapshotFrameIndex) {
+    if (frameIndex - frameIndex_ <= snapshotInterval_) {
+      // a short step forward, as during playback
+      while (frameIndex_ < frameIndex) {
+        applyKeyframe(getKeyframe(++frameIndex_));
+        keepSnapshot(frameIndex_, state_);
+      }
+      return;
+    }
+    Snapshot snapshot = state_;
+    advanceSnapshot(&snapshot, frameIndex_, frameIndex);
+    setSceneToSnapshot(std::move(snapshot));
+  } else {
+    Snapshot snapshot;
+    if (snapshotFrameIndex != ID_UNDEFINED) {
+      snapshot = snapshots_[snapshotFrameIndex / snapshotInterval_];
+    }
+    advanceSnapshot(&snapshot, snapshotFrameIndex, frameIndex);
+    setSceneToSnapshot(std::move(snapshot));
+  }
+  frameIndex_ = frameIndex;
+}
+
+void Player::setSnapshotInterval(int interval) {
+  ASSERT(interval > 0);
+  snapshotInterval_ = interval;
+  snapshots_.clear();
 }
 
 bool Player::getUserTransform(const std::string& name,
@@ -59,7 +111,7 @@ bool Player::getUserTransform(const std::string& name,
   ASSERT(frameIndex_ >= 0 && frameIndex_ < getNumKeyframes());
   ASSERT(translation);
   ASSERT(rotation);
-  const auto& keyframe = keyframes_[frameIndex_];
+  const auto& keyframe = getKeyframe(frameIndex_);
   const auto& it = keyframe.userTransforms.find(name);
   if (it != keyframe.userTransforms.end()) {
     *translation = it->second.translation;
@@ -75,22 +127,63 @@ void Player::clearFrame() {
     delete pair.second;
   }
   createdInstances_.clear();
-  assetInfos_.clear();
+  state_ = Snapshot{};
   frameIndex_ = -1;
 }
 
 void Player::applyKeyframe(const Keyframe& keyframe) {
+  applyKeyframeToSnapshot(keyframe, &state_);
+
+  for (const auto& deletionInstanceKey : keyframe.deletions) {
+    const auto& it = createdInstances_.find(deletionInstanceKey);
+    if (it == createdInstances_.end()) {
+      // missing instance for this key, probably due to a failed instance
+      // creation
+      continue;
+    }
+
+    delete it->second;
+    createdInstances_.erase(it);
+  }
+
+  for (const auto& pair : keyframe.creations) {
+    const auto& instanceKey = pair.first;
+    const auto& it = state_.instances.find(instanceKey);
+    if (it == state_.instances.end()) {
+      // missing asset info, or deleted in this same keyframe
+      continue;
+    }
+    ASSERT(createdInstances_.count(instanceKey) == 0);
+    auto node = createInstance(state_, *it->second.creation);
+    if (node) {
+      createdInstances_[instanceKey] = node;
+    }
+  }
+
+  for (const auto& pair : keyframe.stateUpdates) {
+    const auto& it = createdInstances_.find(pair.first);
+    if (it == createdInstances_.end()) {
+      // missing instance for this key, probably due to a failed instance
+      // creation
+      continue;
+    }
+    setInstanceState(it->second, pair.second);
+  }
+}
+
+void Player::applyKeyframeToSnapshot(const Keyframe& keyframe,
+                                     Snapshot* snapshot) {
   for (const auto& assetInfo : keyframe.loads) {
-    ASSERT(assetInfos_.count(assetInfo.filepath) == 0);
+    ASSERT(snapshot->assetInfos.count(assetInfo.filepath) == 0);
     if (failedFilepaths_.count(assetInfo.filepath)) {
       continue;
     }
-    assetInfos_[assetInfo.filepath] = assetInfo;
+    snapshot->assetInfos[assetInfo.filepath] = assetInfo;
   }
 
   for (const auto& pair : keyframe.creations) {
     const auto& creation = pair.second;
-    if (!assetInfos_.count(creation.filepath)) {
+    if (!snapshot->assetInfos.count(creation.filepath)) {
       if (!failedFilepaths_.count(creation.filepath)) {
         LOG(WARNING) << "Player: missing asset info for [" << creation.filepath
                      << "]";
@@ -98,49 +191,119 @@ void Player::applyKeyframe(const Keyframe& keyframe) {
       }
       continue;
     }
-    ASSERT(assetInfos_.count(creation.filepath));
-    auto node = loadAndCreateRenderAssetInstanceCallback(
-        assetInfos_[creation.filepath], creation);
-    if (!node) {
-      if (!failedFilepaths_.count(creation.filepath)) {
-        LOG(WARNING) << "Player: load failed for asset [" << creation.filepath
-                     << "]";
-        failedFilepaths_.insert(creation.filepath);
-      }
-      continue;
-    }
-
-    const auto& instanceKey = pair.first;
-    ASSERT(createdInstances_.count(instanceKey) == 0);
-    createdInstances_[instanceKey] = node;
+    snapshot->instances[pair.first] = InstanceSnapshot{
+        std::make_shared<const esp::assets::RenderAssetInstanceCreationInfo>(
+            creation),
+        Corrade::Containers::NullOpt};
   }
 
   for (const auto& deletionInstanceKey : keyframe.deletions) {
-    const auto& it = createdInstances_.find(deletionInstanceKey);
-    if (it == createdInstances_.end()) {
-      // missing instance for this key, probably due to a failed instance
-      // creation
-      continue;
+    snapshot->instances.erase(deletionInstanceKey);
+  }
+
+  for (const auto& pair : keyframe.stateUpdates) {
+    const auto& it = snapshot->instances.find(pair.first);
+    if (it != snapshot->instances.end()) {
+      it->second.state = pair.second;
     }
+  }
+}
 
-    auto node = it->second;
-    delete node;
-    createdInstances_.erase(deletionInstanceKey);
+void Player::advanceSnapshot(Snapshot* snapshot,
+                             int fromFrameIndex,
+                             int toFrameIndex) {
+  for (int frameIndex = fromFrameIndex + 1; frameIndex <= toFrameIndex;
+       ++frameIndex) {
+    applyKeyframeToSnapshot(getKeyframe(frameIndex), snapshot);
+    keepSnapshot(frameIndex, *snapshot);
   }
+}
 
-  for (const auto& pair : keyframe.stateUpdates) {
+void Player::keepSnapshot(int frameIndex, const Snapshot& snapshot) {
+  // snapshots are kept in order, the first time their keyframe is reached
+  if (frameIndex % snapshotInterval_ == 0 &&
+      frameIndex / snapshotInterval_ == int(snapshots_.size())) {
+    snapshots_.push_back(snapshot);
+  }
+}
+
+namespace {
+
+bool isSameCreation(const esp::assets::RenderAssetInstanceCreationInfo& a,
+                    const esp::assets::RenderAssetInstanceCreationInfo& b) {
+  const bool sameScale =
+      bool(a.scale) == bool(b.scale) && (!a.scale || *a.scale == *b.scale);
+  return a.filepath == b.filepath && sameScale && a.flags == b.flags &&
+         a.lightSetupKey == b.lightSetupKey;
+}
+
+}  // namespace
+
+void Player::setSceneToSnapshot(Snapshot&& snapshot) {
+  // Delete the nodes of instances that aren't live in the new snapshot. A node
+  // is also re-created if it was moved but the instance in the new snapshot
+  // has no state yet, so it gets its initial transform back.
+  for (auto it = createdInstances_.begin(); it != createdInstances_.end();) {
+    const auto& current = state_.instances.at(it->first);
+    const auto& newIt = snapshot.instances.find(it->first);
+    if (newIt == snapshot.instances.end() ||
+        (current.state && !newIt->second.state) ||
+        (current.creation != newIt->second.creation &&
+         !isSameCreation(*current.creation, *newIt->second.creation))) {
+      delete it->second;
+      it = createdInstances_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // create missing nodes and update the ones whose state changed
+  for (const auto& pair : snapshot.instances) {
+    const auto& instance = pair.second;
     const auto& it = createdInstances_.find(pair.first);
-    if (it == createdInstances_.end()) {
-      // missing instance for this key, probably due to a failed instance
-      // creation
+    if (it != createdInstances_.end()) {
+      const auto& current = state_.instances.at(pair.first);
+      if (instance.state &&
+          !(current.state && *current.state == *instance.state)) {
+        setInstanceState(it->second, *instance.state);
+      }
+      continue;
+    }
+    auto node = createInstance(snapshot, *instance.creation);
+    if (!node) {
       continue;
     }
-    auto node = it->second;
-    const auto& state = pair.second;
-    node->setTranslation(state.absTransform.translation);
-    node->setRotation(state.absTransform.rotation);
-    setSemanticIdForSubtree(node, state.semanticId);
+    createdInstances_[pair.first] = node;
+    if (instance.state) {
+      setInstanceState(node, *instance.state);
+    }
+  }
+
+  state_ = std::move(snapshot);
+}
+
+scene::SceneNode* Player::createInstance(
+    const Snapshot& snapshot,
+    const esp::assets::RenderAssetInstanceCreationInfo& creation) {
+  if (failedFilepaths_.count(creation.filepath)) {
+    return nullptr;
   }
+  const auto& it = snapshot.assetInfos.find(creation.filepath);
+  ASSERT(it != snapshot.assetInfos.end());
+  auto node = loadAndCreateRenderAssetInstanceCallback(it->second, creation);
+  if (!node) {
+    LOG(WARNING) << "Player: load failed for asset [" << creation.filepath
+                 << "]";
+    failedFilepaths_.insert(creation.filepath);
+  }
+  return node;
+}
+
+void Player::setInstanceState(esp::scene::SceneNode* node,
+                              const RenderAssetInstanceState& state) {
+  node->setTranslation(state.absTransform.translation);
+  node->setRotation(state.absTransform.rotation);
+  setSemanticIdForSubtree(node, state.semanticId);
 }
 
 void Player::setSemanticIdForSubtree(esp::scene::SceneNode* rootNode,
@@ -6,13 +6,13 @@
 #define ESP_GFX_REPLAY_PLAYER_H_
 
 #include "Keyframe.h"
+#include "KeyframeFile.h"
 
 #include "esp/assets/Asset.h"
 #include "esp/assets/RenderAssetInstanceCreationInfo.h"
 
-#include <rapidjson/document.h>
-
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -27,14 +27,20 @@ namespace replay {
 /**
  * @brief Playback for "render replay".
  *
- * This class is work in progress (readKeyframesFromFile isn't implemented
- * yet).
- *
  * This class reads render keyframes from a file so that observations can be
  * reproduced (from the same camera perspective or a different one). A loaded
  * keyframe can be set (applied to the scene) with setKeyframeIndex; render
  * asset instances are added to the scene as needed and new observations can be
- * rendered. Render assets are loaded as needed. See also @ref Recorder. See
+ * rendered. Render assets are loaded as needed. Files are memory-mapped and
+ * decoded a chunk at a time as keyframes are set, so long recordings don't need
+ * to fit in memory.
+ *
+ * As keyframes are played, the Player keeps a snapshot of the live instances
+ * and their states every few keyframes. Seeking backward, or forward by more
+ * than a few keyframes, starts from the nearest snapshot and applies keyframes
+ * to the snapshot rather than to the scene. The scene is then updated to
+ * match, keeping the nodes of instances that are still live. See also @ref
+ * Recorder. See
  * examples/replay_tutorial.py for usage of this class through bindings (coming
  * soon).
  */
@@ -55,8 +61,10 @@ class Player {
    * @brief Read keyframes. See also @ref Recorder::writeSavedKeyframesToFile.
    * After calling this, use @ref setKeyframeIndex to set a keyframe.
    * @param filepath
+   * @return Whether or not the file was read. On failure, no keyframes are
+   * available.
    */
-  void readKeyframesFromFile(const std::string& filepath);
+  bool readKeyframesFromFile(const std::string& filepath);
 
   /**
    * @brief Get the currently-set keyframe, or -1 if no keyframe is set.
@@ -74,6 +82,15 @@ class Player {
    */
   void setKeyframeIndex(int frameIndex);
 
+  /**
+   * @brief Set how many keyframes apart snapshots are kept for seeking.
+   * Smaller intervals make seeking faster but use more memory, one copy of
+   * the live instance states per snapshot. Clears existing snapshots.
+   */
+  void setSnapshotInterval(int interval);
+
+  int getSnapshotInterval() const { return snapshotInterval_; }
+
   /**
    * @brief Get a user transform. See @ref Recorder::addUserTransformToKeyframe
    * for usage tips.
@@ -86,13 +103,48 @@ class Player {
    * @brief Reserved for unit-testing.
    */
   void debugSetKeyframes(std::vector<Keyframe>&& keyframes) {
+    clearFrame();
+    snapshots_.clear();
+    reader_ = nullptr;
     keyframes_ = std::move(keyframes);
   }
 
  private:
-  void readKeyframesFromJsonDocument(const rapidjson::Document& d);
+  using CreationInfoPtr =
+      std::shared_ptr<const esp::assets::RenderAssetInstanceCreationInfo>;
+
+  // A live instance. The creation info is shared by all snapshots holding the
+  // instance, which also identifies the instance if its key is reused.
+  struct InstanceSnapshot {
+    CreationInfoPtr creation;
+    Corrade::Containers::Optional<RenderAssetInstanceState> state;
+  };
+
+  // The loaded assets and live instances after applying some keyframes
+  struct Snapshot {
+    std::map<std::string, esp::assets::AssetInfo> assetInfos;
+    std::map<RenderAssetInstanceKey, InstanceSnapshot> instances;
+  };
+
+  //! The keyframe at an index, decoding its chunk if reading from a file
+  const Keyframe& getKeyframe(int frameIndex) const;
   void clearFrame();
+  //! Apply a keyframe to the scene and to @ref state_
   void applyKeyframe(const Keyframe& keyframe);
+  //! Apply a keyframe to a snapshot without touching the scene
+  void applyKeyframeToSnapshot(const Keyframe& keyframe, Snapshot* snapshot);
+  //! Apply keyframes (from, to] to a snapshot, keeping snapshots on the way
+  void advanceSnapshot(Snapshot* snapshot,
+                       int fromFrameIndex,
+                       int toFrameIndex);
+  void keepSnapshot(int frameIndex, const Snapshot& snapshot);
+  //! Update the scene from @ref state_ to another snapshot, reusing nodes
+  void setSceneToSnapshot(Snapshot&& snapshot);
+  scene::SceneNode* createInstance(
+      const Snapshot& snapshot,
+      const esp::assets::RenderAssetInstanceCreationInfo& creation);
+  static void setInstanceState(esp::scene::SceneNode* node,
+                               const RenderAssetInstanceState& state);
   static void setSemanticIdForSubtree(esp::scene::SceneNode* rootNode,
                                       int semanticId);
 
@@ -100,7 +152,15 @@ class Player {
       loadAndCreateRenderAssetInstanceCallback;
   int frameIndex_ = -1;
   std::vector<Keyframe> keyframes_;
-  std::map<std::string, esp::assets::AssetInfo> assetInfos_;
+  KeyframeReader::ptr reader_;
+  // keyframes of the most recently decoded chunk of reader_
+  mutable std::vector<Keyframe> chunkKeyframes_;
+  mutable int chunkIndex_ = ID_UNDEFINED;
+  // the loaded assets and live instances at frameIndex_
+  Snapshot state_;
+  // snapshots_[i] is the state at keyframe i * snapshotInterval_
+  std::vector<Snapshot> snapshots_;
+  int snapshotInterval_ = 64;
   std::map<RenderAssetInstanceKey, scene::SceneNode*> createdInstances_;
   std::set<std::string> failedFilepaths_;
 
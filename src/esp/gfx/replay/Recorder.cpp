@@ -5,39 +5,77 @@
 #include "Recorder.h"
 
 #include "esp/assets/RenderAssetInstanceCreationInfo.h"
-#include "esp/io/json.h"
+#include "esp/core/ThreadPool.h"
 #include "esp/scene/SceneNode.h"
 
+#include <algorithm>
+
 namespace esp {
 namespace gfx {
 namespace replay {
 
 /**
  * @brief Helper class to get notified when a SceneNode is about to be
- * destroyed.
+ * destroyed. It also keeps the instance's creation info, so that an instance
+ * released for reuse can be recorded as created again.
  */
 class NodeDeletionHelper : public Magnum::SceneGraph::AbstractFeature3D {
  public:
-  NodeDeletionHelper(scene::SceneNode& node_, Recorder* writer)
+  NodeDeletionHelper(
+      scene::SceneNode& node_,
+      Recorder* writer,
+      const esp::assets::RenderAssetInstanceCreationInfo& creation)
       : Magnum::SceneGraph::AbstractFeature3D(node_),
         node(&node_),
-        recorder_(writer) {}
+        recorder_(writer),
+        creation_(creation) {}
 
   ~NodeDeletionHelper() override {
+    if (released_) {
+      // the deletion was already recorded on release
+      recorder_->releasedHelpers_.erase(this);
+    } else {
+      recorder_->onDeleteRenderAssetInstance(node);
+    }
+  }
+
+  bool isReleased() const { return released_; }
+
+  void release() {
     recorder_->onDeleteRenderAssetInstance(node);
+    recorder_->releasedHelpers_.insert(this);
+    released_ = true;
+  }
+
+  void reuse() {
+    recorder_->releasedHelpers_.erase(this);
+    released_ = false;
+    recorder_->addInstance(node, creation_, this);
   }
 
  private:
   Recorder* recorder_ = nullptr;
-  const scene::SceneNode* node = nullptr;
+  scene::SceneNode* node = nullptr;
+  esp::assets::RenderAssetInstanceCreationInfo creation_;
+  bool released_ = false;
 };
 
+Recorder::Recorder() = default;
+
 Recorder::~Recorder() {
+  if (streamWriter_) {
+    stopStreamingKeyframesToFile();
+  }
+
   // Delete NodeDeletionHelpers. This is important because they hold raw
   // pointers to this Recorder and these pointers would become dangling
-  // (invalid) after this Recorder is destroyed.
-  for (auto& instanceRecord : instanceRecords_) {
-    delete instanceRecord.deletionHelper;
+  // (invalid) after this Recorder is destroyed. Each deletion removes the
+  // helper from instanceRecords_ or releasedHelpers_.
+  while (!instanceRecords_.empty()) {
+    delete instanceRecords_.back().deletionHelper;
+  }
+  while (!releasedHelpers_.empty()) {
+    delete *releasedHelpers_.begin();
   }
 }
 
@@ -51,22 +89,46 @@ void Recorder::onCreateRenderAssetInstance(
   ASSERT(node);
   ASSERT(findInstance(node) == ID_UNDEFINED);
 
-  RenderAssetInstanceKey instanceKey = getNewInstanceKey();
-
-  getKeyframe().creations.emplace_back(std::make_pair(instanceKey, creation));
-
   // Constructing NodeDeletionHelper here is equivalent to calling
   // node->addFeature. We keep a pointer to deletionHelper so we can delete it
   // manually later if necessary.
-  NodeDeletionHelper* deletionHelper = new NodeDeletionHelper{*node, this};
+  NodeDeletionHelper* deletionHelper =
+      new NodeDeletionHelper{*node, this, creation};
 
-  instanceRecords_.emplace_back(InstanceRecord{
-      node, instanceKey, Corrade::Containers::NullOpt, deletionHelper});
+  addInstance(node, creation, deletionHelper);
+}
+
+void Recorder::addInstance(
+    scene::SceneNode* node,
+    const esp::assets::RenderAssetInstanceCreationInfo& creation,
+    NodeDeletionHelper* deletionHelper) {
+  RenderAssetInstanceKey instanceKey = getNewInstanceKey();
+
+  getKeyframe().creations.emplace_back(std::make_pair(instanceKey, creation));
+
+  instanceIndices_[node] = instanceRecords_.size();
+  instanceRecords_.emplace_back(
+      InstanceRecord{node, instanceKey, deletionHelper});
+  recentTranslations_.emplace_back();
+  recentRotations_.emplace_back();
+  recentSemanticIds_.push_back(ID_UNDEFINED);
+  hasRecentState_.push_back(false);
 }
 
 void Recorder::saveKeyframe() {
   updateInstanceStates();
   advanceKeyframe();
+
+  if (streamWriter_ &&
+      savedKeyframes_.size() >= static_cast<size_t>(keyframesPerChunk_)) {
+    if (!streamWriter_->writeChunk(savedKeyframes_.begin(),
+                                   savedKeyframes_.end())) {
+      streamFailed_ = true;
+    }
+    addLoadsCreationsDeletions(savedKeyframes_.begin(), savedKeyframes_.end(),
+                               &streamedSummary_);
+    savedKeyframes_.clear();
+  }
 }
 
 void Recorder::addUserTransformToKeyframe(const std::string& name,
@@ -93,10 +155,14 @@ void Recorder::addLoadsCreationsDeletions(KeyframeIterator begin,
 
 void Recorder::checkAndAddDeletion(Keyframe* keyframe,
                                    RenderAssetInstanceKey instanceKey) {
-  auto it =
-      std::find_if(keyframe->creations.begin(), keyframe->creations.end(),
-                   [&](const auto& pair) { return pair.first == instanceKey; });
-  if (it != keyframe->creations.end()) {
+  // Creations are sorted by key, since keys are handed out in increasing order
+  // and keyframes are only ever merged into later ones.
+  auto it = std::lower_bound(
+      keyframe->creations.begin(), keyframe->creations.end(), instanceKey,
+      [](const auto& pair, RenderAssetInstanceKey key) {
+        return pair.first < key;
+      });
+  if (it != keyframe->creations.end() && it->first == instanceKey) {
     // this deletion just cancels out with an earlier creation
     keyframe->creations.erase(it);
   } else {
@@ -106,6 +172,24 @@ void Recorder::checkAndAddDeletion(Keyframe* keyframe,
   }
 }
 
+void Recorder::releaseRenderAssetInstances(scene::SceneNode& node) {
+  scene::preOrderFeatureTraversalWithCallback<NodeDeletionHelper>(
+      node, [](NodeDeletionHelper& helper) {
+        if (!helper.isReleased()) {
+          helper.release();
+        }
+      });
+}
+
+void Recorder::reuseRenderAssetInstances(scene::SceneNode& node) {
+  scene::preOrderFeatureTraversalWithCallback<NodeDeletionHelper>(
+      node, [](NodeDeletionHelper& helper) {
+        if (helper.isReleased()) {
+          helper.reuse();
+        }
+      });
+}
+
 void Recorder::onDeleteRenderAssetInstance(const scene::SceneNode* node) {
   int index = findInstance(node);
   ASSERT(index != ID_UNDEFINED);
@@ -114,7 +198,26 @@ void Recorder::onDeleteRenderAssetInstance(const scene::SceneNode* node) {
 
   checkAndAddDeletion(&getKeyframe(), instanceKey);
 
-  instanceRecords_.erase(instanceRecords_.begin() + index);
+  removeInstance(index);
+}
+
+void Recorder::removeInstance(int index) {
+  instanceIndices_.erase(instanceRecords_[index].node);
+  // fill the hole with the last instance to keep the arrays packed
+  const int last = instanceRecords_.size() - 1;
+  if (index != last) {
+    instanceRecords_[index] = instanceRecords_[last];
+    recentTranslations_[index] = recentTranslations_[last];
+    recentRotations_[index] = recentRotations_[last];
+    recentSemanticIds_[index] = recentSemanticIds_[last];
+    hasRecentState_[index] = hasRecentState_[last];
+    instanceIndices_[instanceRecords_[index].node] = index;
+  }
+  instanceRecords_.pop_back();
+  recentTranslations_.pop_back();
+  recentRotations_.pop_back();
+  recentSemanticIds_.pop_back();
+  hasRecentState_.pop_back();
 }
 
 Keyframe& Recorder::getKeyframe() {
@@ -125,14 +228,9 @@ RenderAssetInstanceKey Recorder::getNewInstanceKey() {
   return nextInstanceKey_++;
 }
 
-int Recorder::findInstance(const scene::SceneNode* queryNode) {
-  auto it = std::find_if(instanceRecords_.begin(), instanceRecords_.end(),
-                         [&queryNode](const InstanceRecord& record) {
-                           return record.node == queryNode;
-                         });
-
-  return it == instanceRecords_.end() ? ID_UNDEFINED
-                                      : int(it - instanceRecords_.begin());
+int Recorder::findInstance(const scene::SceneNode* queryNode) const {
+  const auto it = instanceIndices_.find(queryNode);
+  return it == instanceIndices_.end() ? ID_UNDEFINED : it->second;
 }
 
 RenderAssetInstanceState Recorder::getInstanceState(
@@ -145,47 +243,152 @@ RenderAssetInstanceState Recorder::getInstanceState(
   return RenderAssetInstanceState{absTransform, node->getSemanticId()};
 }
 
+void Recorder::updateInstanceState(int index) {
+  const auto state = getInstanceState(instanceRecords_[index].node);
+  const Transform& transform = state.absTransform;
+  const bool changed = !hasRecentState_[index] ||
+                       recentTranslations_[index] != transform.translation ||
+                       recentRotations_[index] != transform.rotation ||
+                       recentSemanticIds_[index] != state.semanticId;
+  stateChanged_[index] = changed;
+  if (changed) {
+    recentTranslations_[index] = transform.translation;
+    recentRotations_[index] = transform.rotation;
+    recentSemanticIds_[index] = state.semanticId;
+    hasRecentState_[index] = true;
+  }
+}
+
 void Recorder::updateInstanceStates() {
-  for (auto& instanceRecord : instanceRecords_) {
-    auto state = getInstanceState(instanceRecord.node);
-    if (!instanceRecord.recentState || state != instanceRecord.recentState) {
-      getKeyframe().stateUpdates.push_back(
-          std::make_pair(instanceRecord.instanceKey, state));
-      instanceRecord.recentState = state;
+  // Gather and compare states first; each instance only touches its own
+  // slots, so this can be spread over threads.
+  const size_t numInstances = instanceRecords_.size();
+  stateChanged_.resize(numInstances);
+  if (threadPool_) {
+    threadPool_->parallelFor(
+        numInstances,
+        [this](int, size_t index) { updateInstanceState(index); },
+        /* grainSize */ 256);
+  } else {
+    for (size_t index = 0; index < numInstances; ++index) {
+      updateInstanceState(index);
+    }
+  }
+
+  auto& stateUpdates = getKeyframe().stateUpdates;
+  for (size_t index = 0; index < numInstances; ++index) {
+    if (stateChanged_[index]) {
+      stateUpdates.emplace_back(
+          instanceRecords_[index].instanceKey,
+          RenderAssetInstanceState{
+              Transform{recentTranslations_[index], recentRotations_[index]},
+              recentSemanticIds_[index]});
     }
   }
 }
 
+void Recorder::setNumThreads(int numThreads) {
+  if (ownedThreadPool_ && ownedThreadPool_->numThreads() == numThreads) {
+    return;
+  }
+  ownedThreadPool_ = nullptr;
+  threadPool_ = nullptr;
+  if (numThreads <= 0) {
+    threadPool_ = &core::ThreadPool::shared();
+  } else if (numThreads > 1) {
+    ownedThreadPool_ = std::make_unique<core::ThreadPool>(numThreads);
+    threadPool_ = ownedThreadPool_.get();
+  }
+}
+
 void Recorder::advanceKeyframe() {
   savedKeyframes_.emplace_back(std::move(currKeyframe_));
   currKeyframe_ = Keyframe{};
 }
 
-void Recorder::writeSavedKeyframesToFile(const std::string& filepath) {
-  auto document = writeKeyframesToJsonDocument();
-  esp::io::writeJsonToFile(document, filepath);
+void Recorder::consolidateWrittenKeyframes(const Keyframe& summary) {
+  // Put the loads, creations and deletions of the written keyframes ahead of
+  // the current keyframe, so the next file starts with the full scene.
+  Keyframe current = std::move(currKeyframe_);
+  currKeyframe_ = summary;
+  currKeyframe_.loads.insert(currKeyframe_.loads.end(), current.loads.begin(),
+                             current.loads.end());
+  currKeyframe_.creations.insert(currKeyframe_.creations.end(),
+                                 current.creations.begin(),
+                                 current.creations.end());
+  for (const auto& deletionInstanceKey : current.deletions) {
+    checkAndAddDeletion(&currKeyframe_, deletionInstanceKey);
+  }
+  currKeyframe_.userTransforms = std::move(current.userTransforms);
+
+  // the next file also needs the state of every instance
+  std::fill(hasRecentState_.begin(), hasRecentState_.end(), false);
+}
+
+bool Recorder::writeSavedKeyframesToFile(const std::string& filepath) {
+  if (streamWriter_) {
+    LOG(ERROR) << "Recorder::writeSavedKeyframesToFile: keyframes are being "
+                  "streamed to file; use stopStreamingKeyframesToFile instead";
+    return false;
+  }
+  if (savedKeyframes_.empty()) {
+    LOG(WARNING) << "Recorder::writeSavedKeyframesToFile: no saved keyframes "
+                    "to write";
+  }
+
+  KeyframeWriter writer{filepath};
+  const bool success =
+      writer.writeChunk(savedKeyframes_.begin(), savedKeyframes_.end());
+  writer.close();
 
-  // consolidate saved keyframes into current keyframe
+  Keyframe summary;
   addLoadsCreationsDeletions(savedKeyframes_.begin(), savedKeyframes_.end(),
-                             &getKeyframe());
+                             &summary);
   savedKeyframes_.clear();
+  consolidateWrittenKeyframes(summary);
+  return success;
 }
 
-rapidjson::Document Recorder::writeKeyframesToJsonDocument() {
-  LOG(WARNING) << "Recorder::writeKeyframesToJsonDocument: not implemented";
-  return rapidjson::Document();
-#if 0  // coming soon
-  if (savedKeyframes_.empty()) {
-    LOG(WARNING) << "Recorder::writeKeyframesToJsonDocument: no saved "
-                    "keyframes to write";
-    return rapidjson::Document();
+bool Recorder::startStreamingKeyframesToFile(const std::string& filepath,
+                                             int keyframesPerChunk) {
+  if (streamWriter_) {
+    LOG(ERROR) << "Recorder::startStreamingKeyframesToFile: already streaming";
+    return false;
+  }
+  if (keyframesPerChunk <= 0) {
+    LOG(ERROR) << "Recorder::startStreamingKeyframesToFile: keyframesPerChunk "
+                  "must be positive";
+    return false;
   }
+  auto writer = KeyframeWriter::create_unique(filepath);
+  if (!writer->isValid()) {
+    return false;
+  }
+  streamWriter_ = std::move(writer);
+  keyframesPerChunk_ = keyframesPerChunk;
+  streamedSummary_ = Keyframe{};
+  streamFailed_ = false;
+  return true;
+}
 
-  Document d(kObjectType);
-  Document::AllocatorType& allocator = d.GetAllocator();
-  esp::io::AddMember(d, "keyframes", savedKeyframes_, allocator);
-  return d;
-#endif
+bool Recorder::stopStreamingKeyframesToFile() {
+  if (!streamWriter_) {
+    LOG(ERROR) << "Recorder::stopStreamingKeyframesToFile: not streaming";
+    return false;
+  }
+  if (!streamWriter_->writeChunk(savedKeyframes_.begin(),
+                                 savedKeyframes_.end())) {
+    streamFailed_ = true;
+  }
+  streamWriter_->close();
+  streamWriter_ = nullptr;
+
+  addLoadsCreationsDeletions(savedKeyframes_.begin(), savedKeyframes_.end(),
+                             &streamedSummary_);
+  savedKeyframes_.clear();
+  consolidateWrittenKeyframes(streamedSummary_);
+  streamedSummary_ = Keyframe{};
+  return !streamFailed_;
 }
 
 }  // namespace replay
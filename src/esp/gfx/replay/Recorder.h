@@ -6,16 +6,22 @@
 #define ESP_GFX_REPLAY_RECORDER_H_
 
 #include "Keyframe.h"
+#include "KeyframeFile.h"
 
-#include <rapidjson/document.h>
-
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace esp {
 namespace assets {
 struct AssetInfo;
 struct RenderAssetInstanceCreationInfo;
 }  // namespace assets
+namespace core {
+class ThreadPool;
+}
 namespace scene {
 class SceneNode;
 }
@@ -27,20 +33,21 @@ class NodeDeletionHelper;
 /**
  * @brief Recording for "render replay".
  *
- * This class is work in progress (writeSavedKeyframesToFile isn't implemented
- * yet).
- *
  * This class saves and serializes render keyframes. A render keyframe is a
  * visual snapshot of a scene. It includes the visual parts of a scene, such
  * that observations can be reproduced (from the same camera perspective or a
  * different one). The render keyframe includes support for named "user
  * transforms" which can be used to store cameras, agents, or other
- * application-specific objects. See also @ref Player (coming soon). See
+ * application-specific objects. Keyframes are written in the binary format
+ * described in @ref KeyframeWriter, either all at once with
+ * writeSavedKeyframesToFile or streamed to disk in chunks while recording with
+ * startStreamingKeyframesToFile. See also @ref Player. See
  * examples/replay_tutorial.py for usage of this class through bindings (coming
  * soon).
  */
 class Recorder {
  public:
+  Recorder();
   ~Recorder();
 
   /**
@@ -90,10 +97,62 @@ class Recorder {
                                   const Magnum::Quaternion& rotation);
 
   /**
-   * @brief write saved keyframes to file. Not implemented yet.
+   * @brief Write saved keyframes to file and clear them. The next file will
+   * start from a keyframe summarizing the written ones, so that each file can
+   * be played back on its own.
    * @param filepath
+   * @return Whether or not the file was written.
+   */
+  bool writeSavedKeyframesToFile(const std::string& filepath);
+
+  /**
+   * @brief Start streaming keyframes to file. Saved keyframes, including any
+   * saved before this call, are appended to the file a chunk at a time as they
+   * accumulate, so memory use stays bounded for long recordings.
+   * @param filepath
+   * @param keyframesPerChunk The number of keyframes to accumulate before
+   * appending them. Larger chunks compress strings better but make seeking
+   * during playback coarser.
+   * @return Whether or not the file was opened.
+   */
+  bool startStreamingKeyframesToFile(const std::string& filepath,
+                                     int keyframesPerChunk = 64);
+
+  /**
+   * @brief Append the remaining saved keyframes to the streamed file and close
+   * it. Like writeSavedKeyframesToFile, the next file will start from a
+   * keyframe summarizing the written ones.
+   * @return Whether or not all chunks were written.
+   */
+  bool stopStreamingKeyframesToFile();
+
+  /** @brief Whether keyframes are being streamed to file. */
+  bool isStreamingKeyframesToFile() const { return streamWriter_ != nullptr; }
+
+  /**
+   * @brief Set the number of threads used to gather and compare instance
+   * states in saveKeyframe. Only worthwhile for thousands of instances.
+   * @param numThreads Total number of threads including the calling thread.
+   * Values <= 0 use the process-wide @ref core::ThreadPool::shared() pool.
+   * Defaults to 1.
    */
-  void writeSavedKeyframesToFile(const std::string& filepath);
+  void setNumThreads(int numThreads);
+
+  /** @brief The number of instances being tracked. */
+  int getNumInstances() const { return instanceRecords_.size(); }
+
+  /**
+   * @brief Record the deletion of the render asset instances at or below
+   * @p node without deleting them, for nodes kept hidden for later reuse, such
+   * as pooled objects. Affects the instances of every Recorder.
+   */
+  static void releaseRenderAssetInstances(scene::SceneNode& node);
+
+  /**
+   * @brief Record the instances released by @ref releaseRenderAssetInstances
+   * at or below @p node as created again, under new instance keys.
+   */
+  static void reuseRenderAssetInstances(scene::SceneNode& node);
 
   /**
    * @brief Reserved for unit-testing.
@@ -103,37 +162,64 @@ class Recorder {
   }
 
  private:
-  // NodeDeletionHelper calls onDeleteRenderAssetInstance
+  // NodeDeletionHelper calls onDeleteRenderAssetInstance and addInstance
   friend class NodeDeletionHelper;
 
   // Helper for tracking render asset instances
   struct InstanceRecord {
     scene::SceneNode* node = nullptr;
     RenderAssetInstanceKey instanceKey = ID_UNDEFINED;
-    Corrade::Containers::Optional<RenderAssetInstanceState> recentState;
     NodeDeletionHelper* deletionHelper = nullptr;
   };
 
   using KeyframeIterator = std::vector<Keyframe>::const_iterator;
 
-  rapidjson::Document writeKeyframesToJsonDocument();
+  void addInstance(scene::SceneNode* node,
+                   const esp::assets::RenderAssetInstanceCreationInfo& creation,
+                   NodeDeletionHelper* deletionHelper);
   void onDeleteRenderAssetInstance(const scene::SceneNode* node);
   Keyframe& getKeyframe();
   void advanceKeyframe();
   RenderAssetInstanceKey getNewInstanceKey();
-  int findInstance(const scene::SceneNode* queryNode);
-  RenderAssetInstanceState getInstanceState(const scene::SceneNode* node);
+  int findInstance(const scene::SceneNode* queryNode) const;
+  void removeInstance(int index);
+  static RenderAssetInstanceState getInstanceState(
+      const scene::SceneNode* node);
+  //! Refresh the recorded state of an instance, flagging it if it changed
+  void updateInstanceState(int index);
   void updateInstanceStates();
   void checkAndAddDeletion(Keyframe* keyframe,
                            RenderAssetInstanceKey instanceKey);
   void addLoadsCreationsDeletions(KeyframeIterator begin,
                                   KeyframeIterator end,
                                   Keyframe* dest);
+  void consolidateWrittenKeyframes(const Keyframe& summary);
 
+  // Instances are packed, with removals filled by the last instance. The
+  // most recently saved state of each instance is kept in arrays parallel to
+  // instanceRecords_, so saveKeyframe compares states in contiguous memory.
   std::vector<InstanceRecord> instanceRecords_;
+  std::unordered_map<const scene::SceneNode*, int> instanceIndices_;
+  std::vector<Magnum::Vector3> recentTranslations_;
+  std::vector<Magnum::Quaternion> recentRotations_;
+  std::vector<int> recentSemanticIds_;
+  std::vector<char> hasRecentState_;
+  // helpers of instances released by releaseRenderAssetInstances
+  std::unordered_set<NodeDeletionHelper*> releasedHelpers_;
+  // scratch, whether each instance's state changed in updateInstanceStates
+  std::vector<char> stateChanged_;
+  // the pool for updateInstanceStates, or nullptr to update serially
+  core::ThreadPool* threadPool_ = nullptr;
+  std::unique_ptr<core::ThreadPool> ownedThreadPool_;
   Keyframe currKeyframe_;
   std::vector<Keyframe> savedKeyframes_;
   RenderAssetInstanceKey nextInstanceKey_ = 0;
+
+  KeyframeWriter::uptr streamWriter_;
+  int keyframesPerChunk_ = 0;
+  // loads, creations and deletions of the keyframes streamed so far
+  Keyframe streamedSummary_;
+  bool streamFailed_ = false;
 };
 
 }  // namespace replay
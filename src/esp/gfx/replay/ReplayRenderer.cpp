@@ -0,0 +1,318 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "ReplayRenderer.h"
+
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pointer.h>
+#include <Corrade/PluginManager/Manager.h>
+#include <Corrade/Utility/Directory.h>
+#include <Magnum/GL/Context.h>
+#include <Magnum/Image.h>
+#include <Magnum/ImageView.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/Trade/AbstractImageConverter.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "esp/assets/ResourceManager.h"
+#include "esp/gfx/DepthUnprojection.h"
+#include "esp/gfx/RenderCamera.h"
+#include "esp/gfx/RenderTarget.h"
+#include "esp/gfx/Renderer.h"
+#include "esp/gfx/WindowlessContext.h"
+#include "esp/gfx/replay/Player.h"
+#include "esp/metadata/MetadataMediator.h"
+#include "esp/scene/SceneManager.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace gfx {
+namespace replay {
+
+namespace {
+
+// GL reads images bottom row first
+void flipRows(Mn::Image2D& image) {
+  const size_t rowSize = image.pixelSize() * image.size().x();
+  char* data = image.data().data();
+  for (int top = 0, bottom = image.size().y() - 1; top < bottom;
+       ++top, --bottom) {
+    std::swap_ranges(data + top * rowSize, data + (top + 1) * rowSize,
+                     data + bottom * rowSize);
+  }
+}
+
+}  // namespace
+
+struct ReplayRenderer::Impl {
+  explicit Impl(const ReplayRendererConfiguration& cfg);
+  ~Impl();
+
+  bool renderReplay(const std::string& replayFilepath,
+                    const std::vector<std::string>& cameraNames,
+                    const std::string& outputDirectory,
+                    int keyframeStride);
+
+  // Image writing. Rendered images are queued and written by background
+  // threads, each with its own converter instance.
+  struct ImageJob {
+    std::string filepath;
+    Mn::Image2D image;
+  };
+  void queueImage(std::string filepath, Mn::Image2D&& image);
+  void waitForWrites();
+  void writerLoop(Mn::Trade::AbstractImageConverter& converter);
+
+  const ReplayRendererConfiguration cfg_;
+
+  // declared first so GL resources below are released while it's current
+  WindowlessContext::uptr context_;
+  metadata::MetadataMediator::ptr metadataMediator_;
+  std::unique_ptr<assets::ResourceManager> resourceManager_;
+  scene::SceneManager sceneManager_;
+  int sceneID_ = ID_UNDEFINED;
+  Renderer::ptr renderer_;
+  // owned by its node in the scene graph
+  RenderCamera* camera_ = nullptr;
+  // one per camera, reused across keyframes and replays
+  std::vector<RenderTarget::uptr> renderTargets_;
+  int numRenderedImages_ = 0;
+
+  Cr::PluginManager::Manager<Mn::Trade::AbstractImageConverter>
+      converterManager_;
+  std::vector<Cr::Containers::Pointer<Mn::Trade::AbstractImageConverter>>
+      converters_;
+  std::vector<std::thread> writers_;
+  std::mutex writeMutex_;
+  std::condition_variable writeQueueChanged_;
+  std::deque<ImageJob> writeQueue_;
+  int numWriting_ = 0;
+  int numFailedWrites_ = 0;
+  bool shutdown_ = false;
+};
+
+ReplayRenderer::Impl::Impl(const ReplayRendererConfiguration& cfg)
+    : cfg_(cfg) {
+  if (!Mn::GL::Context::hasCurrent()) {
+    context_ = WindowlessContext::create_unique(cfg_.gpuDeviceId);
+  }
+
+  metadataMediator_ = metadata::MetadataMediator::create();
+  resourceManager_ =
+      std::make_unique<assets::ResourceManager>(metadataMediator_);
+  resourceManager_->setRequiresTextures(cfg_.requiresTextures);
+  sceneID_ = sceneManager_.initSceneGraph();
+  renderer_ = Renderer::create();
+
+  auto& cameraNode =
+      sceneManager_.getSceneGraph(sceneID_).getRootNode().createChild();
+  camera_ = new RenderCamera(cameraNode);
+  camera_->setProjectionMatrix(cfg_.imageSize.x(), cfg_.imageSize.y(),
+                               cfg_.zNear, cfg_.zFar, Mn::Deg{cfg_.hfov});
+
+  const int numWriters = std::max(1, cfg_.numImageWriterThreads);
+  for (int i = 0; i < numWriters; ++i) {
+    auto converter = converterManager_.loadAndInstantiate("PngImageConverter");
+    if (!converter) {
+      LOG(ERROR) << "ReplayRenderer: unable to load an image converter, images "
+                    "won't be written";
+      break;
+    }
+    converters_.emplace_back(std::move(converter));
+  }
+  for (auto& converter : converters_) {
+    writers_.emplace_back(&Impl::writerLoop, this, std::ref(*converter));
+  }
+}
+
+ReplayRenderer::Impl::~Impl() {
+  {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    shutdown_ = true;
+  }
+  writeQueueChanged_.notify_all();
+  for (auto& writer : writers_) {
+    writer.join();
+  }
+}
+
+bool ReplayRenderer::Impl::renderReplay(
+    const std::string& replayFilepath,
+    const std::vector<std::string>& cameraNames,
+    const std::string& outputDirectory,
+    int keyframeStride) {
+  if (keyframeStride <= 0) {
+    LOG(ERROR) << "ReplayRenderer::renderReplay: keyframeStride must be "
+                  "positive";
+    return false;
+  }
+  if (converters_.empty()) {
+    LOG(ERROR) << "ReplayRenderer::renderReplay: no image converter";
+    return false;
+  }
+  if (!Cr::Utility::Directory::mkpath(outputDirectory)) {
+    LOG(ERROR) << "ReplayRenderer::renderReplay: unable to create "
+               << outputDirectory;
+    return false;
+  }
+
+  const std::vector<int> sceneIDs{sceneID_, ID_UNDEFINED};
+  Player player(
+      [&](const assets::AssetInfo& assetInfo,
+          const assets::RenderAssetInstanceCreationInfo& creation) {
+        return resourceManager_->loadAndCreateRenderAssetInstance(
+            assetInfo, creation, &sceneManager_, sceneIDs);
+      });
+  if (!player.readKeyframesFromFile(replayFilepath)) {
+    return false;
+  }
+
+  const std::string replayName =
+      Cr::Utility::Directory::splitExtension(
+          Cr::Utility::Directory::filename(replayFilepath))
+          .first;
+  while (renderTargets_.size() < cameraNames.size()) {
+    renderTargets_.emplace_back(RenderTarget::create_unique(
+        cfg_.imageSize,
+        calculateDepthUnprojection(camera_->projectionMatrix())));
+  }
+
+  int numFailedWrites = 0;
+  {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    numFailedWrites = numFailedWrites_;
+  }
+
+  auto& sceneGraph = sceneManager_.getSceneGraph(sceneID_);
+  std::vector<char> cameraFound(cameraNames.size());
+  for (int keyframeIndex = 0; keyframeIndex < player.getNumKeyframes();
+       keyframeIndex += keyframeStride) {
+    player.setKeyframeIndex(keyframeIndex);
+
+    // issue the draws for all cameras before reading any of them back, so
+    // the GPU isn't stalled between draws
+    for (size_t i = 0; i < cameraNames.size(); ++i) {
+      Mn::Vector3 translation;
+      Mn::Quaternion rotation;
+      cameraFound[i] =
+          player.getUserTransform(cameraNames[i], &translation, &rotation);
+      if (!cameraFound[i]) {
+        continue;
+      }
+      camera_->node().setTranslation(translation);
+      camera_->node().setRotation(rotation);
+      renderTargets_[i]->renderEnter();
+      renderer_->draw(*camera_, sceneGraph);
+      renderTargets_[i]->renderExit();
+    }
+
+    for (size_t i = 0; i < cameraNames.size(); ++i) {
+      if (!cameraFound[i]) {
+        continue;
+      }
+      Mn::Image2D image{
+          Mn::PixelFormat::RGBA8Unorm, cfg_.imageSize,
+          Cr::Containers::Array<char>{
+              Cr::Containers::NoInit,
+              std::size_t(cfg_.imageSize.product()) * 4}};
+      renderTargets_[i]->readFrameRgba(image);
+
+      std::ostringstream filename;
+      filename << replayName << '.' << cameraNames[i] << '.'
+               << std::setw(5) << std::setfill('0') << keyframeIndex << ".png";
+      queueImage(Cr::Utility::Directory::join(outputDirectory, filename.str()),
+                 std::move(image));
+      ++numRenderedImages_;
+    }
+  }
+
+  // remove the replay's instances but keep its assets loaded for the next one
+  player.setKeyframeIndex(-1);
+
+  waitForWrites();
+  std::lock_guard<std::mutex> lock(writeMutex_);
+  return numFailedWrites_ == numFailedWrites;
+}
+
+void ReplayRenderer::Impl::queueImage(std::string filepath,
+                                      Mn::Image2D&& image) {
+  {
+    std::unique_lock<std::mutex> lock(writeMutex_);
+    writeQueueChanged_.wait(lock, [&] {
+      return int(writeQueue_.size()) < std::max(1, cfg_.maxQueuedImages);
+    });
+    writeQueue_.push_back(ImageJob{std::move(filepath), std::move(image)});
+  }
+  writeQueueChanged_.notify_all();
+}
+
+void ReplayRenderer::Impl::waitForWrites() {
+  std::unique_lock<std::mutex> lock(writeMutex_);
+  writeQueueChanged_.wait(
+      lock, [&] { return writeQueue_.empty() && numWriting_ == 0; });
+}
+
+void ReplayRenderer::Impl::writerLoop(
+    Mn::Trade::AbstractImageConverter& converter) {
+  while (true) {
+    Cr::Containers::Optional<ImageJob> job;
+    {
+      std::unique_lock<std::mutex> lock(writeMutex_);
+      writeQueueChanged_.wait(
+          lock, [&] { return shutdown_ || !writeQueue_.empty(); });
+      if (writeQueue_.empty()) {
+        return;
+      }
+      job.emplace(std::move(writeQueue_.front()));
+      writeQueue_.pop_front();
+      ++numWriting_;
+    }
+    // wake the renderer if it's waiting for room in the queue
+    writeQueueChanged_.notify_all();
+
+    flipRows(job->image);
+    const bool written = converter.exportToFile(job->image, job->filepath);
+    if (!written) {
+      LOG(ERROR) << "ReplayRenderer: unable to write " << job->filepath;
+    }
+    {
+      std::lock_guard<std::mutex> lock(writeMutex_);
+      --numWriting_;
+      if (!written) {
+        ++numFailedWrites_;
+      }
+    }
+    writeQueueChanged_.notify_all();
+  }
+}
+
+ReplayRenderer::ReplayRenderer(const ReplayRendererConfiguration& cfg)
+    : pimpl_(spimpl::make_unique_impl<Impl>(cfg)) {}
+
+ReplayRenderer::~ReplayRenderer() = default;
+
+bool ReplayRenderer::renderReplay(const std::string& replayFilepath,
+                                  const std::vector<std::string>& cameraNames,
+                                  const std::string& outputDirectory,
+                                  int keyframeStride) {
+  return pimpl_->renderReplay(replayFilepath, cameraNames, outputDirectory,
+                              keyframeStride);
+}
+
+int ReplayRenderer::getNumRenderedImages() const {
+  return pimpl_->numRenderedImages_;
+}
+
+}  // namespace replay
+}  // namespace gfx
+}  // namespace esp
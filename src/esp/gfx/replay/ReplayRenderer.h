@@ -0,0 +1,104 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GFX_REPLAY_REPLAYRENDERER_H_
+#define ESP_GFX_REPLAY_REPLAYRENDERER_H_
+
+/** @file
+ * @brief Class @ref esp::gfx::replay::ReplayRenderer, struct @ref
+ * esp::gfx::replay::ReplayRendererConfiguration
+ */
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Vector2.h>
+
+#include <string>
+#include <vector>
+
+#include "esp/core/esp.h"
+
+namespace esp {
+namespace gfx {
+namespace replay {
+
+struct ReplayRendererConfiguration {
+  //! Size of the rendered images in pixels
+  Magnum::Vector2i imageSize{640, 480};
+  //! Horizontal field of view of the cameras in degrees
+  float hfov = 90.0f;
+  float zNear = 0.01f;
+  float zFar = 1000.0f;
+  /**
+   * @brief The GPU to render with if no GL context is current. Pass -1 to use
+   * the default EGL device instead, for example a software renderer on CI
+   * machines without a GPU.
+   */
+  int gpuDeviceId = 0;
+  //! Whether or not to load textures for the render assets
+  bool requiresTextures = true;
+  //! Number of background threads encoding and writing images
+  int numImageWriterThreads = 2;
+  /**
+   * @brief Number of rendered images that may wait to be written before
+   * rendering blocks, bounding memory use when writing is the bottleneck
+   */
+  int maxQueuedImages = 64;
+
+  ESP_SMART_POINTERS(ReplayRendererConfiguration)
+};
+
+/**
+@brief Renders recorded replays headlessly, from the cameras stored in them.
+
+Replays written by @ref Recorder are played back with a @ref Player into a
+scene graph owned by the ReplayRenderer. For every rendered keyframe, each of
+the requested cameras is looked up by name among the keyframe's user
+transforms (see @ref Recorder::addUserTransformToKeyframe) and rendered into
+its own @ref RenderTarget. The images are read back and handed to background
+threads which encode and write them as PNG files while the next keyframe is
+rendered.
+
+Render assets are loaded by a single @ref assets::ResourceManager shared by
+all replays rendered with the same ReplayRenderer, so assets common to many
+replays are only loaded once.
+
+Creates a @ref WindowlessContext unless a GL context is already current.
+*/
+class ReplayRenderer {
+ public:
+  explicit ReplayRenderer(const ReplayRendererConfiguration& cfg);
+
+  ~ReplayRenderer();
+
+  /**
+   * @brief Render the keyframes of a replay file from named cameras.
+   *
+   * Images are written to
+   * `<outputDirectory>/<replay name>.<camera name>.<keyframe index>.png`,
+   * with the keyframe index zero-padded to five digits. A camera missing from
+   * a keyframe's user transforms is skipped for that keyframe. Returns once
+   * all images are written.
+   *
+   * @param replayFilepath A file written by @ref Recorder.
+   * @param cameraNames Names of the user transforms to render from.
+   * @param outputDirectory Directory for the images, created if needed.
+   * @param keyframeStride Render every keyframeStride-th keyframe.
+   * @return Whether or not the replay was read and all images were written.
+   */
+  bool renderReplay(const std::string& replayFilepath,
+                    const std::vector<std::string>& cameraNames,
+                    const std::string& outputDirectory,
+                    int keyframeStride = 1);
+
+  /** @brief The number of images rendered since construction. */
+  int getNumRenderedImages() const;
+
+  ESP_SMART_POINTERS_WITH_UNIQUE_PIMPL(ReplayRenderer)
+};
+
+}  // namespace replay
+}  // namespace gfx
+}  // namespace esp
+
+#endif  // ESP_GFX_REPLAY_REPLAYRENDERER_H_
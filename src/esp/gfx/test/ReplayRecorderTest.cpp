@@ -0,0 +1,169 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/TestSuite/Tester.h>
+#include <Magnum/Math/Quaternion.h>
+
+#include <vector>
+
+#include "esp/gfx/replay/Recorder.h"
+#include "esp/scene/SceneGraph.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace gfx {
+namespace test {
+namespace {
+
+struct ReplayRecorderTest : Cr::TestSuite::Tester {
+  explicit ReplayRecorderTest();
+
+  void deleteInstances();
+  void parallelStateUpdates();
+
+  void benchmarkSaveKeyframe();
+};
+
+constexpr struct {
+  const char* name;
+  int numInstances;
+  // every movingStride-th instance moves each keyframe, or none if 0
+  int movingStride;
+  int numThreads;
+} SaveKeyframeBenchmarkData[]{
+    {"10k static", 10000, 0, 1},
+    {"10k, 10% moving", 10000, 10, 1},
+    {"10k moving", 10000, 1, 1},
+    {"10k moving, 4 threads", 10000, 1, 4}};
+
+ReplayRecorderTest::ReplayRecorderTest() {
+  // clang-format off
+  addTests({&ReplayRecorderTest::deleteInstances,
+            &ReplayRecorderTest::parallelStateUpdates});
+  addInstancedBenchmarks({&ReplayRecorderTest::benchmarkSaveKeyframe}, 10,
+                         Cr::Containers::arraySize(SaveKeyframeBenchmarkData));
+  // clang-format on
+}
+
+esp::assets::RenderAssetInstanceCreationInfo makeCreation() {
+  return esp::assets::RenderAssetInstanceCreationInfo{
+      "box.glb", Cr::Containers::NullOpt, {}, ""};
+}
+
+// nodes parented to a common node, so absolute transforms involve a product
+std::vector<scene::SceneNode*> createInstances(scene::SceneGraph& sceneGraph,
+                                               replay::Recorder& recorder,
+                                               int numInstances) {
+  auto& parent = sceneGraph.getRootNode().createChild();
+  parent.setTranslation({0.0f, 1.0f, 0.0f});
+  std::vector<scene::SceneNode*> nodes;
+  nodes.reserve(numInstances);
+  for (int i = 0; i < numInstances; ++i) {
+    auto& node = parent.createChild();
+    node.setTranslation({float(i), 0.0f, 0.0f});
+    recorder.onCreateRenderAssetInstance(&node, makeCreation());
+    nodes.push_back(&node);
+  }
+  return nodes;
+}
+
+void ReplayRecorderTest::deleteInstances() {
+  scene::SceneGraph sceneGraph;
+  replay::Recorder recorder;
+  auto nodes = createInstances(sceneGraph, recorder, 5);
+  recorder.saveKeyframe();
+
+  // the removed instance is filled by the last one, which must still be
+  // tracked under its own key
+  delete nodes[1];
+  CORRADE_COMPARE(recorder.getNumInstances(), 4);
+  nodes[4]->setTranslation({10.0f, 0.0f, 0.0f});
+  recorder.saveKeyframe();
+
+  const auto& keyframes = recorder.debugGetSavedKeyframes();
+  CORRADE_COMPARE(keyframes.size(), 2u);
+  CORRADE_COMPARE(keyframes[0].creations.size(), 5u);
+  CORRADE_COMPARE(keyframes[0].stateUpdates.size(), 5u);
+  CORRADE_COMPARE(keyframes[1].deletions.size(), 1u);
+  CORRADE_COMPARE(keyframes[1].deletions[0], keyframes[0].creations[1].first);
+  CORRADE_COMPARE(keyframes[1].stateUpdates.size(), 1u);
+  CORRADE_COMPARE(keyframes[1].stateUpdates[0].first,
+                  keyframes[0].creations[4].first);
+  CORRADE_COMPARE(
+      keyframes[1].stateUpdates[0].second.absTransform.translation,
+      (Mn::Vector3{10.0f, 1.0f, 0.0f}));
+
+  // a creation deleted before being saved cancels out
+  auto& node = sceneGraph.getRootNode().createChild();
+  recorder.onCreateRenderAssetInstance(&node, makeCreation());
+  delete &node;
+  delete nodes[2];
+  recorder.saveKeyframe();
+  CORRADE_COMPARE(keyframes[2].creations.size(), 0u);
+  CORRADE_COMPARE(keyframes[2].deletions.size(), 1u);
+  CORRADE_COMPARE(keyframes[2].deletions[0], keyframes[0].creations[2].first);
+  CORRADE_COMPARE(recorder.getNumInstances(), 3);
+}
+
+void ReplayRecorderTest::parallelStateUpdates() {
+  scene::SceneGraph sceneGraph;
+  replay::Recorder recorder;
+  recorder.setNumThreads(4);
+  auto nodes = createInstances(sceneGraph, recorder, 2000);
+  recorder.saveKeyframe();
+  for (size_t i = 0; i < nodes.size(); i += 3) {
+    nodes[i]->setRotation(
+        Mn::Quaternion::rotation(Mn::Deg(90.0f), Mn::Vector3::yAxis()));
+  }
+  recorder.saveKeyframe();
+
+  const auto& keyframes = recorder.debugGetSavedKeyframes();
+  CORRADE_COMPARE(keyframes[0].stateUpdates.size(), 2000u);
+  const auto& stateUpdates = keyframes[1].stateUpdates;
+  CORRADE_COMPARE(stateUpdates.size(), 667u);
+  // updates follow the instance order
+  for (size_t i = 0; i < stateUpdates.size(); ++i) {
+    CORRADE_COMPARE(stateUpdates[i].first, keyframes[0].creations[i * 3].first);
+    CORRADE_COMPARE(
+        stateUpdates[i].second.absTransform.translation,
+        (Mn::Vector3{float(i * 3), 1.0f, 0.0f}));
+  }
+}
+
+void ReplayRecorderTest::benchmarkSaveKeyframe() {
+  auto&& data = SaveKeyframeBenchmarkData[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+
+  scene::SceneGraph sceneGraph;
+  replay::Recorder recorder;
+  recorder.setNumThreads(data.numThreads);
+  auto nodes = createInstances(sceneGraph, recorder, data.numInstances);
+  recorder.saveKeyframe();
+
+  float x = 0.0f;
+  CORRADE_BENCHMARK(10) {
+    x += 1.0f;
+    for (size_t i = 0; data.movingStride && i < nodes.size();
+         i += data.movingStride) {
+      nodes[i]->setTranslation({x, 0.0f, 0.0f});
+    }
+    recorder.saveKeyframe();
+  }
+
+  const auto& keyframes = recorder.debugGetSavedKeyframes();
+  const size_t expectedUpdates =
+      data.movingStride ? (nodes.size() + data.movingStride - 1) /
+                              data.movingStride
+                        : 0;
+  CORRADE_COMPARE(keyframes.back().stateUpdates.size(), expectedUpdates);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace gfx
+}  // namespace esp
+
+CORRADE_TEST_MAIN(esp::gfx::test::ReplayRecorderTest)
@@ -53,6 +53,7 @@ ObjectAttributes::ObjectAttributes(const std::string& handle)
 
   setBoundingBoxCollisions(false);
   setJoinCollisionMeshes(true);
+  setCollisionHullMaxVertices(0);
   setRequiresLighting(true);
   setIsVisible(true);
   setSemanticId(0);
@@ -231,6 +231,16 @@ class ObjectAttributes : public AbstractObjectAttributes {
     return getBool("join_collision_meshes");
   }
 
+  // maximum number of vertices kept in each convex collision hull built from
+  // the collision mesh. 0 keeps every vertex of the exact hull, values below 6
+  // are raised to 6.
+  void setCollisionHullMaxVertices(int collisionHullMaxVertices) {
+    setInt("collision_hull_max_vertices", collisionHullMaxVertices);
+  }
+  int getCollisionHullMaxVertices() const {
+    return getInt("collision_hull_max_vertices");
+  }
+
   /**
    * @brief If not visible can add dynamic non-rendered object into a scene
    * object.  If is not visible then should not add object to drawables.
@@ -13,6 +13,8 @@ PhysicsManagerAttributes::PhysicsManagerAttributes(const std::string& handle)
   setSimulator("none");
   setTimestep(0.01);
   setMaxSubsteps(10);
+  setCollisionCacheDirectory("");
+  setNumThreads(1);
 }  // PhysicsManagerAttributes ctor
 
 }  // namespace attributes
@@ -46,6 +46,26 @@ class PhysicsManagerAttributes : public AbstractAttributes {
     return getDouble("restitution_coefficient");
   }
 
+  /**
+   * @brief Directory in which derived collision data (e.g. reduced convex
+   * hulls) is cached across processes. Empty disables the on-disk cache.
+   */
+  void setCollisionCacheDirectory(const std::string& collisionCacheDirectory) {
+    setString("collision_cache_directory", collisionCacheDirectory);
+  }
+  std::string getCollisionCacheDirectory() const {
+    return getString("collision_cache_directory");
+  }
+
+  /**
+   * @brief Number of threads stepping the simulation and running batched
+   * queries such as ray casts. Values above 1 switch Bullet to its
+   * multithreaded world, if built with BUILD_BULLET_MULTITHREADING. Batched
+   * queries with values <= 0 use the shared pool with all hardware threads.
+   */
+  void setNumThreads(int numThreads) { setInt("num_threads", numThreads); }
+  int getNumThreads() const { return getInt("num_threads"); }
+
  public:
   ESP_SMART_POINTERS(PhysicsManagerAttributes)
 };  // class PhysicsManagerAttributes
@@ -102,6 +102,12 @@ void ObjectAttributesManager::setValsFromJSONDoc(
       jsonConfig, "join_collision_meshes",
       std::bind(&ObjectAttributes::setJoinCollisionMeshes, objAttributes, _1));
 
+  // Vertex budget for convex collision hulls
+  io::jsonIntoSetter<int>(
+      jsonConfig, "collision_hull_max_vertices",
+      std::bind(&ObjectAttributes::setCollisionHullMaxVertices, objAttributes,
+                _1));
+
   // The object's interia matrix diagonal
   io::jsonIntoConstSetter<Magnum::Vector3>(
       jsonConfig, "inertia",
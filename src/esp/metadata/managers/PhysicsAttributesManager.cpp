@@ -62,6 +62,17 @@ void PhysicsAttributesManager::setValsFromJSONDoc(
       std::bind(&PhysicsManagerAttributes::setRestitutionCoefficient,
                 physicsManagerAttributes, _1));
 
+  // load the directory for cached collision data
+  io::jsonIntoConstSetter<std::string>(
+      jsonConfig, "collision_cache_directory",
+      std::bind(&PhysicsManagerAttributes::setCollisionCacheDirectory,
+                physicsManagerAttributes, _1));
+
+  // load the number of simulation threads
+  io::jsonIntoSetter<int>(jsonConfig, "num_threads",
+                          std::bind(&PhysicsManagerAttributes::setNumThreads,
+                                    physicsManagerAttributes, _1));
+
   // load world gravity
   io::jsonIntoConstSetter<Magnum::Vector3>(
       jsonConfig, "gravity",
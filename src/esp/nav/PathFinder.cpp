@@ -3,9 +3,11 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "PathFinder.h"
+#include <algorithm>
+#include <functional>
 #include <numeric>
+#include <queue>
 #include <stack>
-#include <unordered_map>
 
 #include <Magnum/Magnum.h>
 #include <Magnum/Math/Vector3.h>
@@ -21,8 +23,11 @@
 #include <limits>
 
 #include "esp/assets/MeshData.h"
+#include "esp/core/ThreadPool.h"
 #include "esp/core/esp.h"
+#include "esp/core/random.h"
 
+#include "DetourCommon.h"
 #include "DetourNavMesh.h"
 #include "DetourNavMeshBuilder.h"
 #include "DetourNavMeshQuery.h"
@@ -61,6 +66,46 @@ const std::vector<vec3f>& MultiGoalShortestPath::getRequestedEnds() const {
   return pimpl_->requestedEnds;
 }
 
+struct GeodesicDistanceField::Impl {
+  std::vector<vec3f> goals;
+
+  //! Version of the navmesh the field was computed for, 0 if not computed
+  uint64_t navMeshVersion = 0;
+
+  //! Offset of the first polygon of each tile into the per-polygon arrays
+  std::vector<int> tileOffsets;
+  //! Length of the search path from each polygon to the closest goal, 0 for
+  //! goal polygons and inf for polygons that can't reach any goal
+  std::vector<float> dist;
+  //! Index of the next polygon towards the closest goal, -1 for goal polygons
+  std::vector<int> nextPolys;
+  //! Ends of the portal through which each polygon is left towards the goal,
+  //! as seen from the polygon (see dtNavMeshQuery::findStraightPath)
+  std::vector<vec3f> exitLefts;
+  std::vector<vec3f> exitRights;
+  //! String-pulled distance from each end of the exit portal to the closest
+  //! goal, along the rest of the corridor
+  std::vector<float> exitLeftDists;
+  std::vector<float> exitRightDists;
+  //! Goals projected on the navmesh with the index of their polygon, sorted
+  //! by polygon
+  std::vector<std::pair<int, vec3f>> goalPoints;
+  //! Largest number of goals on the same polygon
+  int maxGoalsPerPoly = 0;
+};
+
+GeodesicDistanceField::GeodesicDistanceField()
+    : pimpl_{spimpl::make_unique_impl<Impl>()} {};
+
+void GeodesicDistanceField::setGoals(const std::vector<vec3f>& newGoals) {
+  pimpl_->goals = newGoals;
+  pimpl_->navMeshVersion = 0;
+}
+
+const std::vector<vec3f>& GeodesicDistanceField::getGoals() const {
+  return pimpl_->goals;
+}
+
 namespace {
 template <typename T>
 std::tuple<dtStatus, dtPolyRef, vec3f> projectToPoly(
@@ -117,82 +162,380 @@ namespace impl {
 // are connected This gives O(1) lookup for if a path between two polygons
 // exists or not
 // Takes O(npolys) to construct
+//
+// Island ids are stored in one dense array per tile indexed by the decoded
+// polygon id, so a lookup is a decode and two loads. Construction runs a
+// union-find over the polygon links, with the links inside each tile merged in
+// parallel across tiles and the few links across tile borders merged after.
 class IslandSystem {
  public:
-  IslandSystem(const dtNavMesh* navMesh, const dtQueryFilter* filter) {
-    std::vector<vec3f> islandVerts;
-
-    // Iterate over all tiles
-    for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+  static constexpr uint32_t NO_ISLAND = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * @param pool Optional pool to process the tiles in parallel with
+   */
+  IslandSystem(const dtNavMesh* navMesh,
+               const dtQueryFilter* filter,
+               core::ThreadPool* pool = nullptr)
+      : navMesh_{navMesh} {
+    const int maxTiles = navMesh->getMaxTiles();
+    tiles_.resize(maxTiles);
+
+    // Offset of the first polygon of every tile in the union-find forest
+    std::vector<uint32_t> tileOffsets(maxTiles + 1, 0);
+    for (int iTile = 0; iTile < maxTiles; ++iTile) {
       const dtMeshTile* tile = navMesh->getTile(iTile);
-      if (!tile)
-        continue;
+      int polyCount = 0;
+      if (tile && tile->header) {
+        polyCount = tile->header->polyCount;
+        tiles_[iTile].salt = tile->salt;
+        tiles_[iTile].islands.assign(polyCount, NO_ISLAND);
+      }
+      tileOffsets[iTile + 1] = tileOffsets[iTile] + polyCount;
+    }
 
-      // Iterate over all polygons in a tile
+    std::vector<uint32_t> parent(tileOffsets.back());
+    std::iota(parent.begin(), parent.end(), 0);
+    const auto globalIndex = [this, &tileOffsets](dtPolyRef ref) {
+      unsigned int salt = 0, it = 0, ip = 0;
+      navMesh_->decodePolyId(ref, salt, it, ip);
+      return tileOffsets[it] + ip;
+    };
+
+    // Links within a tile only touch that tile's range of the forest, so the
+    // tiles can be merged independently
+    std::vector<std::vector<dtPolyRef>> borderLinks(maxTiles);
+    const auto mergeTile = [&](int, size_t iTile) {
+      const dtMeshTile* tile = navMesh->getTile(iTile);
+      if (!tile || !tile->header)
+        return;
+      const dtPolyRef base = navMesh->getPolyRefBase(tile);
       for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
-        // Get the polygon reference from the tile and polygon id
-        dtPolyRef startRef = navMesh->encodePolyId(tile->salt, iTile, jPoly);
-
-        // If the polygon ref is valid, and we haven't seen it yet,
-        // start connected component analysis from this polygon
-        if (navMesh->isValidPolyRef(startRef) &&
-            (polyToIsland_.find(startRef) == polyToIsland_.end())) {
-          uint32_t newIslandId = islandRadius_.size();
-          expandFrom(navMesh, filter, newIslandId, startRef, islandVerts);
-
-          // The radius is calculated as the max deviation from the mean for all
-          // points in the island
-          vec3f centroid = vec3f::Zero();
-          for (auto& v : islandVerts) {
-            centroid += v;
-          }
-          centroid /= islandVerts.size();
+        const dtPoly* poly = &tile->polys[jPoly];
+        const dtPolyRef ref = base | static_cast<dtPolyRef>(jPoly);
+        if (!filter->passFilter(ref, tile, poly))
+          continue;
 
-          float maxRadius = 0.0;
-          for (auto& v : islandVerts) {
-            maxRadius = std::max(maxRadius, (v - centroid).norm());
+        for (unsigned int iLink = poly->firstLink; iLink != DT_NULL_LINK;
+             iLink = tile->links[iLink].next) {
+          const dtPolyRef neighbourRef = tile->links[iLink].ref;
+          if (navMesh->decodePolyIdTile(neighbourRef) != iTile) {
+            borderLinks[iTile].emplace_back(ref);
+            borderLinks[iTile].emplace_back(neighbourRef);
+            continue;
           }
+          if (passFilter(navMesh, filter, neighbourRef)) {
+            unite(parent, tileOffsets[iTile] + jPoly,
+                  globalIndex(neighbourRef));
+          }
+        }
+      }
+    };
+    if (pool) {
+      pool->parallelFor(maxTiles, mergeTile);
+    } else {
+      for (int iTile = 0; iTile < maxTiles; ++iTile)
+        mergeTile(0, iTile);
+    }
 
-          islandRadius_.emplace_back(maxRadius);
+    for (const auto& links : borderLinks) {
+      for (size_t iLink = 0; iLink < links.size(); iLink += 2) {
+        if (passFilter(navMesh, filter, links[iLink + 1])) {
+          unite(parent, globalIndex(links[iLink]),
+                globalIndex(links[iLink + 1]));
         }
       }
     }
+
+    // Number the roots in polygon order and label every polygon
+    std::vector<uint32_t> rootToIsland(parent.size(), NO_ISLAND);
+    uint32_t numIslands = 0;
+    for (int iTile = 0; iTile < maxTiles; ++iTile) {
+      std::vector<uint32_t>& islands = tiles_[iTile].islands;
+      for (size_t jPoly = 0; jPoly < islands.size(); ++jPoly) {
+        const uint32_t root = find(parent, tileOffsets[iTile] + jPoly);
+        if (rootToIsland[root] == NO_ISLAND)
+          rootToIsland[root] = numIslands++;
+        islands[jPoly] = rootToIsland[root];
+      }
+    }
+
+    computeRadii(numIslands, pool);
+  }
+
+  /**
+   * @brief Forgets the islands of the given polygons. All other polygons of
+   * those islands are kept aside to be relabeled by @ref relabel, and their
+   * ids are freed for reuse.
+   *
+   * Must be called before the tiles of any of the given polygons are removed
+   * from the navmesh.
+   */
+  void invalidate(const std::vector<dtPolyRef>& polys) {
+    std::vector<bool> staleIslands(islandRadius_.size(), false);
+    bool anyStale = false;
+    for (dtPolyRef ref : polys) {
+      const uint32_t island = islandOf(ref);
+      if (island != NO_ISLAND) {
+        staleIslands[island] = true;
+        anyStale = true;
+      }
+    }
+    if (!anyStale)
+      return;
+
+    for (uint32_t island = 0; island < staleIslands.size(); ++island) {
+      if (staleIslands[island]) {
+        islandRadius_[island] = 0.0f;
+        freeIslands_.emplace_back(island);
+      }
+    }
+    // Hand out the smallest free ids first, so relabeling the same polygons
+    // again gives back the same ids
+    std::sort(freeIslands_.begin(), freeIslands_.end(),
+              std::greater<uint32_t>());
+
+    for (size_t iTile = 0; iTile < tiles_.size(); ++iTile) {
+      TileIslands& tile = tiles_[iTile];
+      for (size_t jPoly = 0; jPoly < tile.islands.size(); ++jPoly) {
+        const uint32_t island = tile.islands[jPoly];
+        if (island != NO_ISLAND && staleIslands[island]) {
+          staleRefs_.emplace_back(
+              navMesh_->encodePolyId(tile.salt, iTile, jPoly));
+          tile.islands[jPoly] = NO_ISLAND;
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Runs connected component analysis from the polygons kept aside by
+   * @ref invalidate and the newly added polygons only.
+   *
+   * Polygons of tiles removed in the meantime are skipped. The caller is
+   * responsible for invalidating every island a new polygon can link to.
+   */
+  void relabel(const dtQueryFilter* filter,
+               const std::vector<dtPolyRef>& newPolys) {
+    // Tiles that were removed or replaced since the last labeling
+    for (size_t iTile = 0; iTile < tiles_.size(); ++iTile) {
+      const dtMeshTile* tile = navMesh_->getTile(iTile);
+      TileIslands& islands = tiles_[iTile];
+      if (!tile || !tile->header) {
+        islands = TileIslands{};
+      } else if (islands.salt != tile->salt ||
+                 islands.islands.size() != size_t(tile->header->polyCount)) {
+        islands.salt = tile->salt;
+        islands.islands.assign(tile->header->polyCount, NO_ISLAND);
+      }
+    }
+
+    std::vector<vec3f> islandVerts;
+    staleRefs_.insert(staleRefs_.end(), newPolys.begin(), newPolys.end());
+    for (dtPolyRef startRef : staleRefs_) {
+      if (navMesh_->isValidPolyRef(startRef) &&
+          islandOf(startRef) == NO_ISLAND) {
+        labelIsland(filter, startRef, islandVerts);
+      }
+    }
+    staleRefs_.clear();
+
+    // Drop the free ids at the end of the range, the others stay empty until
+    // the next relabeling
+    while (!freeIslands_.empty() &&
+           freeIslands_.front() + 1 == islandRadius_.size()) {
+      freeIslands_.erase(freeIslands_.begin());
+      islandRadius_.pop_back();
+    }
   }
 
   inline bool hasConnection(dtPolyRef startRef, dtPolyRef endRef) const {
     // If both polygons are on the same island, there must be a path between
     // them
-    auto itStart = polyToIsland_.find(startRef);
-    if (itStart == polyToIsland_.end())
-      return false;
-
-    auto itEnd = polyToIsland_.find(endRef);
-    if (itEnd == polyToIsland_.end())
-      return false;
-
-    return itStart->second == itEnd->second;
+    const uint32_t startIsland = islandOf(startRef);
+    return startIsland != NO_ISLAND && startIsland == islandOf(endRef);
   }
 
   inline float islandRadius(dtPolyRef ref) const {
-    auto itRef = polyToIsland_.find(ref);
-    if (itRef == polyToIsland_.end())
+    const uint32_t island = islandOf(ref);
+    if (island == NO_ISLAND)
       return 0.0;
 
-    return islandRadius_[itRef->second];
+    return islandRadius_[island];
+  }
+
+  //! Islands ids are in [0, numIslands()). Ids dropped by @ref invalidate
+  //! are reused by @ref relabel, so a few ids in the range may have no
+  //! polygons.
+  inline uint32_t numIslands() const { return islandRadius_.size(); }
+
+  inline float radiusOfIsland(uint32_t island) const {
+    return islandRadius_[island];
+  }
+
+  inline uint32_t islandOf(dtPolyRef ref) const {
+    unsigned int salt = 0, it = 0, ip = 0;
+    navMesh_->decodePolyId(ref, salt, it, ip);
+    if (it >= tiles_.size())
+      return NO_ISLAND;
+    const TileIslands& tile = tiles_[it];
+    if (tile.salt != salt || ip >= tile.islands.size())
+      return NO_ISLAND;
+    return tile.islands[ip];
   }
 
  private:
-  std::unordered_map<dtPolyRef, uint32_t> polyToIsland_;
+  struct TileIslands {
+    unsigned int salt = 0;
+    //! Island id of every polygon of the tile, indexed by polygon id
+    std::vector<uint32_t> islands;
+  };
+
+  const dtNavMesh* navMesh_;
+  //! Indexed by tile id
+  std::vector<TileIslands> tiles_;
   std::vector<float> islandRadius_;
+  //! Polygons waiting to be relabeled after @ref invalidate
+  std::vector<dtPolyRef> staleRefs_;
+  //! Ids freed by @ref invalidate, in decreasing order
+  std::vector<uint32_t> freeIslands_;
+
+  inline void setIsland(dtPolyRef ref, uint32_t island) {
+    unsigned int salt = 0, it = 0, ip = 0;
+    navMesh_->decodePolyId(ref, salt, it, ip);
+    tiles_[it].islands[ip] = island;
+  }
+
+  static bool passFilter(const dtNavMesh* navMesh,
+                         const dtQueryFilter* filter,
+                         dtPolyRef ref) {
+    const dtMeshTile* tile = nullptr;
+    const dtPoly* poly = nullptr;
+    navMesh->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+    return filter->passFilter(ref, tile, poly);
+  }
+
+  static uint32_t find(std::vector<uint32_t>& parent, uint32_t i) {
+    // Path halving
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  }
+
+  static void unite(std::vector<uint32_t>& parent, uint32_t a, uint32_t b) {
+    a = find(parent, a);
+    b = find(parent, b);
+    // Always link to the smaller root so merges are deterministic
+    if (a < b)
+      parent[b] = a;
+    else if (b < a)
+      parent[a] = b;
+  }
+
+  // The radius is calculated as the max deviation from the mean for all
+  // points in the island
+  void computeRadii(uint32_t numIslands, core::ThreadPool* pool) {
+    const int numWorkers = pool ? pool->numThreads() : 1;
+    const size_t numTiles = tiles_.size();
+    const auto forEachTile = [&](const core::ThreadPool::Task& task) {
+      if (pool) {
+        pool->parallelFor(numTiles, task);
+      } else {
+        for (size_t iTile = 0; iTile < numTiles; ++iTile)
+          task(0, iTile);
+      }
+    };
+    // Calls f(island, vertex) for every vertex of every polygon of a tile
+    const auto forEachVert = [this](size_t iTile, auto&& f) {
+      const dtMeshTile* tile = navMesh_->getTile(iTile);
+      const std::vector<uint32_t>& islands = tiles_[iTile].islands;
+      for (size_t jPoly = 0; jPoly < islands.size(); ++jPoly) {
+        const dtPoly& poly = tile->polys[jPoly];
+        for (int iVert = 0; iVert < poly.vertCount; ++iVert) {
+          f(islands[jPoly],
+            Eigen::Map<const vec3f>(&tile->verts[poly.verts[iVert] * 3]));
+        }
+      }
+    };
+
+    // Per worker accumulators, reduced after every pass
+    std::vector<std::vector<vec3f>> sums(
+        numWorkers, std::vector<vec3f>(numIslands, vec3f::Zero()));
+    std::vector<std::vector<uint32_t>> counts(
+        numWorkers, std::vector<uint32_t>(numIslands, 0));
+    forEachTile([&](int iWorker, size_t iTile) {
+      forEachVert(iTile, [&](uint32_t island, const vec3f& v) {
+        sums[iWorker][island] += v;
+        ++counts[iWorker][island];
+      });
+    });
+    std::vector<vec3f> centroids(numIslands, vec3f::Zero());
+    for (uint32_t iIsland = 0; iIsland < numIslands; ++iIsland) {
+      uint32_t count = 0;
+      for (int iWorker = 0; iWorker < numWorkers; ++iWorker) {
+        centroids[iIsland] += sums[iWorker][iIsland];
+        count += counts[iWorker][iIsland];
+      }
+      centroids[iIsland] /= count;
+    }
+
+    std::vector<std::vector<float>> radii(
+        numWorkers, std::vector<float>(numIslands, 0.0f));
+    forEachTile([&](int iWorker, size_t iTile) {
+      forEachVert(iTile, [&](uint32_t island, const vec3f& v) {
+        radii[iWorker][island] =
+            std::max(radii[iWorker][island], (v - centroids[island]).norm());
+      });
+    });
+    islandRadius_.assign(numIslands, 0.0f);
+    for (int iWorker = 0; iWorker < numWorkers; ++iWorker) {
+      for (uint32_t iIsland = 0; iIsland < numIslands; ++iIsland) {
+        islandRadius_[iIsland] =
+            std::max(islandRadius_[iIsland], radii[iWorker][iIsland]);
+      }
+    }
+  }
+
+  void labelIsland(const dtQueryFilter* filter,
+                   const dtPolyRef& startRef,
+                   std::vector<vec3f>& islandVerts) {
+    uint32_t newIslandId = islandRadius_.size();
+    if (!freeIslands_.empty()) {
+      newIslandId = freeIslands_.back();
+      freeIslands_.pop_back();
+    }
+    expandFrom(filter, newIslandId, startRef, islandVerts);
+
+    vec3f centroid = vec3f::Zero();
+    for (auto& v : islandVerts) {
+      centroid += v;
+    }
+    centroid /= islandVerts.size();
+
+    float maxRadius = 0.0;
+    for (auto& v : islandVerts) {
+      maxRadius = std::max(maxRadius, (v - centroid).norm());
+    }
+
+    if (newIslandId == islandRadius_.size())
+      islandRadius_.emplace_back(maxRadius);
+    else
+      islandRadius_[newIslandId] = maxRadius;
+  }
 
-  void expandFrom(const dtNavMesh* navMesh,
-                  const dtQueryFilter* filter,
+  void expandFrom(const dtQueryFilter* filter,
                   const uint32_t newIslandId,
                   const dtPolyRef& startRef,
                   std::vector<vec3f>& islandVerts) {
-    polyToIsland_.emplace(startRef, newIslandId);
+    setIsland(startRef, newIslandId);
     islandVerts.clear();
 
+    // Polygons that don't pass the filter form their own island, as in the
+    // union-find construction
+    const bool expand = passFilter(navMesh_, filter, startRef);
+
     // Force std::stack to be implemented via an std::vector as linked
     // lists are gross
     std::stack<dtPolyRef, std::vector<dtPolyRef>> stack;
@@ -205,36 +548,108 @@ class IslandSystem {
 
       const dtMeshTile* tile = nullptr;
       const dtPoly* poly = nullptr;
-      navMesh->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+      navMesh_->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
 
       for (int iVert = 0; iVert < poly->vertCount; ++iVert) {
         islandVerts.emplace_back(
             Eigen::Map<vec3f>(&tile->verts[poly->verts[iVert] * 3]));
       }
+      if (!expand)
+        continue;
 
       // Iterate over all neighbours
       for (unsigned int iLink = poly->firstLink; iLink != DT_NULL_LINK;
            iLink = tile->links[iLink].next) {
         dtPolyRef neighbourRef = tile->links[iLink].ref;
         // If we've already visited this poly, skip it!
-        if (polyToIsland_.find(neighbourRef) != polyToIsland_.end())
+        if (islandOf(neighbourRef) != NO_ISLAND)
           continue;
 
-        const dtMeshTile* neighbourTile = nullptr;
-        const dtPoly* neighbourPoly = nullptr;
-        navMesh->getTileAndPolyByRefUnsafe(neighbourRef, &neighbourTile,
-                                           &neighbourPoly);
-
         // If a neighbour isn't walkable, don't add it
-        if (!filter->passFilter(neighbourRef, neighbourTile, neighbourPoly))
+        if (!passFilter(navMesh_, filter, neighbourRef))
           continue;
 
-        polyToIsland_.emplace(neighbourRef, newIslandId);
+        setIsland(neighbourRef, newIslandId);
         stack.push(neighbourRef);
       }
     }
   }
 };
+
+constexpr uint32_t IslandSystem::NO_ISLAND;
+
+// Samples indices proportionally to their weights in O(1) with Vose's alias
+// method
+// Takes O(nweights) to construct
+class AliasTable {
+ public:
+  AliasTable() = default;
+
+  explicit AliasTable(const std::vector<float>& weights) {
+    const size_t n = weights.size();
+    const double total =
+        std::accumulate(weights.begin(), weights.end(), double(0));
+    if (n == 0 || !(total > 0))
+      return;
+
+    prob_.resize(n);
+    alias_.resize(n);
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small, large;
+    for (size_t i = 0; i < n; ++i) {
+      scaled[i] = weights[i] * n / total;
+      (scaled[i] < 1.0 ? small : large).emplace_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+      const uint32_t s = small.back();
+      small.pop_back();
+      const uint32_t l = large.back();
+      prob_[s] = scaled[s];
+      alias_[s] = l;
+      scaled[l] -= 1.0 - scaled[s];
+      if (scaled[l] < 1.0) {
+        large.pop_back();
+        small.emplace_back(l);
+      }
+    }
+    // Whatever is left is 1 up to rounding
+    for (uint32_t i : large) {
+      prob_[i] = 1.0f;
+      alias_[i] = i;
+    }
+    for (uint32_t i : small) {
+      prob_[i] = 1.0f;
+      alias_[i] = i;
+    }
+  }
+
+  bool empty() const { return prob_.empty(); }
+
+  size_t size() const { return prob_.size(); }
+
+  size_t sample(core::Random& random) const {
+    const size_t i = random.uniform_uint() % prob_.size();
+    return random.uniform_float_01() < prob_[i] ? i : alias_[i];
+  }
+
+ private:
+  std::vector<float> prob_;
+  std::vector<uint32_t> alias_;
+};
+
+// Detour query object owning growable scratch buffers for the path queries
+// run on it, so that queries don't allocate. Each worker thread has its own.
+class PathQuery : public dtNavMeshQuery {
+ public:
+  //! Polygon corridor, sized to the node pool as a corridor never holds more
+  //! polygons than the search can visit
+  std::vector<dtPolyRef> polys;
+  //! Straight path corners, grown on demand
+  std::vector<vec3f> points;
+  //! Query with a much larger node pool for routes the regular search runs
+  //! out of nodes on. Created on first use.
+  std::unique_ptr<PathQuery> longRouteQuery;
+};
 }  // namespace impl
 
 struct PathFinder::Impl {
@@ -250,16 +665,68 @@ struct PathFinder::Impl {
              const float* bmax);
   bool build(const NavMeshSettings& bs, const esp::assets::MeshData& mesh);
 
+  bool buildTiled(const NavMeshSettings& bs,
+                  const float* verts,
+                  const int nverts,
+                  const int* tris,
+                  const int ntris,
+                  const float* bmin,
+                  const float* bmax);
+
+  bool rebuildTiles(const esp::assets::MeshData& mesh,
+                    const vec3f& regionMin,
+                    const vec3f& regionMax);
+
   vec3f getRandomNavigablePoint();
 
-  bool findPath(ShortestPath& path);
-  bool findPath(MultiGoalShortestPath& path);
+  std::vector<vec3f> getRandomNavigablePoints(int numPoints, int islandIndex);
+
+  std::vector<vec3f> getRandomNavigablePointsMinIslandRadius(
+      int numPoints,
+      float minIslandRadius);
+
+  int getIslandIndex(const vec3f& pt) const;
+
+  bool findPath(ShortestPath& path) {
+    return findPath(path, navQuery_.get());
+  }
+  bool findPath(MultiGoalShortestPath& path) {
+    return findPath(path, navQuery_.get());
+  }
+
+  template <typename PathT>
+  std::vector<bool> findPaths(const std::vector<PathT*>& paths);
+
+  float geodesicDistance(GeodesicDistanceField& field, const vec3f& pt);
+
+  void setNumThreads(int numThreads);
+
+  int getNumThreads() const {
+    return numThreads_ > 0 ? numThreads_
+                           : core::ThreadPool::defaultNumThreads();
+  }
 
   template <typename T>
-  T tryStep(const T& start, const T& end, bool allowSliding);
+  T tryStep(const T& start, const T& end, bool allowSliding) {
+    return tryStep(start, end, allowSliding, navQuery_.get());
+  }
 
   template <typename T>
-  T snapPoint(const T& pt);
+  T snapPoint(const T& pt) {
+    return snapPoint(pt, navQuery_.get());
+  }
+
+  bool tryStepBatch(const Eigen::Ref<const Eigen::RowMatrixXf>& starts,
+                    const Eigen::Ref<const Eigen::RowMatrixXf>& ends,
+                    Eigen::Ref<Eigen::RowMatrixXf> endPoints,
+                    bool allowSliding);
+
+  bool snapPointBatch(const Eigen::Ref<const Eigen::RowMatrixXf>& points,
+                      Eigen::Ref<Eigen::RowMatrixXf> snappedPoints);
+
+  bool isNavigableBatch(const Eigen::Ref<const Eigen::RowMatrixXf>& points,
+                        Eigen::Ref<VectorXb> navigable,
+                        const float maxYDelta);
 
   bool loadNavMesh(const std::string& path);
 
@@ -279,13 +746,17 @@ struct PathFinder::Impl {
       const vec3f& pt,
       const float maxSearchRadius = 2.0) const;
 
-  bool isNavigable(const vec3f& pt, const float maxYDelta = 0.5) const;
+  bool isNavigable(const vec3f& pt, const float maxYDelta = 0.5) const {
+    return isNavigable(pt, maxYDelta, navQuery_.get());
+  }
 
   std::pair<vec3f, vec3f> bounds() const { return bounds_; };
 
-  Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> getTopDownView(
-      const float metersPerPixel,
-      const float height);
+  MatrixXb getTopDownView(const float metersPerPixel, const float height);
+
+  std::vector<MatrixXb> getTopDownViews(const float metersPerPixel,
+                                        const std::vector<float>& heights,
+                                        const float maxYDelta);
 
   const assets::MeshData::ptr getNavMeshData();
 
@@ -293,15 +764,25 @@ struct PathFinder::Impl {
   struct NavMeshDeleter {
     void operator()(dtNavMesh* mesh) { dtFreeNavMesh(mesh); }
   };
-  struct NavQueryDeleter {
-    void operator()(dtNavMeshQuery* query) { dtFreeNavMeshQuery(query); }
-  };
 
   std::unique_ptr<dtNavMesh, NavMeshDeleter> navMesh_ = nullptr;
-  std::unique_ptr<dtNavMeshQuery, NavQueryDeleter> navQuery_ = nullptr;
+  std::unique_ptr<impl::PathQuery> navQuery_ = nullptr;
   std::unique_ptr<dtQueryFilter> filter_ = nullptr;
   std::unique_ptr<impl::IslandSystem> islandSystem_ = nullptr;
 
+  //! Incremented every time the navmesh changes, used to invalidate caches
+  //! held outside of the PathFinder
+  uint64_t navMeshVersion_ = 0;
+
+  //! Requested number of worker threads for batched queries, <= 0 means the
+  //! shared pool with all hardware threads.
+  int numThreads_ = 0;
+  //! Created lazily on the first batched query, unless using the shared pool.
+  std::unique_ptr<core::ThreadPool> threadPool_ = nullptr;
+  //! One query object per additional worker thread, worker 0 (the calling
+  //! thread) uses navQuery_. Reset with navQuery_.
+  std::vector<std::unique_ptr<impl::PathQuery>> workerQueries_;
+
   //! Holds triangulated geom/topo. Generated when queried. Reset with
   //! navQuery_.
   assets::MeshData::ptr meshData_ = nullptr;
@@ -310,23 +791,118 @@ struct PathFinder::Impl {
   //! removeZeroAreaPolys.
   float navMeshArea_ = 0;
 
+  //! Per instance so that PathFinders in different threads neither share nor
+  //! race on a random state
+  core::Random random_;
+
+  //! Walkable polygons grouped by island and their area-weighted sampling
+  //! tables. Rebuilt whenever the navmesh changes, for the navmesh version in
+  //! polySamplerVersion_
+  std::vector<dtPolyRef> samplePolys_;
+  impl::AliasTable polySampler_;
+  //! Polygons of island i are samplePolys_[islandOffsets_[i],
+  //! islandOffsets_[i + 1])
+  std::vector<uint32_t> islandOffsets_;
+  std::vector<float> islandAreas_;
+  //! Indices are relative to the island's first polygon
+  std::vector<impl::AliasTable> islandSamplers_;
+  uint64_t polySamplerVersion_ = 0;
+
+  void updatePolySampler();
+  vec3f randomPointOnPoly(dtPolyRef ref);
+  vec3f randomPointOnIsland(uint32_t island);
+
   std::pair<vec3f, vec3f> bounds_;
 
   void removeZeroAreaPolys();
+  float removeZeroAreaPolys(const dtMeshTile* tile);
+  float walkableArea(const dtMeshTile* tile) const;
+
+  void updateBounds();
+
+  struct TileBuildData {
+    unsigned char* data = nullptr;
+    int size = 0;
+    bool failed = false;
+  };
+
+  //! Builds the Detour data of the given tiles of a tiled navmesh in parallel
+  bool buildTiles(const NavMeshSettings& bs,
+                  const float* verts,
+                  const int nverts,
+                  const int* tris,
+                  const int ntris,
+                  const float* bmin,
+                  const float* bmax,
+                  const std::vector<vec2i>& tiles,
+                  std::vector<TileBuildData>& tileData);
+
+  //! What a tiled navmesh was built with, needed to rebuild its tiles
+  struct TiledBuildInfo {
+    NavMeshSettings settings;
+    vec3f bmin;
+    vec3f bmax;
+  };
+  //! Set by tiled builds only, reset when the navmesh is built solo or loaded
+  std::unique_ptr<TiledBuildInfo> tiledBuild_ = nullptr;
 
   bool initNavQuery();
 
+  std::unique_ptr<impl::PathQuery> createPathQuery(int maxNodes) const;
+
+  core::ThreadPool& threadPool();
+
+  bool initWorkerQueries();
+
+  void computeDistanceField(GeodesicDistanceField::Impl& field);
+
+  bool findPath(ShortestPath& path, impl::PathQuery* navQuery);
+  bool findPath(MultiGoalShortestPath& path, impl::PathQuery* navQuery);
+
+  template <typename T>
+  T tryStep(const T& start,
+            const T& end,
+            bool allowSliding,
+            impl::PathQuery* navQuery);
+
+  template <typename T>
+  T snapPoint(const T& pt, dtNavMeshQuery* navQuery);
+
+  bool isNavigable(const vec3f& pt,
+                   const float maxYDelta,
+                   dtNavMeshQuery* navQuery) const;
+
+  //! Runs @p query for every item in [0, @p count) on the thread pool, handing
+  //! each worker its own query object
+  void runQueries(
+      size_t count,
+      size_t grainSize,
+      const std::function<void(impl::PathQuery* navQuery, size_t iItem)>&
+          query);
+
   Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
-  findPathInternal(const vec3f& start,
+  findPathInternal(impl::PathQuery* navQuery,
+                   const vec3f& start,
                    dtPolyRef startRef,
                    const vec3f& pathStart,
                    const vec3f& end,
                    dtPolyRef endRef,
                    const vec3f& pathEnd);
 
-  bool findPathSetup(MultiGoalShortestPath& path,
+  bool findPathSetup(dtNavMeshQuery* navQuery,
+                     MultiGoalShortestPath& path,
                      dtPolyRef& startRef,
                      vec3f& pathStart);
+
+  //! Sliced search on the long route query of @p navQuery, for routes the
+  //! regular search runs out of nodes on. The corridor is left in the long
+  //! route query's polys.
+  impl::PathQuery* findLongRoute(impl::PathQuery* navQuery,
+                                 dtPolyRef startRef,
+                                 const vec3f& pathStart,
+                                 dtPolyRef endRef,
+                                 const vec3f& pathEnd,
+                                 int& numPolys);
 };
 
 namespace {
@@ -364,22 +940,9 @@ PathFinder::Impl::Impl() {
   filter_->setExcludeFlags(0);
 }
 
-bool PathFinder::Impl::build(const NavMeshSettings& bs,
-                             const float* verts,
-                             const int nverts,
-                             const int* tris,
-                             const int ntris,
-                             const float* bmin,
-                             const float* bmax) {
-  Workspace ws;
-  rcContext ctx;
-
-  //
-  // Step 1. Initialize build config.
-  //
-
-  // Init build configuration from GUI
-  rcConfig cfg{};
+namespace {
+// Fills the Recast build configuration shared by solo and tiled builds
+void initBuildConfig(const NavMeshSettings& bs, rcConfig& cfg) {
   memset(&cfg, 0, sizeof(cfg));
   cfg.cs = bs.cellSize;
   cfg.ch = bs.cellHeight;
@@ -397,16 +960,18 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
   cfg.detailSampleDist =
       bs.detailSampleDist < 0.9f ? 0 : bs.cellSize * bs.detailSampleDist;
   cfg.detailSampleMaxError = bs.cellHeight * bs.detailSampleMaxError;
+}
 
-  // Set the area where the navigation will be build.
-  // Here the bounds of the input mesh are used, but the
-  // area could be specified by an user defined box, etc.
-  rcVcopy(cfg.bmin, bmin);
-  rcVcopy(cfg.bmax, bmax);
-  rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
-  LOG(INFO) << "Building navmesh with " << cfg.width << "x" << cfg.height
-            << " cells";
-
+// Runs the Recast pipeline (steps 2 to 7) on the area described by cfg and
+// leaves the resulting poly mesh and detail mesh in ws
+bool buildPolyMesh(rcContext* ctx,
+                   const rcConfig& cfg,
+                   const NavMeshSettings& bs,
+                   const float* verts,
+                   const int nverts,
+                   const int* tris,
+                   const int ntris,
+                   Workspace& ws) {
   //
   // Step 2. Rasterize input polygon soup.
   //
@@ -417,7 +982,7 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
     LOG(ERROR) << "Out of memory for heightfield allocation";
     return false;
   }
-  if (!rcCreateHeightfield(&ctx, *ws.solid, cfg.width, cfg.height, cfg.bmin,
+  if (!rcCreateHeightfield(ctx, *ws.solid, cfg.width, cfg.height, cfg.bmin,
                            cfg.bmax, cfg.cs, cfg.ch)) {
     LOG(ERROR) << "Could not create solid heightfield";
     return false;
@@ -436,9 +1001,9 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
   // If your input data is multiple meshes, you can transform them here,
   // calculate the are type for each of the meshes and rasterize them.
   memset(ws.triareas, 0, ntris * sizeof(unsigned char));
-  rcMarkWalkableTriangles(&ctx, cfg.walkableSlopeAngle, verts, nverts, tris,
+  rcMarkWalkableTriangles(ctx, cfg.walkableSlopeAngle, verts, nverts, tris,
                           ntris, ws.triareas);
-  if (!rcRasterizeTriangles(&ctx, verts, nverts, tris, ws.triareas, ntris,
+  if (!rcRasterizeTriangles(ctx, verts, nverts, tris, ws.triareas, ntris,
                             *ws.solid, cfg.walkableClimb)) {
     LOG(ERROR) << "Could not rasterize triangles.";
     return false;
@@ -452,11 +1017,11 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
   // remove unwanted overhangs caused by the conservative rasterization
   // as well as filter spans where the character cannot possibly stand.
   if (bs.filterLowHangingObstacles)
-    rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *ws.solid);
+    rcFilterLowHangingWalkableObstacles(ctx, cfg.walkableClimb, *ws.solid);
   if (bs.filterLedgeSpans)
-    rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *ws.solid);
+    rcFilterLedgeSpans(ctx, cfg.walkableHeight, cfg.walkableClimb, *ws.solid);
   if (bs.filterWalkableLowHeightSpans)
-    rcFilterWalkableLowHeightSpans(&ctx, cfg.walkableHeight, *ws.solid);
+    rcFilterWalkableLowHeightSpans(ctx, cfg.walkableHeight, *ws.solid);
 
   //
   // Step 4. Partition walkable surface to simple regions.
@@ -470,14 +1035,14 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
     LOG(ERROR) << "Out of memory for compact heightfield";
     return false;
   }
-  if (!rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb,
+  if (!rcBuildCompactHeightfield(ctx, cfg.walkableHeight, cfg.walkableClimb,
                                  *ws.solid, *ws.chf)) {
     LOG(ERROR) << "Could not build compact heightfield";
     return false;
   }
 
   // Erode the walkable area by agent radius.
-  if (!rcErodeWalkableArea(&ctx, cfg.walkableRadius, *ws.chf)) {
+  if (!rcErodeWalkableArea(ctx, cfg.walkableRadius, *ws.chf)) {
     LOG(ERROR) << "Could not erode walkable area";
     return false;
   }
@@ -524,12 +1089,12 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
 
   // Prepare for region partitioning, by calculating distance field along the
   // walkable surface.
-  if (!rcBuildDistanceField(&ctx, *ws.chf)) {
+  if (!rcBuildDistanceField(ctx, *ws.chf)) {
     LOG(ERROR) << "Could not build distance field";
     return false;
   }
   // Partition the walkable surface into simple regions without holes.
-  if (!rcBuildRegions(&ctx, *ws.chf, 0, cfg.minRegionArea,
+  if (!rcBuildRegions(ctx, *ws.chf, cfg.borderSize, cfg.minRegionArea,
                       cfg.mergeRegionArea)) {
     LOG(ERROR) << "Could not build watershed regions";
     return false;
@@ -551,7 +1116,7 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
     LOG(ERROR) << "Out of memory for contour set";
     return false;
   }
-  if (!rcBuildContours(&ctx, *ws.chf, cfg.maxSimplificationError,
+  if (!rcBuildContours(ctx, *ws.chf, cfg.maxSimplificationError,
                        cfg.maxEdgeLen, *ws.cset)) {
     LOG(ERROR) << "Could not create contours";
     return false;
@@ -567,7 +1132,7 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
     LOG(ERROR) << "Out of memory for polymesh";
     return false;
   }
-  if (!rcBuildPolyMesh(&ctx, *ws.cset, cfg.maxVertsPerPoly, *ws.pmesh)) {
+  if (!rcBuildPolyMesh(ctx, *ws.cset, cfg.maxVertsPerPoly, *ws.pmesh)) {
     LOG(ERROR) << "Could not triangulate contours";
     return false;
   }
@@ -583,7 +1148,7 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
     return false;
   }
 
-  if (!rcBuildPolyMeshDetail(&ctx, *ws.pmesh, *ws.chf, cfg.detailSampleDist,
+  if (!rcBuildPolyMeshDetail(ctx, *ws.pmesh, *ws.chf, cfg.detailSampleDist,
                              cfg.detailSampleMaxError, *ws.dmesh)) {
     LOG(ERROR) << "Could not build detail mesh";
     return false;
@@ -592,6 +1157,120 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
   // At this point the navigation mesh data is ready, you can access it from
   // ws.pmesh. See duDebugDrawPolyMesh or dtCreateNavMeshData as examples how to
   // access the data.
+  return true;
+}
+
+// Creates the Detour data for one tile from the poly mesh in ws (step 8).
+// navData is left as nullptr if the poly mesh is empty.
+bool createNavMeshData(const rcConfig& cfg,
+                       const NavMeshSettings& bs,
+                       const int tileX,
+                       const int tileY,
+                       Workspace& ws,
+                       unsigned char** navData,
+                       int* navDataSize) {
+  *navData = nullptr;
+  *navDataSize = 0;
+  if (ws.pmesh->npolys == 0)
+    return true;
+
+  // Update poly flags from areas.
+  for (int i = 0; i < ws.pmesh->npolys; ++i) {
+    if (ws.pmesh->areas[i] == RC_WALKABLE_AREA) {
+      ws.pmesh->areas[i] = POLYAREA_GROUND;
+    }
+    if (ws.pmesh->areas[i] == POLYAREA_GROUND) {
+      ws.pmesh->flags[i] = POLYFLAGS_WALK;
+    } else if (ws.pmesh->areas[i] == POLYAREA_DOOR) {
+      ws.pmesh->flags[i] = POLYFLAGS_WALK | POLYFLAGS_DOOR;
+    }
+  }
+
+  dtNavMeshCreateParams params{};
+  memset(&params, 0, sizeof(params));
+  params.verts = ws.pmesh->verts;
+  params.vertCount = ws.pmesh->nverts;
+  params.polys = ws.pmesh->polys;
+  params.polyAreas = ws.pmesh->areas;
+  params.polyFlags = ws.pmesh->flags;
+  params.polyCount = ws.pmesh->npolys;
+  params.nvp = ws.pmesh->nvp;
+  params.detailMeshes = ws.dmesh->meshes;
+  params.detailVerts = ws.dmesh->verts;
+  params.detailVertsCount = ws.dmesh->nverts;
+  params.detailTris = ws.dmesh->tris;
+  params.detailTriCount = ws.dmesh->ntris;
+  // params.offMeshConVerts = geom->getOffMeshConnectionVerts();
+  // params.offMeshConRad = geom->getOffMeshConnectionRads();
+  // params.offMeshConDir = geom->getOffMeshConnectionDirs();
+  // params.offMeshConAreas = geom->getOffMeshConnectionAreas();
+  // params.offMeshConFlags = geom->getOffMeshConnectionFlags();
+  // params.offMeshConUserID = geom->getOffMeshConnectionId();
+  // params.offMeshConCount = geom->getOffMeshConnectionCount();
+  params.walkableHeight = bs.agentHeight;
+  params.walkableRadius = bs.agentRadius;
+  params.walkableClimb = bs.agentMaxClimb;
+  params.tileX = tileX;
+  params.tileY = tileY;
+  params.tileLayer = 0;
+  rcVcopy(params.bmin, ws.pmesh->bmin);
+  rcVcopy(params.bmax, ws.pmesh->bmax);
+  params.cs = cfg.cs;
+  params.ch = cfg.ch;
+  params.buildBvTree = true;
+
+  if (!dtCreateNavMeshData(&params, navData, navDataSize)) {
+    LOG(ERROR) << "Could not build Detour navmesh";
+    return false;
+  }
+
+  return true;
+}
+
+// Returns the number of bits needed to store values up to v
+int bitsFor(unsigned int v) {
+  int bits = 0;
+  while ((1u << bits) < v)
+    ++bits;
+  return bits;
+}
+}  // namespace
+
+bool PathFinder::Impl::build(const NavMeshSettings& bs,
+                             const float* verts,
+                             const int nverts,
+                             const int* tris,
+                             const int ntris,
+                             const float* bmin,
+                             const float* bmax) {
+  tiledBuild_.reset();
+  if (bs.tiled) {
+    return buildTiled(bs, verts, nverts, tris, ntris, bmin, bmax);
+  }
+
+  Workspace ws;
+  rcContext ctx;
+
+  //
+  // Step 1. Initialize build config.
+  //
+
+  // Init build configuration from GUI
+  rcConfig cfg{};
+  initBuildConfig(bs, cfg);
+
+  // Set the area where the navigation will be build.
+  // Here the bounds of the input mesh are used, but the
+  // area could be specified by an user defined box, etc.
+  rcVcopy(cfg.bmin, bmin);
+  rcVcopy(cfg.bmax, bmax);
+  rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
+  LOG(INFO) << "Building navmesh with " << cfg.width << "x" << cfg.height
+            << " cells";
+
+  if (!buildPolyMesh(&ctx, cfg, bs, verts, nverts, tris, ntris, ws)) {
+    return false;
+  }
 
   //
   // (Optional) Step 8. Create Detour data from Recast poly mesh.
@@ -603,49 +1282,8 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
     unsigned char* navData = nullptr;
     int navDataSize = 0;
 
-    // Update poly flags from areas.
-    for (int i = 0; i < ws.pmesh->npolys; ++i) {
-      if (ws.pmesh->areas[i] == RC_WALKABLE_AREA) {
-        ws.pmesh->areas[i] = POLYAREA_GROUND;
-      }
-      if (ws.pmesh->areas[i] == POLYAREA_GROUND) {
-        ws.pmesh->flags[i] = POLYFLAGS_WALK;
-      } else if (ws.pmesh->areas[i] == POLYAREA_DOOR) {
-        ws.pmesh->flags[i] = POLYFLAGS_WALK | POLYFLAGS_DOOR;
-      }
-    }
-
-    dtNavMeshCreateParams params{};
-    memset(&params, 0, sizeof(params));
-    params.verts = ws.pmesh->verts;
-    params.vertCount = ws.pmesh->nverts;
-    params.polys = ws.pmesh->polys;
-    params.polyAreas = ws.pmesh->areas;
-    params.polyFlags = ws.pmesh->flags;
-    params.polyCount = ws.pmesh->npolys;
-    params.nvp = ws.pmesh->nvp;
-    params.detailMeshes = ws.dmesh->meshes;
-    params.detailVerts = ws.dmesh->verts;
-    params.detailVertsCount = ws.dmesh->nverts;
-    params.detailTris = ws.dmesh->tris;
-    params.detailTriCount = ws.dmesh->ntris;
-    // params.offMeshConVerts = geom->getOffMeshConnectionVerts();
-    // params.offMeshConRad = geom->getOffMeshConnectionRads();
-    // params.offMeshConDir = geom->getOffMeshConnectionDirs();
-    // params.offMeshConAreas = geom->getOffMeshConnectionAreas();
-    // params.offMeshConFlags = geom->getOffMeshConnectionFlags();
-    // params.offMeshConUserID = geom->getOffMeshConnectionId();
-    // params.offMeshConCount = geom->getOffMeshConnectionCount();
-    params.walkableHeight = bs.agentHeight;
-    params.walkableRadius = bs.agentRadius;
-    params.walkableClimb = bs.agentMaxClimb;
-    rcVcopy(params.bmin, ws.pmesh->bmin);
-    rcVcopy(params.bmax, ws.pmesh->bmax);
-    params.cs = cfg.cs;
-    params.ch = cfg.ch;
-    params.buildBvTree = true;
-
-    if (!dtCreateNavMeshData(&params, &navData, &navDataSize)) {
+    if (!createNavMeshData(cfg, bs, 0, 0, ws, &navData, &navDataSize) ||
+        !navData) {
       LOG(ERROR) << "Could not build Detour navmesh";
       return false;
     }
@@ -664,6 +1302,7 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
       LOG(ERROR) << "Could not init Detour navmesh";
       return false;
     }
+    updateBounds();
     if (!initNavQuery()) {
       return false;
     }
@@ -671,6 +1310,7 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
 
   // Added as we also need to remove these on navmesh recomputation
   removeZeroAreaPolys();
+  updatePolySampler();
 
   LOG(INFO) << "Created navmesh with " << ws.pmesh->nverts << " vertices "
             << ws.pmesh->npolys << " polygons";
@@ -678,23 +1318,469 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
   return true;
 }
 
+namespace {
+// Tile grid of a tiled navmesh build
+struct TileGrid {
+  int numTilesX = 0;
+  int numTilesZ = 0;
+  float tileWorldSize = 0;
+};
+
+TileGrid tileGrid(const NavMeshSettings& bs,
+                  const float* bmin,
+                  const float* bmax) {
+  int gridWidth = 0, gridHeight = 0;
+  rcCalcGridSize(bmin, bmax, bs.cellSize, &gridWidth, &gridHeight);
+  TileGrid grid;
+  grid.numTilesX = (gridWidth + bs.tileSize - 1) / bs.tileSize;
+  grid.numTilesZ = (gridHeight + bs.tileSize - 1) / bs.tileSize;
+  grid.tileWorldSize = bs.tileSize * bs.cellSize;
+  return grid;
+}
+}  // namespace
+
+bool PathFinder::Impl::buildTiles(const NavMeshSettings& bs,
+                                  const float* verts,
+                                  const int nverts,
+                                  const int* tris,
+                                  const int ntris,
+                                  const float* bmin,
+                                  const float* bmax,
+                                  const std::vector<vec2i>& tiles,
+                                  std::vector<TileBuildData>& tileData) {
+  rcConfig cfg{};
+  initBuildConfig(bs, cfg);
+  const TileGrid grid = tileGrid(bs, bmin, bmax);
+
+  cfg.tileSize = bs.tileSize;
+  cfg.borderSize = cfg.walkableRadius + 3;
+  cfg.width = cfg.tileSize + cfg.borderSize * 2;
+  cfg.height = cfg.tileSize + cfg.borderSize * 2;
+  const float borderWorldSize = cfg.borderSize * cfg.cs;
+
+  // Bin the triangles into every requested tile whose (border-expanded)
+  // bounds they overlap so that each tile only rasterizes the geometry it can
+  // see
+  std::vector<int> tileSlots(grid.numTilesX * grid.numTilesZ, -1);
+  for (size_t iTile = 0; iTile < tiles.size(); ++iTile) {
+    tileSlots[tiles[iTile][1] * grid.numTilesX + tiles[iTile][0]] = iTile;
+  }
+  const auto tileCoord = [&grid](float x, float origin, int numTilesAxis) {
+    const int t = static_cast<int>(floorf((x - origin) / grid.tileWorldSize));
+    return std::min(std::max(t, 0), numTilesAxis - 1);
+  };
+  std::vector<std::vector<int>> tileTris(tiles.size());
+  for (int iTri = 0; iTri < ntris; ++iTri) {
+    const float* v0 = &verts[tris[iTri * 3] * 3];
+    float triMin[2] = {v0[0], v0[2]};
+    float triMax[2] = {v0[0], v0[2]};
+    for (int k = 1; k < 3; ++k) {
+      const float* v = &verts[tris[iTri * 3 + k] * 3];
+      triMin[0] = std::min(triMin[0], v[0]);
+      triMin[1] = std::min(triMin[1], v[2]);
+      triMax[0] = std::max(triMax[0], v[0]);
+      triMax[1] = std::max(triMax[1], v[2]);
+    }
+
+    const int x0 =
+        tileCoord(triMin[0] - borderWorldSize, bmin[0], grid.numTilesX);
+    const int x1 =
+        tileCoord(triMax[0] + borderWorldSize, bmin[0], grid.numTilesX);
+    const int z0 =
+        tileCoord(triMin[1] - borderWorldSize, bmin[2], grid.numTilesZ);
+    const int z1 =
+        tileCoord(triMax[1] + borderWorldSize, bmin[2], grid.numTilesZ);
+    for (int z = z0; z <= z1; ++z) {
+      for (int x = x0; x <= x1; ++x) {
+        const int slot = tileSlots[z * grid.numTilesX + x];
+        if (slot < 0)
+          continue;
+        std::vector<int>& dst = tileTris[slot];
+        dst.insert(dst.end(), &tris[iTri * 3], &tris[iTri * 3 + 3]);
+      }
+    }
+  }
+
+  // Build the tiles in parallel, every worker uses its own Recast context and
+  // workspace
+  tileData.assign(tiles.size(), TileBuildData{});
+  threadPool().parallelFor(tiles.size(), [&](int /*workerIndex*/,
+                                             size_t iTile) {
+    const int x = tiles[iTile][0];
+    const int z = tiles[iTile][1];
+    const std::vector<int>& indices = tileTris[iTile];
+    if (indices.empty())
+      return;
+
+    rcConfig tileCfg = cfg;
+    rcVcopy(tileCfg.bmin, bmin);
+    rcVcopy(tileCfg.bmax, bmax);
+    tileCfg.bmin[0] = bmin[0] + x * grid.tileWorldSize - borderWorldSize;
+    tileCfg.bmin[2] = bmin[2] + z * grid.tileWorldSize - borderWorldSize;
+    tileCfg.bmax[0] = bmin[0] + (x + 1) * grid.tileWorldSize + borderWorldSize;
+    tileCfg.bmax[2] = bmin[2] + (z + 1) * grid.tileWorldSize + borderWorldSize;
+
+    Workspace ws;
+    rcContext ctx;
+    if (!buildPolyMesh(&ctx, tileCfg, bs, verts, nverts, indices.data(),
+                       indices.size() / 3, ws) ||
+        !createNavMeshData(tileCfg, bs, x, z, ws, &tileData[iTile].data,
+                           &tileData[iTile].size)) {
+      LOG(ERROR) << "Could not build navmesh tile " << x << "," << z;
+      tileData[iTile].failed = true;
+    }
+  });
+
+  for (const auto& tile : tileData) {
+    if (tile.failed) {
+      for (auto& tileToFree : tileData) {
+        dtFree(tileToFree.data);
+        tileToFree.data = nullptr;
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PathFinder::Impl::buildTiled(const NavMeshSettings& bs,
+                                  const float* verts,
+                                  const int nverts,
+                                  const int* tris,
+                                  const int ntris,
+                                  const float* bmin,
+                                  const float* bmax) {
+  if (static_cast<int>(bs.vertsPerPoly) > DT_VERTS_PER_POLYGON) {
+    LOG(ERROR) << "Tiled navmesh requires vertsPerPoly <= "
+               << DT_VERTS_PER_POLYGON;
+    return false;
+  }
+  if (bs.tileSize <= 0) {
+    LOG(ERROR) << "Tiled navmesh requires a positive tileSize";
+    return false;
+  }
+
+  const TileGrid grid = tileGrid(bs, bmin, bmax);
+  const int numTiles = grid.numTilesX * grid.numTilesZ;
+
+  // Polygon refs are 32 bits of which at least 10 are used by the salt, the
+  // rest is split between the tile and the polygon index.
+  const int tileBits = std::min(
+      bitsFor(bs.maxTiles > 0 ? std::max(bs.maxTiles, numTiles) : numTiles),
+      14);
+  if ((1 << tileBits) < numTiles) {
+    LOG(ERROR) << "Navmesh needs " << numTiles << " tiles, more than the "
+               << (1 << tileBits) << " Detour supports. Increase tileSize.";
+    return false;
+  }
+  const int polyBits = 22 - tileBits;
+
+  LOG(INFO) << "Building tiled navmesh with " << grid.numTilesX << "x"
+            << grid.numTilesZ << " tiles";
+
+  std::vector<vec2i> tiles;
+  tiles.reserve(numTiles);
+  for (int z = 0; z < grid.numTilesZ; ++z) {
+    for (int x = 0; x < grid.numTilesX; ++x) {
+      tiles.emplace_back(x, z);
+    }
+  }
+  std::vector<TileBuildData> tileData;
+  if (!buildTiles(bs, verts, nverts, tris, ntris, bmin, bmax, tiles,
+                  tileData)) {
+    return false;
+  }
+
+  const auto freeTileData = [&tileData]() {
+    for (auto& tile : tileData) {
+      dtFree(tile.data);
+      tile.data = nullptr;
+    }
+  };
+
+  dtNavMeshParams params{};
+  memset(&params, 0, sizeof(params));
+  rcVcopy(params.orig, bmin);
+  params.tileWidth = grid.tileWorldSize;
+  params.tileHeight = grid.tileWorldSize;
+  params.maxTiles = 1 << tileBits;
+  params.maxPolys = 1 << polyBits;
+
+  navMesh_.reset(dtAllocNavMesh());
+  if (!navMesh_) {
+    freeTileData();
+    LOG(ERROR) << "Could not allocate Detour navmesh";
+    return false;
+  }
+  dtStatus status = navMesh_->init(&params);
+  if (dtStatusFailed(status)) {
+    freeTileData();
+    LOG(ERROR) << "Could not init Detour navmesh";
+    return false;
+  }
+
+  // Adding tiles links them to their neighbours, which Detour does not allow
+  // concurrently
+  int numPolys = 0;
+  for (auto& tile : tileData) {
+    if (!tile.data)
+      continue;
+    status =
+        navMesh_->addTile(tile.data, tile.size, DT_TILE_FREE_DATA, 0, nullptr);
+    if (dtStatusFailed(status)) {
+      LOG(ERROR) << "Could not add navmesh tile";
+      freeTileData();
+      return false;
+    }
+    numPolys += reinterpret_cast<const dtMeshHeader*>(tile.data)->polyCount;
+    // Owned by the navmesh now
+    tile.data = nullptr;
+  }
+
+  updateBounds();
+  if (!initNavQuery()) {
+    return false;
+  }
+
+  // Added as we also need to remove these on navmesh recomputation
+  removeZeroAreaPolys();
+  updatePolySampler();
+
+  tiledBuild_ = std::make_unique<TiledBuildInfo>();
+  tiledBuild_->settings = bs;
+  tiledBuild_->bmin = vec3f(bmin);
+  tiledBuild_->bmax = vec3f(bmax);
+
+  LOG(INFO) << "Created tiled navmesh with " << numPolys << " polygons";
+
+  return true;
+}
+
+bool PathFinder::Impl::rebuildTiles(const esp::assets::MeshData& mesh,
+                                    const vec3f& regionMin,
+                                    const vec3f& regionMax) {
+  if (!isLoaded()) {
+    LOG(ERROR) << "PathFinder::rebuildTiles: no navmesh loaded";
+    return false;
+  }
+  if (!tiledBuild_) {
+    if (navMesh_->getParams()->maxTiles > 1) {
+      // navmesh files don't store the build settings and bounds
+      LOG(ERROR) << "PathFinder::rebuildTiles: the tiles of a navmesh loaded "
+                    "from a file can't be rebuilt, build it with "
+                    "NavMeshSettings::tiled first";
+    } else {
+      LOG(ERROR) << "PathFinder::rebuildTiles: tiles can only be rebuilt on a "
+                    "navmesh built with NavMeshSettings::tiled";
+    }
+    return false;
+  }
+  if (mesh.vbo.empty()) {
+    return false;
+  }
+
+  const NavMeshSettings& bs = tiledBuild_->settings;
+  const float* bmin = tiledBuild_->bmin.data();
+  const float* bmax = tiledBuild_->bmax.data();
+  const TileGrid grid = tileGrid(bs, bmin, bmax);
+
+  // The region affects every tile whose border-expanded bounds it overlaps,
+  // as the agent radius erosion reaches into neighbouring tiles
+  const float borderWorldSize =
+      (ceilf(bs.agentRadius / bs.cellSize) + 3) * bs.cellSize;
+  if (regionMax[0] + borderWorldSize < bmin[0] ||
+      regionMin[0] - borderWorldSize > bmax[0] ||
+      regionMax[2] + borderWorldSize < bmin[2] ||
+      regionMin[2] - borderWorldSize > bmax[2]) {
+    LOG(ERROR) << "Cannot rebuild navmesh tiles outside of the bounds the "
+                  "navmesh was built with, recompute the navmesh instead";
+    return false;
+  }
+  // The tile grid and the rasterized height range are fixed by the original
+  // build, geometry beyond them is clipped
+  for (int axis = 0; axis < 3; ++axis) {
+    if (regionMin[axis] < bmin[axis] || regionMax[axis] > bmax[axis]) {
+      LOG(WARNING) << "Rebuilding navmesh tiles for a region extending beyond "
+                      "the bounds the navmesh was built with, geometry outside "
+                      "of them is ignored. Recompute the navmesh to include "
+                      "it.";
+      break;
+    }
+  }
+
+  const auto tileCoord = [&grid](float x, float origin, int numTilesAxis) {
+    const int t = static_cast<int>(floorf((x - origin) / grid.tileWorldSize));
+    return std::min(std::max(t, 0), numTilesAxis - 1);
+  };
+  const int x0 =
+      tileCoord(regionMin[0] - borderWorldSize, bmin[0], grid.numTilesX);
+  const int x1 =
+      tileCoord(regionMax[0] + borderWorldSize, bmin[0], grid.numTilesX);
+  const int z0 =
+      tileCoord(regionMin[2] - borderWorldSize, bmin[2], grid.numTilesZ);
+  const int z1 =
+      tileCoord(regionMax[2] + borderWorldSize, bmin[2], grid.numTilesZ);
+
+  std::vector<vec2i> tiles;
+  for (int z = z0; z <= z1; ++z) {
+    for (int x = x0; x <= x1; ++x) {
+      tiles.emplace_back(x, z);
+    }
+  }
+
+  std::vector<int> indices(mesh.ibo.begin(), mesh.ibo.end());
+  std::vector<TileBuildData> tileData;
+  if (!buildTiles(bs, mesh.vbo[0].data(), mesh.vbo.size(), indices.data(),
+                  indices.size() / 3, bmin, bmax, tiles, tileData)) {
+    return false;
+  }
+
+  const dtNavMesh* constNavMesh = navMesh_.get();
+
+  // New tiles only link to polygons in their own or the neighbouring tiles, so
+  // only the islands touching that ring can split or merge. Forget them before
+  // the old tiles are removed.
+  std::vector<dtPolyRef> touchedPolys;
+  for (int z = std::max(z0 - 1, 0); z <= std::min(z1 + 1, grid.numTilesZ - 1);
+       ++z) {
+    for (int x = std::max(x0 - 1, 0);
+         x <= std::min(x1 + 1, grid.numTilesX - 1); ++x) {
+      const dtMeshTile* tile = constNavMesh->getTileAt(x, z, 0);
+      if (!tile || !tile->header)
+        continue;
+      const dtPolyRef base = navMesh_->getPolyRefBase(tile);
+      for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+        touchedPolys.emplace_back(base | static_cast<dtPolyRef>(jPoly));
+      }
+    }
+  }
+  islandSystem_->invalidate(touchedPolys);
+
+  for (const auto& tileCoords : tiles) {
+    const dtMeshTile* tile =
+        constNavMesh->getTileAt(tileCoords[0], tileCoords[1], 0);
+    if (tile && tile->header)
+      navMeshArea_ -= walkableArea(tile);
+  }
+
+  std::vector<dtPolyRef> addedPolys;
+  for (size_t iTile = 0; iTile < tiles.size(); ++iTile) {
+    const int x = tiles[iTile][0];
+    const int z = tiles[iTile][1];
+    const dtTileRef oldRef = navMesh_->getTileRefAt(x, z, 0);
+    if (oldRef) {
+      navMesh_->removeTile(oldRef, nullptr, nullptr);
+    }
+
+    TileBuildData& tile = tileData[iTile];
+    if (!tile.data)
+      continue;
+    dtTileRef newRef = 0;
+    dtStatus status = navMesh_->addTile(tile.data, tile.size,
+                                        DT_TILE_FREE_DATA, 0, &newRef);
+    if (dtStatusFailed(status)) {
+      LOG(ERROR) << "Could not add navmesh tile " << x << "," << z;
+      dtFree(tile.data);
+      tile.data = nullptr;
+      continue;
+    }
+    tile.data = nullptr;
+
+    const dtMeshTile* newTile = navMesh_->getTileByRef(newRef);
+    navMeshArea_ += removeZeroAreaPolys(newTile);
+    const dtPolyRef base = navMesh_->getPolyRefBase(newTile);
+    for (int jPoly = 0; jPoly < newTile->header->polyCount; ++jPoly) {
+      addedPolys.emplace_back(base | static_cast<dtPolyRef>(jPoly));
+    }
+  }
+  islandSystem_->relabel(filter_.get(), addedPolys);
+
+  updateBounds();
+  // Query objects only hold a pointer to the navmesh, but derived data has to
+  // be regenerated
+  meshData_.reset();
+  ++navMeshVersion_;
+  updatePolySampler();
+
+  LOG(INFO) << "Rebuilt " << tiles.size() << " navmesh tiles";
+
+  return true;
+}
+
+namespace {
+// Search node pool of the query objects. Bounds the polygons a path search can
+// visit.
+constexpr int NAV_QUERY_MAX_NODES = 2048;
+// Node pool of the queries for routes exceeding NAV_QUERY_MAX_NODES, the most
+// Detour can address
+constexpr int LONG_ROUTE_MAX_NODES = 65535;
+// Search iterations per slice of a long route search
+constexpr int LONG_ROUTE_ITERATIONS_PER_SLICE = 1024;
+}  // namespace
+
+std::unique_ptr<impl::PathQuery> PathFinder::Impl::createPathQuery(
+    int maxNodes) const {
+  auto query = std::make_unique<impl::PathQuery>();
+  if (dtStatusFailed(query->init(navMesh_.get(), maxNodes)))
+    return nullptr;
+  query->polys.resize(maxNodes);
+  return query;
+}
+
 bool PathFinder::Impl::initNavQuery() {
   // if we are reinitializing the NavQuery, then also reset the MeshData
   meshData_.reset();
+  workerQueries_.clear();
+  ++navMeshVersion_;
 
-  navQuery_.reset(dtAllocNavMeshQuery());
-  dtStatus status = navQuery_->init(navMesh_.get(), 2048);
-  if (dtStatusFailed(status)) {
+  navQuery_ = createPathQuery(NAV_QUERY_MAX_NODES);
+  if (!navQuery_) {
     LOG(ERROR) << "Could not init Detour navmesh query";
     return false;
   }
 
-  islandSystem_ =
-      std::make_unique<impl::IslandSystem>(navMesh_.get(), filter_.get());
+  // Solo navmeshes are a single tile, only tiled ones have anything to split
+  // across workers
+  islandSystem_ = std::make_unique<impl::IslandSystem>(
+      navMesh_.get(), filter_.get(),
+      navMesh_->getMaxTiles() > 1 ? &threadPool() : nullptr);
+
+  return true;
+}
+
+core::ThreadPool& PathFinder::Impl::threadPool() {
+  if (numThreads_ <= 0) {
+    return core::ThreadPool::shared();
+  }
+  if (!threadPool_) {
+    threadPool_ = std::make_unique<core::ThreadPool>(numThreads_);
+  }
+  return *threadPool_;
+}
+
+bool PathFinder::Impl::initWorkerQueries() {
+  const size_t numWorkerQueries = threadPool().numThreads() - 1;
+  while (workerQueries_.size() < numWorkerQueries) {
+    workerQueries_.emplace_back(createPathQuery(NAV_QUERY_MAX_NODES));
+    if (!workerQueries_.back()) {
+      workerQueries_.pop_back();
+      LOG(ERROR) << "Could not init Detour navmesh query for worker thread";
+      return false;
+    }
+  }
 
   return true;
 }
 
+void PathFinder::Impl::setNumThreads(int numThreads) {
+  if (numThreads == numThreads_)
+    return;
+
+  numThreads_ = numThreads;
+  threadPool_.reset();
+  workerQueries_.clear();
+}
+
 bool PathFinder::Impl::build(const NavMeshSettings& bs,
                              const esp::assets::MeshData& mesh) {
   const int numVerts = mesh.vbo.size();
@@ -797,28 +1883,61 @@ void PathFinder::Impl::removeZeroAreaPolys() {
   for (int iTile = 0; iTile < navMesh_->getMaxTiles(); ++iTile) {
     const dtMeshTile* tile =
         const_cast<const dtNavMesh*>(navMesh_.get())->getTile(iTile);
-    if (!tile)
+    if (!tile || !tile->header)
       continue;
 
-    // Iterate over all polygons in a tile
-    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
-      // Get the polygon reference from the tile and polygon id
-      dtPolyRef polyRef = navMesh_->encodePolyId(tile->salt, iTile, jPoly);
-      const dtPoly* poly = nullptr;
-      const dtMeshTile* tmp = nullptr;
-      navMesh_->getTileAndPolyByRefUnsafe(polyRef, &tmp, &poly);
+    navMeshArea_ += removeZeroAreaPolys(tile);
+  }
+}
 
-      CORRADE_INTERNAL_ASSERT(poly != nullptr);
-      CORRADE_INTERNAL_ASSERT(tmp != nullptr);
+float PathFinder::Impl::removeZeroAreaPolys(const dtMeshTile* tile) {
+  float area = 0;
+  const dtPolyRef base = navMesh_->getPolyRefBase(tile);
+  // Iterate over all polygons in a tile
+  for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+    // Get the polygon reference from the tile and polygon id
+    dtPolyRef polyRef = base | static_cast<dtPolyRef>(jPoly);
+    const dtPoly* poly = &tile->polys[jPoly];
+
+    float polygonArea = polyArea(poly, tile);
+    if (polygonArea < 1e-5) {
+      navMesh_->setPolyFlags(polyRef, POLYFLAGS_DISABLED);
+    } else if (poly->flags & POLYFLAGS_WALK) {
+      area += polygonArea;
+    }
+  }
+  return area;
+}
 
-      float polygonArea = polyArea(poly, tile);
-      if (polygonArea < 1e-5) {
-        navMesh_->setPolyFlags(polyRef, POLYFLAGS_DISABLED);
-      } else if (poly->flags & POLYFLAGS_WALK) {
-        navMeshArea_ += polygonArea;
-      }
+float PathFinder::Impl::walkableArea(const dtMeshTile* tile) const {
+  float area = 0;
+  for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+    const dtPoly* poly = &tile->polys[jPoly];
+    if (poly->flags & POLYFLAGS_WALK)
+      area += polyArea(poly, tile);
+  }
+  return area;
+}
+
+void PathFinder::Impl::updateBounds() {
+  const dtNavMesh* navMesh = navMesh_.get();
+  bool first = true;
+  vec3f bmin, bmax;
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+
+    if (first) {
+      bmin = vec3f(tile->header->bmin);
+      bmax = vec3f(tile->header->bmax);
+      first = false;
+    } else {
+      bmin = bmin.array().min(Eigen::Array3f{tile->header->bmin});
+      bmax = bmax.array().max(Eigen::Array3f{tile->header->bmax});
     }
   }
+  bounds_ = std::make_pair(bmin, bmax);
 }
 
 bool PathFinder::Impl::loadNavMesh(const std::string& path) {
@@ -842,8 +1961,6 @@ bool PathFinder::Impl::loadNavMesh(const std::string& path) {
     return false;
   }
 
-  vec3f bmin, bmax;
-
   dtNavMesh* mesh = dtAllocNavMesh();
   if (!mesh) {
     fclose(fp);
@@ -881,24 +1998,20 @@ bool PathFinder::Impl::loadNavMesh(const std::string& path) {
 
     mesh->addTile(data, tileHeader.dataSize, DT_TILE_FREE_DATA,
                   tileHeader.tileRef, nullptr);
-    const dtMeshTile* tile = mesh->getTileByRef(tileHeader.tileRef);
-    if (i == 0) {
-      bmin = vec3f(tile->header->bmin);
-      bmax = vec3f(tile->header->bmax);
-    } else {
-      bmin = bmin.array().min(Eigen::Array3f{tile->header->bmin});
-      bmax = bmax.array().max(Eigen::Array3f{tile->header->bmax});
-    }
   }
 
   fclose(fp);
 
   navMesh_.reset(mesh);
-  bounds_ = std::make_pair(bmin, bmax);
+  tiledBuild_.reset();
+  updateBounds();
 
   removeZeroAreaPolys();
 
-  return initNavQuery();
+  if (!initNavQuery())
+    return false;
+  updatePolySampler();
+  return true;
 }
 
 bool PathFinder::Impl::saveNavMesh(const std::string& path) {
@@ -944,26 +2057,193 @@ bool PathFinder::Impl::saveNavMesh(const std::string& path) {
 }
 
 void PathFinder::Impl::seed(uint32_t newSeed) {
-  // TODO: this should be using core::Random instead, but passing function
-  // to navQuery_->findRandomPoint needs to be figured out first
-  srand(newSeed);
+  random_.seed(newSeed);
+}
+
+void PathFinder::Impl::updatePolySampler() {
+  if (polySamplerVersion_ == navMeshVersion_)
+    return;
+  polySamplerVersion_ = navMeshVersion_;
+
+  struct SamplePoly {
+    uint32_t island;
+    dtPolyRef ref;
+    float area;
+  };
+  std::vector<SamplePoly> polys;
+  const dtNavMesh* navMesh = navMesh_.get();
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+    const dtPolyRef base = navMesh->getPolyRefBase(tile);
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPoly* poly = &tile->polys[jPoly];
+      const dtPolyRef ref = base | static_cast<dtPolyRef>(jPoly);
+      if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION ||
+          !filter_->passFilter(ref, tile, poly))
+        continue;
+      polys.push_back({islandSystem_->islandOf(ref), ref, polyArea(poly, tile)});
+    }
+  }
+  std::stable_sort(polys.begin(), polys.end(),
+                   [](const SamplePoly& a, const SamplePoly& b) {
+                     return a.island < b.island;
+                   });
+
+  const uint32_t numIslands = islandSystem_->numIslands();
+  samplePolys_.resize(polys.size());
+  std::vector<float> areas(polys.size());
+  islandOffsets_.assign(numIslands + 1, 0);
+  islandAreas_.assign(numIslands, 0.0f);
+  for (size_t i = 0; i < polys.size(); ++i) {
+    samplePolys_[i] = polys[i].ref;
+    areas[i] = polys[i].area;
+    // Walkable polygons are always labeled, but stay safe
+    if (polys[i].island < numIslands) {
+      ++islandOffsets_[polys[i].island + 1];
+      islandAreas_[polys[i].island] += polys[i].area;
+    }
+  }
+  std::partial_sum(islandOffsets_.begin(), islandOffsets_.end(),
+                   islandOffsets_.begin());
+
+  polySampler_ = impl::AliasTable(areas);
+  islandSamplers_.resize(numIslands);
+  for (uint32_t iIsland = 0; iIsland < numIslands; ++iIsland) {
+    islandSamplers_[iIsland] = impl::AliasTable(
+        std::vector<float>(areas.begin() + islandOffsets_[iIsland],
+                           areas.begin() + islandOffsets_[iIsland + 1]));
+  }
 }
 
-// Returns a random number [0..1]
-static float frand() {
-  return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+vec3f PathFinder::Impl::randomPointOnPoly(dtPolyRef ref) {
+  const dtMeshTile* tile = nullptr;
+  const dtPoly* poly = nullptr;
+  navMesh_->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+
+  float verts[3 * DT_VERTS_PER_POLYGON];
+  float areas[DT_VERTS_PER_POLYGON];
+  for (int iVert = 0; iVert < poly->vertCount; ++iVert) {
+    dtVcopy(&verts[iVert * 3], &tile->verts[poly->verts[iVert] * 3]);
+  }
+
+  const float s = random_.uniform_float_01();
+  const float t = random_.uniform_float_01();
+  vec3f pt;
+  dtRandomPointInConvexPoly(verts, poly->vertCount, areas, s, t, pt.data());
+
+  float height = 0.0f;
+  navQuery_->getPolyHeight(ref, pt.data(), &height);
+  pt[1] = height;
+  return pt;
+}
+
+vec3f PathFinder::Impl::randomPointOnIsland(uint32_t island) {
+  return randomPointOnPoly(
+      samplePolys_[islandOffsets_[island] +
+                   islandSamplers_[island].sample(random_)]);
 }
 
 vec3f PathFinder::Impl::getRandomNavigablePoint() {
-  dtPolyRef ref;
   constexpr float inf = std::numeric_limits<float>::infinity();
-  vec3f pt(inf, inf, inf);
-  dtStatus status =
-      navQuery_->findRandomPoint(filter_.get(), frand, &ref, pt.data());
-  if (!dtStatusSucceed(status)) {
+  if (!isLoaded()) {
     LOG(ERROR) << "Failed to getRandomNavigablePoint";
+    return {inf, inf, inf};
   }
-  return pt;
+  updatePolySampler();
+  if (polySampler_.empty()) {
+    LOG(ERROR) << "Failed to getRandomNavigablePoint";
+    return {inf, inf, inf};
+  }
+  return randomPointOnPoly(samplePolys_[polySampler_.sample(random_)]);
+}
+
+std::vector<vec3f> PathFinder::Impl::getRandomNavigablePoints(
+    int numPoints,
+    int islandIndex) {
+  std::vector<vec3f> points;
+  if (numPoints <= 0)
+    return points;
+  if (!isLoaded()) {
+    LOG(ERROR) << "Failed to getRandomNavigablePoints";
+    return points;
+  }
+  updatePolySampler();
+
+  points.reserve(numPoints);
+  if (islandIndex == ID_UNDEFINED) {
+    if (polySampler_.empty()) {
+      LOG(ERROR) << "Failed to getRandomNavigablePoints";
+      return points;
+    }
+    for (int i = 0; i < numPoints; ++i) {
+      points.emplace_back(
+          randomPointOnPoly(samplePolys_[polySampler_.sample(random_)]));
+    }
+    return points;
+  }
+
+  if (islandIndex < 0 || islandIndex >= int(islandSamplers_.size()) ||
+      islandSamplers_[islandIndex].empty()) {
+    LOG(ERROR) << "getRandomNavigablePoints: island " << islandIndex
+               << " has no navigable area";
+    return points;
+  }
+  for (int i = 0; i < numPoints; ++i) {
+    points.emplace_back(randomPointOnIsland(islandIndex));
+  }
+  return points;
+}
+
+std::vector<vec3f> PathFinder::Impl::getRandomNavigablePointsMinIslandRadius(
+    int numPoints,
+    float minIslandRadius) {
+  std::vector<vec3f> points;
+  if (numPoints <= 0)
+    return points;
+  if (!isLoaded()) {
+    LOG(ERROR) << "Failed to getRandomNavigablePoints";
+    return points;
+  }
+  updatePolySampler();
+
+  // Pick islands by area so the points stay uniform over the selected islands
+  std::vector<uint32_t> islands;
+  std::vector<float> areas;
+  for (uint32_t iIsland = 0; iIsland < islandSamplers_.size(); ++iIsland) {
+    if (!islandSamplers_[iIsland].empty() &&
+        islandSystem_->radiusOfIsland(iIsland) >= minIslandRadius) {
+      islands.emplace_back(iIsland);
+      areas.emplace_back(islandAreas_[iIsland]);
+    }
+  }
+  const impl::AliasTable islandSampler(areas);
+  if (islandSampler.empty()) {
+    LOG(ERROR) << "getRandomNavigablePoints: no island with radius >= "
+               << minIslandRadius;
+    return points;
+  }
+
+  points.reserve(numPoints);
+  for (int i = 0; i < numPoints; ++i) {
+    points.emplace_back(
+        randomPointOnIsland(islands[islandSampler.sample(random_)]));
+  }
+  return points;
+}
+
+int PathFinder::Impl::getIslandIndex(const vec3f& pt) const {
+  dtPolyRef ptRef;
+  dtStatus status;
+  std::tie(status, ptRef, std::ignore) =
+      projectToPoly(pt, navQuery_.get(), filter_.get());
+  if (status != DT_SUCCESS || ptRef == 0)
+    return ID_UNDEFINED;
+
+  const uint32_t island = islandSystem_->islandOf(ptRef);
+  return island == impl::IslandSystem::NO_ISLAND ? ID_UNDEFINED
+                                                  : static_cast<int>(island);
 }
 
 namespace {
@@ -981,12 +2261,13 @@ float pathLength(const std::vector<vec3f>& points) {
 }
 }  // namespace
 
-bool PathFinder::Impl::findPath(ShortestPath& path) {
+bool PathFinder::Impl::findPath(ShortestPath& path,
+                                impl::PathQuery* navQuery) {
   MultiGoalShortestPath tmp;
   tmp.requestedStart = path.requestedStart;
   tmp.setRequestedEnds({path.requestedEnd});
 
-  bool status = findPath(tmp);
+  bool status = findPath(tmp, navQuery);
 
   path.geodesicDistance = tmp.geodesicDistance;
   path.points = std::move(tmp.points);
@@ -994,7 +2275,8 @@ bool PathFinder::Impl::findPath(ShortestPath& path) {
 }
 
 Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
-PathFinder::Impl::findPathInternal(const vec3f& start,
+PathFinder::Impl::findPathInternal(impl::PathQuery* navQuery,
+                                   const vec3f& start,
                                    dtPolyRef startRef,
                                    const vec3f& pathStart,
                                    const vec3f& end,
@@ -1010,34 +2292,88 @@ PathFinder::Impl::findPathInternal(const vec3f& start,
     return Cr::Containers::NullOpt;
   }
 
-  static const int MAX_POLYS = 256;
-  dtPolyRef polys[MAX_POLYS];
-
   int numPolys = 0;
-  dtStatus status =
-      navQuery_->findPath(startRef, endRef, pathStart.data(), pathEnd.data(),
-                          filter_.get(), polys, &numPolys, MAX_POLYS);
-  if (status != DT_SUCCESS || numPolys == 0) {
+  const dtPolyRef* polys = navQuery->polys.data();
+  dtStatus status = navQuery->findPath(
+      startRef, endRef, pathStart.data(), pathEnd.data(), filter_.get(),
+      navQuery->polys.data(), &numPolys, navQuery->polys.size());
+  if (dtStatusFailed(status)) {
+    return Cr::Containers::NullOpt;
+  }
+  if (dtStatusDetail(status, DT_PARTIAL_RESULT)) {
+    // The end wasn't reached. If the search ran out of nodes the route is just
+    // longer than the regular search can explore, so retry on a larger pool.
+    if (!dtStatusDetail(status, DT_OUT_OF_NODES))
+      return Cr::Containers::NullOpt;
+    const impl::PathQuery* longRouteQuery = findLongRoute(
+        navQuery, startRef, pathStart, endRef, pathEnd, numPolys);
+    if (!longRouteQuery)
+      return Cr::Containers::NullOpt;
+    polys = longRouteQuery->polys.data();
+  } else if (numPolys == 0) {
     return Cr::Containers::NullOpt;
   }
 
+  // The straight path has at most a corner per portal plus the endpoints, but
+  // grow the buffer if Detour disagrees
+  std::vector<vec3f>& points = navQuery->points;
+  if (points.size() < size_t(numPolys) + 1)
+    points.resize(numPolys + 1);
   int numPoints = 0;
-  std::vector<vec3f> points(MAX_POLYS);
-  status = navQuery_->findStraightPath(start.data(), end.data(), polys,
-                                       numPolys, points[0].data(), nullptr,
-                                       nullptr, &numPoints, MAX_POLYS);
+  while (true) {
+    status = navQuery->findStraightPath(start.data(), end.data(), polys,
+                                        numPolys, points[0].data(), nullptr,
+                                        nullptr, &numPoints, points.size());
+    if (!dtStatusDetail(status, DT_BUFFER_TOO_SMALL))
+      break;
+    points.resize(2 * points.size());
+  }
   if (status != DT_SUCCESS || numPoints == 0) {
     return Corrade::Containers::NullOpt;
   }
 
-  points.resize(numPoints);
+  std::vector<vec3f> pathPoints(points.begin(), points.begin() + numPoints);
+
+  const float length = pathLength(pathPoints);
+
+  return std::make_tuple(length, std::move(pathPoints));
+}
 
-  const float length = pathLength(points);
+impl::PathQuery* PathFinder::Impl::findLongRoute(impl::PathQuery* navQuery,
+                                                 dtPolyRef startRef,
+                                                 const vec3f& pathStart,
+                                                 dtPolyRef endRef,
+                                                 const vec3f& pathEnd,
+                                                 int& numPolys) {
+  if (!navQuery->longRouteQuery) {
+    navQuery->longRouteQuery = createPathQuery(LONG_ROUTE_MAX_NODES);
+    if (!navQuery->longRouteQuery) {
+      LOG(ERROR) << "Could not init Detour navmesh query for long routes";
+      return nullptr;
+    }
+  }
+  impl::PathQuery* query = navQuery->longRouteQuery.get();
 
-  return std::make_tuple(length, std::move(points));
+  dtStatus status = query->initSlicedFindPath(startRef, endRef, pathStart.data(),
+                                              pathEnd.data(), filter_.get());
+  while (dtStatusInProgress(status)) {
+    status =
+        query->updateSlicedFindPath(LONG_ROUTE_ITERATIONS_PER_SLICE, nullptr);
+  }
+  if (dtStatusFailed(status))
+    return nullptr;
+
+  numPolys = 0;
+  status = query->finalizeSlicedFindPath(query->polys.data(), &numPolys,
+                                         query->polys.size());
+  if (dtStatusFailed(status) || dtStatusDetail(status, DT_PARTIAL_RESULT) ||
+      numPolys == 0)
+    return nullptr;
+  return query;
 }
 
-bool PathFinder::Impl::findPathSetup(MultiGoalShortestPath& path,
+bool PathFinder::Impl::findPathSetup(dtNavMeshQuery* navQuery,
+                                     MultiGoalShortestPath& path,
                                      dtPolyRef& startRef,
                                      vec3f& pathStart) {
   path.geodesicDistance = std::numeric_limits<float>::infinity();
@@ -1046,7 +2382,7 @@ bool PathFinder::Impl::findPathSetup(MultiGoalShortestPath& path,
   // find nearest polys and path
   dtStatus status;
   std::tie(status, startRef, pathStart) =
-      projectToPoly(path.requestedStart, navQuery_.get(), filter_.get());
+      projectToPoly(path.requestedStart, navQuery, filter_.get());
 
   if (status != DT_SUCCESS || startRef == 0) {
     return false;
@@ -1059,7 +2395,7 @@ bool PathFinder::Impl::findPathSetup(MultiGoalShortestPath& path,
     dtPolyRef endRef;
     vec3f pathEnd;
     std::tie(status, endRef, pathEnd) =
-        projectToPoly(rqEnd, navQuery_.get(), filter_.get());
+        projectToPoly(rqEnd, navQuery, filter_.get());
 
     if (status != DT_SUCCESS || endRef == 0) {
       return false;
@@ -1072,10 +2408,11 @@ bool PathFinder::Impl::findPathSetup(MultiGoalShortestPath& path,
   return true;
 }
 
-bool PathFinder::Impl::findPath(MultiGoalShortestPath& path) {
+bool PathFinder::Impl::findPath(MultiGoalShortestPath& path,
+                                impl::PathQuery* navQuery) {
   dtPolyRef startRef;
   vec3f pathStart;
-  if (!findPathSetup(path, startRef, pathStart))
+  if (!findPathSetup(navQuery, path, startRef, pathStart))
     return false;
 
   if (path.pimpl_->requestedEnds.size() > 1) {
@@ -1086,7 +2423,7 @@ bool PathFinder::Impl::findPath(MultiGoalShortestPath& path) {
     ShortestPath prevPath;
     prevPath.requestedStart = path.requestedStart;
     prevPath.requestedEnd = path.pimpl_->prevRequestedStart;
-    findPath(prevPath);
+    findPath(prevPath, navQuery);
     const float movedAmount = prevPath.geodesicDistance;
 
     for (int i = 0; i < path.pimpl_->requestedEnds.size(); ++i) {
@@ -1113,8 +2450,8 @@ bool PathFinder::Impl::findPath(MultiGoalShortestPath& path) {
 
     const Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
         findResult =
-            findPathInternal(path.requestedStart, startRef, pathStart,
-                             path.pimpl_->requestedEnds[i],
+            findPathInternal(navQuery, path.requestedStart, startRef,
+                             pathStart, path.pimpl_->requestedEnds[i],
                              path.pimpl_->endRefs[i], path.pimpl_->pathEnds[i]);
 
     if (findResult && std::get<0>(*findResult) < path.geodesicDistance) {
@@ -1127,18 +2464,463 @@ bool PathFinder::Impl::findPath(MultiGoalShortestPath& path) {
   return path.geodesicDistance < std::numeric_limits<float>::infinity();
 }
 
+template <typename PathT>
+std::vector<bool> PathFinder::Impl::findPaths(
+    const std::vector<PathT*>& paths) {
+  if (paths.empty() || !isLoaded())
+    return std::vector<bool>(paths.size(), false);
+
+  if (!initWorkerQueries())
+    return std::vector<bool>(paths.size(), false);
+
+  // std::vector<bool> is bit-packed, so concurrent writes to it would race
+  std::vector<uint8_t> found(paths.size(), 0);
+  runQueries(paths.size(), 1,
+             [this, &paths, &found](impl::PathQuery* navQuery, size_t iPath) {
+               found[iPath] = findPath(*paths[iPath], navQuery);
+             });
+
+  return std::vector<bool>(found.begin(), found.end());
+}
+
+void PathFinder::Impl::runQueries(
+    size_t count,
+    size_t grainSize,
+    const std::function<void(impl::PathQuery* navQuery, size_t iItem)>&
+        query) {
+  threadPool().parallelFor(
+      count,
+      [this, &query](int workerIndex, size_t iItem) {
+        query(workerIndex == 0 ? navQuery_.get()
+                               : workerQueries_[workerIndex - 1].get(),
+              iItem);
+      },
+      grainSize);
+}
+
+namespace {
+// Number of points handed to a worker at once by the batched point queries,
+// which are too cheap to be scheduled one by one
+constexpr size_t POINT_QUERY_GRAIN_SIZE = 16;
+
+bool checkPointBatch(const char* name,
+                     const Eigen::Ref<const Eigen::RowMatrixXf>& points,
+                     Eigen::Index numOutputRows) {
+  if (points.cols() != 3) {
+    LOG(ERROR) << name << ": expected an N x 3 array of points, got "
+               << points.rows() << " x " << points.cols();
+    return false;
+  }
+  if (numOutputRows != points.rows()) {
+    LOG(ERROR) << name << ": output has " << numOutputRows << " rows, expected "
+               << points.rows();
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
+bool PathFinder::Impl::tryStepBatch(
+    const Eigen::Ref<const Eigen::RowMatrixXf>& starts,
+    const Eigen::Ref<const Eigen::RowMatrixXf>& ends,
+    Eigen::Ref<Eigen::RowMatrixXf> endPoints,
+    bool allowSliding) {
+  if (!checkPointBatch("PathFinder::tryStepBatch", starts, ends.rows()) ||
+      !checkPointBatch("PathFinder::tryStepBatch", ends, endPoints.rows()) ||
+      endPoints.cols() != 3)
+    return false;
+  if (!isLoaded() || !initWorkerQueries())
+    return false;
+
+  runQueries(starts.rows(), POINT_QUERY_GRAIN_SIZE,
+             [&](impl::PathQuery* navQuery, size_t i) {
+               const vec3f start = starts.row(i).transpose();
+               const vec3f end = ends.row(i).transpose();
+               endPoints.row(i) =
+                   tryStep(start, end, allowSliding, navQuery).transpose();
+             });
+  return true;
+}
+
+bool PathFinder::Impl::snapPointBatch(
+    const Eigen::Ref<const Eigen::RowMatrixXf>& points,
+    Eigen::Ref<Eigen::RowMatrixXf> snappedPoints) {
+  if (!checkPointBatch("PathFinder::snapPointBatch", points,
+                       snappedPoints.rows()) ||
+      snappedPoints.cols() != 3)
+    return false;
+  if (!isLoaded() || !initWorkerQueries())
+    return false;
+
+  runQueries(points.rows(), POINT_QUERY_GRAIN_SIZE,
+             [&](impl::PathQuery* navQuery, size_t i) {
+               const vec3f pt = points.row(i).transpose();
+               snappedPoints.row(i) = snapPoint(pt, navQuery).transpose();
+             });
+  return true;
+}
+
+bool PathFinder::Impl::isNavigableBatch(
+    const Eigen::Ref<const Eigen::RowMatrixXf>& points,
+    Eigen::Ref<VectorXb> navigable,
+    const float maxYDelta) {
+  if (!checkPointBatch("PathFinder::isNavigableBatch", points,
+                       navigable.rows()))
+    return false;
+  if (!isLoaded() || !initWorkerQueries())
+    return false;
+
+  runQueries(points.rows(), POINT_QUERY_GRAIN_SIZE,
+             [&](impl::PathQuery* navQuery, size_t i) {
+               const vec3f pt = points.row(i).transpose();
+               navigable[i] = isNavigable(pt, maxYDelta, navQuery);
+             });
+  return true;
+}
+
+namespace {
+inline int polyIndex(const dtNavMesh* navMesh,
+                     const std::vector<int>& tileOffsets,
+                     dtPolyRef ref) {
+  unsigned int salt, iTile, iPoly;
+  navMesh->decodePolyId(ref, salt, iTile, iPoly);
+  return tileOffsets[iTile] + iPoly;
+}
+
+// Returns the segment shared by a polygon and the neighbour of the given link,
+// clipped to the neighbour's extent for links crossing tile borders
+void portalPoints(const dtMeshTile* tile,
+                  const dtPoly* poly,
+                  const dtLink& link,
+                  vec3f& left,
+                  vec3f& right) {
+  const int v0 = poly->verts[link.edge];
+  const int v1 = poly->verts[(link.edge + 1) % poly->vertCount];
+  left = Eigen::Map<const vec3f>(&tile->verts[v0 * 3]);
+  right = Eigen::Map<const vec3f>(&tile->verts[v1 * 3]);
+
+  if (link.side != 0xff && (link.bmin != 0 || link.bmax != 255)) {
+    const vec3f edge = right - left;
+    const float s = 1.0f / 255.0f;
+    right = left + edge * (link.bmax * s);
+    left = left + edge * (link.bmin * s);
+  }
+}
+
+vec3f closestPointOnSegment(const vec3f& pt, const vec3f& a, const vec3f& b) {
+  const vec3f ab = b - a;
+  const float lengthSq = ab.squaredNorm();
+  if (lengthSq < 1e-12f)
+    return a;
+  const float t = std::min(std::max((pt - a).dot(ab) / lengthSq, 0.0f), 1.0f);
+  return a + t * ab;
+}
+
+typedef std::vector<std::pair<int, vec3f>>::const_iterator GoalIterator;
+typedef std::pair<GoalIterator, GoalIterator> GoalRange;
+
+// The goals of the field on the polygon `iPoly`
+GoalRange goalsOnPoly(const GeodesicDistanceField::Impl& field, int iPoly) {
+  GoalIterator first = std::lower_bound(
+      field.goalPoints.begin(), field.goalPoints.end(), iPoly,
+      [](const std::pair<int, vec3f>& goal, int i) { return goal.first < i; });
+  GoalIterator last = first;
+  while (last != field.goalPoints.end() && last->first == iPoly)
+    ++last;
+  return {first, last};
+}
+
+// Distance from `start`, on the polygon `iPoly`, to the goal along the field's
+// corridor. The corridor is string-pulled as in
+// dtNavMeshQuery::findStraightPath, but only up to the first corner, whose
+// remaining distance is already stored in the field. If the corridor reaches
+// the goal polygon first, its `goalSlot`th goal is the target and
+// `reachedGoal` is set.
+float distanceAlongField(const GeodesicDistanceField::Impl& field,
+                         const vec3f& start,
+                         int iPoly,
+                         int goalSlot,
+                         bool& reachedGoal) {
+  reachedGoal = false;
+  vec3f funnelLeft = start;
+  vec3f funnelRight = start;
+  // Polygons whose exit portal the funnel sides lie on, -1 for the goal
+  int leftPoly = -1;
+  int rightPoly = -1;
+  while (true) {
+    vec3f left, right;
+    int portalPoly = iPoly;
+    if (field.nextPolys[iPoly] < 0) {
+      // The goal polygon, its goal is the last portal
+      const GoalRange goals = goalsOnPoly(field, iPoly);
+      if (goalSlot >= goals.second - goals.first)
+        return std::numeric_limits<float>::infinity();
+      reachedGoal = true;
+      left = right = (goals.first + goalSlot)->second;
+      portalPoly = -1;
+    } else {
+      left = field.exitLefts[iPoly];
+      right = field.exitRights[iPoly];
+    }
+
+    bool cornerFound = false;
+    int cornerPoly = -1;
+    bool cornerOnLeft = false;
+    if (dtTriArea2D(start.data(), funnelRight.data(), right.data()) <= 0.0f) {
+      if (dtVequal(start.data(), funnelRight.data()) ||
+          dtTriArea2D(start.data(), funnelLeft.data(), right.data()) > 0.0f) {
+        funnelRight = right;
+        rightPoly = portalPoly;
+      } else {
+        cornerFound = true;
+        cornerPoly = leftPoly;
+        cornerOnLeft = true;
+      }
+    }
+    if (!cornerFound &&
+        dtTriArea2D(start.data(), funnelLeft.data(), left.data()) >= 0.0f) {
+      if (dtVequal(start.data(), funnelLeft.data()) ||
+          dtTriArea2D(start.data(), funnelRight.data(), left.data()) < 0.0f) {
+        funnelLeft = left;
+        leftPoly = portalPoly;
+      } else {
+        cornerFound = true;
+        cornerPoly = rightPoly;
+        cornerOnLeft = false;
+      }
+    }
+
+    if (cornerFound && cornerPoly >= 0) {
+      const vec3f& corner = cornerOnLeft ? field.exitLefts[cornerPoly]
+                                         : field.exitRights[cornerPoly];
+      if (!dtVequal(start.data(), corner.data())) {
+        return (corner - start).norm() +
+               (cornerOnLeft ? field.exitLeftDists[cornerPoly]
+                             : field.exitRightDists[cornerPoly]);
+      }
+      // The path bends at the start itself, restart the funnel behind the
+      // portal of the corner
+      funnelLeft = funnelRight = start;
+      leftPoly = rightPoly = -1;
+      iPoly = field.nextPolys[cornerPoly];
+      continue;
+    }
+    if (portalPoly < 0) {
+      // The goal is in a straight line from the start
+      return (left - start).norm();
+    }
+    iPoly = field.nextPolys[iPoly];
+  }
+}
+
+// Distance from `start`, on the polygon `iPoly`, to the closest goal along the
+// field's corridor
+float distanceAlongField(const GeodesicDistanceField::Impl& field,
+                         const vec3f& start,
+                         int iPoly) {
+  float minDist = std::numeric_limits<float>::infinity();
+  for (int goalSlot = 0; goalSlot < field.maxGoalsPerPoly; ++goalSlot) {
+    bool reachedGoal = false;
+    const float dist =
+        distanceAlongField(field, start, iPoly, goalSlot, reachedGoal);
+    minDist = std::min(minDist, dist);
+    // Paths bending before the goal polygon don't depend on the goal
+    if (!reachedGoal)
+      break;
+  }
+  return minDist;
+}
+}  // namespace
+
+void PathFinder::Impl::computeDistanceField(
+    GeodesicDistanceField::Impl& field) {
+  constexpr float inf = std::numeric_limits<float>::infinity();
+  const dtNavMesh* navMesh = navMesh_.get();
+
+  field.tileOffsets.assign(navMesh->getMaxTiles() + 1, 0);
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    const int numPolys = (tile && tile->header) ? tile->header->polyCount : 0;
+    field.tileOffsets[iTile + 1] = field.tileOffsets[iTile] + numPolys;
+  }
+  const int numPolys = field.tileOffsets.back();
+  field.dist.assign(numPolys, inf);
+  field.nextPolys.assign(numPolys, -1);
+  field.exitLefts.assign(numPolys, vec3f::Zero());
+  field.exitRights.assign(numPolys, vec3f::Zero());
+  field.exitLeftDists.assign(numPolys, inf);
+  field.exitRightDists.assign(numPolys, inf);
+  field.goalPoints.clear();
+  field.maxGoalsPerPoly = 0;
+
+  // Point through which the search entered each polygon, and the polygon it
+  // came from
+  std::vector<vec3f> entryPoints(numPolys, vec3f::Zero());
+  std::vector<dtPolyRef> nextRefs(numPolys, 0);
+
+  typedef std::pair<float, dtPolyRef> QueueEntry;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                      std::greater<QueueEntry>>
+      queue;
+
+  // Seed the search with every goal that lies on the navmesh. Goal polygons
+  // keep all of their goals, and are entered through each of them.
+  for (const auto& goal : field.goals) {
+    dtStatus status;
+    dtPolyRef goalRef;
+    vec3f goalPt;
+    std::tie(status, goalRef, goalPt) =
+        projectToPoly(goal, navQuery_.get(), filter_.get());
+    if (status != DT_SUCCESS || goalRef == 0)
+      continue;
+
+    const int idx = polyIndex(navMesh, field.tileOffsets, goalRef);
+    field.goalPoints.emplace_back(idx, goalPt);
+    if (field.dist[idx] == 0.0f)
+      continue;
+    field.dist[idx] = 0.0f;
+    queue.emplace(0.0f, goalRef);
+  }
+  std::stable_sort(
+      field.goalPoints.begin(), field.goalPoints.end(),
+      [](const std::pair<int, vec3f>& a, const std::pair<int, vec3f>& b) {
+        return a.first < b.first;
+      });
+  for (size_t i = 0, j = 0; i < field.goalPoints.size(); i = j) {
+    while (j < field.goalPoints.size() &&
+           field.goalPoints[j].first == field.goalPoints[i].first)
+      ++j;
+    field.maxGoalsPerPoly = std::max(field.maxGoalsPerPoly, int(j - i));
+  }
+
+  // Multi-source Dijkstra over the polygon graph, picking the corridor of
+  // every polygon. Every polygon is entered through the point on the shared
+  // portal edge closest to the entry point of the polygon it was reached
+  // from.
+  std::vector<dtPolyRef> settledRefs;
+  std::vector<vec3f> entries;
+  while (!queue.empty()) {
+    const QueueEntry top = queue.top();
+    queue.pop();
+    const dtPolyRef ref = top.second;
+    const int idx = polyIndex(navMesh, field.tileOffsets, ref);
+    if (top.first > field.dist[idx])
+      continue;
+    settledRefs.emplace_back(ref);
+
+    const dtMeshTile* tile = nullptr;
+    const dtPoly* poly = nullptr;
+    navMesh->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+    entries.clear();
+    if (top.first == 0.0f) {
+      const GoalRange goals = goalsOnPoly(field, idx);
+      for (auto it = goals.first; it != goals.second; ++it)
+        entries.emplace_back(it->second);
+    } else {
+      entries.emplace_back(entryPoints[idx]);
+    }
+
+    for (unsigned int iLink = poly->firstLink; iLink != DT_NULL_LINK;
+         iLink = tile->links[iLink].next) {
+      const dtLink& link = tile->links[iLink];
+      const dtPolyRef neighbourRef = link.ref;
+      if (!neighbourRef)
+        continue;
+
+      const dtMeshTile* neighbourTile = nullptr;
+      const dtPoly* neighbourPoly = nullptr;
+      navMesh->getTileAndPolyByRefUnsafe(neighbourRef, &neighbourTile,
+                                         &neighbourPoly);
+      if (neighbourPoly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION ||
+          !filter_->passFilter(neighbourRef, neighbourTile, neighbourPoly))
+        continue;
+
+      vec3f left, right;
+      portalPoints(tile, poly, link, left, right);
+      const int neighbourIdx =
+          polyIndex(navMesh, field.tileOffsets, neighbourRef);
+      for (const vec3f& entry : entries) {
+        const vec3f portalPt = closestPointOnSegment(entry, left, right);
+        const float neighbourDist = top.first + (portalPt - entry).norm();
+        if (neighbourDist < field.dist[neighbourIdx]) {
+          field.dist[neighbourIdx] = neighbourDist;
+          entryPoints[neighbourIdx] = portalPt;
+          nextRefs[neighbourIdx] = ref;
+          field.nextPolys[neighbourIdx] = idx;
+          queue.emplace(neighbourDist, neighbourRef);
+        }
+      }
+    }
+  }
+
+  // String-pull the corridor from both ends of every polygon's exit portal.
+  // Polygons are settled after the next one towards the goal, so the funnel
+  // only needs to run up to the first corner, whose distance is known.
+  for (const dtPolyRef ref : settledRefs) {
+    const int idx = polyIndex(navMesh, field.tileOffsets, ref);
+    const int nextIdx = field.nextPolys[idx];
+    if (nextIdx < 0)
+      continue;
+
+    const dtMeshTile* tile = nullptr;
+    const dtPoly* poly = nullptr;
+    navMesh->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+    for (unsigned int iLink = poly->firstLink; iLink != DT_NULL_LINK;
+         iLink = tile->links[iLink].next) {
+      if (tile->links[iLink].ref == nextRefs[idx]) {
+        portalPoints(tile, poly, tile->links[iLink], field.exitLefts[idx],
+                     field.exitRights[idx]);
+        break;
+      }
+    }
+    field.exitLeftDists[idx] =
+        distanceAlongField(field, field.exitLefts[idx], nextIdx);
+    field.exitRightDists[idx] =
+        distanceAlongField(field, field.exitRights[idx], nextIdx);
+  }
+
+  field.navMeshVersion = navMeshVersion_;
+}
+
+float PathFinder::Impl::geodesicDistance(GeodesicDistanceField& field,
+                                         const vec3f& pt) {
+  constexpr float inf = std::numeric_limits<float>::infinity();
+  if (!isLoaded())
+    return inf;
+
+  GeodesicDistanceField::Impl& f = *field.pimpl_;
+  if (f.navMeshVersion != navMeshVersion_)
+    computeDistanceField(f);
+
+  dtStatus status;
+  dtPolyRef startRef;
+  vec3f pathStart;
+  std::tie(status, startRef, pathStart) =
+      projectToPoly(pt, navQuery_.get(), filter_.get());
+  if (status != DT_SUCCESS || startRef == 0)
+    return inf;
+
+  const int startIdx = polyIndex(navMesh_.get(), f.tileOffsets, startRef);
+  if (f.dist[startIdx] == inf)
+    return inf;
+
+  return distanceAlongField(f, pathStart, startIdx);
+}
+
 template <typename T>
-T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
-  static const int MAX_POLYS = 256;
-  dtPolyRef polys[MAX_POLYS];
+T PathFinder::Impl::tryStep(const T& start,
+                            const T& end,
+                            bool allowSliding,
+                            impl::PathQuery* navQuery) {
+  dtPolyRef* polys = navQuery->polys.data();
 
   dtStatus startStatus, endStatus;
   dtPolyRef startRef, endRef;
   vec3f pathStart;
   std::tie(startStatus, startRef, pathStart) =
-      projectToPoly(start, navQuery_.get(), filter_.get());
+      projectToPoly(start, navQuery, filter_.get());
   std::tie(endStatus, endRef, std::ignore) =
-      projectToPoly(end, navQuery_.get(), filter_.get());
+      projectToPoly(end, navQuery, filter_.get());
 
   if (dtStatusFailed(startStatus) || dtStatusFailed(endStatus)) {
     return start;
@@ -1150,9 +2932,9 @@ T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
 
   vec3f endPoint;
   int numPolys;
-  navQuery_->moveAlongSurface(startRef, pathStart.data(), end.data(),
-                              filter_.get(), endPoint.data(), polys, &numPolys,
-                              MAX_POLYS, allowSliding);
+  navQuery->moveAlongSurface(startRef, pathStart.data(), end.data(),
+                             filter_.get(), endPoint.data(), polys, &numPolys,
+                             navQuery->polys.size(), allowSliding);
   // If there isn't any possible path between start and end, just return
   // start, that is cleanest
   if (numPolys == 0) {
@@ -1167,7 +2949,7 @@ T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
   // surface at the endPoint and set its height to that.
   // Note, this will never fail as endPoint is always within in the poly
   // polys[numPolys - 1]
-  navQuery_->getPolyHeight(polys[numPolys - 1], endPoint.data(), &endPoint[1]);
+  navQuery->getPolyHeight(polys[numPolys - 1], endPoint.data(), &endPoint[1]);
 
   // Hack to deal with infinitely thin walls in recast allowing you to
   // transition between two different connected components
@@ -1175,7 +2957,7 @@ T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
   // is in the same connected component as the startRef according to
   // findNearestPoly
   std::tie(std::ignore, endRef, std::ignore) =
-      projectToPoly(endPoint, navQuery_.get(), filter_.get());
+      projectToPoly(endPoint, navQuery, filter_.get());
   if (!this->islandSystem_->hasConnection(startRef, endRef)) {
     // There isn't a connection!  This happens when endPoint is on an edge
     // shared between two different connected components (aka infinitely thin
@@ -1203,11 +2985,11 @@ T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
 }
 
 template <typename T>
-T PathFinder::Impl::snapPoint(const T& pt) {
+T PathFinder::Impl::snapPoint(const T& pt, dtNavMeshQuery* navQuery) {
   dtStatus status;
   vec3f projectedPt;
   std::tie(status, std::ignore, projectedPt) =
-      projectToPoly(pt, navQuery_.get(), filter_.get());
+      projectToPoly(pt, navQuery, filter_.get());
 
   if (dtStatusSucceed(status)) {
     return T{projectedPt};
@@ -1256,12 +3038,13 @@ HitRecord PathFinder::Impl::closestObstacleSurfacePoint(
 }
 
 bool PathFinder::Impl::isNavigable(const vec3f& pt,
-                                   const float maxYDelta /*= 0.5*/) const {
+                                   const float maxYDelta,
+                                   dtNavMeshQuery* navQuery) const {
   dtPolyRef ptRef;
   dtStatus status;
   vec3f polyPt;
   std::tie(status, ptRef, polyPt) =
-      projectToPoly(pt, navQuery_.get(), filter_.get());
+      projectToPoly(pt, navQuery, filter_.get());
 
   if (status != DT_SUCCESS || ptRef == 0)
     return false;
@@ -1274,36 +3057,175 @@ bool PathFinder::Impl::isNavigable(const vec3f& pt,
   return true;
 }
 
-typedef Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> MatrixXb;
+namespace {
+// Pixel grid of the top-down maps. Pixel (h, w) samples the navmesh at
+// x = startX + w * metersPerPixel, z = startZ + h * metersPerPixel
+struct TopDownGrid {
+  float startX, startZ, metersPerPixel;
+  int xResolution, zResolution;
+
+  int firstRow(float z) const {
+    return std::max(0, static_cast<int>(std::ceil((z - startZ) /
+                                                  metersPerPixel)));
+  }
+  int lastRow(float z) const {
+    return std::min(zResolution - 1,
+                    static_cast<int>(std::floor((z - startZ) /
+                                                metersPerPixel)));
+  }
+};
+
+// Slack for pixels sampled exactly on a triangle edge, so that pixels on the
+// edge shared by two polygons are not dropped by rounding
+constexpr float RASTER_EPSILON = 1e-4;
+
+// Scanline fills the xz footprint of a detail triangle into the rows
+// [rowBegin, rowEnd) of the maps. A pixel is set in every height slice within
+// maxYDelta of the triangle's surface at the pixel.
+void rasterizeTriangle(const vec3f* tri,
+                       const TopDownGrid& grid,
+                       const int rowBegin,
+                       const int rowEnd,
+                       const std::vector<float>& heights,
+                       const float maxYDelta,
+                       std::vector<MatrixXb>& maps) {
+  const vec3f& a = tri[0];
+  const vec3f normal = (tri[1] - a).cross(tri[2] - a);
+  // Vertical triangles have no footprint
+  if (std::abs(normal[1]) < 1e-12f)
+    return;
+
+  const float zMin = std::min({tri[0][2], tri[1][2], tri[2][2]});
+  const float zMax = std::max({tri[0][2], tri[1][2], tri[2][2]});
+  const int h0 = std::max(rowBegin, grid.firstRow(zMin - RASTER_EPSILON));
+  const int h1 = std::min(rowEnd - 1, grid.lastRow(zMax + RASTER_EPSILON));
+
+  for (int h = h0; h <= h1; ++h) {
+    const float z = grid.startZ + h * grid.metersPerPixel;
+
+    // Intersect the row with the triangle edges
+    float xMin = std::numeric_limits<float>::infinity();
+    float xMax = -std::numeric_limits<float>::infinity();
+    for (int iEdge = 0; iEdge < 3; ++iEdge) {
+      const vec3f& p = tri[iEdge];
+      const vec3f& q = tri[(iEdge + 1) % 3];
+      if (z < std::min(p[2], q[2]) - RASTER_EPSILON ||
+          z > std::max(p[2], q[2]) + RASTER_EPSILON)
+        continue;
+      if (p[2] == q[2]) {
+        xMin = std::min({xMin, p[0], q[0]});
+        xMax = std::max({xMax, p[0], q[0]});
+        continue;
+      }
+      const float t = std::min(std::max((z - p[2]) / (q[2] - p[2]), 0.0f), 1.0f);
+      const float x = p[0] + t * (q[0] - p[0]);
+      xMin = std::min(xMin, x);
+      xMax = std::max(xMax, x);
+    }
+    if (xMin > xMax)
+      continue;
+
+    const int w0 = std::max(
+        0, static_cast<int>(std::ceil((xMin - RASTER_EPSILON - grid.startX) /
+                                      grid.metersPerPixel)));
+    const int w1 = std::min(
+        grid.xResolution - 1,
+        static_cast<int>(std::floor((xMax + RASTER_EPSILON - grid.startX) /
+                                    grid.metersPerPixel)));
+    for (int w = w0; w <= w1; ++w) {
+      const float x = grid.startX + w * grid.metersPerPixel;
+      // Height of the triangle's plane at the pixel
+      const float y =
+          a[1] - (normal[0] * (x - a[0]) + normal[2] * (z - a[2])) / normal[1];
+      for (size_t iSlice = 0; iSlice < heights.size(); ++iSlice) {
+        if (std::abs(y - heights[iSlice]) <= maxYDelta)
+          maps[iSlice](h, w) = true;
+      }
+    }
+  }
+}
+
+// Number of map rows rasterized by a worker at once
+constexpr int RASTER_ROWS_PER_BAND = 16;
+}  // namespace
+
+MatrixXb PathFinder::Impl::getTopDownView(const float metersPerPixel,
+                                          const float height) {
+  return std::move(getTopDownViews(metersPerPixel, {height}, 0.5)[0]);
+}
 
-Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>
-PathFinder::Impl::getTopDownView(const float metersPerPixel,
-                                 const float height) {
+std::vector<MatrixXb> PathFinder::Impl::getTopDownViews(
+    const float metersPerPixel,
+    const std::vector<float>& heights,
+    const float maxYDelta) {
   std::pair<vec3f, vec3f> mapBounds = bounds();
   vec3f bound1 = mapBounds.first;
   vec3f bound2 = mapBounds.second;
 
   float xspan = std::abs(bound1[0] - bound2[0]);
   float zspan = std::abs(bound1[2] - bound2[2]);
-  int xResolution = xspan / metersPerPixel;
-  int zResolution = zspan / metersPerPixel;
-  float startx = fmin(bound1[0], bound2[0]);
-  float startz = fmin(bound1[2], bound2[2]);
-  MatrixXb topdownMap(zResolution, xResolution);
+  TopDownGrid grid;
+  grid.metersPerPixel = metersPerPixel;
+  grid.xResolution = xspan / metersPerPixel;
+  grid.zResolution = zspan / metersPerPixel;
+  grid.startX = fmin(bound1[0], bound2[0]);
+  grid.startZ = fmin(bound1[2], bound2[2]);
+
+  std::vector<MatrixXb> topdownMaps(
+      heights.size(), MatrixXb::Constant(grid.zResolution, grid.xResolution,
+                                         false));
+  if (!isLoaded() || grid.xResolution <= 0 || grid.zResolution <= 0)
+    return topdownMaps;
 
-  float curz = startz;
-  float curx = startx;
-  for (int h = 0; h < zResolution; h++) {
-    for (int w = 0; w < xResolution; w++) {
-      vec3f point = vec3f(curx, height, curz);
-      topdownMap(h, w) = isNavigable(point, 0.5);
-      curx = curx + metersPerPixel;
+  const dtNavMesh* navMesh = navMesh_.get();
+  const int maxTiles = navMesh->getMaxTiles();
+  core::ThreadPool& pool = threadPool();
+
+  // Gather the detail triangles of the walkable polygons of every tile, the
+  // same polygons isNavigable can snap to
+  std::vector<std::vector<vec3f>> tileTriangles(maxTiles);
+  pool.parallelFor(maxTiles, [&](int, size_t iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      return;
+    const dtPolyRef base = navMesh->getPolyRefBase(tile);
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPoly* poly = &tile->polys[jPoly];
+      if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION ||
+          !filter_->passFilter(base | static_cast<dtPolyRef>(jPoly), tile,
+                               poly))
+        continue;
+      for (const Triangle& tri : getPolygonTriangles(poly, tile)) {
+        tileTriangles[iTile].insert(tileTriangles[iTile].end(), tri.v.begin(),
+                                    tri.v.end());
+      }
     }
-    curz = curz + metersPerPixel;
-    curx = startx;
-  }
+  });
+
+  // Workers own disjoint bands of rows, so writes never race. Tiles outside a
+  // band are culled by their bounds.
+  const int numBands =
+      (grid.zResolution + RASTER_ROWS_PER_BAND - 1) / RASTER_ROWS_PER_BAND;
+  pool.parallelFor(numBands, [&](int, size_t iBand) {
+    const int rowBegin = iBand * RASTER_ROWS_PER_BAND;
+    const int rowEnd =
+        std::min(rowBegin + RASTER_ROWS_PER_BAND, grid.zResolution);
+    for (int iTile = 0; iTile < maxTiles; ++iTile) {
+      const std::vector<vec3f>& triangles = tileTriangles[iTile];
+      if (triangles.empty())
+        continue;
+      const dtMeshHeader* header = navMesh->getTile(iTile)->header;
+      if (grid.lastRow(header->bmax[2] + RASTER_EPSILON) < rowBegin ||
+          grid.firstRow(header->bmin[2] - RASTER_EPSILON) >= rowEnd)
+        continue;
+      for (size_t iTri = 0; iTri < triangles.size(); iTri += 3) {
+        rasterizeTriangle(&triangles[iTri], grid, rowBegin, rowEnd, heights,
+                          maxYDelta, topdownMaps);
+      }
+    }
+  });
 
-  return topdownMap;
+  return topdownMaps;
 }
 
 const assets::MeshData::ptr PathFinder::Impl::getNavMeshData() {
@@ -1316,7 +3238,7 @@ const assets::MeshData::ptr PathFinder::Impl::getNavMeshData() {
     for (int iTile = 0; iTile < navMesh_->getMaxTiles(); ++iTile) {
       const dtMeshTile* tile =
           const_cast<const dtNavMesh*>(navMesh_.get())->getTile(iTile);
-      if (!tile)
+      if (!tile || !tile->header)
         continue;
 
       // Iterate over all polygons in a tile
@@ -1360,10 +3282,32 @@ bool PathFinder::build(const NavMeshSettings& bs,
   return pimpl_->build(bs, mesh);
 }
 
+bool PathFinder::rebuildTiles(const esp::assets::MeshData& mesh,
+                              const vec3f& regionMin,
+                              const vec3f& regionMax) {
+  return pimpl_->rebuildTiles(mesh, regionMin, regionMax);
+}
+
 vec3f PathFinder::getRandomNavigablePoint() {
   return pimpl_->getRandomNavigablePoint();
 }
 
+std::vector<vec3f> PathFinder::getRandomNavigablePoints(int numPoints,
+                                                        int islandIndex) {
+  return pimpl_->getRandomNavigablePoints(numPoints, islandIndex);
+}
+
+std::vector<vec3f> PathFinder::getRandomNavigablePointsMinIslandRadius(
+    int numPoints,
+    float minIslandRadius) {
+  return pimpl_->getRandomNavigablePointsMinIslandRadius(numPoints,
+                                                         minIslandRadius);
+}
+
+int PathFinder::getIslandIndex(const vec3f& pt) const {
+  return pimpl_->getIslandIndex(pt);
+}
+
 bool PathFinder::findPath(ShortestPath& path) {
   return pimpl_->findPath(path);
 }
@@ -1372,6 +3316,61 @@ bool PathFinder::findPath(MultiGoalShortestPath& path) {
   return pimpl_->findPath(path);
 }
 
+float PathFinder::geodesicDistance(GeodesicDistanceField& field,
+                                   const vec3f& pt) {
+  return pimpl_->geodesicDistance(field, pt);
+}
+
+namespace {
+template <typename PathT>
+std::vector<PathT*> pathPointers(std::vector<PathT>& paths) {
+  std::vector<PathT*> pointers;
+  pointers.reserve(paths.size());
+  for (auto& path : paths) {
+    pointers.emplace_back(&path);
+  }
+  return pointers;
+}
+
+template <typename PathT>
+std::vector<PathT*> pathPointers(
+    const std::vector<std::shared_ptr<PathT>>& paths) {
+  std::vector<PathT*> pointers;
+  pointers.reserve(paths.size());
+  for (const auto& path : paths) {
+    pointers.emplace_back(path.get());
+  }
+  return pointers;
+}
+}  // namespace
+
+std::vector<bool> PathFinder::findPaths(std::vector<ShortestPath>& paths) {
+  return pimpl_->findPaths(pathPointers(paths));
+}
+
+std::vector<bool> PathFinder::findPaths(
+    std::vector<MultiGoalShortestPath>& paths) {
+  return pimpl_->findPaths(pathPointers(paths));
+}
+
+std::vector<bool> PathFinder::findPaths(
+    const std::vector<ShortestPath::ptr>& paths) {
+  return pimpl_->findPaths(pathPointers(paths));
+}
+
+std::vector<bool> PathFinder::findPaths(
+    const std::vector<MultiGoalShortestPath::ptr>& paths) {
+  return pimpl_->findPaths(pathPointers(paths));
+}
+
+void PathFinder::setNumThreads(int numThreads) {
+  pimpl_->setNumThreads(numThreads);
+}
+
+int PathFinder::getNumThreads() const {
+  return pimpl_->getNumThreads();
+}
+
 template vec3f PathFinder::tryStep<vec3f>(const vec3f&, const vec3f&);
 template Mn::Vector3 PathFinder::tryStep<Mn::Vector3>(const Mn::Vector3&,
                                                       const Mn::Vector3&);
@@ -1434,6 +3433,27 @@ bool PathFinder::isNavigable(const vec3f& pt, const float maxYDelta) const {
   return pimpl_->isNavigable(pt, maxYDelta);
 }
 
+bool PathFinder::tryStepBatch(
+    const Eigen::Ref<const Eigen::RowMatrixXf>& starts,
+    const Eigen::Ref<const Eigen::RowMatrixXf>& ends,
+    Eigen::Ref<Eigen::RowMatrixXf> endPoints,
+    bool allowSliding) {
+  return pimpl_->tryStepBatch(starts, ends, endPoints, allowSliding);
+}
+
+bool PathFinder::snapPointBatch(
+    const Eigen::Ref<const Eigen::RowMatrixXf>& points,
+    Eigen::Ref<Eigen::RowMatrixXf> snappedPoints) {
+  return pimpl_->snapPointBatch(points, snappedPoints);
+}
+
+bool PathFinder::isNavigableBatch(
+    const Eigen::Ref<const Eigen::RowMatrixXf>& points,
+    Eigen::Ref<VectorXb> navigable,
+    const float maxYDelta) {
+  return pimpl_->isNavigableBatch(points, navigable, maxYDelta);
+}
+
 float PathFinder::getNavigableArea() const {
   return pimpl_->getNavigableArea();
 }
@@ -1442,12 +3462,18 @@ std::pair<vec3f, vec3f> PathFinder::bounds() const {
   return pimpl_->bounds();
 }
 
-Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> PathFinder::getTopDownView(
-    const float metersPerPixel,
-    const float height) {
+MatrixXb PathFinder::getTopDownView(const float metersPerPixel,
+                                    const float height) {
   return pimpl_->getTopDownView(metersPerPixel, height);
 }
 
+std::vector<MatrixXb> PathFinder::getTopDownViews(
+    const float metersPerPixel,
+    const std::vector<float>& heights,
+    const float maxYDelta) {
+  return pimpl_->getTopDownViews(metersPerPixel, heights, maxYDelta);
+}
+
 const assets::MeshData::ptr PathFinder::getNavMeshData() {
   return pimpl_->getNavMeshData();
 }
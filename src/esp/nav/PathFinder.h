@@ -20,6 +20,9 @@ namespace nav {
 
 class PathFinder;
 
+typedef Eigen::Matrix<bool, Eigen::Dynamic, 1> VectorXb;
+typedef Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> MatrixXb;
+
 struct HitRecord {
   vec3f hitPos;
   vec3f hitNormal;
@@ -100,6 +103,35 @@ struct MultiGoalShortestPath {
   ESP_SMART_POINTERS_WITH_UNIQUE_PIMPL(MultiGoalShortestPath);
 };
 
+/**
+ * @brief Geodesic distance field to a fixed set of goals. Used in conjunction
+ * with @ref PathFinder.geodesicDistance
+ *
+ * The field is computed once per goal set (and navigation mesh) with a
+ * multi-source Dijkstra search over the navigation mesh polygons, which picks
+ * a corridor to the closest goal for every polygon. The string-pulled distance
+ * from both ends of the portal each polygon is left through is stored with
+ * it. A query only string-pulls from the point to the first corner of its
+ * path and reads the rest of the distance from the field, without any A*
+ * search. Like @ref PathFinder::findPath, the result is the exact length
+ * within the chosen corridor, which may be slightly longer than the true
+ * geodesic distance when another corridor is shorter.
+ */
+struct GeodesicDistanceField {
+  GeodesicDistanceField();
+
+  /**
+   * @brief Set the list of goal points. Invalidates the cached field.
+   */
+  void setGoals(const std::vector<vec3f>& newGoals);
+
+  const std::vector<vec3f>& getGoals() const;
+
+  friend class PathFinder;
+
+  ESP_SMART_POINTERS_WITH_UNIQUE_PIMPL(GeodesicDistanceField);
+};
+
 struct NavMeshSettings {
   //! Cell size in world units
   float cellSize;
@@ -136,6 +168,15 @@ struct NavMeshSettings {
   bool filterLedgeSpans;
   bool filterWalkableLowHeightSpans;
 
+  //! Build a multi-tile navmesh whose tiles are built in parallel. Tiles can
+  //! later be rebuilt individually.
+  bool tiled;
+  //! Tile width and depth in cells, used when @ref tiled is set
+  int tileSize;
+  //! Maximum number of tiles the navmesh can hold, used when @ref tiled is
+  //! set. Values <= 0 size it to fit the bounds of the input geometry.
+  int maxTiles;
+
   void setDefaults() {
     cellSize = 0.05f;
     cellHeight = 0.2f;
@@ -154,6 +195,9 @@ struct NavMeshSettings {
     filterLedgeSpans = true;
     filterWalkableLowHeightSpans = true;
     navMeshBBMax = -1.0f;
+    tiled = false;
+    tileSize = 128;
+    maxTiles = 0;
   }
 
   NavMeshSettings() { setDefaults(); }
@@ -182,6 +226,31 @@ class PathFinder {
              const float* bmax);
   bool build(const NavMeshSettings& bs, const esp::assets::MeshData& mesh);
 
+  /**
+   * @brief Rebuilds only the tiles of the navigation mesh affected by changes
+   * to the geometry inside a region, e.g. an object being added, moved or
+   * removed.
+   *
+   * The navigation mesh must have been built in this process with
+   * @ref NavMeshSettings.tiled, the tiles are rebuilt with the same settings.
+   * Navigation meshes loaded with @ref loadNavMesh can't be rebuilt, as the
+   * files don't store the build settings and bounds. Connected component
+   * information is only recomputed for the islands touching the rebuilt
+   * tiles. The tiles cover the bounds of the original build, geometry
+   * outside of them is ignored with a warning, and a region entirely outside
+   * of them fails.
+   *
+   * @param[in] mesh The full (updated) geometry the navigation mesh was built
+   * from. Only triangles overlapping the rebuilt tiles are rasterized.
+   * @param[in] regionMin Minimum corner of the changed region
+   * @param[in] regionMax Maximum corner of the changed region
+   *
+   * @return Whether or not the tiles were successfully rebuilt
+   */
+  bool rebuildTiles(const esp::assets::MeshData& mesh,
+                    const vec3f& regionMin,
+                    const vec3f& regionMax);
+
   /**
    * @brief Returns a random navigable point
    *
@@ -193,6 +262,49 @@ class PathFinder {
    */
   vec3f getRandomNavigablePoint();
 
+  /**
+   * @brief Returns random navigable points, distributed uniformly over the
+   * navigable area
+   *
+   * Polygons are picked in O(1) per point from area-weighted alias tables
+   * which are built whenever the navmesh is loaded, built or updated.
+   *
+   * @param[in] numPoints The number of points to sample
+   * @param[in] islandIndex Restricts sampling to one island, see @ref
+   * getIslandIndex. @ref ID_UNDEFINED samples the whole navmesh.
+   *
+   * @return The sampled points. Empty if no navmesh is loaded or the island
+   * has no navigable area.
+   */
+  std::vector<vec3f> getRandomNavigablePoints(int numPoints,
+                                              int islandIndex = ID_UNDEFINED);
+
+  /**
+   * @brief Returns random navigable points, distributed uniformly over the
+   * islands with at least the given @ref islandRadius
+   *
+   * Replaces rejection sampling against @ref islandRadius.
+   *
+   * @param[in] numPoints The number of points to sample
+   * @param[in] minIslandRadius The minimum radius of the sampled islands
+   *
+   * @return The sampled points. Empty if no island is large enough.
+   */
+  std::vector<vec3f> getRandomNavigablePointsMinIslandRadius(
+      int numPoints,
+      float minIslandRadius);
+
+  /**
+   * @brief Returns the index of the island (connected component) @ref pt
+   * belongs to
+   *
+   * @param[in] pt The point to snap to the navigation mesh
+   *
+   * @return The island index, or @ref ID_UNDEFINED if @ref pt is not close to
+   * the navigation mesh. Indices change when the navmesh changes.
+   */
+  int getIslandIndex(const vec3f& pt) const;
+
   /**
    * @brief Finds the shortest path between two points on the navigation mesh
    *
@@ -220,6 +332,65 @@ class PathFinder {
    */
   bool findPath(MultiGoalShortestPath& path);
 
+  /**
+   * @brief Returns the geodesic distance from a point to the closest goal of
+   * a @ref GeodesicDistanceField
+   *
+   * The field is (re)computed on the first query after its goals or the
+   * navigation mesh changed, subsequent queries reuse it.
+   *
+   * @param[inout] field The distance field holding the goals
+   * @param[in] pt The point to query
+   *
+   * @return The geodesic distance, or inf if no goal is reachable from @ref pt
+   */
+  float geodesicDistance(GeodesicDistanceField& field, const vec3f& pt);
+
+  /**
+   * @brief Finds the shortest paths for a batch of queries at once.
+   *
+   * The queries are distributed over a pool of worker threads (see @ref
+   * setNumThreads), each of which owns its own Detour query object over the
+   * shared navigation mesh. Results are identical to calling @ref findPath on
+   * every element in order.
+   *
+   * @param[inout] paths The @ref ShortestPath structures to solve. Each one is
+   * populated as in @ref findPath.
+   *
+   * @return For each element of @ref paths, whether or not a path exists
+   */
+  std::vector<bool> findPaths(std::vector<ShortestPath>& paths);
+
+  /**
+   * @overload
+   */
+  std::vector<bool> findPaths(std::vector<MultiGoalShortestPath>& paths);
+
+  /**
+   * @overload
+   */
+  std::vector<bool> findPaths(const std::vector<ShortestPath::ptr>& paths);
+
+  /**
+   * @overload
+   */
+  std::vector<bool> findPaths(
+      const std::vector<MultiGoalShortestPath::ptr>& paths);
+
+  /**
+   * @brief Sets the number of worker threads used by the batched queries such
+   * as @ref findPaths and by tiled navmesh builds.
+   *
+   * @param[in] numThreads The number of threads, including the calling one.
+   * Values <= 0 use the process-wide @ref core::ThreadPool::shared() pool.
+   */
+  void setNumThreads(int numThreads);
+
+  /**
+   * @return The number of worker threads used by the batched queries
+   */
+  int getNumThreads() const;
+
   /**
    * @brief Attempts to move from @ref start to @ref end and returns the
    * navigable point closest to @ref end that is feasibly reachable from @ref
@@ -279,7 +450,8 @@ class PathFinder {
    *
    * @param[in] newSeed The random seed
    *
-   * @note This just seeds the global c @ref rand function.
+   * @note The random state is owned by this PathFinder, so PathFinders in
+   * different threads sample independently and reproducibly.
    */
   void seed(uint32_t newSeed);
 
@@ -327,6 +499,53 @@ class PathFinder {
    */
   bool isNavigable(const vec3f& pt, const float maxYDelta = 0.5) const;
 
+  /**
+   * @brief Batched version of @ref tryStep and @ref tryStepNoSliding for
+   * stepping many agents at once
+   *
+   * The steps are spread over @ref getNumThreads() threads, each with its own
+   * query object.
+   *
+   * @param[in] starts N x 3 array of starting locations
+   * @param[in] ends N x 3 array of desired end locations
+   * @param[out] endPoints Preallocated N x 3 array receiving the found end
+   * locations
+   * @param[in] allowSliding Whether or not to slide along walls
+   *
+   * @return Whether or not the batch was run. Fails on mismatched shapes or
+   * if no navmesh is loaded
+   */
+  bool tryStepBatch(const Eigen::Ref<const Eigen::RowMatrixXf>& starts,
+                    const Eigen::Ref<const Eigen::RowMatrixXf>& ends,
+                    Eigen::Ref<Eigen::RowMatrixXf> endPoints,
+                    bool allowSliding = true);
+
+  /**
+   * @brief Batched version of @ref snapPoint
+   *
+   * @param[in] points N x 3 array of points to snap to the navigation mesh
+   * @param[out] snappedPoints Preallocated N x 3 array receiving the snapped
+   * points
+   *
+   * @return Whether or not the batch was run
+   */
+  bool snapPointBatch(const Eigen::Ref<const Eigen::RowMatrixXf>& points,
+                      Eigen::Ref<Eigen::RowMatrixXf> snappedPoints);
+
+  /**
+   * @brief Batched version of @ref isNavigable
+   *
+   * @param[in] points N x 3 array of locations to check
+   * @param[out] navigable Preallocated array of N flags receiving whether or
+   * not each location is navigable
+   * @param[in] maxYDelta The maximum y displacement
+   *
+   * @return Whether or not the batch was run
+   */
+  bool isNavigableBatch(const Eigen::Ref<const Eigen::RowMatrixXf>& points,
+                        Eigen::Ref<VectorXb> navigable,
+                        const float maxYDelta = 0.5);
+
   /**
    * Compute and return the total area of all NavMesh polygons
    */
@@ -337,9 +556,38 @@ class PathFinder {
    */
   std::pair<vec3f, vec3f> bounds() const;
 
-  Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> getTopDownView(
-      const float metersPerPixel,
-      const float height);
+  /**
+   * @brief Computes a top-down navigability map of the navmesh
+   *
+   * The map covers @ref bounds in the x-z plane, rows along z and columns
+   * along x. A pixel is navigable if a walkable navmesh triangle covers its
+   * location within 0.5m of @ref height. The map is rasterized directly from
+   * the navmesh polygons, so it only approximates probing every pixel with
+   * @ref isNavigable: pixels right on the navmesh border can differ, as
+   * @ref isNavigable snaps to the closest polygon and accepts points within
+   * 1cm of it.
+   *
+   * @param[in] metersPerPixel The size of a pixel
+   * @param[in] height The height of the slice, e.g. the floor of a level
+   *
+   * @return The navigability map
+   */
+  MatrixXb getTopDownView(const float metersPerPixel, const float height);
+
+  /**
+   * @brief Same as @ref getTopDownView for several height slices at once,
+   * e.g. one per floor, sharing a single pass over the navmesh
+   *
+   * @param[in] metersPerPixel The size of a pixel
+   * @param[in] heights The height of each slice
+   * @param[in] maxYDelta The maximum distance between a slice and the
+   * navmesh surface for a pixel to be navigable
+   *
+   * @return One navigability map per height
+   */
+  std::vector<MatrixXb> getTopDownViews(const float metersPerPixel,
+                                        const std::vector<float>& heights,
+                                        const float maxYDelta = 0.5);
 
   /**
    * @brief Returns a MeshData object containing triangulated NavMesh polys. The
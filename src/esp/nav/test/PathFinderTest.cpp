@@ -1,7 +1,12 @@
+#include <algorithm>
+#include <cmath>
+
 #include <Corrade/Containers/ArrayView.h>
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 
+#include <esp/assets/MeshData.h>
+#include <esp/core/ThreadPool.h>
 #include <esp/nav/PathFinder.h>
 
 #include <Corrade/Utility/Directory.h>
@@ -27,24 +32,52 @@ constexpr struct {
 } MultiGoalBenchMarkData[]{{"path to closest of 1000", false},
                            {"cached path to closest of 1000", true}};
 
+constexpr struct {
+  const char* name;
+  bool tiled;
+} LoadNavMeshBenchmarkData[]{{"solo navmesh", false}, {"tiled navmesh", true}};
+
 struct PathFinderTest : Cr::TestSuite::Tester {
   explicit PathFinderTest();
 
   void bounds();
   void tryStepNoSliding();
   void multiGoalPath();
+  void batchedPaths();
+  void batchedPointQueries();
+  void batchedQueriesSharedPool();
+  void geodesicDistanceField();
+  void geodesicDistanceFieldSharedPolygon();
+  void tiledBuild();
+  void rebuildTiles();
+  void topDownView();
+  void randomPoints();
 
   void benchmarkSingleGoal();
   void benchmarkMultiGoal();
+  void benchmarkBatchedPaths();
+  void benchmarkUnreachablePaths();
+  void benchmarkLoadNavMesh();
 
   void testCaching();
 };
 
 PathFinderTest::PathFinderTest() {
   addTests({&PathFinderTest::bounds, &PathFinderTest::tryStepNoSliding,
-            &PathFinderTest::multiGoalPath, &PathFinderTest::testCaching});
+            &PathFinderTest::multiGoalPath, &PathFinderTest::batchedPaths,
+            &PathFinderTest::batchedPointQueries,
+            &PathFinderTest::batchedQueriesSharedPool,
+            &PathFinderTest::geodesicDistanceField,
+            &PathFinderTest::geodesicDistanceFieldSharedPolygon,
+            &PathFinderTest::tiledBuild, &PathFinderTest::rebuildTiles,
+            &PathFinderTest::topDownView, &PathFinderTest::randomPoints,
+            &PathFinderTest::testCaching});
 
   addBenchmarks({&PathFinderTest::benchmarkSingleGoal}, 1000);
+  addBenchmarks({&PathFinderTest::benchmarkBatchedPaths}, 10);
+  addBenchmarks({&PathFinderTest::benchmarkUnreachablePaths}, 100);
+  addInstancedBenchmarks({&PathFinderTest::benchmarkLoadNavMesh}, 10,
+                         Cr::Containers::arraySize(LoadNavMeshBenchmarkData));
   addInstancedBenchmarks({&PathFinderTest::benchmarkMultiGoal}, 100,
                          Cr::Containers::arraySize(MultiGoalBenchMarkData));
 }
@@ -125,6 +158,463 @@ void PathFinderTest::multiGoalPath() {
   }
 }
 
+void PathFinderTest::batchedPaths() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+  pathFinder.setNumThreads(4);
+  CORRADE_COMPARE(pathFinder.getNumThreads(), 4);
+
+  std::vector<esp::nav::ShortestPath> paths(1000);
+  for (auto& path : paths) {
+    path.requestedStart = pathFinder.getRandomNavigablePoint();
+    path.requestedEnd = pathFinder.getRandomNavigablePoint();
+  }
+
+  const std::vector<bool> found = pathFinder.findPaths(paths);
+  CORRADE_COMPARE(found.size(), paths.size());
+
+  for (int i = 0; i < paths.size(); ++i) {
+    CORRADE_ITERATION(i);
+    esp::nav::ShortestPath path;
+    path.requestedStart = paths[i].requestedStart;
+    path.requestedEnd = paths[i].requestedEnd;
+
+    CORRADE_COMPARE(found[i], pathFinder.findPath(path));
+    CORRADE_COMPARE(paths[i].geodesicDistance, path.geodesicDistance);
+    CORRADE_COMPARE(paths[i].points.size(), path.points.size());
+  }
+}
+
+void PathFinderTest::batchedPointQueries() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+  pathFinder.setNumThreads(4);
+
+  constexpr int numPoints = 500;
+  Eigen::RowMatrixXf starts(numPoints, 3), ends(numPoints, 3);
+  for (int i = 0; i < numPoints; ++i) {
+    starts.row(i) = pathFinder.getRandomNavigablePoint().transpose();
+    // Steps of up to 1m, with some points off the navmesh
+    ends.row(i) = starts.row(i) + Eigen::RowVector3f::Random();
+  }
+
+  Eigen::RowMatrixXf endPoints(numPoints, 3), snapped(numPoints, 3);
+  esp::nav::VectorXb navigable(numPoints);
+  CORRADE_VERIFY(pathFinder.tryStepBatch(starts, ends, endPoints));
+  CORRADE_VERIFY(pathFinder.snapPointBatch(ends, snapped));
+  CORRADE_VERIFY(pathFinder.isNavigableBatch(ends, navigable));
+
+  for (int i = 0; i < numPoints; ++i) {
+    CORRADE_ITERATION(i);
+    const esp::vec3f start = starts.row(i).transpose();
+    const esp::vec3f end = ends.row(i).transpose();
+    CORRADE_COMPARE(Mn::Vector3{esp::vec3f{endPoints.row(i).transpose()}},
+                    Mn::Vector3{pathFinder.tryStep(start, end)});
+    const esp::vec3f snappedPoint = pathFinder.snapPoint(end);
+    // Points that can't be snapped are NAN, which never compare equal
+    if (!std::isnan(snappedPoint[0])) {
+      CORRADE_COMPARE(Mn::Vector3{esp::vec3f{snapped.row(i).transpose()}},
+                      Mn::Vector3{snappedPoint});
+    }
+    CORRADE_COMPARE(navigable[i], pathFinder.isNavigable(end));
+  }
+
+  CORRADE_VERIFY(pathFinder.tryStepBatch(starts, ends, endPoints, false));
+  for (int i = 0; i < numPoints; ++i) {
+    CORRADE_ITERATION(i);
+    const esp::vec3f start = starts.row(i).transpose();
+    const esp::vec3f end = ends.row(i).transpose();
+    CORRADE_COMPARE(Mn::Vector3{esp::vec3f{endPoints.row(i).transpose()}},
+                    Mn::Vector3{pathFinder.tryStepNoSliding(start, end)});
+  }
+
+  // Mismatched shapes are rejected
+  Eigen::RowMatrixXf tooFew(numPoints - 1, 3);
+  CORRADE_VERIFY(!pathFinder.tryStepBatch(starts, ends, tooFew));
+  CORRADE_VERIFY(!pathFinder.snapPointBatch(starts.leftCols(2), snapped));
+}
+
+void PathFinderTest::batchedQueriesSharedPool() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+  // No setNumThreads, the batched queries run on the shared pool
+  CORRADE_COMPARE(pathFinder.getNumThreads(),
+                  esp::core::ThreadPool::defaultNumThreads());
+
+  constexpr int numPoints = 100;
+  std::vector<esp::nav::ShortestPath> paths(numPoints);
+  Eigen::RowMatrixXf starts(numPoints, 3), ends(numPoints, 3);
+  for (int i = 0; i < numPoints; ++i) {
+    paths[i].requestedStart = pathFinder.getRandomNavigablePoint();
+    paths[i].requestedEnd = pathFinder.getRandomNavigablePoint();
+    starts.row(i) = paths[i].requestedStart.transpose();
+    ends.row(i) = starts.row(i) + Eigen::RowVector3f::Random();
+  }
+
+  const std::vector<bool> found = pathFinder.findPaths(paths);
+  Eigen::RowMatrixXf endPoints(numPoints, 3), snapped(numPoints, 3);
+  esp::nav::VectorXb navigable(numPoints);
+  CORRADE_VERIFY(pathFinder.tryStepBatch(starts, ends, endPoints));
+  CORRADE_VERIFY(pathFinder.snapPointBatch(starts, snapped));
+  CORRADE_VERIFY(pathFinder.isNavigableBatch(ends, navigable));
+
+  for (int i = 0; i < numPoints; ++i) {
+    CORRADE_ITERATION(i);
+    esp::nav::ShortestPath path;
+    path.requestedStart = paths[i].requestedStart;
+    path.requestedEnd = paths[i].requestedEnd;
+    CORRADE_COMPARE(found[i], pathFinder.findPath(path));
+    CORRADE_COMPARE(paths[i].geodesicDistance, path.geodesicDistance);
+
+    const esp::vec3f start = starts.row(i).transpose();
+    const esp::vec3f end = ends.row(i).transpose();
+    CORRADE_COMPARE(Mn::Vector3{esp::vec3f{endPoints.row(i).transpose()}},
+                    Mn::Vector3{pathFinder.tryStep(start, end)});
+    CORRADE_COMPARE(Mn::Vector3{esp::vec3f{snapped.row(i).transpose()}},
+                    Mn::Vector3{pathFinder.snapPoint(start)});
+    CORRADE_COMPARE(navigable[i], pathFinder.isNavigable(end));
+  }
+}
+
+void PathFinderTest::geodesicDistanceField() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+
+  std::vector<esp::vec3f> goals;
+  for (int i = 0; i < 5; ++i) {
+    goals.emplace_back(pathFinder.getRandomNavigablePoint());
+  }
+  esp::nav::GeodesicDistanceField field;
+  field.setGoals(goals);
+
+  esp::nav::MultiGoalShortestPath path;
+  path.setRequestedEnds(goals);
+  for (int i = 0; i < 500; ++i) {
+    CORRADE_ITERATION(i);
+    path.requestedStart = pathFinder.getRandomNavigablePoint();
+    const bool found = pathFinder.findPath(path);
+    const float fieldDist =
+        pathFinder.geodesicDistance(field, path.requestedStart);
+
+    CORRADE_COMPARE(found, fieldDist < std::numeric_limits<float>::infinity());
+    if (!found)
+      continue;
+
+    // Both string-pull a polygon corridor to the closest goal, the corridors
+    // only differ where two are about as short
+    CORRADE_COMPARE_WITH(
+        fieldDist, path.geodesicDistance,
+        Cr::TestSuite::Compare::around(0.02f * path.geodesicDistance + 0.01f));
+    float euclideanDist = std::numeric_limits<float>::infinity();
+    for (const auto& goal : goals) {
+      euclideanDist =
+          std::min(euclideanDist, (goal - path.requestedStart).norm());
+    }
+    CORRADE_COMPARE_AS(fieldDist, euclideanDist - 1e-2f,
+                       Cr::TestSuite::Compare::GreaterOrEqual);
+  }
+
+  // A goal is at distance 0 from itself
+  CORRADE_COMPARE_WITH(pathFinder.geodesicDistance(field, goals[0]), 0.0f,
+                       Cr::TestSuite::Compare::around(1e-3f));
+}
+
+void PathFinderTest::geodesicDistanceFieldSharedPolygon() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+
+  // Two goals close enough to lie on the same polygon, away from obstacles
+  esp::vec3f first = pathFinder.getRandomNavigablePoint();
+  while (pathFinder.distanceToClosestObstacle(first) < 1.0f) {
+    first = pathFinder.getRandomNavigablePoint();
+  }
+  const esp::vec3f second =
+      pathFinder.snapPoint(first + esp::vec3f{0.3f, 0.0f, 0.3f});
+  CORRADE_VERIFY(pathFinder.isNavigable(second));
+
+  esp::nav::GeodesicDistanceField firstField, secondField, bothField;
+  firstField.setGoals({first});
+  secondField.setGoals({second});
+  bothField.setGoals({first, second});
+
+  // Each goal is at distance 0, not measured to the other one
+  CORRADE_COMPARE_WITH(pathFinder.geodesicDistance(bothField, first), 0.0f,
+                       Cr::TestSuite::Compare::around(1e-3f));
+  CORRADE_COMPARE_WITH(pathFinder.geodesicDistance(bothField, second), 0.0f,
+                       Cr::TestSuite::Compare::around(1e-3f));
+
+  for (int i = 0; i < 100; ++i) {
+    CORRADE_ITERATION(i);
+    const esp::vec3f pt = pathFinder.getRandomNavigablePoint();
+    const float expected =
+        std::min(pathFinder.geodesicDistance(firstField, pt),
+                 pathFinder.geodesicDistance(secondField, pt));
+    if (expected == std::numeric_limits<float>::infinity()) {
+      CORRADE_COMPARE(pathFinder.geodesicDistance(bothField, pt), expected);
+      continue;
+    }
+    CORRADE_COMPARE_WITH(
+        pathFinder.geodesicDistance(bothField, pt), expected,
+        Cr::TestSuite::Compare::around(0.02f * expected + 0.01f));
+  }
+}
+
+void PathFinderTest::tiledBuild() {
+  esp::nav::PathFinder source;
+  source.loadNavMesh(skokloster);
+  CORRADE_VERIFY(source.isLoaded());
+  // Rebuild from the triangulated navmesh polygons, which is enough geometry
+  // to compare the solo and the tiled build modes
+  const esp::assets::MeshData::ptr mesh = source.getNavMeshData();
+
+  esp::nav::NavMeshSettings settings;
+  settings.agentRadius = 0.0f;
+  esp::nav::PathFinder solo;
+  CORRADE_VERIFY(solo.build(settings, *mesh));
+
+  settings.tiled = true;
+  settings.tileSize = 64;
+  esp::nav::PathFinder tiled;
+  tiled.setNumThreads(4);
+  CORRADE_VERIFY(tiled.build(settings, *mesh));
+  CORRADE_COMPARE_WITH(
+      tiled.getNavigableArea(), solo.getNavigableArea(),
+      Cr::TestSuite::Compare::around(0.05f * solo.getNavigableArea()));
+
+  const std::string tiledFile =
+      Cr::Utility::Directory::join(Cr::Utility::Directory::tmp(),
+                                   "PathFinderTest-tiled.navmesh");
+  CORRADE_VERIFY(tiled.saveNavMesh(tiledFile));
+  esp::nav::PathFinder loaded;
+  CORRADE_VERIFY(loaded.loadNavMesh(tiledFile));
+  CORRADE_COMPARE(loaded.getNavigableArea(), tiled.getNavigableArea());
+  CORRADE_COMPARE(Mn::Vector3{loaded.bounds().first},
+                  Mn::Vector3{tiled.bounds().first});
+  CORRADE_COMPARE(Mn::Vector3{loaded.bounds().second},
+                  Mn::Vector3{tiled.bounds().second});
+  Cr::Utility::Directory::rm(tiledFile);
+}
+
+void PathFinderTest::rebuildTiles() {
+  esp::nav::PathFinder source;
+  source.loadNavMesh(skokloster);
+  CORRADE_VERIFY(source.isLoaded());
+  const esp::assets::MeshData::ptr mesh = source.getNavMeshData();
+
+  esp::nav::NavMeshSettings settings;
+  settings.agentRadius = 0.0f;
+  esp::nav::PathFinder solo;
+  CORRADE_VERIFY(solo.build(settings, *mesh));
+  // Only tiled navmeshes can be updated incrementally
+  CORRADE_VERIFY(!solo.rebuildTiles(*mesh, solo.bounds().first,
+                                    solo.bounds().second));
+
+  settings.tiled = true;
+  settings.tileSize = 64;
+  // leave head room above the floor for the obstacle added below, the
+  // rebuilt tiles keep the height range of the original build
+  settings.navMeshBBMax = source.bounds().second[1] + 3.0f;
+  esp::nav::PathFinder tiled;
+  CORRADE_VERIFY(tiled.build(settings, *mesh));
+  const float area = tiled.getNavigableArea();
+
+  // Navmesh files don't store the build settings, so the tiles of a loaded
+  // navmesh can't be rebuilt
+  const std::string tiledFile =
+      Cr::Utility::Directory::join(Cr::Utility::Directory::tmp(),
+                                   "PathFinderTest-rebuild.navmesh");
+  CORRADE_VERIFY(tiled.saveNavMesh(tiledFile));
+  esp::nav::PathFinder loaded;
+  CORRADE_VERIFY(loaded.loadNavMesh(tiledFile));
+  Cr::Utility::Directory::rm(tiledFile);
+  CORRADE_VERIFY(!loaded.rebuildTiles(*mesh, loaded.bounds().first,
+                                      loaded.bounds().second));
+
+  const std::pair<esp::vec3f, esp::vec3f> bounds = tiled.bounds();
+  const esp::vec3f center = 0.5f * (bounds.first + bounds.second);
+  esp::nav::ShortestPath path;
+  path.requestedStart = tiled.snapPoint(center);
+  path.requestedEnd = tiled.getRandomNavigablePoint();
+  const bool found = tiled.findPath(path);
+  const float geodesicDistance = path.geodesicDistance;
+
+  // Rebuilding from unchanged geometry must reproduce the same navmesh
+  CORRADE_VERIFY(tiled.rebuildTiles(*mesh, center - esp::vec3f{1, 1, 1},
+                                    center + esp::vec3f{1, 1, 1}));
+  CORRADE_COMPARE_WITH(tiled.getNavigableArea(), area,
+                       Cr::TestSuite::Compare::around(1e-3f * area));
+  CORRADE_COMPARE(tiled.findPath(path), found);
+  if (found) {
+    CORRADE_COMPARE_WITH(path.geodesicDistance, geodesicDistance,
+                         Cr::TestSuite::Compare::around(1e-3f));
+  }
+
+  // The ids of relabeled islands are reused, so they don't grow with every
+  // rebuild
+  const int islandIndex = tiled.getIslandIndex(path.requestedStart);
+  for (int i = 0; i < 5; ++i) {
+    CORRADE_VERIFY(tiled.rebuildTiles(*mesh, center - esp::vec3f{1, 1, 1},
+                                      center + esp::vec3f{1, 1, 1}));
+    CORRADE_COMPARE(tiled.getIslandIndex(path.requestedStart), islandIndex);
+  }
+
+  // Put a 1m x 2m x 1m box in open space and rebuild the tiles around it
+  esp::vec3f openPoint = tiled.getRandomNavigablePoint();
+  while (tiled.distanceToClosestObstacle(openPoint) < 1.8f) {
+    openPoint = tiled.getRandomNavigablePoint();
+  }
+  esp::assets::MeshData obstacleMesh = *mesh;
+  const uint32_t firstVertex = obstacleMesh.vbo.size();
+  for (int corner = 0; corner < 8; ++corner) {
+    obstacleMesh.vbo.emplace_back(
+        openPoint + esp::vec3f{corner & 1 ? 0.5f : -0.5f,
+                               corner & 2 ? 2.0f : -0.1f,
+                               corner & 4 ? 0.5f : -0.5f});
+  }
+  // two triangles per face, the corners of each face in order around it. The
+  // top face points down, so that the top of the box isn't walkable either.
+  constexpr uint32_t faces[6][4]{{0, 1, 3, 2}, {4, 6, 7, 5}, {0, 4, 5, 1},
+                                 {2, 3, 7, 6}, {0, 2, 6, 4}, {1, 5, 7, 3}};
+  for (const auto& face : faces) {
+    for (uint32_t i : {0, 1, 2, 0, 2, 3}) {
+      obstacleMesh.ibo.emplace_back(firstVertex + face[i]);
+    }
+  }
+  const esp::vec3f obstacleMin = openPoint - esp::vec3f{0.5f, 0.1f, 0.5f};
+  const esp::vec3f obstacleMax = openPoint + esp::vec3f{0.5f, 2.0f, 0.5f};
+
+  esp::nav::ShortestPath aroundPath;
+  aroundPath.requestedStart = openPoint - esp::vec3f{1.0f, 0.0f, 0.0f};
+  aroundPath.requestedEnd = openPoint + esp::vec3f{1.0f, 0.0f, 0.0f};
+  CORRADE_VERIFY(tiled.findPath(aroundPath));
+  CORRADE_COMPARE_WITH(aroundPath.geodesicDistance, 2.0f,
+                       Cr::TestSuite::Compare::around(5e-2f));
+
+  CORRADE_VERIFY(tiled.rebuildTiles(obstacleMesh, obstacleMin, obstacleMax));
+  CORRADE_VERIFY(!tiled.isNavigable(openPoint, 0.5f));
+  CORRADE_COMPARE_AS(tiled.getNavigableArea(), area - 0.8f,
+                     Cr::TestSuite::Compare::Less);
+  // the path now has to go around the box
+  CORRADE_VERIFY(tiled.findPath(aroundPath));
+  CORRADE_COMPARE_AS(aroundPath.geodesicDistance, 2.15f,
+                     Cr::TestSuite::Compare::Greater);
+
+  // removing the box again restores the navmesh
+  CORRADE_VERIFY(tiled.rebuildTiles(*mesh, obstacleMin, obstacleMax));
+  CORRADE_VERIFY(tiled.isNavigable(openPoint, 0.5f));
+  CORRADE_COMPARE_WITH(tiled.getNavigableArea(), area,
+                       Cr::TestSuite::Compare::around(1e-3f * area));
+  CORRADE_VERIFY(tiled.findPath(aroundPath));
+  CORRADE_COMPARE_WITH(aroundPath.geodesicDistance, 2.0f,
+                       Cr::TestSuite::Compare::around(5e-2f));
+
+  // regions outside of the original bounds can't be rebuilt
+  const esp::vec3f farAway{bounds.second[0] + 100.0f, bounds.second[1],
+                           bounds.second[2] + 100.0f};
+  CORRADE_VERIFY(
+      !tiled.rebuildTiles(*mesh, farAway, farAway + esp::vec3f{1, 1, 1}));
+}
+
+void PathFinderTest::topDownView() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+
+  constexpr float metersPerPixel = 0.1f;
+  const std::pair<esp::vec3f, esp::vec3f> bounds = pathFinder.bounds();
+  const float height = bounds.first[1] + 0.5f;
+  const esp::nav::MatrixXb map =
+      pathFinder.getTopDownView(metersPerPixel, height);
+  CORRADE_COMPARE(map.rows(), int((bounds.second[2] - bounds.first[2]) /
+                                  metersPerPixel));
+  CORRADE_COMPARE(map.cols(), int((bounds.second[0] - bounds.first[0]) /
+                                  metersPerPixel));
+  CORRADE_VERIFY(map.count() > 0);
+
+  // The rasterized map agrees with probing every pixel, up to pixels right
+  // on the navmesh border
+  int numMismatches = 0;
+  for (int h = 0; h < map.rows(); ++h) {
+    for (int w = 0; w < map.cols(); ++w) {
+      const esp::vec3f point{bounds.first[0] + w * metersPerPixel, height,
+                             bounds.first[2] + h * metersPerPixel};
+      numMismatches += map(h, w) != pathFinder.isNavigable(point, 0.5);
+    }
+  }
+  CORRADE_COMPARE_AS(numMismatches, int(map.size() / 100),
+                     Cr::TestSuite::Compare::LessOrEqual);
+
+  // Slices computed together match slices computed one by one
+  const std::vector<float> heights{height, bounds.second[1] - 0.5f};
+  const std::vector<esp::nav::MatrixXb> maps =
+      pathFinder.getTopDownViews(metersPerPixel, heights);
+  CORRADE_COMPARE(maps.size(), heights.size());
+  for (size_t i = 0; i < heights.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_VERIFY(maps[i] ==
+                   pathFinder.getTopDownView(metersPerPixel, heights[i]));
+  }
+}
+
+void PathFinderTest::randomPoints() {
+  esp::nav::PathFinder a, b;
+  a.loadNavMesh(skokloster);
+  b.loadNavMesh(skokloster);
+  CORRADE_VERIFY(a.isLoaded());
+  CORRADE_VERIFY(b.isLoaded());
+
+  // Each PathFinder owns its random state, so interleaved sampling from equally
+  // seeded instances yields the same sequences
+  a.seed(3);
+  b.seed(3);
+  for (int i = 0; i < 100; ++i) {
+    CORRADE_ITERATION(i);
+    const esp::vec3f pt = a.getRandomNavigablePoint();
+    CORRADE_COMPARE(Mn::Vector3{pt}, Mn::Vector3{b.getRandomNavigablePoint()});
+    CORRADE_VERIFY(a.isNavigable(pt));
+  }
+
+  a.seed(5);
+  b.seed(5);
+  const std::vector<esp::vec3f> points = a.getRandomNavigablePoints(1000);
+  CORRADE_COMPARE(points.size(), 1000);
+  for (int i = 0; i < points.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(Mn::Vector3{points[i]},
+                    Mn::Vector3{b.getRandomNavigablePoint()});
+    CORRADE_VERIFY(a.isNavigable(points[i]));
+  }
+
+  // Island-restricted sampling
+  const int island = a.getIslandIndex(points[0]);
+  CORRADE_VERIFY(island != esp::ID_UNDEFINED);
+  for (const esp::vec3f& pt : a.getRandomNavigablePoints(100, island)) {
+    CORRADE_COMPARE(a.getIslandIndex(pt), island);
+  }
+  const float minRadius = a.islandRadius(points[0]);
+  for (const esp::vec3f& pt :
+       a.getRandomNavigablePointsMinIslandRadius(100, minRadius)) {
+    CORRADE_COMPARE_AS(a.islandRadius(pt), minRadius,
+                       Cr::TestSuite::Compare::GreaterOrEqual);
+  }
+  CORRADE_VERIFY(a.getRandomNavigablePointsMinIslandRadius(10, 1e6f).empty());
+  CORRADE_VERIFY(a.getRandomNavigablePoints(10, -5).empty());
+
+  CORRADE_VERIFY(a.getRandomNavigablePoints(0).empty());
+  esp::nav::PathFinder empty;
+  CORRADE_VERIFY(empty.getRandomNavigablePoints(10).empty());
+}
+
 void PathFinderTest::testCaching() {
   esp::nav::PathFinder pathFinder;
   pathFinder.loadNavMesh(skokloster);
@@ -199,6 +689,80 @@ void PathFinderTest::benchmarkMultiGoal() {
   CORRADE_VERIFY(status);
 }
 
+void PathFinderTest::benchmarkBatchedPaths() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+
+  std::vector<esp::nav::ShortestPath> paths(1000);
+  for (auto& path : paths) {
+    path.requestedStart = pathFinder.getRandomNavigablePoint();
+    path.requestedEnd = pathFinder.getRandomNavigablePoint();
+  }
+
+  std::vector<bool> found;
+  CORRADE_BENCHMARK(1) { found = pathFinder.findPaths(paths); };
+  CORRADE_COMPARE(found.size(), paths.size());
+}
+
+void PathFinderTest::benchmarkUnreachablePaths() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+
+  // Paths between different islands are rejected by the island lookup
+  // before any search, so this mostly measures the lookup
+  std::vector<esp::nav::ShortestPath> paths;
+  while (paths.size() < 100) {
+    esp::nav::ShortestPath path;
+    path.requestedStart = pathFinder.getRandomNavigablePoint();
+    path.requestedEnd = pathFinder.getRandomNavigablePoint();
+    if (!pathFinder.findPath(path))
+      paths.emplace_back(std::move(path));
+  }
+
+  bool status = false;
+  CORRADE_BENCHMARK(10) {
+    for (auto& path : paths) {
+      status |= pathFinder.findPath(path);
+    }
+  };
+  CORRADE_VERIFY(!status);
+}
+
+void PathFinderTest::benchmarkLoadNavMesh() {
+  auto&& data = LoadNavMeshBenchmarkData[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+
+  // Loading rebuilds the island system, which dominates for large navmeshes
+  std::string navMeshFile = skokloster;
+  if (data.tiled) {
+    esp::nav::PathFinder source;
+    source.loadNavMesh(skokloster);
+    CORRADE_VERIFY(source.isLoaded());
+
+    esp::nav::NavMeshSettings settings;
+    settings.tiled = true;
+    settings.tileSize = 32;
+    esp::nav::PathFinder tiled;
+    CORRADE_VERIFY(tiled.build(settings, *source.getNavMeshData()));
+    navMeshFile = Cr::Utility::Directory::join(
+        Cr::Utility::Directory::tmp(), "PathFinderTest-benchmark.navmesh");
+    CORRADE_VERIFY(tiled.saveNavMesh(navMeshFile));
+  }
+
+  esp::nav::PathFinder pathFinder;
+  bool loaded = false;
+  CORRADE_BENCHMARK(1) { loaded = pathFinder.loadNavMesh(navMeshFile); };
+  CORRADE_VERIFY(loaded);
+
+  if (data.tiled) {
+    Cr::Utility::Directory::rm(navMeshFile);
+  }
+}
+
 }  // namespace
 
 CORRADE_TEST_MAIN(PathFinderTest)
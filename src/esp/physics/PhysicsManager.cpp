@@ -5,6 +5,9 @@
 #include "PhysicsManager.h"
 #include "esp/assets/CollisionMeshData.h"
 
+#include <atomic>
+#include <limits>
+
 #include <Magnum/Math/Range.h>
 
 namespace esp {
@@ -31,6 +34,7 @@ bool PhysicsManager::initPhysicsFinalize() {
 
 PhysicsManager::~PhysicsManager() {
   LOG(INFO) << "Deconstructing PhysicsManager";
+  clearObjectPools();
 }
 
 bool PhysicsManager::addStage(
@@ -139,6 +143,21 @@ int PhysicsManager::addObject(const std::string& configFileHandle,
                               DrawableGroup* drawables,
                               scene::SceneNode* attachmentNode,
                               const std::string& lightSetup) {
+  if (attachmentNode == nullptr) {
+    auto poolIter = objectPools_.find(configFileHandle);
+    if (poolIter != objectPools_.end() && !poolIter->second.objects.empty() &&
+        poolIter->second.drawables == drawables &&
+        poolIter->second.lightSetup == lightSetup) {
+      // reuse a pooled object, its assets and collision shapes already exist
+      RigidObject::uptr object = std::move(poolIter->second.objects.back());
+      poolIter->second.objects.pop_back();
+      const int objectID = allocateObjectID();
+      object->reuseFromPool(objectID);
+      existingObjects_.emplace(objectID, std::move(object));
+      return objectID;
+    }
+  }
+
   //! Make rigid object and add it to existingObjects
   int nextObjectID_ = allocateObjectID();
   scene::SceneNode* objectNode = attachmentNode;
@@ -200,10 +219,30 @@ void PhysicsManager::removeObject(const int physObjectID,
                                   bool deleteObjectNode,
                                   bool deleteVisualNode) {
   assertIDValidity(physObjectID);
+  if (deleteObjectNode && !objectPools_.empty()) {
+    auto poolIter = objectPools_.find(
+        existingObjects_.at(physObjectID)->getInitializationAttributes()
+            ->getHandle());
+    if (poolIter != objectPools_.end() &&
+        poolIter->second.objects.size() < poolIter->second.capacity) {
+      // keep the object and its node for reuse by addObject
+      RigidObject::uptr object = existingObjects_.extract(physObjectID);
+      object->releaseToPool();
+      poolIter->second.objects.emplace_back(std::move(object));
+      deallocateObjectID(physObjectID);
+      movedObjectIds_.erase(std::remove(movedObjectIds_.begin(),
+                                        movedObjectIds_.end(), physObjectID),
+                            movedObjectIds_.end());
+      return;
+    }
+  }
   scene::SceneNode* objectNode = &existingObjects_.at(physObjectID)->node();
   scene::SceneNode* visualNode = existingObjects_.at(physObjectID)->visualNode_;
   existingObjects_.erase(physObjectID);
   deallocateObjectID(physObjectID);
+  movedObjectIds_.erase(std::remove(movedObjectIds_.begin(),
+                                    movedObjectIds_.end(), physObjectID),
+                        movedObjectIds_.end());
   if (deleteObjectNode) {
     delete objectNode;
   } else if (deleteVisualNode && visualNode) {
@@ -211,6 +250,65 @@ void PhysicsManager::removeObject(const int physObjectID,
   }
 }
 
+bool PhysicsManager::preallocateObjects(const std::string& configFile,
+                                        int capacity,
+                                        DrawableGroup* drawables,
+                                        const std::string& lightSetup) {
+  if (capacity <= 0) {
+    LOG(ERROR) << "PhysicsManager::preallocateObjects : capacity must be "
+                  "positive.";
+    return false;
+  }
+  ObjectPool& pool = objectPools_[configFile];
+  if (pool.capacity > 0 &&
+      (pool.drawables != drawables || pool.lightSetup != lightSetup)) {
+    LOG(ERROR) << "PhysicsManager::preallocateObjects : " << configFile
+               << " is already pooled with different drawables or light "
+                  "setup.";
+    return false;
+  }
+  pool.drawables = drawables;
+  pool.lightSetup = lightSetup;
+  pool.capacity = std::max(pool.capacity, size_t(capacity));
+
+  // instance the objects then release them into the pool. Their IDs are
+  // handed back afterwards, so that pooling doesn't change the IDs of later
+  // objects.
+  const int nextObjectID = nextObjectID_;
+  const std::vector<int> recycledObjectIDs = recycledObjectIDs_;
+  std::vector<int> objectIDs;
+  while (pool.objects.size() + objectIDs.size() < size_t(capacity)) {
+    const int objectID = addObject(configFile, drawables, nullptr, lightSetup);
+    if (objectID == ID_UNDEFINED) {
+      break;
+    }
+    objectIDs.push_back(objectID);
+  }
+  for (int objectID : objectIDs) {
+    removeObject(objectID);
+  }
+  nextObjectID_ = nextObjectID;
+  recycledObjectIDs_ = recycledObjectIDs;
+  return pool.objects.size() >= size_t(capacity);
+}
+
+int PhysicsManager::getNumPooledObjects(const std::string& configFile) const {
+  auto poolIter = objectPools_.find(configFile);
+  return poolIter == objectPools_.end() ? 0
+                                        : poolIter->second.objects.size();
+}
+
+void PhysicsManager::clearObjectPools() {
+  for (auto& pool : objectPools_) {
+    for (RigidObject::uptr& object : pool.second.objects) {
+      scene::SceneNode* objectNode = &object->node();
+      object.reset();
+      delete objectNode;
+    }
+  }
+  objectPools_.clear();
+}
+
 void PhysicsManager::removeContactTestObject(const std::string& handle,
                                              bool deleteObjectNode,
                                              bool deleteVisualNode) {
@@ -229,7 +327,9 @@ void PhysicsManager::removeContactTestObject(const std::string& handle,
 bool PhysicsManager::setObjectMotionType(const int physObjectID,
                                          MotionType mt) {
   assertIDValidity(physObjectID);
-  return existingObjects_.at(physObjectID)->setMotionType(mt);
+  const bool success = existingObjects_.at(physObjectID)->setMotionType(mt);
+  existingObjects_.updateMotionType(physObjectID);
+  return success;
 }
 
 MotionType PhysicsManager::getObjectMotionType(const int physObjectID) const {
@@ -252,6 +352,11 @@ int PhysicsManager::deallocateObjectID(int physObjectID) {
   return physObjectID;
 }
 
+uint64_t PhysicsManager::nextWorldId() {
+  static std::atomic<uint64_t> worldCounter{0};
+  return ++worldCounter;
+}
+
 void PhysicsManager::clearRecycledObjectIds() {
   nextObjectID_ = 0;
   recycledObjectIDs_.clear();
@@ -287,6 +392,57 @@ bool PhysicsManager::isMeshPrimitiveValid(const assets::CollisionMeshData&) {
   return true;
 }
 
+bool PhysicsManager::checkRayBatch(
+    const char* caller,
+    const Eigen::Ref<const Eigen::RowMatrixXf>& origins,
+    const Eigen::Ref<const Eigen::RowMatrixXf>& directions,
+    const Eigen::Ref<Eigen::VectorXf>& hitDistances,
+    const Eigen::Ref<Eigen::RowMatrixXf>& hitNormals,
+    const Eigen::Ref<Eigen::VectorXi>& hitObjectIds) {
+  const Eigen::Index numRays = origins.rows();
+  if (origins.cols() != 3 || directions.cols() != 3 || hitNormals.cols() != 3) {
+    LOG(ERROR) << caller << ": origins, directions and normals must be N x 3";
+    return false;
+  }
+  if (directions.rows() != numRays || hitDistances.rows() != numRays ||
+      hitNormals.rows() != numRays || hitObjectIds.rows() != numRays) {
+    LOG(ERROR) << caller << ": expected " << numRays
+               << " rows in every ray array";
+    return false;
+  }
+  return true;
+}
+
+bool PhysicsManager::castRays(
+    const Eigen::Ref<const Eigen::RowMatrixXf>& origins,
+    const Eigen::Ref<const Eigen::RowMatrixXf>& directions,
+    double maxDistance,
+    Eigen::Ref<Eigen::VectorXf> hitDistances,
+    Eigen::Ref<Eigen::RowMatrixXf> hitNormals,
+    Eigen::Ref<Eigen::VectorXi> hitObjectIds) {
+  if (!checkRayBatch("PhysicsManager::castRays", origins, directions,
+                     hitDistances, hitNormals, hitObjectIds)) {
+    return false;
+  }
+  for (Eigen::Index i = 0; i < origins.rows(); ++i) {
+    const esp::geo::Ray ray{
+        Magnum::Vector3{origins(i, 0), origins(i, 1), origins(i, 2)},
+        Magnum::Vector3{directions(i, 0), directions(i, 1), directions(i, 2)}};
+    RaycastResults results = castRay(ray, maxDistance);
+    if (results.hasHits()) {
+      const RayHitInfo& hit = results.hits.front();
+      hitDistances[i] = hit.rayDistance;
+      hitNormals.row(i) << hit.normal.x(), hit.normal.y(), hit.normal.z();
+      hitObjectIds[i] = hit.objectId;
+    } else {
+      hitDistances[i] = std::numeric_limits<float>::infinity();
+      hitNormals.row(i).setZero();
+      hitObjectIds[i] = ID_UNDEFINED;
+    }
+  }
+  return true;
+}
+
 // TODO: this function should do any engine specific setting which is
 // necessary to change the timestep
 void PhysicsManager::setTimestep(double dt) {
@@ -314,21 +470,36 @@ void PhysicsManager::stepPhysics(double dt) {
     dt = fixedTimeStep_;
   }
 
+  movedObjectIds_.clear();
+
   // handle in-between step times? Ideally dt is a multiple of
   // sceneMetaData_.timestep
   double targetTime = worldTime_ + dt;
+  bool stepped = false;
   while (worldTime_ < targetTime) {
     // per fixed-step operations can be added here
 
     // kinematic velocity control intergration
-    for (auto& object : existingObjects_) {
-      VelocityControl::ptr velControl = object.second->getVelocityControl();
-      if (velControl->controllingAngVel || velControl->controllingLinVel) {
-        object.second->setRigidState(velControl->integrateTransform(
-            fixedTimeStep_, object.second->getRigidState()));
+    for (int i = 0; i < static_cast<int>(existingObjects_.size()); ++i) {
+      VelocityControl& velControl = existingObjects_.velocityControlAt(i);
+      if (velControl.controllingAngVel || velControl.controllingLinVel) {
+        RigidObject& object = existingObjects_.objectAt(i);
+        object.setRigidState(velControl.integrateTransform(
+            fixedTimeStep_, object.getRigidState()));
       }
     }
     worldTime_ += fixedTimeStep_;
+    stepped = true;
+  }
+
+  if (stepped) {
+    for (int i = 0; i < static_cast<int>(existingObjects_.size()); ++i) {
+      const VelocityControl& velControl =
+          existingObjects_.velocityControlAt(i);
+      if (velControl.controllingAngVel || velControl.controllingLinVel) {
+        movedObjectIds_.push_back(existingObjects_.idAt(i));
+      }
+    }
   }
 }
 
@@ -517,6 +688,146 @@ Magnum::Vector3 PhysicsManager::getAngularVelocity(
   return existingObjects_.at(physObjectID)->getAngularVelocity();
 }
 
+bool PhysicsManager::checkObjectBatch(
+    const char* caller,
+    const Eigen::Ref<const Eigen::VectorXi>& physObjectIDs,
+    Eigen::Index rows,
+    Eigen::Index cols,
+    Eigen::Index numColumns) const {
+  if (rows != physObjectIDs.rows() || cols != numColumns) {
+    LOG(ERROR) << caller << ": expected a " << physObjectIDs.rows() << " x "
+               << numColumns << " array, got " << rows << " x " << cols;
+    return false;
+  }
+  for (Eigen::Index i = 0; i < physObjectIDs.rows(); ++i) {
+    if (existingObjects_.count(physObjectIDs[i]) == 0) {
+      LOG(ERROR) << caller << ": no object with ID " << physObjectIDs[i];
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PhysicsManager::getRigidStates(
+    const Eigen::Ref<const Eigen::VectorXi>& physObjectIDs,
+    Eigen::Ref<Eigen::RowMatrixXf> states) const {
+  if (!checkObjectBatch("PhysicsManager::getRigidStates", physObjectIDs,
+                        states.rows(), states.cols(), 7)) {
+    return false;
+  }
+  for (Eigen::Index i = 0; i < physObjectIDs.rows(); ++i) {
+    const scene::SceneNode& node = existingObjects_.at(physObjectIDs[i])->node();
+    const Magnum::Vector3 translation = node.translation();
+    const Magnum::Quaternion rotation = node.rotation();
+    states.row(i) << translation.x(), translation.y(), translation.z(),
+        rotation.vector().x(), rotation.vector().y(), rotation.vector().z(),
+        rotation.scalar();
+  }
+  return true;
+}
+
+bool PhysicsManager::setRigidStates(
+    const Eigen::Ref<const Eigen::VectorXi>& physObjectIDs,
+    const Eigen::Ref<const Eigen::RowMatrixXf>& states) {
+  if (!checkObjectBatch("PhysicsManager::setRigidStates", physObjectIDs,
+                        states.rows(), states.cols(), 7)) {
+    return false;
+  }
+  for (Eigen::Index i = 0; i < physObjectIDs.rows(); ++i) {
+    const Magnum::Quaternion rotation{
+        {states(i, 3), states(i, 4), states(i, 5)}, states(i, 6)};
+    existingObjects_.at(physObjectIDs[i])
+        ->setRigidState(core::RigidState{
+            rotation.normalized(),
+            Magnum::Vector3{states(i, 0), states(i, 1), states(i, 2)}});
+  }
+  return true;
+}
+
+bool PhysicsManager::getVelocities(
+    const Eigen::Ref<const Eigen::VectorXi>& physObjectIDs,
+    Eigen::Ref<Eigen::RowMatrixXf> velocities) const {
+  if (!checkObjectBatch("PhysicsManager::getVelocities", physObjectIDs,
+                        velocities.rows(), velocities.cols(), 6)) {
+    return false;
+  }
+  for (Eigen::Index i = 0; i < physObjectIDs.rows(); ++i) {
+    const RigidObject& object = *existingObjects_.at(physObjectIDs[i]);
+    const Magnum::Vector3 linVel = object.getLinearVelocity();
+    const Magnum::Vector3 angVel = object.getAngularVelocity();
+    velocities.row(i) << linVel.x(), linVel.y(), linVel.z(), angVel.x(),
+        angVel.y(), angVel.z();
+  }
+  return true;
+}
+
+bool PhysicsManager::setVelocities(
+    const Eigen::Ref<const Eigen::VectorXi>& physObjectIDs,
+    const Eigen::Ref<const Eigen::RowMatrixXf>& velocities) {
+  if (!checkObjectBatch("PhysicsManager::setVelocities", physObjectIDs,
+                        velocities.rows(), velocities.cols(), 6)) {
+    return false;
+  }
+  for (Eigen::Index i = 0; i < physObjectIDs.rows(); ++i) {
+    RigidObject& object = *existingObjects_.at(physObjectIDs[i]);
+    object.setLinearVelocity(
+        {velocities(i, 0), velocities(i, 1), velocities(i, 2)});
+    object.setAngularVelocity(
+        {velocities(i, 3), velocities(i, 4), velocities(i, 5)});
+  }
+  return true;
+}
+
+PhysicsState::ptr PhysicsManager::saveState() const {
+  auto state = PhysicsState::create();
+  state->worldId_ = worldId_;
+  state->worldTime_ = worldTime_;
+
+  const int numObjects = existingObjects_.size();
+  state->objectIds_.resize(numObjects);
+  state->generations_.resize(numObjects);
+  state->objectStates_.resize(numObjects);
+  for (int i = 0; i < numObjects; ++i) {
+    const int id = existingObjects_.idAt(i);
+    state->objectIds_[i] = id;
+    state->generations_[i] = existingObjects_.generationOf(id);
+    existingObjects_.objectAt(i).saveState(state->objectStates_[i]);
+  }
+  return state;
+}
+
+bool PhysicsManager::restoreState(const PhysicsState& state) {
+  if (state.worldId_ != worldId_) {
+    LOG(ERROR) << "PhysicsManager::restoreState : the state was saved from "
+                  "another physical world.";
+    return false;
+  }
+  // validate everything first, so a stale state leaves the world untouched
+  for (size_t i = 0; i < state.objectIds_.size(); ++i) {
+    const int id = state.objectIds_[i];
+    if (existingObjects_.count(id) == 0 ||
+        existingObjects_.generationOf(id) != state.generations_[i]) {
+      LOG(ERROR) << "PhysicsManager::restoreState : object " << id
+                 << " was removed since the state was saved.";
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < state.objectIds_.size(); ++i) {
+    const int id = state.objectIds_[i];
+    const RigidObjectState& objectState = state.objectStates_[i];
+    RigidObject& object = *existingObjects_.at(id);
+    const bool motionTypeChanged =
+        object.getMotionType() != objectState.motionType;
+    object.restoreState(objectState);
+    if (motionTypeChanged) {
+      existingObjects_.updateMotionType(id);
+    }
+  }
+  worldTime_ = state.worldTime_;
+  return true;
+}
+
 VelocityControl::ptr PhysicsManager::getVelocityControl(
     const int physObjectID) {
   assertIDValidity(physObjectID);
@@ -627,7 +938,7 @@ void PhysicsManager::setObjectBBDraw(int physObjectID,
     existingObjects_.at(physObjectID)->BBNode_->MagnumObject::setScaling(scale);
     existingObjects_.at(physObjectID)
         ->BBNode_->MagnumObject::setTranslation(
-            existingObjects_[physObjectID]
+            existingObjects_.at(physObjectID)
                 ->visualNode_->getCumulativeBB()
                 .center());
     resourceManager_.addPrimitiveToDrawables(
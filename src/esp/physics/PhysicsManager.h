@@ -7,9 +7,12 @@
 
 /** @file
  * @brief Class @ref esp::physics::PhysicsManager, enum @ref
- * esp::physics::PhysicsManager::PhysicsSimulationLibrary
+ * esp::physics::PhysicsManager::PhysicsSimulationLibrary, class @ref
+ * esp::physics::PhysicsState
  */
 
+#include <algorithm>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -18,6 +21,7 @@
 /* Bullet Physics Integration */
 
 #include "RigidObject.h"
+#include "RigidObjectRegistry.h"
 #include "RigidStage.h"
 #include "esp/assets/Asset.h"
 #include "esp/assets/BaseMesh.h"
@@ -65,6 +69,41 @@ struct RaycastResults {
   ESP_SMART_POINTERS(RaycastResults)
 };
 
+class PhysicsManager;
+
+/**
+@brief In-memory snapshot of the dynamic state of a physical world, created by
+@ref PhysicsManager::saveState and restored with @ref
+PhysicsManager::restoreState.
+
+Opaque to users. Holds the @ref RigidObjectState of every object in one
+contiguous array, so it is cheap to keep many of them, e.g. one per branch of
+a planning rollout.
+*/
+class PhysicsState {
+ public:
+  /** @brief The world time at which the state was saved. */
+  double getWorldTime() const { return worldTime_; }
+
+  /** @brief The IDs of the objects captured in the state. */
+  const std::vector<int>& getObjectIds() const { return objectIds_; }
+
+ private:
+  friend class PhysicsManager;
+
+  //! The world the state was saved from, see @ref PhysicsManager::worldId_
+  uint64_t worldId_ = 0;
+  double worldTime_ = 0.0;
+
+  // parallel arrays, in packed object order at save time
+  std::vector<int> objectIds_;
+  //! Tell objects apart from later ones which recycled their IDs
+  std::vector<uint32_t> generations_;
+  std::vector<RigidObjectState> objectStates_;
+
+  ESP_SMART_POINTERS(PhysicsState)
+};
+
 // TODO: repurpose to manage multiple physical worlds. Currently represents
 // exactly one world.
 
@@ -126,7 +165,8 @@ class PhysicsManager {
       const metadata::attributes::PhysicsManagerAttributes::cptr
           _physicsManagerAttributes)
       : resourceManager_(_resourceManager),
-        physicsManagerAttributes_(_physicsManagerAttributes){};
+        physicsManagerAttributes_(_physicsManagerAttributes),
+        worldId_(nextWorldId()){};
 
   /** @brief Destructor*/
   virtual ~PhysicsManager();
@@ -223,6 +263,46 @@ class PhysicsManager {
                             bool deleteObjectNode = true,
                             bool deleteVisualNode = true);
 
+  /**
+   * @brief Pre-instantiate objects of a template into a fixed-capacity pool.
+   *
+   * While a template has a pool, @ref removeObject returns its objects to the
+   * pool as long as it has room, hiding them and taking them out of the
+   * simulation. @ref addObject reuses pooled objects for calls with the same
+   * drawables and light setup, resetting them to a freshly added state
+   * instead of instancing assets and building collision shapes again. Objects
+   * attached to user supplied nodes, or removed without deleting their node,
+   * are never pooled. Render asset instances of pooled objects tracked by a
+   * @ref gfx::replay::Recorder are recorded as deleted and created again, as
+   * they would be without pooling. Pooled objects keep the template as it was
+   * when they were first created.
+   * @param configFile The handle of the object's template.
+   * @param capacity The number of objects to pre-instantiate and the most the
+   * pool will hold.
+   * @param drawables The drawables group pooled objects render into.
+   * @param lightSetup The light setup of the pooled objects.
+   * @return Whether or not the pool was filled.
+   */
+  bool preallocateObjects(const std::string& configFile,
+                          int capacity,
+                          DrawableGroup* drawables,
+                          const std::string& lightSetup =
+                              metadata::MetadataMediator::DEFAULT_LIGHTING_KEY);
+
+  /**
+   * @brief Get the number of objects waiting in the pool of a template. See
+   * @ref preallocateObjects.
+   * @param configFile The handle of the object's template.
+   * @return The number of pooled objects, 0 if the template has no pool.
+   */
+  int getNumPooledObjects(const std::string& configFile) const;
+
+  /**
+   * @brief Destroy all pooled objects and their nodes, and stop pooling.
+   * Called on destruction. See @ref preallocateObjects.
+   */
+  void clearObjectPools();
+
   virtual void removeContactTestObject(const std::string& handle,
                                        bool deleteObjectNode = true,
                                        bool deleteVisualNode = true);
@@ -235,13 +315,16 @@ class PhysicsManager {
 
   /** @brief Get a list of existing object IDs (i.e., existing keys in @ref
    * PhysicsManager::existingObjects_.)
-   *  @return List of object ID keys from @ref PhysicsManager::existingObjects_.
+   *  @return List of object ID keys from @ref PhysicsManager::existingObjects_,
+   * in ascending order.
    */
   std::vector<int> getExistingObjectIDs() const {
     std::vector<int> v;
+    v.reserve(existingObjects_.size());
     for (auto& bro : existingObjects_) {
       v.push_back(bro.first);
     }
+    std::sort(v.begin(), v.end());
     return v;
   };
 
@@ -269,6 +352,18 @@ class PhysicsManager {
    */
   virtual void stepPhysics(double dt = 0.0);
 
+  /**
+   * @brief The IDs of the objects whose pose was changed by the last @ref
+   * stepPhysics, in no particular order.
+   *
+   * Objects asleep for the whole step are left out, as are poses set directly
+   * between steps. Lets renderers and recorders update only what moved.
+   * @return The IDs of the moved objects.
+   */
+  const std::vector<int>& getMovedObjectIds() const {
+    return movedObjectIds_;
+  }
+
   // =========== Global Setter functions ===========
 
   /** @brief Set the @ref fixedTimeStep_ of the physical world. See @ref
@@ -785,6 +880,81 @@ class PhysicsManager {
    */
   Magnum::Vector3 getAngularVelocity(const int physObjectID) const;
 
+  /**
+   * @brief Write the rigid states of a batch of objects into a preallocated
+   * array.
+   *
+   * Each row holds the translation followed by the rotation quaternion, in
+   * the order x, y, z, qx, qy, qz, qw. Nothing is written if any ID is
+   * invalid.
+   * @param physObjectIDs N object IDs.
+   * @param[out] states N x 7 rigid states.
+   * @return Whether or not the states were written.
+   */
+  bool getRigidStates(const Eigen::Ref<const Eigen::VectorXi>& physObjectIDs,
+                      Eigen::Ref<Eigen::RowMatrixXf> states) const;
+
+  /**
+   * @brief Set the rigid states of a batch of objects, see @ref
+   * getRigidStates for the layout. Rotations are normalized. @ref
+   * MotionType::STATIC objects are skipped as in @ref setTranslation.
+   * Nothing is set if any ID is invalid.
+   * @param physObjectIDs N object IDs.
+   * @param states N x 7 rigid states.
+   * @return Whether or not the states were set.
+   */
+  bool setRigidStates(const Eigen::Ref<const Eigen::VectorXi>& physObjectIDs,
+                      const Eigen::Ref<const Eigen::RowMatrixXf>& states);
+
+  /**
+   * @brief Write the velocities of a batch of objects into a preallocated
+   * array.
+   *
+   * Each row holds the linear followed by the angular velocity. Velocities of
+   * objects which are not @ref MotionType::DYNAMIC are zero, as in @ref
+   * getLinearVelocity. Nothing is written if any ID is invalid.
+   * @param physObjectIDs N object IDs.
+   * @param[out] velocities N x 6 velocities.
+   * @return Whether or not the velocities were written.
+   */
+  bool getVelocities(const Eigen::Ref<const Eigen::VectorXi>& physObjectIDs,
+                     Eigen::Ref<Eigen::RowMatrixXf> velocities) const;
+
+  /**
+   * @brief Set the velocities of a batch of objects, see @ref getVelocities
+   * for the layout. Only affects @ref MotionType::DYNAMIC objects, as in @ref
+   * setLinearVelocity. Nothing is set if any ID is invalid.
+   * @param physObjectIDs N object IDs.
+   * @param velocities N x 6 velocities.
+   * @return Whether or not the velocities were set.
+   */
+  bool setVelocities(const Eigen::Ref<const Eigen::VectorXi>& physObjectIDs,
+                     const Eigen::Ref<const Eigen::RowMatrixXf>& velocities);
+
+  /**
+   * @brief Capture the transforms, velocities, sleeping states and @ref
+   * MotionType of all objects, and the world time, for a later @ref
+   * restoreState.
+   *
+   * Control velocities and the static stage are not part of the state.
+   * @return The captured state.
+   */
+  PhysicsState::ptr saveState() const;
+
+  /**
+   * @brief Restore a state captured by @ref saveState in place, without
+   * re-creating any objects. Much cheaper than removing and re-adding objects
+   * to reset an episode, and can be repeated to simulate several futures from
+   * one state.
+   *
+   * Objects added since the state was saved are left untouched. Nothing is
+   * restored if the state comes from another world or any of its objects
+   * has been removed since.
+   * @param state A state saved from this world.
+   * @return Whether or not the state was restored.
+   */
+  bool restoreState(const PhysicsState& state);
+
   /**@brief Retrieves a shared pointer to the VelocityControl struct for this
    * object.
    */
@@ -898,6 +1068,28 @@ class PhysicsManager {
     return false;
   };
 
+  /**
+   * @brief Test a contact test object template at K candidate poses in one
+   * call, e.g. for rejection sampling of object placements.
+   *
+   * Not implemented for default @ref PhysicsManager. See @ref
+   * BulletPhysicsManager.
+   * @param handle The handle of a template added with @ref
+   * addContactTestObject.
+   * @param translations The K candidate translations.
+   * @param rotations K candidate rotations, or empty for identity rotations.
+   * @return One bit per candidate, set if that candidate is in contact with
+   * any collision enabled object.
+   */
+  virtual std::vector<bool> preAddContactTestBatch(
+      CORRADE_UNUSED const std::string& handle,
+      const std::vector<Magnum::Vector3>& translations,
+      CORRADE_UNUSED const std::vector<Magnum::Quaternion>& rotations = {},
+      CORRADE_UNUSED int collisionFilterGroup = 1,
+      CORRADE_UNUSED int collisionFilterMask = -1) {
+    return std::vector<bool>(translations.size(), false);
+  };
+
   /** @brief Return the library implementation type for the simulator currently
    * in use. Use to check for a particular implementation.
    * @return The implementation type of this simulator.
@@ -968,6 +1160,31 @@ class PhysicsManager {
     return results;
   }
 
+  /**
+   * @brief Cast a batch of rays into the collision world and write the
+   * closest hit of each ray into preallocated output arrays.
+   *
+   * Rays without a hit report an infinite distance, a zero normal and
+   * @ref esp::ID_UNDEFINED as object id. Stage hits also report -1, so check
+   * the distance to tell them apart.
+   *
+   * @param origins N x 3 ray origins.
+   * @param directions N x 3 ray directions. Need not be unit length, hit
+   * distances are reported as in @ref castRay.
+   * @param maxDistance The maximum distance along each ray direction to
+   * search. In units of ray length.
+   * @param[out] hitDistances N closest hit distances.
+   * @param[out] hitNormals N x 3 world space normals at the closest hits.
+   * @param[out] hitObjectIds N ids of the objects hit.
+   * @return Whether or not the batch was cast. Fails on mismatched shapes.
+   */
+  virtual bool castRays(const Eigen::Ref<const Eigen::RowMatrixXf>& origins,
+                        const Eigen::Ref<const Eigen::RowMatrixXf>& directions,
+                        double maxDistance,
+                        Eigen::Ref<Eigen::VectorXf> hitDistances,
+                        Eigen::Ref<Eigen::RowMatrixXf> hitNormals,
+                        Eigen::Ref<Eigen::VectorXi> hitObjectIds);
+
   virtual int getNumActiveContactPoints() { return -1; }
 
   virtual int getNumActiveOverlappingPairs() { return -1; }
@@ -991,6 +1208,29 @@ class PhysicsManager {
     CHECK(existingObjects_.count(physObjectID) > 0);
   };
 
+  /** @brief Check that a batch of object IDs are valid and that the state
+   * array handed to a bulk accessor has one row of @p numColumns values per
+   * ID. Logs an error naming @p caller if not.
+   * @return true if the batch is consistent, false otherwise.
+   */
+  bool checkObjectBatch(const char* caller,
+                        const Eigen::Ref<const Eigen::VectorXi>& physObjectIDs,
+                        Eigen::Index rows,
+                        Eigen::Index cols,
+                        Eigen::Index numColumns) const;
+
+  /** @brief Check that the arrays handed to @ref castRays describe the same
+   * number of rays. Logs an error naming @p caller if not.
+   * @return true if the shapes are consistent, false otherwise.
+   */
+  static bool checkRayBatch(
+      const char* caller,
+      const Eigen::Ref<const Eigen::RowMatrixXf>& origins,
+      const Eigen::Ref<const Eigen::RowMatrixXf>& directions,
+      const Eigen::Ref<Eigen::VectorXf>& hitDistances,
+      const Eigen::Ref<Eigen::RowMatrixXf>& hitNormals,
+      const Eigen::Ref<Eigen::VectorXi>& hitObjectIds);
+
   /** @brief Check if a particular mesh can be used as a collision mesh for a
    * particular physics implemenation. Always True for base @ref PhysicsManager
    * class, since the mesh has already been successfully loaded by @ref
@@ -1014,6 +1254,9 @@ class PhysicsManager {
    */
   int deallocateObjectID(int physObjectID);
 
+  /** @brief Allocate a new @ref worldId_, unique within the process. */
+  static uint64_t nextWorldId();
+
   /**
    * @brief Finalize physics initialization. Setup staticStageObject_ and
    * initialize any other physics-related values for physics-based scenes.
@@ -1060,6 +1303,11 @@ class PhysicsManager {
   const metadata::attributes::PhysicsManagerAttributes::cptr
       physicsManagerAttributes_;
 
+  /** @brief Identifies this world among all worlds created by the process,
+   * never reused. Tells apart states saved from another world, even one that
+   * lived at the same address. See @ref restoreState. */
+  const uint64_t worldId_;
+
   /** @brief The current physics library implementation used by this
    * @ref PhysicsManager. Can be used to correctly cast the @ref PhysicsManager
    * to its derived type if necessary.*/
@@ -1085,9 +1333,9 @@ class PhysicsManager {
   //! ==== Rigid object memory management ====
 
   /** @brief Maps object IDs to all existing physical object instances in the
-   * world.
+   * world. Objects are stored densely, see @ref RigidObjectRegistry.
    */
-  std::map<int, physics::RigidObject::uptr> existingObjects_;
+  RigidObjectRegistry existingObjects_;
 
   /** @brief A counter of unique object ID's allocated thus far. Used to
    * allocate new IDs when  @ref recycledObjectIDs_ is empty without needing to
@@ -1115,8 +1363,25 @@ class PhysicsManager {
    * simulated with @ref stepPhysics up to this point. */
   double worldTime_ = 0.0;
 
+  /** @brief The objects moved by the last @ref stepPhysics. See @ref
+   * getMovedObjectIds. */
+  std::vector<int> movedObjectIds_;
+
   std::map<std::string, physics::RigidObject::uptr> contactTestObjects_;
 
+  /** @brief Released objects of one template waiting for reuse, see @ref
+   * preallocateObjects. */
+  struct ObjectPool {
+    //! Objects are only reused for @ref addObject calls with these
+    DrawableGroup* drawables = nullptr;
+    std::string lightSetup;
+    size_t capacity = 0;
+    std::vector<RigidObject::uptr> objects;
+  };
+
+  /** @brief Object pools keyed by template handle. */
+  std::map<std::string, ObjectPool> objectPools_;
+
   ESP_SMART_POINTERS(PhysicsManager)
 };
 
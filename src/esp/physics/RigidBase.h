@@ -319,8 +319,11 @@ class RigidBase : public Magnum::SceneGraph::AbstractFeature3D {
    * @brief Set the rotation and translation of the object.
    */
   virtual void setRigidState(const core::RigidState& rigidState) {
-    setTranslation(rigidState.translation);
-    setRotation(rigidState.rotation);
+    if (objectMotionType_ != MotionType::STATIC) {
+      node().setTranslation(rigidState.translation);
+      node().setRotation(rigidState.rotation);
+      syncPose();
+    }
   };
 
   /**
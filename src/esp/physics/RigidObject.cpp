@@ -4,6 +4,10 @@
 
 #include "RigidObject.h"
 
+#include "esp/gfx/Drawable.h"
+#include "esp/gfx/DrawableGroup.h"
+#include "esp/gfx/replay/Recorder.h"
+
 namespace esp {
 namespace physics {
 
@@ -68,6 +72,64 @@ bool RigidObject::setMotionType(MotionType mt) {
   }
 }
 
+void RigidObject::saveState(RigidObjectState& state) const {
+  state.rotation = node().rotation();
+  state.translation = node().translation();
+  state.linearVelocity = getLinearVelocity();
+  state.angularVelocity = getAngularVelocity();
+  state.motionType = objectMotionType_;
+}
+
+void RigidObject::restoreState(const RigidObjectState& state) {
+  // bypass setRigidState, STATIC objects may have moved while KINEMATIC
+  node().setTranslation(state.translation);
+  node().setRotation(state.rotation);
+  if (state.motionType != objectMotionType_) {
+    setMotionType(state.motionType);
+  }
+}
+
+void RigidObject::releaseToPool() {
+  for (scene::SceneNode* node : visualNodes_) {
+    for (auto& feature : node->features()) {
+      auto* drawable = dynamic_cast<gfx::Drawable*>(&feature);
+      if (drawable != nullptr && drawable->drawables() != nullptr) {
+        pooledDrawables_.emplace_back(drawable, drawable->drawables());
+        drawable->drawables()->remove(*drawable);
+      }
+    }
+  }
+  if (BBNode_ != nullptr) {
+    delete BBNode_;
+    BBNode_ = nullptr;
+  }
+  // replays see the object deleted, as they would without pooling
+  gfx::replay::Recorder::releaseRenderAssetInstances(node());
+}
+
+void RigidObject::reuseFromPool(int objectId) {
+  objectId_ = objectId;
+  node().resetTransformation();
+  // don't hand the previous user's controls to the new one
+  velControl_ = VelocityControl::create();
+
+  for (const auto& pooledDrawable : pooledDrawables_) {
+    pooledDrawable.second->add(*pooledDrawable.first);
+  }
+  pooledDrawables_.clear();
+  setSemanticId(
+      static_cast<const metadata::attributes::ObjectAttributes&>(
+          *initializationAttributes_)
+          .getSemanticId());
+
+  reuseFromPool_LibSpecific();
+  gfx::replay::Recorder::reuseRenderAssetInstances(node());
+}
+
+void RigidObject::reuseFromPool_LibSpecific() {
+  initialization_LibSpecific();
+}
+
 //////////////////
 // VelocityControl
 
@@ -8,11 +8,13 @@
 /** @file
  * @brief Class @ref esp::physics::RigidObject, enum @ref
  * esp::physics::MotionType, enum @ref esp::physics::RigidObjectType, struct
- * @ref VelocityControl
+ * @ref VelocityControl, struct @ref esp::physics::RigidObjectState
  */
 
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/Reference.h>
+#include <utility>
+#include <vector>
 #include "esp/assets/Asset.h"
 #include "esp/assets/BaseMesh.h"
 #include "esp/assets/GenericInstanceMeshData.h"
@@ -30,6 +32,10 @@ namespace assets {
 
 class ResourceManager;
 }  // namespace assets
+namespace gfx {
+class Drawable;
+class DrawableGroup;
+}  // namespace gfx
 namespace physics {
 
 /**@brief Convenience struct for applying constant velocity control to a rigid
@@ -79,6 +85,28 @@ struct VelocityControl {
   ESP_SMART_POINTERS(VelocityControl)
 };
 
+/**
+ * @brief The dynamic state of a @ref RigidObject captured by @ref
+ * RigidObject::saveState. Plain data, so that the states of many objects can be
+ * stored and copied as one contiguous block.
+ */
+struct RigidObjectState {
+  /**@brief Rotation of the object's @ref scene::SceneNode. */
+  Magnum::Quaternion rotation;
+  /**@brief Translation of the object's @ref scene::SceneNode. */
+  Magnum::Vector3 translation;
+  /**@brief Linear velocity, zero unless @ref MotionType::DYNAMIC. */
+  Magnum::Vector3 linearVelocity;
+  /**@brief Angular velocity, zero unless @ref MotionType::DYNAMIC. */
+  Magnum::Vector3 angularVelocity;
+  /**@brief The object's @ref MotionType. */
+  MotionType motionType = MotionType::UNDEFINED;
+  /**@brief Physics library specific sleeping state, unused without one. */
+  int activationState = 0;
+  /**@brief Time the object has been at rest, used to put it to sleep. */
+  float deactivationTime = 0.0f;
+};
+
 /**
  * @brief An AbstractFeature3D representing an individual rigid object instance
  * attached to a SceneNode, updating its state through simulation. This may be a
@@ -170,13 +198,57 @@ class RigidObject : public RigidBase {
    */
   VelocityControl::ptr getVelocityControl() { return velControl_; };
 
+  /**
+   * @brief Capture the dynamic state of the object, see @ref
+   * RigidObjectState. Overridden by dynamics implementations to add
+   * velocities and sleeping state.
+   * @param[out] state The captured state.
+   */
+  virtual void saveState(RigidObjectState& state) const;
+
+  /**
+   * @brief Restore a state captured by @ref saveState, in place. Only
+   * re-creates library specific structures if the @ref MotionType changed.
+   * Forces accumulated since the last step are discarded.
+   * @param state The state to restore.
+   */
+  virtual void restoreState(const RigidObjectState& state);
+
+  /**
+   * @brief Hide the object and take it out of the simulation, so that it can
+   * wait in a pool for reuse. Render asset instances tracked by a @ref
+   * gfx::replay::Recorder are recorded as deleted. See @ref
+   * PhysicsManager::preallocateObjects.
+   */
+  virtual void releaseToPool();
+
+  /**
+   * @brief Bring an object back from a pool under a new ID, in the state of a
+   * freshly added instance of its template. Render asset instances released
+   * by @ref releaseToPool are recorded as created again.
+   * @param objectId The new ID of the object.
+   */
+  void reuseFromPool(int objectId);
+
  protected:
+  /**
+   * @brief Reset any required library specific structures of an object
+   * brought back from a pool. See @ref reuseFromPool.
+   */
+  virtual void reuseFromPool_LibSpecific();
+
   /**
    * @brief Convenience variable: specifies a constant control velocity (linear
    * | angular) applied to the rigid body before each step.
    */
   VelocityControl::ptr velControl_;
 
+  /**
+   * @brief Drawables hidden by @ref releaseToPool and the groups they are
+   * restored to by @ref reuseFromPool.
+   */
+  std::vector<std::pair<gfx::Drawable*, gfx::DrawableGroup*>> pooledDrawables_;
+
  public:
   ESP_SMART_POINTERS(RigidObject)
 };  // class RigidObject
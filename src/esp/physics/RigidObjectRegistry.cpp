@@ -0,0 +1,112 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "RigidObjectRegistry.h"
+
+namespace esp {
+namespace physics {
+
+bool RigidObjectRegistry::emplace(int id, RigidObject::uptr object) {
+  if (id < 0 || object == nullptr || count(id) > 0) {
+    return false;
+  }
+  if (id >= static_cast<int>(idToIndex_.size())) {
+    idToIndex_.resize(id + 1, ID_UNDEFINED);
+  }
+  if (id >= static_cast<int>(generations_.size())) {
+    generations_.resize(id + 1, 0);
+  }
+  idToIndex_[id] = entries_.size();
+  motionTypes_.push_back(object->getMotionType());
+  velControls_.push_back(object->getVelocityControl().get());
+  entries_.emplace_back(id, std::move(object));
+  subsetsDirty_ = true;
+  return true;
+}
+
+size_t RigidObjectRegistry::erase(int id) {
+  const int index = indexOf(id);
+  if (index == ID_UNDEFINED) {
+    return 0;
+  }
+  // fill the hole with the last object to keep the arrays packed
+  const int last = entries_.size() - 1;
+  if (index != last) {
+    entries_[index] = std::move(entries_[last]);
+    motionTypes_[index] = motionTypes_[last];
+    velControls_[index] = velControls_[last];
+    idToIndex_[entries_[index].first] = index;
+  }
+  entries_.pop_back();
+  motionTypes_.pop_back();
+  velControls_.pop_back();
+  idToIndex_[id] = ID_UNDEFINED;
+  ++generations_[id];
+  subsetsDirty_ = true;
+  return 1;
+}
+
+RigidObject::uptr RigidObjectRegistry::extract(int id) {
+  RigidObject::uptr object = std::move(at(id));
+  erase(id);
+  return object;
+}
+
+void RigidObjectRegistry::clear() {
+  for (const Entry& entry : entries_) {
+    ++generations_[entry.first];
+  }
+  entries_.clear();
+  motionTypes_.clear();
+  velControls_.clear();
+  idToIndex_.clear();
+  dynamicIndices_.clear();
+  kinematicIndices_.clear();
+  subsetsDirty_ = false;
+}
+
+RigidObject::uptr& RigidObjectRegistry::at(int id) {
+  const int index = indexOf(id);
+  CHECK(index != ID_UNDEFINED)
+      << "RigidObjectRegistry::at : no object with ID " << id;
+  return entries_[index].second;
+}
+
+const RigidObject::uptr& RigidObjectRegistry::at(int id) const {
+  const int index = indexOf(id);
+  CHECK(index != ID_UNDEFINED)
+      << "RigidObjectRegistry::at : no object with ID " << id;
+  return entries_[index].second;
+}
+
+void RigidObjectRegistry::updateMotionType(int id) {
+  const int index = indexOf(id);
+  if (index == ID_UNDEFINED) {
+    return;
+  }
+  const MotionType motionType = entries_[index].second->getMotionType();
+  if (motionTypes_[index] != motionType) {
+    motionTypes_[index] = motionType;
+    subsetsDirty_ = true;
+  }
+}
+
+void RigidObjectRegistry::updateSubsets() const {
+  if (!subsetsDirty_) {
+    return;
+  }
+  dynamicIndices_.clear();
+  kinematicIndices_.clear();
+  for (int i = 0; i < static_cast<int>(motionTypes_.size()); ++i) {
+    if (motionTypes_[i] == MotionType::DYNAMIC) {
+      dynamicIndices_.push_back(i);
+    } else if (motionTypes_[i] == MotionType::KINEMATIC) {
+      kinematicIndices_.push_back(i);
+    }
+  }
+  subsetsDirty_ = false;
+}
+
+}  // namespace physics
+}  // namespace esp
@@ -0,0 +1,168 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_PHYSICS_RIGIDOBJECTREGISTRY_H_
+#define ESP_PHYSICS_RIGIDOBJECTREGISTRY_H_
+
+/** @file
+ * @brief Class @ref esp::physics::RigidObjectRegistry
+ */
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "esp/core/esp.h"
+#include "esp/physics/RigidObject.h"
+
+namespace esp {
+namespace physics {
+
+/**
+@brief Dense registry of the @ref RigidObject instances of a @ref
+PhysicsManager, keyed by stable object ID.
+
+Objects are kept packed in insertion order with removals filled by the last
+object, so iteration touches contiguous memory. IDs map to packed indices
+through a flat table, since IDs are small and recycled. The per-object state
+read every step (@ref MotionType and @ref VelocityControl) is mirrored in
+arrays parallel to the packed objects, and the packed indices of the @ref
+MotionType::DYNAMIC and @ref MotionType::KINEMATIC objects are kept as
+subsets so step loops skip static objects entirely.
+
+Exposes the subset of the @ref std::map interface used to manage objects. The
+mirrored motion type must be refreshed with @ref updateMotionType whenever an
+object's @ref MotionType changes.
+*/
+class RigidObjectRegistry {
+ public:
+  //! An object and its ID. Iteration visits these in packed order.
+  using Entry = std::pair<int, RigidObject::uptr>;
+  using iterator = std::vector<Entry>::iterator;
+  using const_iterator = std::vector<Entry>::const_iterator;
+
+  /**
+   * @brief Add an object under an ID not already in use.
+   * @return false if @p id is negative or already in use, in which case
+   * @p object is destroyed.
+   */
+  bool emplace(int id, RigidObject::uptr object);
+
+  /**
+   * @brief Remove the object with the given ID, if any.
+   * @return The number of removed objects, 0 or 1.
+   */
+  size_t erase(int id);
+
+  /**
+   * @brief Remove the object with the given ID without destroying it. The ID
+   * must exist.
+   * @return The removed object.
+   */
+  RigidObject::uptr extract(int id);
+
+  /** @brief Remove all objects. */
+  void clear();
+
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+
+  /** @brief Whether an object with the given ID exists, 0 or 1. */
+  size_t count(int id) const { return indexOf(id) == ID_UNDEFINED ? 0 : 1; }
+
+  /**
+   * @brief The object with the given ID. The ID must exist.
+   */
+  RigidObject::uptr& at(int id);
+  const RigidObject::uptr& at(int id) const;
+
+  iterator begin() { return entries_.begin(); }
+  iterator end() { return entries_.end(); }
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator end() const { return entries_.end(); }
+
+  /**
+   * @brief The packed index of the object with the given ID, or @ref
+   * ID_UNDEFINED. Indices are invalidated by @ref erase.
+   */
+  int indexOf(int id) const {
+    return (id >= 0 && id < static_cast<int>(idToIndex_.size()))
+               ? idToIndex_[id]
+               : ID_UNDEFINED;
+  }
+
+  /**
+   * @brief The generation of an ID, incremented whenever the object holding
+   * it is removed. Tells a recycled ID apart from the object which held it
+   * before.
+   */
+  uint32_t generationOf(int id) const {
+    return (id >= 0 && id < static_cast<int>(generations_.size()))
+               ? generations_[id]
+               : 0;
+  }
+
+  /** @brief The ID of the object at a packed index. */
+  int idAt(int index) const { return entries_[index].first; }
+
+  /** @brief The object at a packed index. */
+  RigidObject& objectAt(int index) const { return *entries_[index].second; }
+
+  /** @brief The mirrored @ref MotionType of the object at a packed index. */
+  MotionType motionTypeAt(int index) const { return motionTypes_[index]; }
+
+  /** @brief The @ref VelocityControl of the object at a packed index. */
+  VelocityControl& velocityControlAt(int index) const {
+    return *velControls_[index];
+  }
+
+  /**
+   * @brief Refresh the mirrored @ref MotionType of an object after it
+   * changed.
+   */
+  void updateMotionType(int id);
+
+  /**
+   * @brief Packed indices of the objects with @ref MotionType::DYNAMIC, in
+   * packed order.
+   */
+  const std::vector<int>& getDynamicIndices() const {
+    updateSubsets();
+    return dynamicIndices_;
+  }
+
+  /**
+   * @brief Packed indices of the objects with @ref MotionType::KINEMATIC, in
+   * packed order.
+   */
+  const std::vector<int>& getKinematicIndices() const {
+    updateSubsets();
+    return kinematicIndices_;
+  }
+
+ private:
+  //! Rebuild the motion type subsets if objects or motion types changed
+  void updateSubsets() const;
+
+  //! Packed index of each ID, or @ref ID_UNDEFINED
+  std::vector<int> idToIndex_;
+  //! Generation of each ID, kept across @ref clear
+  std::vector<uint32_t> generations_;
+
+  // packed, parallel arrays
+  std::vector<Entry> entries_;
+  std::vector<MotionType> motionTypes_;
+  //! Owned by the objects, stable for their lifetime
+  std::vector<VelocityControl*> velControls_;
+
+  // rebuilt lazily, objects are added and removed in bursts
+  mutable std::vector<int> dynamicIndices_;
+  mutable std::vector<int> kinematicIndices_;
+  mutable bool subsetsDirty_ = false;
+};
+
+}  // namespace physics
+}  // namespace esp
+
+#endif  // ESP_PHYSICS_RIGIDOBJECTREGISTRY_H_
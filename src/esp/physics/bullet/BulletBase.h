@@ -8,7 +8,7 @@
 #include <Magnum/BulletIntegration/MotionState.h>
 #include <btBulletDynamicsCommon.h>
 
-#include "BulletDynamics/Featherstone/btMultiBodyDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h"
 #include "esp/assets/Asset.h"
 #include "esp/assets/BaseMesh.h"
 #include "esp/assets/MeshMetaData.h"
@@ -55,6 +55,15 @@ struct SimulationContactResultCallback
     bCollision = true;
     return 0;  // not used
   }
+
+  /**
+   * @brief Skip the narrowphase for any remaining broadphase overlaps once a
+   * contact has been found, since only a binary result is reported.
+   */
+  bool needsCollision(btBroadphaseProxy* proxy0) const override {
+    return !bCollision &&
+           btCollisionWorld::ContactResultCallback::needsCollision(proxy0);
+  }
 };
 
 struct PreAddSimulationContactResultCallback
@@ -93,6 +102,15 @@ struct PreAddSimulationContactResultCallback
     bCollision = true;
     return 0;  // not used
   }
+
+  /**
+   * @brief Skip the narrowphase for any remaining broadphase overlaps once a
+   * contact has been found, since only a binary result is reported.
+   */
+  bool needsCollision(btBroadphaseProxy* proxy0) const override {
+    return !bCollision &&
+           btCollisionWorld::ContactResultCallback::needsCollision(proxy0);
+  }
 };
 
 /**
@@ -101,7 +119,7 @@ struct PreAddSimulationContactResultCallback
 
 class BulletBase {
  public:
-  BulletBase(std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
+  BulletBase(std::shared_ptr<btDiscreteDynamicsWorld> bWorld,
              std::shared_ptr<std::map<const btCollisionObject*, int>>
                  collisionObjToObjIds)
       : bWorld_(bWorld), collisionObjToObjIds_(collisionObjToObjIds) {}
@@ -132,8 +150,8 @@ class BulletBase {
 
  protected:
   /** @brief A pointer to the Bullet world to which this object belongs. See
-   * @ref btMultiBodyDynamicsWorld.*/
-  std::shared_ptr<btMultiBodyDynamicsWorld> bWorld_;
+   * @ref btDiscreteDynamicsWorld.*/
+  std::shared_ptr<btDiscreteDynamicsWorld> bWorld_;
 
   /** @brief Static data: All components of a @ref RigidObjectType::SCENE are
    * stored here. Also, all objects set to STATIC are stored here.
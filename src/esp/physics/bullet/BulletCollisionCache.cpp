@@ -0,0 +1,411 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "BulletCollisionCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+#include <Corrade/Utility/Directory.h>
+#include <Magnum/BulletIntegration/Integration.h>
+#include <Magnum/Math/Constants.h>
+
+#ifdef CORRADE_TARGET_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h"
+#include "BulletCollision/CollisionShapes/btOptimizedBvh.h"
+#include "LinearMath/btAlignedAllocator.h"
+#include "LinearMath/btConvexHullComputer.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace physics {
+
+namespace {
+//! "HULL", little endian
+constexpr uint32_t HULL_FILE_MAGIC = 0x4c4c5548;
+constexpr uint32_t HULL_FILE_VERSION = 1;
+
+struct HullFileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t numVertices;
+};
+
+//! Smallest reduced hull: the support points along the six axis directions.
+//! Fewer points would give a flat or degenerate hull.
+constexpr int MIN_HULL_VERTICES = 6;
+
+int clampHullBudget(int maxVertices) {
+  return maxVertices <= 0 ? 0 : std::max(maxVertices, MIN_HULL_VERTICES);
+}
+
+//! "BVHT", little endian
+constexpr uint32_t BVH_FILE_MAGIC = 0x54485642;
+constexpr uint32_t BVH_FILE_VERSION = 1;
+
+//! Serialized BVHs contain raw pointers and btScalars and are only valid for
+//! the layout that wrote them.
+struct BvhFileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t pointerSize;
+  uint32_t scalarSize;
+  uint64_t dataSize;
+  uint64_t reserved;
+};
+// the serialized BVH follows the header and must stay 16-byte aligned
+static_assert(sizeof(BvhFileHeader) % 16 == 0,
+              "BvhFileHeader size must keep the BVH data aligned");
+}  // namespace
+
+BulletCollisionCache::TriangleMeshBvh::~TriangleMeshBvh() {
+  if (ownsBvh_) {
+    delete bvh_;
+    return;
+  }
+  if (bvh_ != nullptr) {
+    // deserialized in place, its arrays point into the backing memory
+    bvh_->~btOptimizedBvh();
+  }
+#ifdef CORRADE_TARGET_UNIX
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mappingSize_);
+  }
+#endif
+  if (buffer_ != nullptr) {
+    btAlignedFree(buffer_);
+  }
+}
+
+uint64_t BulletCollisionCache::hashBytes(const void* data,
+                                         size_t size,
+                                         uint64_t hash) {
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+std::vector<Mn::Vector3> BulletCollisionCache::reduceConvexHull(
+    const std::vector<Mn::Vector3>& points,
+    int maxVertices) {
+  if (points.size() < 4) {
+    return points;
+  }
+  maxVertices = clampHullBudget(maxVertices);
+  btConvexHullComputer hullComputer;
+  hullComputer.compute(points.front().data(), sizeof(Mn::Vector3),
+                       static_cast<int>(points.size()), 0, 0);
+  const btAlignedObjectArray<btVector3>& vertices = hullComputer.vertices;
+  const int numHullVertices = vertices.size();
+  if (numHullVertices == 0) {
+    // degenerate input, keep the points as they are
+    return points;
+  }
+
+  std::vector<Mn::Vector3> hull;
+  if (maxVertices <= 0 || numHullVertices <= maxVertices) {
+    hull.reserve(numHullVertices);
+    for (int i = 0; i < numHullVertices; ++i) {
+      hull.emplace_back(vertices[i]);
+    }
+    return hull;
+  }
+
+  // keep the support vertex of the exact hull along each sample direction
+  hull.reserve(maxVertices);
+  std::vector<bool> kept(numHullVertices, false);
+  const auto keepSupportVertex = [&](const btVector3& direction) {
+    int support = 0;
+    btScalar supportDot = direction.dot(vertices[0]);
+    for (int i = 1; i < numHullVertices; ++i) {
+      const btScalar dot = direction.dot(vertices[i]);
+      if (dot > supportDot) {
+        supportDot = dot;
+        support = i;
+      }
+    }
+    if (!kept[support] && static_cast<int>(hull.size()) < maxVertices) {
+      kept[support] = true;
+      hull.emplace_back(vertices[support]);
+    }
+  };
+
+  // axis directions first so that the bounding box is preserved
+  for (int axis = 0; axis < 3; ++axis) {
+    for (btScalar sign : {btScalar(1.0), btScalar(-1.0)}) {
+      btVector3 direction(0, 0, 0);
+      direction[axis] = sign;
+      keepSupportVertex(direction);
+    }
+  }
+  // remaining budget spread evenly over a Fibonacci sphere
+  const int numSpreadDirections = std::max(maxVertices - 6, 0);
+  const double goldenAngle = Mn::Constantsd::pi() * (3.0 - std::sqrt(5.0));
+  for (int i = 0; i < numSpreadDirections; ++i) {
+    const double y = 1.0 - 2.0 * (i + 0.5) / numSpreadDirections;
+    const double radius = std::sqrt(1.0 - y * y);
+    const double phi = goldenAngle * i;
+    keepSupportVertex(btVector3(std::cos(phi) * radius, y,
+                                std::sin(phi) * radius));
+  }
+  return hull;
+}
+
+std::vector<Mn::Vector3> BulletCollisionCache::getConvexHull(
+    const std::vector<Mn::Vector3>& points,
+    int maxVertices) {
+  maxVertices = clampHullBudget(maxVertices);
+  uint64_t key = hashBytes(points.data(), points.size() * sizeof(Mn::Vector3));
+  key = hashBytes(&maxVertices, sizeof(maxVertices), key);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto hullIter = hulls_.find(key);
+    if (hullIter != hulls_.end()) {
+      return hullIter->second;
+    }
+  }
+
+  std::vector<Mn::Vector3> hull;
+  if (!readHull(key, hull)) {
+    hull = reduceConvexHull(points, maxVertices);
+    writeHull(key, hull);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  hulls_.emplace(key, hull);
+  return hull;
+}
+
+BulletCollisionCache::TriangleMeshBvh::ptr
+BulletCollisionCache::getTriangleMeshBvh(btBvhTriangleMeshShape& shape,
+                                         uint64_t meshHash) {
+  // scaling and local bounds determine the quantization of the tree
+  const btVector3& scaling = shape.getLocalScaling();
+  const btVector3& aabbMin = shape.getLocalAabbMin();
+  const btVector3& aabbMax = shape.getLocalAabbMax();
+  uint64_t key = hashBytes(scaling.m_floats, 3 * sizeof(btScalar), meshHash);
+  key = hashBytes(aabbMin.m_floats, 3 * sizeof(btScalar), key);
+  key = hashBytes(aabbMax.m_floats, 3 * sizeof(btScalar), key);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto bvhIter = bvhs_.find(key);
+    if (bvhIter != bvhs_.end()) {
+      if (TriangleMeshBvh::ptr bvh = bvhIter->second.lock()) {
+        return bvh;
+      }
+    }
+  }
+
+  TriangleMeshBvh::ptr bvh = loadTriangleMeshBvh(key);
+  if (!bvh) {
+    bvh = TriangleMeshBvh::ptr(new TriangleMeshBvh());
+    bvh->bvh_ = new btOptimizedBvh();
+    bvh->ownsBvh_ = true;
+    bvh->bvh_->build(shape.getMeshInterface(), true, aabbMin, aabbMax);
+    writeTriangleMeshBvh(key, *bvh->bvh_);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  bvhs_[key] = bvh;
+  return bvh;
+}
+
+std::string BulletCollisionCache::cacheFilename(const char* prefix,
+                                                uint64_t key) const {
+  char filename[64];
+  std::snprintf(filename, sizeof(filename), "%s_%016llx.bin", prefix,
+                static_cast<unsigned long long>(key));
+  return Cr::Utility::Directory::join(directory_, filename);
+}
+
+bool BulletCollisionCache::writeCacheFile(const std::string& filename,
+                                          const void* header,
+                                          size_t headerSize,
+                                          const void* data,
+                                          size_t dataSize) const {
+  if (!Cr::Utility::Directory::mkpath(directory_)) {
+    LOG(WARNING) << "BulletCollisionCache::writeCacheFile : could not create "
+                 << directory_ << ".";
+    return false;
+  }
+
+  // write to a unique temporary and rename, so that concurrent processes
+  // never observe partially written files
+  const std::string tmpFilename =
+      filename + ".tmp" +
+      std::to_string(
+          std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+          std::chrono::steady_clock::now().time_since_epoch().count());
+  {
+    std::ofstream file(tmpFilename, std::ios::binary);
+    file.write(static_cast<const char*>(header), headerSize);
+    file.write(static_cast<const char*>(data), dataSize);
+    if (!file) {
+      LOG(WARNING) << "BulletCollisionCache::writeCacheFile : could not write "
+                   << tmpFilename << ".";
+      file.close();
+      std::remove(tmpFilename.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+    std::remove(tmpFilename.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool BulletCollisionCache::readHull(uint64_t key,
+                                    std::vector<Mn::Vector3>& hull) const {
+  if (directory_.empty()) {
+    return false;
+  }
+  std::ifstream file(cacheFilename("convex_hull", key),
+                     std::ios::binary | std::ios::ate);
+  if (!file) {
+    return false;
+  }
+  const size_t fileSize = file.tellg();
+  file.seekg(0);
+  HullFileHeader header{};
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  // check the vertex count against the file before allocating for it
+  if (!file || header.magic != HULL_FILE_MAGIC ||
+      header.version != HULL_FILE_VERSION ||
+      sizeof(header) + size_t(header.numVertices) * sizeof(Mn::Vector3) !=
+          fileSize) {
+    return false;
+  }
+  hull.resize(header.numVertices);
+  file.read(reinterpret_cast<char*>(hull.data()),
+            hull.size() * sizeof(Mn::Vector3));
+  if (!file) {
+    hull.clear();
+    return false;
+  }
+  return true;
+}
+
+void BulletCollisionCache::writeHull(
+    uint64_t key,
+    const std::vector<Mn::Vector3>& hull) const {
+  if (directory_.empty()) {
+    return;
+  }
+  const HullFileHeader header{HULL_FILE_MAGIC, HULL_FILE_VERSION,
+                              static_cast<uint32_t>(hull.size())};
+  writeCacheFile(cacheFilename("convex_hull", key), &header, sizeof(header),
+                 hull.data(), hull.size() * sizeof(Mn::Vector3));
+}
+
+BulletCollisionCache::TriangleMeshBvh::ptr
+BulletCollisionCache::loadTriangleMeshBvh(uint64_t key) const {
+  if (directory_.empty()) {
+    return nullptr;
+  }
+  const std::string filename = cacheFilename("triangle_mesh_bvh", key);
+  const auto validHeader = [](const BvhFileHeader& header, size_t fileSize) {
+    return header.magic == BVH_FILE_MAGIC &&
+           header.version == BVH_FILE_VERSION &&
+           header.pointerSize == sizeof(void*) &&
+           header.scalarSize == sizeof(btScalar) &&
+           header.dataSize + sizeof(BvhFileHeader) == fileSize;
+  };
+  TriangleMeshBvh::ptr bvh(new TriangleMeshBvh());
+
+#ifdef CORRADE_TARGET_UNIX
+  // map privately: deserializing in place only writes the object header, so
+  // only that page is copied and the tree stays shared between processes
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat fileStat {};
+  if (fstat(fd, &fileStat) != 0 ||
+      static_cast<size_t>(fileStat.st_size) < sizeof(BvhFileHeader)) {
+    close(fd);
+    return nullptr;
+  }
+  const size_t fileSize = fileStat.st_size;
+  void* mapping = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                       fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return nullptr;
+  }
+  bvh->mapping_ = mapping;
+  bvh->mappingSize_ = fileSize;
+  const auto& header = *static_cast<const BvhFileHeader*>(mapping);
+  if (!validHeader(header, fileSize)) {
+    // released by the destructor
+    return nullptr;
+  }
+  char* data = static_cast<char*>(mapping) + sizeof(BvhFileHeader);
+#else
+  std::ifstream file(filename, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return nullptr;
+  }
+  const size_t fileSize = file.tellg();
+  file.seekg(0);
+  BvhFileHeader header{};
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file || !validHeader(header, fileSize)) {
+    return nullptr;
+  }
+  bvh->buffer_ = btAlignedAlloc(header.dataSize, 16);
+  char* data = static_cast<char*>(bvh->buffer_);
+  file.read(data, header.dataSize);
+  if (!file) {
+    return nullptr;
+  }
+#endif
+
+  bvh->bvh_ = btOptimizedBvh::deSerializeInPlace(
+      data, static_cast<unsigned>(header.dataSize), false);
+  if (bvh->bvh_ == nullptr) {
+    LOG(WARNING) << "BulletCollisionCache::loadTriangleMeshBvh : could not "
+                    "deserialize "
+                 << filename << ", rebuilding.";
+    return nullptr;
+  }
+  return bvh;
+}
+
+void BulletCollisionCache::writeTriangleMeshBvh(
+    uint64_t key,
+    const btOptimizedBvh& bvh) const {
+  if (directory_.empty()) {
+    return;
+  }
+  const unsigned dataSize = bvh.calculateSerializeBufferSize();
+  void* data = btAlignedAlloc(dataSize, 16);
+  if (bvh.serializeInPlace(data, dataSize, false)) {
+    const BvhFileHeader header{BVH_FILE_MAGIC,   BVH_FILE_VERSION,
+                               sizeof(void*),    sizeof(btScalar),
+                               uint64_t{dataSize}, 0};
+    writeCacheFile(cacheFilename("triangle_mesh_bvh", key), &header,
+                   sizeof(header), data, dataSize);
+  }
+  btAlignedFree(data);
+}
+
+}  // namespace physics
+}  // namespace esp
@@ -0,0 +1,161 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_PHYSICS_BULLET_BULLETCOLLISIONCACHE_H_
+#define ESP_PHYSICS_BULLET_BULLETCOLLISIONCACHE_H_
+
+/** @file
+ * @brief Class @ref esp::physics::BulletCollisionCache
+ */
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Vector3.h>
+
+#include "esp/core/esp.h"
+
+class btBvhTriangleMeshShape;
+class btOptimizedBvh;
+
+namespace esp {
+namespace physics {
+
+/**
+@brief Cache of collision data derived from collision meshes, shared by all
+objects of a @ref BulletPhysicsManager.
+
+Convex hulls are reduced once per distinct set of input points and vertex
+budget, then kept in memory and, if a cache directory is configured, on disk
+so that later processes skip hull building entirely. Stage triangle mesh BVHs
+are serialized in place and memory-mapped on later loads, so processes loading
+the same stage share one copy. Entries are keyed by a hash of the input
+geometry, so edited assets never hit stale entries.
+*/
+class BulletCollisionCache {
+ public:
+  /**
+   * @brief A quantized BVH which may be shared by several triangle mesh
+   * shapes. Either built in memory or deserialized in place from a
+   * memory-mapped cache file. Must outlive the shapes using it.
+   */
+  class TriangleMeshBvh {
+   public:
+    ~TriangleMeshBvh();
+
+    btOptimizedBvh* get() const { return bvh_; }
+
+   private:
+    friend class BulletCollisionCache;
+    TriangleMeshBvh() = default;
+
+    btOptimizedBvh* bvh_ = nullptr;
+    //! The BVH was built in memory and is deleted with this object
+    bool ownsBvh_ = false;
+    //! Memory-mapped cache file backing @ref bvh_, if any
+    void* mapping_ = nullptr;
+    size_t mappingSize_ = 0;
+    //! Aligned buffer backing @ref bvh_ where files can't be mapped
+    void* buffer_ = nullptr;
+
+    ESP_SMART_POINTERS(TriangleMeshBvh)
+  };
+
+  /**
+   * @brief Constructor.
+   * @param directory Directory for the on-disk cache. Created on first write.
+   * Empty disables the on-disk cache.
+   */
+  explicit BulletCollisionCache(std::string directory = "")
+      : directory_(std::move(directory)) {}
+
+  /**
+   * @brief Get the vertices of the convex hull of @p points, reduced to at
+   * most @p maxVertices vertices.
+   *
+   * Interior points are always dropped. If the exact hull has more than
+   * @p maxVertices vertices, it is replaced by the hull of its support points
+   * along @p maxVertices directions spread over the sphere. The axis
+   * directions are always included, so the bounding box is preserved.
+   * @param points The input points.
+   * @param maxVertices The vertex budget. 0 keeps the exact hull, budgets
+   * below 6 are raised to 6, one support point per axis direction.
+   * @return The hull vertices, or @p points if no hull could be computed.
+   */
+  std::vector<Magnum::Vector3> getConvexHull(
+      const std::vector<Magnum::Vector3>& points,
+      int maxVertices);
+
+  /**
+   * @brief Get the BVH of a triangle mesh shape, loading it from the cache
+   * or building and caching it on a miss.
+   *
+   * The shape must have been constructed without building its BVH and
+   * already carry its final local scaling, since both the scaling and the
+   * local bounds quantize the tree. Attach the result with
+   * @ref btBvhTriangleMeshShape::setOptimizedBvh and keep it alive as long as
+   * the shape.
+   * @param shape The triangle mesh shape.
+   * @param meshHash Hash of the vertices and indices of the shape's mesh, see
+   * @ref hashBytes.
+   * @return The BVH, never nullptr.
+   */
+  TriangleMeshBvh::ptr getTriangleMeshBvh(btBvhTriangleMeshShape& shape,
+                                          uint64_t meshHash);
+
+  /**
+   * @brief Compute a reduced convex hull without consulting the cache. See
+   * @ref getConvexHull.
+   */
+  static std::vector<Magnum::Vector3> reduceConvexHull(
+      const std::vector<Magnum::Vector3>& points,
+      int maxVertices);
+
+  /**
+   * @brief 64-bit FNV-1a hash of @p size bytes at @p data, continuing from
+   * @p hash.
+   */
+  static uint64_t hashBytes(const void* data,
+                            size_t size,
+                            uint64_t hash = 14695981039346656037ull);
+
+  /** @brief Directory of the on-disk cache, empty if disabled. */
+  const std::string& getDirectory() const { return directory_; }
+
+ private:
+  std::string cacheFilename(const char* prefix, uint64_t key) const;
+  bool writeCacheFile(const std::string& filename,
+                      const void* header,
+                      size_t headerSize,
+                      const void* data,
+                      size_t dataSize) const;
+
+  bool readHull(uint64_t key, std::vector<Magnum::Vector3>& hull) const;
+  void writeHull(uint64_t key, const std::vector<Magnum::Vector3>& hull) const;
+
+  TriangleMeshBvh::ptr loadTriangleMeshBvh(uint64_t key) const;
+  void writeTriangleMeshBvh(uint64_t key, const btOptimizedBvh& bvh) const;
+
+  std::string directory_;
+
+  //! Guards the in-memory caches, objects may be constructed from several
+  //! threads.
+  std::mutex mutex_;
+  std::unordered_map<uint64_t, std::vector<Magnum::Vector3>> hulls_;
+  //! BVHs are only cached while some stage still uses them
+  std::unordered_map<uint64_t, std::weak_ptr<TriangleMeshBvh>> bvhs_;
+
+  ESP_SMART_POINTERS(BulletCollisionCache)
+};
+
+}  // namespace physics
+}  // namespace esp
+
+#endif  // ESP_PHYSICS_BULLET_BULLETCOLLISIONCACHE_H_
@@ -2,7 +2,7 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
-#include "BulletDynamics/Featherstone/btMultiBodyDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h"
 
 #include "BulletDebugManager.h"
 
@@ -20,7 +20,7 @@ void BulletDebugManager::mapCollisionObjectTo(const btCollisionObject* colObj,
 }
 
 int BulletDebugManager::getNumActiveContactPoints(
-    btMultiBodyDynamicsWorld* bWorld) {
+    btDiscreteDynamicsWorld* bWorld) {
   int count = 0;
   auto func = [&](const btCollisionObject*, const btCollisionObject*,
                   const btPersistentManifold* manifold) {
@@ -33,7 +33,7 @@ int BulletDebugManager::getNumActiveContactPoints(
 }
 
 int BulletDebugManager::getNumActiveOverlappingPairs(
-    btMultiBodyDynamicsWorld* bWorld) {
+    btDiscreteDynamicsWorld* bWorld) {
   int count = 0;
   auto func = [&](const btCollisionObject*, const btCollisionObject*,
                   const btPersistentManifold*) { count++; };
@@ -45,7 +45,7 @@ int BulletDebugManager::getNumActiveOverlappingPairs(
 
 template <typename Func>
 void BulletDebugManager::processActiveManifolds(
-    btMultiBodyDynamicsWorld* bWorld,
+    btDiscreteDynamicsWorld* bWorld,
     Func func) {
   auto* dispatcher = bWorld->getDispatcher();
   for (int i = 0; i < dispatcher->getNumManifolds(); i++) {
@@ -92,7 +92,7 @@ std::string BulletDebugManager::getDebugStringForCollisionObject(
 }
 
 std::string BulletDebugManager::getStepCollisionSummary(
-    btMultiBodyDynamicsWorld* bWorld) {
+    btDiscreteDynamicsWorld* bWorld) {
   std::stringstream s;
   auto func = [&](const btCollisionObject* colObj0,
                   const btCollisionObject* colObj1,
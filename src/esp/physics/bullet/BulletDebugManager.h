@@ -8,7 +8,7 @@
 #include <unordered_map>
 
 class btCollisionObject;
-class btMultiBodyDynamicsWorld;
+class btDiscreteDynamicsWorld;
 
 namespace esp {
 namespace physics {
@@ -36,7 +36,7 @@ class BulletDebugManager {
    * count is a proxy for complexity/cost of collision-handling in the current
    * scene. See also getNumActiveOverlappingPairs.
    */
-  int getNumActiveContactPoints(btMultiBodyDynamicsWorld* bWorld);
+  int getNumActiveContactPoints(btDiscreteDynamicsWorld* bWorld);
 
   /**
    * @brief The number of active overlapping pairs during the last step. When
@@ -45,12 +45,12 @@ class BulletDebugManager {
    * complexity/cost of collision-handling in the current scene. See also
    * getNumActiveContactPoints.
    */
-  int getNumActiveOverlappingPairs(btMultiBodyDynamicsWorld* bWorld);
+  int getNumActiveOverlappingPairs(btDiscreteDynamicsWorld* bWorld);
 
   /**
    * @brief Get a summary of collision-processing from the last physics step.
    */
-  std::string getStepCollisionSummary(btMultiBodyDynamicsWorld* bWorld);
+  std::string getStepCollisionSummary(btDiscreteDynamicsWorld* bWorld);
 
   /**
    * @brief Get the object's debug name plus some useful Bullet collision state.
@@ -59,7 +59,7 @@ class BulletDebugManager {
 
  private:
   template <typename Func>
-  void processActiveManifolds(btMultiBodyDynamicsWorld* bWorld, Func func);
+  void processActiveManifolds(btDiscreteDynamicsWorld* bWorld, Func func);
 
   std::unordered_map<const btCollisionObject*, std::string>
       collisionObjectToDebugName_;
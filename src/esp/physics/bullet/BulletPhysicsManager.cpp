@@ -5,6 +5,17 @@
 //#include "BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h"
 //#include "BulletCollision/Gimpact/btGImpactShape.h"
 
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <utility>
+
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#include "BulletDynamics/Featherstone/btMultiBodyConstraintSolver.h"
+#include "BulletDynamics/Featherstone/btMultiBodyDynamicsWorld.h"
+#include "LinearMath/btThreads.h"
+
 #include "BulletPhysicsManager.h"
 #include "BulletRigidObject.h"
 #include "esp/assets/ResourceManager.h"
@@ -12,10 +23,101 @@
 namespace esp {
 namespace physics {
 
+namespace {
+//! Overlapping pairs claimed by a worker at once when dispatching collisions
+//! with several threads.
+constexpr int COLLISION_DISPATCH_GRAIN_SIZE = 40;
+
+/**
+ * @brief Install Bullet's task scheduler with at least @p numThreads threads.
+ * The scheduler is process wide, so it is created once and only ever grown.
+ * @return false if Bullet was built without thread support.
+ */
+bool acquireTaskScheduler(int numThreads) {
+#if BT_THREADSAFE
+  static std::mutex schedulerMutex;
+  static btITaskScheduler* scheduler = nullptr;
+  std::lock_guard<std::mutex> lock(schedulerMutex);
+  if (scheduler == nullptr) {
+    scheduler = btCreateDefaultTaskScheduler();
+    if (scheduler == nullptr) {
+      LOG(WARNING) << "BulletPhysicsManager : no Bullet task scheduler "
+                      "available, stepping with a single thread.";
+      return false;
+    }
+    btSetTaskScheduler(scheduler);
+  }
+  if (scheduler->getNumThreads() < numThreads) {
+    scheduler->setNumThreads(
+        std::min(numThreads, scheduler->getMaxNumThreads()));
+  }
+  return true;
+#else
+  LOG(WARNING) << "BulletPhysicsManager : Bullet was built without "
+                  "BT_THREADSAFE (see BUILD_BULLET_MULTITHREADING), ignoring "
+                  "num_threads = "
+               << numThreads << " and stepping with a single thread.";
+  return false;
+#endif
+}
+
+/**
+ * @brief Multithreaded collision dispatcher with a reproducible manifold
+ * order.
+ *
+ * Workers append the manifolds they create to per-thread arrays, so the
+ * merged order depends on which worker processed which pair, and the
+ * constraint solver's result depends on that order. Sorting by the
+ * broadphase ids of the bodies makes multithreaded stepping deterministic.
+ * Manifolds of the same pair come from one worker and keep their order.
+ */
+class DeterministicCollisionDispatcherMt : public btCollisionDispatcherMt {
+ public:
+  explicit DeterministicCollisionDispatcherMt(
+      btCollisionConfiguration* collisionConfiguration)
+      : btCollisionDispatcherMt(collisionConfiguration,
+                                COLLISION_DISPATCH_GRAIN_SIZE) {}
+
+  void dispatchAllCollisionPairs(btOverlappingPairCache* pairCache,
+                                 const btDispatcherInfo& dispatchInfo,
+                                 btDispatcher* dispatcher) override {
+    btCollisionDispatcherMt::dispatchAllCollisionPairs(pairCache, dispatchInfo,
+                                                       dispatcher);
+    if (m_manifoldsPtr.size() < 2) {
+      return;
+    }
+    btPersistentManifold** begin = &m_manifoldsPtr[0];
+    btPersistentManifold** end = begin + m_manifoldsPtr.size();
+    const auto byBodies = [](const btPersistentManifold* a,
+                             const btPersistentManifold* b) {
+      return bodyIds(a) < bodyIds(b);
+    };
+    if (!std::is_sorted(begin, end, byBodies)) {
+      std::stable_sort(begin, end, byBodies);
+      // used to release manifolds
+      for (int i = 0; i < m_manifoldsPtr.size(); ++i) {
+        m_manifoldsPtr[i]->m_index1a = i;
+      }
+    }
+  }
+
+ private:
+  static std::pair<int, int> bodyIds(const btPersistentManifold* manifold) {
+    const auto broadphaseId = [](const btCollisionObject* object) {
+      const btBroadphaseProxy* proxy = object->getBroadphaseHandle();
+      return proxy != nullptr ? proxy->m_uniqueId : -1;
+    };
+    return {broadphaseId(manifold->getBody0()),
+            broadphaseId(manifold->getBody1())};
+  }
+};
+}  // namespace
+
 BulletPhysicsManager::~BulletPhysicsManager() {
   LOG(INFO) << "Deconstructing BulletPhysicsManager";
 
   existingObjects_.clear();
+  clearObjectPools();
   contactTestObjects_.clear();
   staticStageObject_.reset(nullptr);
 }
@@ -23,17 +125,36 @@ BulletPhysicsManager::~BulletPhysicsManager() {
 bool BulletPhysicsManager::initPhysicsFinalize() {
   activePhysSimLib_ = BULLET;
 
+  const int numThreads = physicsManagerAttributes_->getNumThreads();
+  if (numThreads > 1 && acquireTaskScheduler(numThreads)) {
+    //! Narrowphase pairs and simulation islands are processed in parallel.
+    //! The multithreaded world has no multibody support, which is unused.
+    bDispatcher_ =
+        std::make_unique<DeterministicCollisionDispatcherMt>(&bCollisionConfig_);
+    auto solverPool = std::make_unique<btConstraintSolverPoolMt>(numThreads);
+    bWorld_ = std::make_shared<btDiscreteDynamicsWorldMt>(
+        bDispatcher_.get(), &bBroadphase_, solverPool.get(), nullptr,
+        &bCollisionConfig_);
+    bSolver_ = std::move(solverPool);
+  } else {
+    bDispatcher_ = std::make_unique<btCollisionDispatcher>(&bCollisionConfig_);
+    auto solver = std::make_unique<btMultiBodyConstraintSolver>();
+    bWorld_ = std::make_shared<btMultiBodyDynamicsWorld>(
+        bDispatcher_.get(), &bBroadphase_, solver.get(), &bCollisionConfig_);
+    bSolver_ = std::move(solver);
+  }
   //! We can potentially use other collision checking algorithms, by
   //! uncommenting the line below
-  // btGImpactCollisionAlgorithm::registerAlgorithm(&bDispatcher_);
-  bWorld_ = std::make_shared<btMultiBodyDynamicsWorld>(
-      &bDispatcher_, &bBroadphase_, &bSolver_, &bCollisionConfig_);
+  // btGImpactCollisionAlgorithm::registerAlgorithm(bDispatcher_.get());
 
   debugDrawer_.setMode(
       Magnum::BulletIntegration::DebugDraw::Mode::DrawWireframe |
       Magnum::BulletIntegration::DebugDraw::Mode::DrawConstraints);
   bWorld_->setDebugDrawer(&debugDrawer_);
 
+  collisionCache_ = BulletCollisionCache::create(
+      physicsManagerAttributes_->getCollisionCacheDirectory());
+
   // currently GLB meshes are y-up
   bWorld_->setGravity(btVector3(physicsManagerAttributes_->getVec3("gravity")));
 
@@ -41,7 +162,7 @@ bool BulletPhysicsManager::initPhysicsFinalize() {
   //! Create new scene node
   staticStageObject_ = physics::BulletRigidStage::create_unique(
       &physicsNode_->createChild(), resourceManager_, bWorld_,
-      collisionObjToObjIds_);
+      collisionObjToObjIds_, collisionCache_);
   Corrade::Utility::Debug() << "creating staticStageObject_ .. done";
 
   return true;
@@ -61,7 +182,7 @@ bool BulletPhysicsManager::makeAndAddRigidObject(int newObjectID,
                                                  scene::SceneNode* objectNode) {
   auto ptr = physics::BulletRigidObject::create_unique(
       objectNode, newObjectID, resourceManager_, bWorld_,
-      collisionObjToObjIds_);
+      collisionObjToObjIds_, collisionCache_);
   bool objSuccess = ptr->initialize(handle);
   if (objSuccess) {
     existingObjects_.emplace(newObjectID, std::move(ptr));
@@ -75,7 +196,7 @@ bool BulletPhysicsManager::makeAndAddContactTestRigidObject(
     scene::SceneNode* objectNode) {
   auto ptr = physics::BulletRigidObject::create_unique(
       objectNode, newObjectID, resourceManager_, bWorld_,
-      collisionObjToObjIds_);
+      collisionObjToObjIds_, collisionCache_);
   bool objSuccess = ptr->initialize(handle);
   if (objSuccess) {
     contactTestObjects_.emplace(handle, std::move(ptr));
@@ -120,10 +241,8 @@ bool BulletPhysicsManager::isMeshPrimitiveValid(
 void BulletPhysicsManager::setGravity(const Magnum::Vector3& gravity) {
   bWorld_->setGravity(btVector3(gravity));
   // After gravity change, need to reactive all bullet objects
-  for (std::map<int, physics::RigidObject::uptr>::iterator it =
-           existingObjects_.begin();
-       it != existingObjects_.end(); ++it) {
-    it->second->setActive();
+  for (auto& objectItr : existingObjects_) {
+    objectItr.second->setActive();
   }
 }
 
@@ -140,37 +259,51 @@ void BulletPhysicsManager::stepPhysics(double dt) {
     dt = fixedTimeStep_;
   }
 
-  // set specified control velocities
-  for (auto& objectItr : existingObjects_) {
-    VelocityControl::ptr velControl = objectItr.second->getVelocityControl();
-    if (objectItr.second->getMotionType() == MotionType::KINEMATIC) {
-      // kinematic velocity control intergration
-      if (velControl->controllingAngVel || velControl->controllingLinVel) {
-        objectItr.second->setRigidState(velControl->integrateTransform(
-            dt, objectItr.second->getRigidState()));
-        objectItr.second->setActive();
-      }
-    } else if (objectItr.second->getMotionType() == MotionType::DYNAMIC) {
-      if (velControl->controllingLinVel) {
-        if (velControl->linVelIsLocal) {
-          setLinearVelocity(objectItr.first,
-                            objectItr.second->node().rotation().transformVector(
-                                velControl->linVel));
-        } else {
-          setLinearVelocity(objectItr.first, velControl->linVel);
-        }
-      }
-      if (velControl->controllingAngVel) {
-        if (velControl->angVelIsLocal) {
-          setAngularVelocity(
-              objectItr.first,
-              objectItr.second->node().rotation().transformVector(
-                  velControl->angVel));
-        } else {
-          setAngularVelocity(objectItr.first, velControl->angVel);
-        }
-      }
+  movedObjectIds_.clear();
+
+  // set specified control velocities, only KINEMATIC and DYNAMIC objects can
+  // be controlled
+  for (int index : existingObjects_.getKinematicIndices()) {
+    // kinematic velocity control intergration
+    VelocityControl& velControl =
+        existingObjects_.velocityControlAt(index);
+    if (velControl.controllingAngVel || velControl.controllingLinVel) {
+      RigidObject& object = existingObjects_.objectAt(index);
+      object.setRigidState(
+          velControl.integrateTransform(dt, object.getRigidState()));
+      object.setActive();
+      movedObjectIds_.push_back(existingObjects_.idAt(index));
+    }
+  }
+  for (int index : existingObjects_.getDynamicIndices()) {
+    VelocityControl& velControl =
+        existingObjects_.velocityControlAt(index);
+    if (!velControl.controllingLinVel && !velControl.controllingAngVel) {
+      continue;
+    }
+    RigidObject& object = existingObjects_.objectAt(index);
+    if (velControl.controllingLinVel) {
+      object.setLinearVelocity(
+          velControl.linVelIsLocal
+              ? object.node().rotation().transformVector(velControl.linVel)
+              : velControl.linVel);
     }
+    if (velControl.controllingAngVel) {
+      object.setAngularVelocity(
+          velControl.angVelIsLocal
+              ? object.node().rotation().transformVector(velControl.angVel)
+              : velControl.angVel);
+    }
+  }
+
+  // Bullet doesn't integrate sleeping bodies, so bodies asleep both before
+  // and after the step haven't moved
+  const std::vector<int>& dynamicIndices =
+      existingObjects_.getDynamicIndices();
+  awakeBeforeStep_.resize(dynamicIndices.size());
+  for (size_t i = 0; i < dynamicIndices.size(); ++i) {
+    awakeBeforeStep_[i] =
+        existingObjects_.objectAt(dynamicIndices[i]).isActive();
   }
 
   // ==== Physics stepforward ======
@@ -179,11 +312,15 @@ void BulletPhysicsManager::stepPhysics(double dt) {
       bWorld_->stepSimulation(dt, /*maxSubSteps*/ 10000, fixedTimeStep_);
   worldTime_ += numSubStepsTaken * fixedTimeStep_;
 
-  // Manually sync the motionstates for all DYNAMIC objects. KINEMATIC and
+  // Manually sync the motionstates for all moved DYNAMIC objects, skipping
+  // sleeping ones keeps their scene graph transforms clean. KINEMATIC and
   // STATIC sync should always be one-way.
-  for (auto& objectItr : existingObjects_) {
-    if (objectItr.second->getMotionType() == MotionType::DYNAMIC) {
-      objectItr.second->syncPose(true);
+  for (size_t i = 0; i < dynamicIndices.size(); ++i) {
+    const int index = dynamicIndices[i];
+    RigidObject& object = existingObjects_.objectAt(index);
+    if (awakeBeforeStep_[i] || object.isActive()) {
+      object.syncPose(true);
+      movedObjectIds_.push_back(existingObjects_.idAt(index));
     }
   }
 }
@@ -228,6 +365,14 @@ const Magnum::Range3D BulletPhysicsManager::getCollisionShapeAabb(
       ->getCollisionShapeAabb();
 }
 
+int BulletPhysicsManager::getMaxConvexHullVertices(
+    const int physObjectID) const {
+  assertIDValidity(physObjectID);
+  return static_cast<BulletRigidObject*>(
+             existingObjects_.at(physObjectID).get())
+      ->getMaxConvexHullVertices();
+}
+
 const Magnum::Range3D BulletPhysicsManager::getStageCollisionShapeAabb() const {
   return static_cast<BulletRigidStage*>(staticStageObject_.get())
       ->getCollisionShapeAabb();
@@ -240,7 +385,7 @@ void BulletPhysicsManager::debugDraw(const Magnum::Matrix4& projTrans) const {
 
 bool BulletPhysicsManager::contactTest(const int physObjectID) {
   assertIDValidity(physObjectID);
-  bWorld_->getCollisionWorld()->performDiscreteCollisionDetection();
+  updateContactTestBroadphase();
   return static_cast<BulletRigidObject*>(
              existingObjects_.at(physObjectID).get())
       ->contactTest();
@@ -252,7 +397,7 @@ bool BulletPhysicsManager::preAddContactTest(const std::string& handle,
                                              int collisionFilterGroup,
                                              int collisionFilterMask) {
   Magnum::Quaternion defaultRotation = Magnum::Quaternion{{0.0, 0.0, 0.0}, 1.0};
-  bWorld_->getCollisionWorld()->performDiscreteCollisionDetection();
+  updateContactTestBroadphase();
   return static_cast<BulletRigidObject*>(contactTestObjects_.at(handle).get())
       ->preAddContactTest(translation, collisionObjToObjIds_, isNavigationTest,
                           defaultRotation, collisionFilterGroup,
@@ -264,12 +409,45 @@ bool BulletPhysicsManager::preAddContactTestRotation(
     const Magnum::Vector3& translation,
     const Magnum::Quaternion& rotation,
     const bool isNavigationTest) {
-  bWorld_->getCollisionWorld()->performDiscreteCollisionDetection();
+  updateContactTestBroadphase();
   return static_cast<BulletRigidObject*>(contactTestObjects_.at(handle).get())
       ->preAddContactTest(translation, collisionObjToObjIds_, isNavigationTest,
                           rotation);
 }
 
+std::vector<bool> BulletPhysicsManager::preAddContactTestBatch(
+    const std::string& handle,
+    const std::vector<Magnum::Vector3>& translations,
+    const std::vector<Magnum::Quaternion>& rotations,
+    int collisionFilterGroup,
+    int collisionFilterMask) {
+  if (contactTestObjects_.count(handle) == 0) {
+    LOG(ERROR) << "BulletPhysicsManager::preAddContactTestBatch : no contact "
+                  "test object with handle "
+               << handle << ", aborting.";
+    return std::vector<bool>(translations.size(), false);
+  }
+  updateContactTestBroadphase();
+  return static_cast<BulletRigidObject*>(contactTestObjects_.at(handle).get())
+      ->preAddContactTestBatch(translations, rotations, collisionFilterGroup,
+                               collisionFilterMask);
+}
+
+void BulletPhysicsManager::updateContactTestBroadphase() {
+  bWorld_->updateAabbs();
+}
+
+core::ThreadPool& BulletPhysicsManager::threadPool() {
+  const int numThreads = physicsManagerAttributes_->getNumThreads();
+  if (numThreads <= 0) {
+    return core::ThreadPool::shared();
+  }
+  if (!threadPool_) {
+    threadPool_ = std::make_unique<core::ThreadPool>(numThreads);
+  }
+  return *threadPool_;
+}
+
 RaycastResults BulletPhysicsManager::castRay(const esp::geo::Ray& ray,
                                              double maxDistance) {
   RaycastResults results;
@@ -306,6 +484,117 @@ RaycastResults BulletPhysicsManager::castRay(const esp::geo::Ray& ray,
   return results;
 }
 
+namespace {
+//! Rays claimed by a worker at once in @ref BulletPhysicsManager::castRays.
+constexpr size_t RAY_BATCH_GRAIN_SIZE = 32;
+
+/**
+ * @brief Broadphase leaf visitor narrowing one ray against each candidate
+ * collision object. Equivalent to btCollisionWorld's internal single ray
+ * callback, but driven by @ref btDbvt::rayTestInternal with a caller-owned
+ * stack so several rays can be traversed concurrently.
+ */
+struct BroadphaseRayTester : btDbvt::ICollide {
+  BroadphaseRayTester(const btTransform& rayFromTrans,
+                      const btTransform& rayToTrans,
+                      btCollisionWorld::RayResultCallback& resultCallback)
+      : rayFromTrans_(rayFromTrans),
+        rayToTrans_(rayToTrans),
+        resultCallback_(resultCallback) {}
+
+  void Process(const btDbvtNode* leaf) {
+    auto* proxy = static_cast<btBroadphaseProxy*>(leaf->data);
+    if (!resultCallback_.needsCollision(proxy)) {
+      return;
+    }
+    auto* collisionObject =
+        static_cast<btCollisionObject*>(proxy->m_clientObject);
+    btCollisionWorld::rayTestSingle(
+        rayFromTrans_, rayToTrans_, collisionObject,
+        collisionObject->getCollisionShape(),
+        collisionObject->getWorldTransform(), resultCallback_);
+  }
+
+  const btTransform& rayFromTrans_;
+  const btTransform& rayToTrans_;
+  btCollisionWorld::RayResultCallback& resultCallback_;
+};
+}  // namespace
+
+bool BulletPhysicsManager::castRays(
+    const Eigen::Ref<const Eigen::RowMatrixXf>& origins,
+    const Eigen::Ref<const Eigen::RowMatrixXf>& directions,
+    double maxDistance,
+    Eigen::Ref<Eigen::VectorXf> hitDistances,
+    Eigen::Ref<Eigen::RowMatrixXf> hitNormals,
+    Eigen::Ref<Eigen::VectorXi> hitObjectIds) {
+  if (!checkRayBatch("BulletPhysicsManager::castRays", origins, directions,
+                     hitDistances, hitNormals, hitObjectIds)) {
+    return false;
+  }
+  core::ThreadPool& pool = threadPool();
+  rayTestStacks_.resize(pool.numThreads());
+
+  const btDbvt* broadphaseSets[] = {&bBroadphase_.m_sets[0],
+                                    &bBroadphase_.m_sets[1]};
+  const std::map<const btCollisionObject*, int>& objIds =
+      *collisionObjToObjIds_;
+
+  pool.parallelFor(
+      origins.rows(),
+      [&](int workerIndex, size_t i) {
+        const btVector3 from(origins(i, 0), origins(i, 1), origins(i, 2));
+        const btVector3 direction(directions(i, 0), directions(i, 1),
+                                  directions(i, 2));
+        const btScalar rayLength = direction.length();
+        hitDistances[i] = std::numeric_limits<float>::infinity();
+        hitNormals.row(i).setZero();
+        hitObjectIds[i] = ID_UNDEFINED;
+        if (rayLength == 0) {
+          return;
+        }
+        const btVector3 to = from + direction * maxDistance;
+
+        btCollisionWorld::ClosestRayResultCallback closestHit(from, to);
+        btTransform rayFromTrans, rayToTrans;
+        rayFromTrans.setIdentity();
+        rayFromTrans.setOrigin(from);
+        rayToTrans.setIdentity();
+        rayToTrans.setOrigin(to);
+        BroadphaseRayTester tester(rayFromTrans, rayToTrans, closestHit);
+
+        // same ray setup as btDbvtBroadphase::rayTest
+        const btVector3 rayDir = direction / rayLength;
+        const btVector3 rayDirectionInverse(
+            rayDir[0] == btScalar(0.0) ? BT_LARGE_FLOAT : 1 / rayDir[0],
+            rayDir[1] == btScalar(0.0) ? BT_LARGE_FLOAT : 1 / rayDir[1],
+            rayDir[2] == btScalar(0.0) ? BT_LARGE_FLOAT : 1 / rayDir[2]);
+        unsigned int signs[3] = {rayDirectionInverse[0] < 0.0,
+                                 rayDirectionInverse[1] < 0.0,
+                                 rayDirectionInverse[2] < 0.0};
+        const btScalar lambdaMax = rayDir.dot(to - from);
+        const btVector3 zero(0, 0, 0);
+        for (const btDbvt* set : broadphaseSets) {
+          set->rayTestInternal(set->m_root, from, to, rayDirectionInverse,
+                               signs, lambdaMax, zero, zero,
+                               rayTestStacks_[workerIndex], tester);
+        }
+
+        if (closestHit.hasHit()) {
+          hitDistances[i] =
+              (closestHit.m_closestHitFraction * maxDistance) / rayLength;
+          const btVector3& normal = closestHit.m_hitNormalWorld;
+          hitNormals.row(i) << normal[0], normal[1], normal[2];
+          // default to -1 for "scene collision" if we don't know which object
+          // was involved
+          auto objIdIter = objIds.find(closestHit.m_collisionObject);
+          hitObjectIds[i] = objIdIter != objIds.end() ? objIdIter->second : -1;
+        }
+      },
+      RAY_BATCH_GRAIN_SIZE);
+  return true;
+}
+
 int BulletPhysicsManager::getNumActiveContactPoints() {
   int pointCount = 0;
   auto* dispatcher = bWorld_->getDispatcher();
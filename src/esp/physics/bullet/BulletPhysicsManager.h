@@ -15,12 +15,11 @@
 #include <Magnum/BulletIntegration/MotionState.h>
 #include <btBulletDynamicsCommon.h>
 
-#include "BulletDynamics/Featherstone/btMultiBodyConstraintSolver.h"
-#include "BulletDynamics/Featherstone/btMultiBodyDynamicsWorld.h"
-
+#include "BulletCollisionCache.h"
 #include "BulletDebugManager.h"
 #include "BulletRigidObject.h"
 #include "BulletRigidStage.h"
+#include "esp/core/ThreadPool.h"
 #include "esp/physics/PhysicsManager.h"
 #include "esp/physics/bullet/BulletRigidObject.h"
 
@@ -31,7 +30,9 @@ namespace physics {
 @brief Dynamic stage and object manager interfacing with Bullet physics
 engine: https://github.com/bulletphysics/bullet3.
 
-See @ref btMultiBodyDynamicsWorld.
+See @ref btMultiBodyDynamicsWorld, or @ref btDiscreteDynamicsWorldMt if
+@ref metadata::attributes::PhysicsManagerAttributes::getNumThreads requests
+more than one thread.
 
 Enables @ref RigidObject simulation with @ref MotionType::DYNAMIC.
 
@@ -66,7 +67,7 @@ class BulletPhysicsManager : public PhysicsManager {
 
   /** @brief Step the physical world forward in time. Time may only advance in
    * increments of @ref fixedTimeStep_. See @ref
-   * btMultiBodyDynamicsWorld::stepSimulation.
+   * btDiscreteDynamicsWorld::stepSimulation.
    * @param dt The desired amount of time to advance the physical world.
    */
   void stepPhysics(double dt) override;
@@ -146,6 +147,15 @@ class BulletPhysicsManager : public PhysicsManager {
    */
   const Magnum::Range3D getCollisionShapeAabb(const int physObjectID) const;
 
+  /**
+   * @brief Query the largest vertex count of the convex hull shapes of a
+   * rigid body. See @ref BulletRigidObject::getMaxConvexHullVertices.
+   * @param physObjectID The object ID and key identifying the object in @ref
+   * PhysicsManager::existingObjects_.
+   * @return The vertex count.
+   */
+  int getMaxConvexHullVertices(const int physObjectID) const;
+
   /**
    * @brief Query the Aabb from bullet physics for the root compound shape of
    * the static stage in its local space. See @ref btCompoundShape::getAabb.
@@ -183,6 +193,13 @@ class BulletPhysicsManager : public PhysicsManager {
                                  const Magnum::Quaternion& rotation,
                                  const bool isNavigationTest = false) override;
 
+  std::vector<bool> preAddContactTestBatch(
+      const std::string& handle,
+      const std::vector<Magnum::Vector3>& translations,
+      const std::vector<Magnum::Quaternion>& rotations = {},
+      int collisionFilterGroup = 1,
+      int collisionFilterMask = -1) override;
+
   /**
    * @brief Cast a ray into the collision world and return a @ref RaycastResults
    * with hit information.
@@ -196,6 +213,21 @@ class BulletPhysicsManager : public PhysicsManager {
   virtual RaycastResults castRay(const esp::geo::Ray& ray,
                                  double maxDistance = 100.0) override;
 
+  /**
+   * @brief Cast a batch of rays and write the closest hit of each into
+   * preallocated output arrays. See @ref PhysicsManager::castRays.
+   *
+   * Rays are spread across @ref threadPool. Each worker traverses the
+   * broadphase trees with its own stack and narrows the ray against candidate
+   * objects with a closest-hit callback, so no results are buffered per hit.
+   */
+  bool castRays(const Eigen::Ref<const Eigen::RowMatrixXf>& origins,
+                const Eigen::Ref<const Eigen::RowMatrixXf>& directions,
+                double maxDistance,
+                Eigen::Ref<Eigen::VectorXf> hitDistances,
+                Eigen::Ref<Eigen::RowMatrixXf> hitNormals,
+                Eigen::Ref<Eigen::VectorXi> hitObjectIds) override;
+
   // The number of contact points that were active during the last step. An
   // object resting on another object will involve several active contact
   // points. Once both objects are asleep, the contact points are inactive. This
@@ -255,14 +287,30 @@ class BulletPhysicsManager : public PhysicsManager {
 
   void setActiveState(const int physObjectID) const;
 
+  /** @brief Bring the broadphase bounds of all collision objects up to date
+   * so that contact tests only need to narrowphase against the pairs
+   * overlapping the queried shape, instead of running collision detection
+   * over the whole world. See @ref btCollisionWorld::updateAabbs.
+   */
+  void updateContactTestBroadphase();
+
+  /** @brief The pool running batched queries, with as many workers as
+   * @ref metadata::attributes::PhysicsManagerAttributes::getNumThreads.
+   * Values <= 0 use @ref core::ThreadPool::shared().
+   */
+  core::ThreadPool& threadPool();
+
   btDbvtBroadphase bBroadphase_;
   btDefaultCollisionConfiguration bCollisionConfig_;
 
-  btMultiBodyConstraintSolver bSolver_;
-  btCollisionDispatcher bDispatcher_{&bCollisionConfig_};
+  //! Created with the world in @ref initPhysicsFinalize, multithreaded
+  //! variants if more than one thread was requested.
+  std::unique_ptr<btConstraintSolver> bSolver_;
+  std::unique_ptr<btCollisionDispatcher> bDispatcher_;
 
-  /** @brief A pointer to the Bullet world. See @ref btMultiBodyDynamicsWorld.*/
-  std::shared_ptr<btMultiBodyDynamicsWorld> bWorld_;
+  /** @brief A pointer to the Bullet world. A @ref btMultiBodyDynamicsWorld,
+   * or a @ref btDiscreteDynamicsWorldMt when stepping with several threads.*/
+  std::shared_ptr<btDiscreteDynamicsWorld> bWorld_;
 
   mutable Magnum::BulletIntegration::DebugDraw debugDrawer_;
 
@@ -271,6 +319,23 @@ class BulletPhysicsManager : public PhysicsManager {
   std::shared_ptr<std::map<const btCollisionObject*, int>>
       collisionObjToObjIds_;
 
+  //! Reduced collision hulls shared by all objects, see @ref
+  //! BulletCollisionCache.
+  BulletCollisionCache::ptr collisionCache_;
+
+  //! Workers for batched queries, created on first use unless using the
+  //! shared pool. See @ref threadPool.
+  std::unique_ptr<core::ThreadPool> threadPool_;
+
+  //! Per-worker broadphase traversal stacks, reused across @ref castRays
+  //! calls.
+  std::vector<btAlignedObjectArray<const btDbvtNode*>> rayTestStacks_;
+
+  //! Whether each DYNAMIC object was awake before the current step, parallel
+  //! to the dynamic subset of @ref existingObjects_. Reused across @ref
+  //! stepPhysics calls.
+  std::vector<char> awakeBeforeStep_;
+
  private:
   /** @brief Check if a particular mesh can be used as a collision mesh for
    * Bullet.
@@ -7,6 +7,7 @@
 
 #include <Corrade/Utility/Assert.h>
 
+#include <algorithm>
 #include <utility>
 
 #include "BulletCollision/CollisionShapes/btCompoundShape.h"
@@ -37,12 +38,14 @@ BulletRigidObject::BulletRigidObject(
     scene::SceneNode* rigidBodyNode,
     int objectId,
     const assets::ResourceManager& resMgr,
-    std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
+    std::shared_ptr<btDiscreteDynamicsWorld> bWorld,
     std::shared_ptr<std::map<const btCollisionObject*, int> >
-        collisionObjToObjIds)
+        collisionObjToObjIds,
+    BulletCollisionCache::ptr collisionCache)
     : BulletBase(std::move(bWorld), std::move(collisionObjToObjIds)),
       RigidObject(rigidBodyNode, objectId, resMgr),
-      MotionState(*rigidBodyNode) {}
+      MotionState(*rigidBodyNode),
+      collisionCache_(std::move(collisionCache)) {}
 
 BulletRigidObject::~BulletRigidObject() {
   if (!isActive()) {
@@ -124,11 +127,14 @@ bool BulletRigidObject::constructCollisionShape() {
         resMgr_.getMeshMetaData(collisionAssetHandle);
 
     if (!usingBBCollisionShape_) {
+      std::vector<Magnum::Vector3> joinedPoints;
       constructBulletCompoundFromMeshes(Magnum::Matrix4{}, meshGroup,
-                                        metaData.root, joinCollisionMeshes);
+                                        metaData.root, joinCollisionMeshes,
+                                        joinedPoints);
 
       // add the final object after joining meshes
       if (joinCollisionMeshes) {
+        addConvexHullShape(joinedPoints);
         bObjectConvexShapes_.back()->setLocalScaling(
             btVector3(tmpAttr->getCollisionAssetSize()));
         bObjectConvexShapes_.back()->setMargin(0.0);
@@ -226,7 +232,8 @@ void BulletRigidObject::constructBulletCompoundFromMeshes(
     const Magnum::Matrix4& transformFromParentToWorld,
     const std::vector<assets::CollisionMeshData>& meshGroup,
     const assets::MeshTransformNode& node,
-    bool join) {
+    bool join,
+    std::vector<Magnum::Vector3>& joinedPoints) {
   Magnum::Matrix4 transformFromLocalToWorld =
       transformFromParentToWorld * node.transformFromLocalToParent;
   if (node.meshIDLocal != ID_UNDEFINED) {
@@ -236,45 +243,53 @@ void BulletRigidObject::constructBulletCompoundFromMeshes(
 
     if (join) {
       // add all points to a single convex instead of compounding (more
-      // stable)
-      if (bObjectConvexShapes_.empty()) {
-        // create the convex if it does not exist
-        bObjectConvexShapes_.emplace_back(
-            std::make_unique<btConvexHullShape>());
-      }
-
-      // add points
+      // stable), the hull is built once the recursion is done
       for (auto& v : mesh.positions) {
-        bObjectConvexShapes_.back()->addPoint(
-            btVector3(transformFromLocalToWorld.transformPoint(v)), false);
+        joinedPoints.push_back(transformFromLocalToWorld.transformPoint(v));
       }
 
     } else {
-      bObjectConvexShapes_.emplace_back(std::make_unique<btConvexHullShape>());
       // transform points into world space, including any scale/shear in
       // transformFromLocalToWorld.
+      std::vector<Magnum::Vector3> points;
+      points.reserve(mesh.positions.size());
       for (auto& v : mesh.positions) {
-        bObjectConvexShapes_.back()->addPoint(
-            btVector3(transformFromLocalToWorld.transformPoint(v)), false);
+        points.push_back(transformFromLocalToWorld.transformPoint(v));
       }
-      // bObjectConvexShapes_.back()->optimizeConvexHull();
-      // bObjectConvexShapes_.back()->initializePolyhedralFeatures();
+      btConvexHullShape* hullShape = addConvexHullShape(points);
       // Remove local convex margin in favor of margin on the containing
       // compound
-      bObjectConvexShapes_.back()->setMargin(0.0);
-      bObjectConvexShapes_.back()->recalcLocalAabb();
+      hullShape->setMargin(0.0);
+      hullShape->recalcLocalAabb();
       //! Add to compound shape stucture
-      bObjectShape_->addChildShape(btTransform::getIdentity(),
-                                   bObjectConvexShapes_.back().get());
+      bObjectShape_->addChildShape(btTransform::getIdentity(), hullShape);
     }
   }
 
   for (auto& child : node.children) {
     constructBulletCompoundFromMeshes(transformFromLocalToWorld, meshGroup,
-                                      child, join);
+                                      child, join, joinedPoints);
   }
 }  // constructBulletCompoundFromMeshes
 
+btConvexHullShape* BulletRigidObject::addConvexHullShape(
+    const std::vector<Magnum::Vector3>& points) {
+  const int maxVertices =
+      getInitializationAttributes()->getCollisionHullMaxVertices();
+  const std::vector<Magnum::Vector3> hull =
+      collisionCache_ ? collisionCache_->getConvexHull(points, maxVertices)
+                      : BulletCollisionCache::reduceConvexHull(points,
+                                                               maxVertices);
+
+  bObjectConvexShapes_.emplace_back(std::make_unique<btConvexHullShape>());
+  btConvexHullShape* hullShape = bObjectConvexShapes_.back().get();
+  for (const Magnum::Vector3& v : hull) {
+    hullShape->addPoint(btVector3(v), false);
+  }
+  hullShape->recalcLocalAabb();
+  return hullShape;
+}  // addConvexHullShape
+
 void BulletRigidObject::setCollisionFromBB() {
   btVector3 dim(node().getCumulativeBB().size() / 2.0);
 
@@ -322,6 +337,82 @@ bool BulletRigidObject::setMotionType(MotionType mt) {
   return true;
 }  // setMotionType
 
+void BulletRigidObject::saveState(RigidObjectState& state) const {
+  RigidObject::saveState(state);
+  state.activationState = bObjectRigidBody_->getActivationState();
+  state.deactivationTime = bObjectRigidBody_->getDeactivationTime();
+}
+
+void BulletRigidObject::restoreState(const RigidObjectState& state) {
+  // re-creates the body only if the motion type changed
+  RigidObject::restoreState(state);
+  syncPose();
+
+  btRigidBody& body = *bObjectRigidBody_;
+  body.setInterpolationWorldTransform(body.getWorldTransform());
+  body.setLinearVelocity(btVector3(state.linearVelocity));
+  body.setAngularVelocity(btVector3(state.angularVelocity));
+  body.setInterpolationLinearVelocity(body.getLinearVelocity());
+  body.setInterpolationAngularVelocity(body.getAngularVelocity());
+  body.clearForces();
+  body.forceActivationState(state.activationState);
+  body.setDeactivationTime(state.deactivationTime);
+
+  if (body.getBroadphaseHandle() != nullptr) {
+    bWorld_->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(
+        body.getBroadphaseHandle(), bWorld_->getDispatcher());
+    bWorld_->updateSingleAabb(&body);
+  }
+}
+
+void BulletRigidObject::releaseToPool() {
+  RigidObject::releaseToPool();
+  if (!isActive()) {
+    // This object may be supporting other sleeping objects, so wake them before
+    // removing.
+    activateCollisionIsland();
+  }
+  bWorld_->removeRigidBody(bObjectRigidBody_.get());
+}
+
+void BulletRigidObject::reuseFromPool_LibSpecific() {
+  auto tmpAttr = getInitializationAttributes();
+  const double margin = tmpAttr->getMargin();
+  if (bObjectShape_ != nullptr && getMargin() != margin) {
+    setMargin(margin);
+  }
+  if (objectMotionType_ != MotionType::DYNAMIC ||
+      isCollidable_ != tmpAttr->getIsCollidable()) {
+    // the previous user changed how the body is built, so build a new one
+    collisionObjToObjIds_->erase(bObjectRigidBody_.get());
+    bObjectRigidBody_.reset();
+    initialization_LibSpecific();
+    return;
+  }
+
+  // keep the pooled body, restoring what the previous user may have changed
+  btRigidBody& body = *bObjectRigidBody_;
+  const double mass = tmpAttr->getMass();
+  body.setMassProps(mass, computeInertia(mass));
+  body.updateInertiaTensor();
+  body.setFriction(tmpAttr->getFrictionCoefficient());
+  body.setRestitution(tmpAttr->getRestitutionCoefficient());
+  body.setDamping(tmpAttr->getLinearDamping(), tmpAttr->getAngularDamping());
+
+  body.setWorldTransform(btTransform(node().transformationMatrix()));
+  body.setInterpolationWorldTransform(body.getWorldTransform());
+  body.setLinearVelocity(btVector3(0, 0, 0));
+  body.setAngularVelocity(btVector3(0, 0, 0));
+  body.setInterpolationLinearVelocity(btVector3(0, 0, 0));
+  body.setInterpolationAngularVelocity(btVector3(0, 0, 0));
+  body.clearForces();
+  body.forceActivationState(ACTIVE_TAG);
+  body.setDeactivationTime(0);
+
+  (*collisionObjToObjIds_)[&body] = objectId_;
+  bWorld_->addRigidBody(&body);
+}
+
 bool BulletRigidObject::setCollidable(bool collidable) {
   if (collidable == isCollidable_) {
     // no work
@@ -377,6 +468,21 @@ void BulletRigidObject::syncPose(bool from) {
   }
 }  // syncPose
 
+btVector3 BulletRigidObject::computeInertia(double mass) const {
+  btVector3 bInertia(getInitializationAttributes()->getInertia());
+  if (bInertia == btVector3{0, 0, 0}) {
+    if (bObjectShape_ != nullptr) {
+      // allow bullet to compute the inertia tensor if we don't have one
+      bObjectShape_->calculateLocalInertia(mass,
+                                           bInertia);  // overrides bInertia
+    } else {
+      // TODO: better default given object information?
+      bInertia = btVector3(1.0, 1.0, 1.0);
+    }
+  }
+  return bInertia;
+}
+
 void BulletRigidObject::constructAndAddRigidBody(MotionType mt) {
   // get this object's creation template, appropriately cast
   auto tmpAttr = getInitializationAttributes();
@@ -389,17 +495,7 @@ void BulletRigidObject::constructAndAddRigidBody(MotionType mt) {
   btVector3 bInertia = {0, 0, 0};
   if (mt == MotionType::DYNAMIC) {
     mass = tmpAttr->getMass();
-    bInertia = btVector3(tmpAttr->getInertia());
-    if (bInertia == btVector3{0, 0, 0}) {
-      if (bObjectShape_ != nullptr) {
-        // allow bullet to compute the inertia tensor if we don't have one
-        bObjectShape_->calculateLocalInertia(mass,
-                                             bInertia);  // overrides bInertia
-      } else {
-        // TODO: better default given object information?
-        bInertia = btVector3(1.0, 1.0, 1.0);
-      }
-    }
+    bInertia = computeInertia(mass);
   }
 
   //! Bullet rigid body setup
@@ -527,19 +623,42 @@ bool BulletRigidObject::preAddContactTest(
     const Magnum::Quaternion& rotation,
     int collisionFilterGroup,
     int collisionFilterMask) {
-  auto rotationMatrix = rotation.toMatrix();
-  auto transformationMatrix =
-      Magnum::Matrix4::from(rotationMatrix, translation);
-  std::unique_ptr<btCollisionObject> colObj =
-      std::make_unique<btCollisionObject>();
-  colObj->setCollisionShape(bObjectRigidBody_->getCollisionShape());
-  colObj->setWorldTransform(btTransform(transformationMatrix));
-
-  PreAddSimulationContactResultCallback src;
-  src.m_collisionFilterGroup = collisionFilterGroup;
-  src.m_collisionFilterMask = collisionFilterMask;
-  bWorld_->getCollisionWorld()->contactTest(colObj.get(), src);
-  return src.bCollision;
+  return preAddContactTestBatch({translation}, {rotation}, collisionFilterGroup,
+                                collisionFilterMask)
+      .front();
+}
+
+std::vector<bool> BulletRigidObject::preAddContactTestBatch(
+    const std::vector<Magnum::Vector3>& translations,
+    const std::vector<Magnum::Quaternion>& rotations,
+    int collisionFilterGroup,
+    int collisionFilterMask) {
+  std::vector<bool> inContact(translations.size(), false);
+  if (!rotations.empty() && rotations.size() != translations.size()) {
+    LOG(ERROR) << "BulletRigidObject::preAddContactTestBatch : got "
+               << rotations.size() << " rotations for " << translations.size()
+               << " translations, aborting.";
+    return inContact;
+  }
+
+  // one probe object is moved through all candidates; contactTest only
+  // narrowphases against the broadphase overlaps of its current bounds
+  btCollisionObject colObj;
+  colObj.setCollisionShape(bObjectRigidBody_->getCollisionShape());
+  for (size_t i = 0; i < translations.size(); ++i) {
+    const Magnum::Matrix3x3 rotationMatrix =
+        rotations.empty() ? Magnum::Matrix3x3{Magnum::Math::IdentityInit}
+                          : rotations[i].toMatrix();
+    colObj.setWorldTransform(
+        btTransform(Magnum::Matrix4::from(rotationMatrix, translations[i])));
+
+    PreAddSimulationContactResultCallback src;
+    src.m_collisionFilterGroup = collisionFilterGroup;
+    src.m_collisionFilterMask = collisionFilterMask;
+    bWorld_->getCollisionWorld()->contactTest(&colObj, src);
+    inContact[i] = src.bCollision;
+  }
+  return inContact;
 }
 
 const Magnum::Range3D BulletRigidObject::getCollisionShapeAabb() const {
@@ -554,6 +673,14 @@ const Magnum::Range3D BulletRigidObject::getCollisionShapeAabb() const {
                          Magnum::Vector3{localAabbMax}};
 }  // getCollisionShapeAabb
 
+int BulletRigidObject::getMaxConvexHullVertices() const {
+  int maxVertices = 0;
+  for (const auto& hullShape : bObjectConvexShapes_) {
+    maxVertices = std::max(maxVertices, hullShape->getNumPoints());
+  }
+  return maxVertices;
+}  // getMaxConvexHullVertices
+
 bool BulletRigidObject::isMe(const btCollisionObject* collisionObject) {
   for (auto& sceneObj : bStaticCollisionObjects_) {
     if (sceneObj.get() == collisionObject) {
@@ -16,12 +16,13 @@
 #include <Magnum/BulletIntegration/MotionState.h>
 #include <btBulletDynamicsCommon.h>
 
-#include "BulletDynamics/Featherstone/btMultiBodyDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h"
 
 #include "esp/core/esp.h"
 
 #include "esp/physics/RigidObject.h"
 #include "esp/physics/bullet/BulletBase.h"
+#include "esp/physics/bullet/BulletCollisionCache.h"
 
 namespace esp {
 namespace physics {
@@ -48,13 +49,16 @@ class BulletRigidObject : public BulletBase,
    * @param bWorld The Bullet world to which this object will belong.
    * @param collisionObjToObjIds The global map of btCollisionObjects to Habitat
    * object IDs for contact query identification.
+   * @param collisionCache Cache of reduced convex hulls shared by all objects
+   * of the world. If nullptr, hulls are rebuilt for every object.
    */
   BulletRigidObject(scene::SceneNode* rigidBodyNode,
                     int objectId,
                     const assets::ResourceManager& resMgr,
-                    std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
+                    std::shared_ptr<btDiscreteDynamicsWorld> bWorld,
                     std::shared_ptr<std::map<const btCollisionObject*, int>>
-                        collisionObjToObjIds);
+                        collisionObjToObjIds,
+                    BulletCollisionCache::ptr collisionCache = nullptr);
 
   /**
    * @brief Destructor cleans up simulation structures for the object.
@@ -92,12 +96,24 @@ class BulletRigidObject : public BulletBase,
    * @param node The current @ref MeshTransformNode in the recursion.
    * @param join Whether or not to join sub-meshes into a single con convex
    * shape, rather than creating individual convexes under the compound.
+   * @param[out] joinedPoints Accumulates the transformed points of all
+   * sub-meshes if @p join is true.
    */
   void constructBulletCompoundFromMeshes(
       const Magnum::Matrix4& transformFromParentToWorld,
       const std::vector<assets::CollisionMeshData>& meshGroup,
       const assets::MeshTransformNode& node,
-      bool join);
+      bool join,
+      std::vector<Magnum::Vector3>& joinedPoints);
+
+  /**
+   * @brief Build a convex hull shape from points, reduced to the vertex budget
+   * of this object's template. See @ref BulletCollisionCache::getConvexHull.
+   * @param points The hull's input points in object-local space.
+   * @return The hull shape, appended to @ref bObjectConvexShapes_.
+   */
+  btConvexHullShape* addConvexHullShape(
+      const std::vector<Magnum::Vector3>& points);
 
   /**
    * @brief Construct the @ref bObjectShape_ for this object.
@@ -129,6 +145,27 @@ class BulletRigidObject : public BulletBase,
    */
   bool setMotionType(MotionType mt) override;
 
+  /**
+   * @brief Capture the dynamic state of the object including its sleeping
+   * state. See @ref btCollisionObject::getActivationState.
+   * @param[out] state The captured state.
+   */
+  void saveState(RigidObjectState& state) const override;
+
+  /**
+   * @brief Restore a state captured by @ref saveState onto the existing @ref
+   * btRigidBody. Contact manifolds of the body are dropped, so rollouts from
+   * the same state don't warm start from different futures.
+   * @param state The state to restore.
+   */
+  void restoreState(const RigidObjectState& state) override;
+
+  /**
+   * @brief Hide the object and remove its @ref btRigidBody from the world,
+   * waking any objects it supported. Its collision shape is kept for reuse.
+   */
+  void releaseToPool() override;
+
   /**
    * Set the object to be collidable or not by selectively adding or remove the
    * @ref bObjectShape_ from the @ref bRigidObject_.
@@ -442,6 +479,24 @@ class BulletRigidObject : public BulletBase,
       int collisionFilterGroup = 1,
       int collisionFilterMask = -1);
 
+  /**
+   * @brief Test this object's collision shape at several candidate
+   * transformations against the collision world without adding it.
+   *
+   * Only objects whose broadphase bounds overlap a candidate are handed to
+   * the narrowphase, so the caller is responsible for the world's bounds
+   * being current. See @ref btCollisionWorld::updateAabbs.
+   * @param translations The candidate translations.
+   * @param rotations The candidate rotations, either one per translation or
+   * empty for identity rotations.
+   * @return One bit per candidate, set if that candidate is in contact.
+   */
+  std::vector<bool> preAddContactTestBatch(
+      const std::vector<Magnum::Vector3>& translations,
+      const std::vector<Magnum::Quaternion>& rotations,
+      int collisionFilterGroup = 1,
+      int collisionFilterMask = -1);
+
   /**
    * @brief Query the Aabb from bullet physics for the root compound shape of
    * the rigid body in its local space. See @ref btCompoundShape::getAabb.
@@ -449,6 +504,13 @@ class BulletRigidObject : public BulletBase,
    */
   const Magnum::Range3D getCollisionShapeAabb() const override;
 
+  /**
+   * @brief Query the largest vertex count of the convex hull shapes built
+   * from the collision mesh. See @ref addConvexHullShape.
+   * @return The vertex count, 0 if the object has no convex hull shapes.
+   */
+  int getMaxConvexHullVertices() const;
+
   bool isMe(const btCollisionObject* collisionObject);
 
   std::string getCollisionDebugName();
@@ -482,6 +544,19 @@ class BulletRigidObject : public BulletBase,
    */
   void constructAndAddRigidBody(MotionType mt);
 
+  /**
+   * @brief The inertia of the @ref btRigidBody for @p mass, from the template
+   * or else computed from the collision shape.
+   */
+  btVector3 computeInertia(double mass) const;
+
+  /**
+   * @brief Reset the pooled @ref btRigidBody to the template's properties,
+   * at rest at the node's transform, and add it back to the world. The body is
+   * only rebuilt if its @ref MotionType or collidability was changed.
+   */
+  void reuseFromPool_LibSpecific() override;
+
   /**
    * @brief shift all child shapes of the @ref bObjectShape_ to modify collision
    * shape origin.
@@ -507,6 +582,9 @@ class BulletRigidObject : public BulletBase,
   //! Object data: Composite convex collision shape
   std::vector<std::unique_ptr<btConvexHullShape>> bObjectConvexShapes_;
 
+  //! Shared cache of reduced convex hulls, may be nullptr
+  BulletCollisionCache::ptr collisionCache_;
+
   //! list of @ref btCollisionShape for storing arbitrary collision shapes
   //! referenced within the @ref bObjectShape_.
   std::vector<std::unique_ptr<btCollisionShape>> bGenericShapes_;
@@ -21,11 +21,13 @@ namespace physics {
 BulletRigidStage::BulletRigidStage(
     scene::SceneNode* rigidBodyNode,
     const assets::ResourceManager& resMgr,
-    std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
+    std::shared_ptr<btDiscreteDynamicsWorld> bWorld,
     std::shared_ptr<std::map<const btCollisionObject*, int> >
-        collisionObjToObjIds)
+        collisionObjToObjIds,
+    BulletCollisionCache::ptr collisionCache)
     : BulletBase(std::move(bWorld), std::move(collisionObjToObjIds)),
-      RigidStage{rigidBodyNode, resMgr} {}
+      RigidStage{rigidBodyNode, resMgr},
+      collisionCache_(std::move(collisionCache)) {}
 
 BulletRigidStage::~BulletRigidStage() {
   // remove collision objects from the world
@@ -130,16 +132,27 @@ void BulletRigidStage::constructBulletSceneFromMeshes(
     //! Embed 3D mesh into bullet shape
     //! btBvhTriangleMeshShape is the most generic/slow choice
     //! which allows concavity if the object is static
+    //! The BVH is built once below, after margin and scaling are final
     std::unique_ptr<btBvhTriangleMeshShape> meshShape =
         std::make_unique<btBvhTriangleMeshShape>(indexedVertexArray.get(),
-                                                 true);
+                                                 true, false);
     meshShape->setMargin(initializationAttributes_->getMargin());
-    meshShape->setLocalScaling(
-        btVector3{transformFromLocalToWorld
-                      .scaling()});  // scale is a property of the shape
-
-    // re-build the bvh after setting margin
-    meshShape->buildOptimizedBvh();
+    // scale is a property of the shape, set it without rebuilding the BVH
+    const btVector3 scaling{transformFromLocalToWorld.scaling()};
+    meshShape->btTriangleMeshShape::setLocalScaling(scaling);
+    if (collisionCache_) {
+      uint64_t meshHash = BulletCollisionCache::hashBytes(
+          v_data.data(), v_data.size() * sizeof(Magnum::Vector3));
+      meshHash = BulletCollisionCache::hashBytes(
+          ui_data.data(), ui_data.size() * sizeof(Magnum::UnsignedInt),
+          meshHash);
+      BulletCollisionCache::TriangleMeshBvh::ptr bvh =
+          collisionCache_->getTriangleMeshBvh(*meshShape, meshHash);
+      meshShape->setOptimizedBvh(bvh->get(), scaling);
+      bStageBvhs_.emplace_back(std::move(bvh));
+    } else {
+      meshShape->buildOptimizedBvh();
+    }
     // mass == 0 to indicate static. See isStaticObject assert below. See also
     // examples/MultiThreadedDemo/CommonRigidBodyMTBase.h
     btVector3 localInertia(0, 0, 0);
@@ -7,6 +7,7 @@
 
 #include "esp/physics/RigidStage.h"
 #include "esp/physics/bullet/BulletBase.h"
+#include "esp/physics/bullet/BulletCollisionCache.h"
 
 /** @file
  * @brief Class @ref esp::physics::BulletRigidStage
@@ -23,9 +24,10 @@ class BulletRigidStage : public BulletBase, public RigidStage {
  public:
   BulletRigidStage(scene::SceneNode* rigidBodyNode,
                    const assets::ResourceManager& resMgr,
-                   std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
+                   std::shared_ptr<btDiscreteDynamicsWorld> bWorld,
                    std::shared_ptr<std::map<const btCollisionObject*, int>>
-                       collisionObjToObjIds);
+                       collisionObjToObjIds,
+                   BulletCollisionCache::ptr collisionCache = nullptr);
 
   /**
    * @brief Destructor cleans up simulation structures for the stage object.
@@ -110,9 +112,16 @@ class BulletRigidStage : public BulletBase, public RigidStage {
   //! Stage data: Bullet triangular mesh vertices
   std::vector<std::unique_ptr<btTriangleIndexVertexArray>> bStageArrays_;
 
+  //! Stage data: BVHs of the triangle mesh shapes, shared through @ref
+  //! collisionCache_. Declared before the shapes so that it outlives them.
+  std::vector<BulletCollisionCache::TriangleMeshBvh::ptr> bStageBvhs_;
+
   //! Stage data: Bullet triangular mesh shape
   std::vector<std::unique_ptr<btBvhTriangleMeshShape>> bStageShapes_;
 
+  //! Cache to load the BVHs from, may be nullptr
+  BulletCollisionCache::ptr collisionCache_;
+
  public:
   ESP_SMART_POINTERS(BulletRigidStage)
 
@@ -91,6 +91,7 @@ void Simulator::reconfigure(const SimulatorConfiguration& cfg) {
   LOG(WARNING) << "Downsampling by : " << cfg.textureDownsampleFactor;
 
   resourceManager_->mipLevelsToSkip = cfg.textureDownsampleFactor;
+  resourceManager_->setNumLoadingThreads(cfg.numAssetLoadingThreads);
 
   if (!sceneManager_) {
     sceneManager_ = scene::SceneManager::create_unique();
@@ -198,6 +199,12 @@ void Simulator::reconfigure(const SimulatorConfiguration& cfg) {
 
     bool loadSuccess = false;
 
+    // pooled objects belong to the previous stage. Clear them even if the
+    // previous physics manager outlives this call.
+    if (physicsManager_ != nullptr) {
+      physicsManager_->clearObjectPools();
+    }
+
     // (re)seat & (re)init physics manager
     resourceManager_->initPhysicsManager(physicsManager_, config_.enablePhysics,
                                          &rootNode, physicsManagerAttributes);
@@ -347,6 +354,19 @@ int Simulator::addObjectByHandle(const std::string& objectLibHandle,
   return ID_UNDEFINED;
 }
 
+bool Simulator::preallocateObjects(const std::string& objectLibHandle,
+                                   const int capacity,
+                                   const std::string& lightSetupKey,
+                                   const int sceneID) {
+  if (sceneHasPhysics(sceneID)) {
+    auto& sceneGraph_ = sceneManager_->getSceneGraph(activeSceneID_);
+    auto& drawables = sceneGraph_.getDrawables();
+    return physicsManager_->preallocateObjects(objectLibHandle, capacity,
+                                               &drawables, lightSetupKey);
+  }
+  return false;
+}
+
 const metadata::attributes::ObjectAttributes::cptr
 Simulator::getObjectInitializationTemplate(const int objectId,
                                            const int sceneID) const {
@@ -581,6 +601,61 @@ Magnum::Vector3 Simulator::getAngularVelocity(const int objectID,
   return Magnum::Vector3();
 }
 
+bool Simulator::getRigidStates(
+    const Eigen::Ref<const Eigen::VectorXi>& objectIDs,
+    Eigen::Ref<Eigen::RowMatrixXf> states,
+    const int sceneID) {
+  if (sceneHasPhysics(sceneID)) {
+    return physicsManager_->getRigidStates(objectIDs, states);
+  }
+  return false;
+}
+
+bool Simulator::setRigidStates(
+    const Eigen::Ref<const Eigen::VectorXi>& objectIDs,
+    const Eigen::Ref<const Eigen::RowMatrixXf>& states,
+    const int sceneID) {
+  if (sceneHasPhysics(sceneID)) {
+    return physicsManager_->setRigidStates(objectIDs, states);
+  }
+  return false;
+}
+
+bool Simulator::getVelocities(
+    const Eigen::Ref<const Eigen::VectorXi>& objectIDs,
+    Eigen::Ref<Eigen::RowMatrixXf> velocities,
+    const int sceneID) {
+  if (sceneHasPhysics(sceneID)) {
+    return physicsManager_->getVelocities(objectIDs, velocities);
+  }
+  return false;
+}
+
+bool Simulator::setVelocities(
+    const Eigen::Ref<const Eigen::VectorXi>& objectIDs,
+    const Eigen::Ref<const Eigen::RowMatrixXf>& velocities,
+    const int sceneID) {
+  if (sceneHasPhysics(sceneID)) {
+    return physicsManager_->setVelocities(objectIDs, velocities);
+  }
+  return false;
+}
+
+esp::physics::PhysicsState::ptr Simulator::savePhysicsState(const int sceneID) {
+  if (sceneHasPhysics(sceneID)) {
+    return physicsManager_->saveState();
+  }
+  return nullptr;
+}
+
+bool Simulator::restorePhysicsState(const esp::physics::PhysicsState& state,
+                                    const int sceneID) {
+  if (sceneHasPhysics(sceneID)) {
+    return physicsManager_->restoreState(state);
+  }
+  return false;
+}
+
 bool Simulator::contactTest(const int objectID, const int sceneID) {
   if (sceneHasPhysics(sceneID)) {
     return physicsManager_->contactTest(objectID);
@@ -624,6 +699,21 @@ bool Simulator::preAddContactTestRotation(const std::string& objectLibHandle,
   return false;
 }
 
+std::vector<bool> Simulator::preAddContactTestBatch(
+    const std::string& objectLibHandle,
+    const std::vector<Magnum::Vector3>& translations,
+    const std::vector<Magnum::Quaternion>& rotations,
+    int collisionFilterGroup,
+    int collisionFilterMask,
+    const int sceneID) {
+  if (sceneHasPhysics(sceneID)) {
+    return physicsManager_->preAddContactTestBatch(
+        objectLibHandle, translations, rotations, collisionFilterGroup,
+        collisionFilterMask);
+  }
+  return std::vector<bool>(translations.size(), false);
+}
+
 int Simulator::addContactTestObject(const std::string& objectLibHandle,
                                     const int sceneID) {
   if (sceneHasPhysics(sceneID)) {
@@ -651,6 +741,20 @@ esp::physics::RaycastResults Simulator::castRay(const esp::geo::Ray& ray,
   return esp::physics::RaycastResults();
 }
 
+bool Simulator::castRays(const Eigen::Ref<const Eigen::RowMatrixXf>& origins,
+                         const Eigen::Ref<const Eigen::RowMatrixXf>& directions,
+                         float maxDistance,
+                         Eigen::Ref<Eigen::VectorXf> hitDistances,
+                         Eigen::Ref<Eigen::RowMatrixXf> hitNormals,
+                         Eigen::Ref<Eigen::VectorXi> hitObjectIds,
+                         const int sceneID) {
+  if (sceneHasPhysics(sceneID)) {
+    return physicsManager_->castRays(origins, directions, maxDistance,
+                                     hitDistances, hitNormals, hitObjectIds);
+  }
+  return false;
+}
+
 void Simulator::setObjectBBDraw(bool drawBB,
                                 const int objectID,
                                 const int sceneID) {
@@ -684,6 +788,13 @@ double Simulator::getWorldTime() {
   return NO_TIME;
 }
 
+std::vector<int> Simulator::getMovedObjectIds(const int sceneID) {
+  if (sceneHasPhysics(sceneID)) {
+    return physicsManager_->getMovedObjectIds();
+  }
+  return std::vector<int>();
+}
+
 void Simulator::setGravity(const Magnum::Vector3& gravity, const int sceneID) {
   if (sceneHasPhysics(sceneID)) {
     physicsManager_->setGravity(gravity);
@@ -708,6 +819,58 @@ bool Simulator::recomputeNavMesh(nav::PathFinder& pathfinder,
                  "loaded without renderer initialization.",
                  false);
 
+  assets::MeshData::uptr joinedMesh =
+      createJoinedNavMeshGeometry(includeStaticObjects);
+
+  if (!pathfinder.build(navMeshSettings, *joinedMesh)) {
+    LOG(ERROR) << "Failed to build navmesh";
+    return false;
+  }
+
+  if (&pathfinder == pathfinder_.get()) {
+    if (isNavMeshVisualizationActive()) {
+      // if updating pathfinder_ instance, refresh the visualization.
+      setNavMeshVisualization(false);  // first clear the old instance
+      setNavMeshVisualization(true);
+    }
+  }
+
+  LOG(INFO) << "reconstruct navmesh successful";
+  return true;
+}
+
+bool Simulator::updateNavMesh(nav::PathFinder& pathfinder,
+                              const Magnum::Range3D& region,
+                              bool includeStaticObjects) {
+  CORRADE_ASSERT(config_.createRenderer,
+                 "Simulator::updateNavMesh: "
+                 "SimulatorConfiguration::createRenderer is "
+                 "false. Scene geometry is required to update navmesh.",
+                 false);
+
+  assets::MeshData::uptr joinedMesh =
+      createJoinedNavMeshGeometry(includeStaticObjects);
+
+  if (!pathfinder.rebuildTiles(
+          *joinedMesh, Magnum::EigenIntegration::cast<vec3f>(region.min()),
+          Magnum::EigenIntegration::cast<vec3f>(region.max()))) {
+    LOG(ERROR) << "Failed to update navmesh";
+    return false;
+  }
+
+  if (&pathfinder == pathfinder_.get()) {
+    if (isNavMeshVisualizationActive()) {
+      // if updating pathfinder_ instance, refresh the visualization.
+      setNavMeshVisualization(false);  // first clear the old instance
+      setNavMeshVisualization(true);
+    }
+  }
+
+  return true;
+}
+
+assets::MeshData::uptr Simulator::createJoinedNavMeshGeometry(
+    bool includeStaticObjects) {
   assets::MeshData::uptr joinedMesh = assets::MeshData::create_unique();
   auto stageInitAttrs = physicsManager_->getStageInitAttributes();
   if (stageInitAttrs != nullptr) {
@@ -751,21 +914,7 @@ bool Simulator::recomputeNavMesh(nav::PathFinder& pathfinder,
     }
   }
 
-  if (!pathfinder.build(navMeshSettings, *joinedMesh)) {
-    LOG(ERROR) << "Failed to build navmesh";
-    return false;
-  }
-
-  if (&pathfinder == pathfinder_.get()) {
-    if (isNavMeshVisualizationActive()) {
-      // if updating pathfinder_ instance, refresh the visualization.
-      setNavMeshVisualization(false);  // first clear the old instance
-      setNavMeshVisualization(true);
-    }
-  }
-
-  LOG(INFO) << "reconstruct navmesh successful";
-  return true;
+  return joinedMesh;
 }
 
 bool Simulator::setNavMeshVisualization(bool visualize) {
@@ -208,6 +208,26 @@ class Simulator {
                             metadata::MetadataMediator::DEFAULT_LIGHTING_KEY,
                         int sceneID = 0);
 
+  /**
+   * @brief Pre-instantiate objects of a template into a pool which later
+   * calls to @ref addObjectByHandle with the same light setup reuse. See @ref
+   * esp::physics::PhysicsManager::preallocateObjects.
+   * @param objectLibHandle The handle of the object's template in
+   * @ref esp::metadata::managers::ObjectAttributesManager.
+   * @param capacity The number of objects to pre-instantiate and the most the
+   * pool will hold.
+   * @param lightSetupKey The string key for the @ref gfx::LightSetup to be used
+   * by the pooled objects.
+   * @param sceneID !! Not used currently !! Specifies which physical scene to
+   * add the objects to.
+   * @return Whether or not the pool was filled.
+   */
+  bool preallocateObjects(const std::string& objectLibHandle,
+                          int capacity,
+                          const std::string& lightSetupKey =
+                              metadata::MetadataMediator::DEFAULT_LIGHTING_KEY,
+                          int sceneID = 0);
+
   /**
    * @brief Get a static view of a physics object's template when the object was
    * instanced.
@@ -478,6 +498,80 @@ class Simulator {
    */
   Magnum::Vector3 getAngularVelocity(int objectID, int sceneID = 0);
 
+  /**
+   * @brief Write the rigid states of a batch of objects into a preallocated
+   * N x 7 array of translations and rotations (x, y, z, qx, qy, qz, qw). See
+   * @ref esp::physics::PhysicsManager::getRigidStates.
+   * @param objectIDs N object IDs.
+   * @param[out] states N x 7 rigid states.
+   * @param sceneID !! Not used currently !! Specifies which physical scene of
+   * the objects.
+   * @return Whether or not the states were written.
+   */
+  bool getRigidStates(const Eigen::Ref<const Eigen::VectorXi>& objectIDs,
+                      Eigen::Ref<Eigen::RowMatrixXf> states,
+                      int sceneID = 0);
+
+  /**
+   * @brief Set the rigid states of a batch of objects from an N x 7 array.
+   * See @ref esp::physics::PhysicsManager::setRigidStates.
+   * @param objectIDs N object IDs.
+   * @param states N x 7 rigid states.
+   * @param sceneID !! Not used currently !! Specifies which physical scene of
+   * the objects.
+   * @return Whether or not the states were set.
+   */
+  bool setRigidStates(const Eigen::Ref<const Eigen::VectorXi>& objectIDs,
+                      const Eigen::Ref<const Eigen::RowMatrixXf>& states,
+                      int sceneID = 0);
+
+  /**
+   * @brief Write the linear and angular velocities of a batch of objects
+   * into a preallocated N x 6 array. See @ref
+   * esp::physics::PhysicsManager::getVelocities.
+   * @param objectIDs N object IDs.
+   * @param[out] velocities N x 6 velocities.
+   * @param sceneID !! Not used currently !! Specifies which physical scene of
+   * the objects.
+   * @return Whether or not the velocities were written.
+   */
+  bool getVelocities(const Eigen::Ref<const Eigen::VectorXi>& objectIDs,
+                     Eigen::Ref<Eigen::RowMatrixXf> velocities,
+                     int sceneID = 0);
+
+  /**
+   * @brief Set the linear and angular velocities of a batch of objects from
+   * an N x 6 array. See @ref esp::physics::PhysicsManager::setVelocities.
+   * @param objectIDs N object IDs.
+   * @param velocities N x 6 velocities.
+   * @param sceneID !! Not used currently !! Specifies which physical scene of
+   * the objects.
+   * @return Whether or not the velocities were set.
+   */
+  bool setVelocities(const Eigen::Ref<const Eigen::VectorXi>& objectIDs,
+                     const Eigen::Ref<const Eigen::RowMatrixXf>& velocities,
+                     int sceneID = 0);
+
+  /**
+   * @brief Capture the dynamic state of all objects and the world time. See
+   * @ref esp::physics::PhysicsManager::saveState.
+   * @param sceneID !! Not used currently !! Specifies which physical scene to
+   * capture.
+   * @return The captured state, or nullptr if the scene has no physics.
+   */
+  esp::physics::PhysicsState::ptr savePhysicsState(int sceneID = 0);
+
+  /**
+   * @brief Restore a state captured by @ref savePhysicsState in place. See
+   * @ref esp::physics::PhysicsManager::restoreState.
+   * @param state The state to restore.
+   * @param sceneID !! Not used currently !! Specifies which physical scene to
+   * restore.
+   * @return Whether or not the state was restored.
+   */
+  bool restorePhysicsState(const esp::physics::PhysicsState& state,
+                           int sceneID = 0);
+
   /**
    * @brief Turn on/off rendering for the bounding box of the object's visual
    * component.
@@ -576,6 +670,30 @@ class Simulator {
                                        float maxDistance = 100.0,
                                        int sceneID = 0);
 
+  /**
+   * @brief Cast a batch of rays into the collision world of a scene, e.g. for
+   * lidar or proximity sensing. See @ref
+   * esp::physics::PhysicsManager::castRays.
+   *
+   * @param origins N x 3 ray origins.
+   * @param directions N x 3 ray directions.
+   * @param maxDistance The maximum distance along each ray direction to
+   * search. In units of ray length.
+   * @param[out] hitDistances N closest hit distances, infinity if missed.
+   * @param[out] hitNormals N x 3 world space hit normals.
+   * @param[out] hitObjectIds N ids of the objects hit.
+   * @param sceneID !! Not used currently !! Specifies which physical scene of
+   * the object.
+   * @return Whether or not the batch was cast.
+   */
+  bool castRays(const Eigen::Ref<const Eigen::RowMatrixXf>& origins,
+                const Eigen::Ref<const Eigen::RowMatrixXf>& directions,
+                float maxDistance,
+                Eigen::Ref<Eigen::VectorXf> hitDistances,
+                Eigen::Ref<Eigen::RowMatrixXf> hitNormals,
+                Eigen::Ref<Eigen::VectorXi> hitObjectIds,
+                int sceneID = 0);
+
   /**
    * @brief the physical world has a notion of time which passes during
    * animation/simulation/action/etc... Step the physical world forward in time
@@ -598,6 +716,15 @@ class Simulator {
    */
   double getWorldTime();
 
+  /**
+   * @brief Get the IDs of the objects moved by the last @ref stepWorld. See
+   * @ref esp::physics::PhysicsManager::getMovedObjectIds.
+   * @param sceneID !! Not used currently !! Specifies which physical scene to
+   * query.
+   * @return The moved object IDs, empty if the scene has no physics.
+   */
+  std::vector<int> getMovedObjectIds(int sceneID = 0);
+
   /**
    * @brief Set the gravity in a physical scene.
    */
@@ -621,6 +748,25 @@ class Simulator {
                         const nav::NavMeshSettings& navMeshSettings,
                         bool includeStaticObjects = false);
 
+  /**
+   * @brief Incrementally update a tiled navmesh after the scene geometry
+   * changed inside a region, e.g. when a STATIC object was added, moved or
+   * removed. Only the navmesh tiles overlapping the region are rebuilt.
+   *
+   * The navmesh must have been computed with @ref recomputeNavMesh and
+   * @ref nav::NavMeshSettings.tiled set, a navmesh loaded from a file can't
+   * be updated.
+   * @param pathfinder The pathfinder object whose navmesh will be updated.
+   * @param region The world space region in which geometry changed. When
+   * moving an object this should cover both its old and new bounds.
+   * @param includeStaticObjects Whether or not MotionType::STATIC objects
+   * constrain navigability, should match @ref recomputeNavMesh.
+   * @return Whether or not the navmesh update succeeded.
+   */
+  bool updateNavMesh(nav::PathFinder& pathfinder,
+                     const Magnum::Range3D& region,
+                     bool includeStaticObjects = false);
+
   /**
    * @brief Set visualization of the current NavMesh @ref pathfinder_ on or off.
    *
@@ -847,6 +993,19 @@ class Simulator {
                                  const bool isNavigationTest = false,
                                  const int sceneID = 0);
 
+  /**
+   * @brief Test a contact test object at K candidate poses in one call. See
+   * @ref esp::physics::PhysicsManager::preAddContactTestBatch.
+   * @return One bit per candidate, set if that candidate is in contact.
+   */
+  std::vector<bool> preAddContactTestBatch(
+      const std::string& objectLibHandle,
+      const std::vector<Magnum::Vector3>& translations,
+      const std::vector<Magnum::Quaternion>& rotations = {},
+      int collisionFilterGroup = 1,
+      int collisionFilterMask = -1,
+      const int sceneID = 0);
+
   void removeContactTestObject(const std::string& objectLibHandle,
                                const int sceneID = 0);
 
@@ -926,6 +1085,10 @@ class Simulator {
     return isValidScene(sceneID) && physicsManager_ != nullptr;
   }
 
+  //! join the stage and optionally all STATIC objects into one mesh for
+  //! navmesh computation
+  assets::MeshData::uptr createJoinedNavMeshGeometry(bool includeStaticObjects);
+
   gfx::WindowlessContext::uptr context_ = nullptr;
   std::shared_ptr<gfx::Renderer> renderer_ = nullptr;
   // CANNOT make the specification of resourceManager_ above the context_!
@@ -31,6 +31,12 @@ struct SimulatorConfiguration {
    */
   bool enablePhysics = false;
   int textureDownsampleFactor = 0;
+  /**
+   * @brief Number of threads decoding textures and importing meshes while
+   * loading render assets. Values <= 0 use the process-wide thread pool,
+   * which has a thread per core.
+   */
+  int numAssetLoadingThreads = 1;
   /**
    * @brief Whether or not to load the semantic mesh
    */
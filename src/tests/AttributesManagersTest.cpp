@@ -423,7 +423,9 @@ TEST_F(AttributesManagersTest, AttributesManagers_PhysicsJSONLoadTest) {
       "timestep": 1.0,
       "gravity": [1,2,3],
       "friction_coefficient": 1.4,
-      "restitution_coefficient": 1.1
+      "restitution_coefficient": 1.1,
+      "collision_cache_directory": "testJSONCollisionCache",
+      "num_threads": 4
     })";
   auto physMgrAttr =
       testBuildAttributesFromJSONString<AttrMgrs::PhysicsAttributesManager,
@@ -438,6 +440,9 @@ TEST_F(AttributesManagersTest, AttributesManagers_PhysicsJSONLoadTest) {
   ASSERT_EQ(physMgrAttr->getSimulator(), "bullet_test");
   ASSERT_EQ(physMgrAttr->getFrictionCoefficient(), 1.4);
   ASSERT_EQ(physMgrAttr->getRestitutionCoefficient(), 1.1);
+  ASSERT_EQ(physMgrAttr->getCollisionCacheDirectory(),
+            "testJSONCollisionCache");
+  ASSERT_EQ(physMgrAttr->getNumThreads(), 4);
 }  // AttributesManagers_PhysicsJSONLoadTest
 
 /**
@@ -635,6 +640,7 @@ TEST_F(AttributesManagersTest, AttributesManagers_ObjectJSONLoadTest) {
         "mass": 9,
         "use_bounding_box_for_collision": true,
         "join_collision_meshes":true,
+        "collision_hull_max_vertices": 64,
         "inertia": [1.1, 0.9, 0.3],
         "COM": [0.1,0.2,0.3]
       })";
@@ -661,6 +667,7 @@ TEST_F(AttributesManagersTest, AttributesManagers_ObjectJSONLoadTest) {
   ASSERT_EQ(objAttr->getMass(), 9);
   ASSERT_EQ(objAttr->getBoundingBoxCollisions(), true);
   ASSERT_EQ(objAttr->getJoinCollisionMeshes(), true);
+  ASSERT_EQ(objAttr->getCollisionHullMaxVertices(), 64);
   ASSERT_EQ(objAttr->getInertia(), Magnum::Vector3(1.1, 0.9, 0.3));
   ASSERT_EQ(objAttr->getCOM(), Magnum::Vector3(0.1, 0.2, 0.3));
 
@@ -4,7 +4,13 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
 #include "esp/core/Configuration.h"
+#include "esp/core/ThreadPool.h"
 #include "esp/core/esp.h"
 
 using namespace esp::core;
@@ -18,3 +24,36 @@ TEST(CoreTest, ConfigurationTest) {
   EXPECT_EQ(cfg.get<int>("myInt"), 10);
   EXPECT_EQ(cfg.get<std::string>("myString"), "test");
 }
+
+TEST(CoreTest, ThreadPoolWorkerIndices) {
+  ThreadPool pool(4);
+  // a worker index is only ever used by one thread at a time, even with
+  // concurrent callers, and nested calls keep the index of their worker
+  std::vector<std::atomic<int>> busy(pool.numThreads());
+  std::atomic<int> numAliased{0};
+  std::atomic<int> numWrongNested{0};
+  std::atomic<int> numItems{0};
+  auto run = [&]() {
+    pool.parallelFor(64, [&](int workerIndex, size_t) {
+      if (busy[workerIndex]++ != 0) {
+        ++numAliased;
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+      ++numItems;
+      --busy[workerIndex];
+
+      pool.parallelFor(2, [&](int nestedWorkerIndex, size_t) {
+        if (nestedWorkerIndex != workerIndex) {
+          ++numWrongNested;
+        }
+      });
+    });
+  };
+  std::thread otherCaller(run);
+  run();
+  otherCaller.join();
+
+  EXPECT_EQ(numItems, 128);
+  EXPECT_EQ(numAliased, 0);
+  EXPECT_EQ(numWrongNested, 0);
+}
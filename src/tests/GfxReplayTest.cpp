@@ -3,18 +3,27 @@
 // LICENSE file in the root directory of this source tree.
 
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/PluginManager/Manager.h>
 #include <Corrade/Utility/Directory.h>
 #include <Magnum/EigenIntegration/Integration.h>
+#include <Magnum/Math/Color.h>
 #include <Magnum/Math/Range.h>
+#include <Magnum/Trade/AbstractImporter.h>
+#include <Magnum/Trade/ImageData.h>
 #include <gtest/gtest.h>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "esp/assets/RenderAssetInstanceCreationInfo.h"
 #include "esp/assets/ResourceManager.h"
 #include "esp/gfx/Renderer.h"
 #include "esp/gfx/WindowlessContext.h"
+#include "esp/gfx/replay/KeyframeFile.h"
 #include "esp/gfx/replay/Player.h"
 #include "esp/gfx/replay/Recorder.h"
+#include "esp/gfx/replay/ReplayRenderer.h"
+#include "esp/scene/SceneGraph.h"
 #include "esp/scene/SceneManager.h"
 
 #include "configure.h"
@@ -234,3 +243,281 @@ TEST(GfxReplayTest, player) {
     }
   }
 }
+
+// stream keyframes to a binary file over several chunks and play them back
+TEST(GfxReplayTest, streamKeyframesToFile) {
+  esp::scene::SceneGraph recordGraph;
+  esp::scene::SceneGraph playGraph;
+  const std::string filepath =
+      Cr::Utility::Directory::join(TEST_ASSETS, "gfx_replay_test.bin");
+
+  esp::assets::AssetInfo info;
+  info.filepath = "box.glb";
+  info.virtualUnitToMeters = 0.5f;
+  esp::assets::RenderAssetInstanceCreationInfo::Flags flags;
+  flags |= esp::assets::RenderAssetInstanceCreationInfo::Flag::IsRGBD;
+  esp::assets::RenderAssetInstanceCreationInfo creation(
+      info.filepath, Mn::Vector3(2.f, 2.f, 2.f), flags, "lights");
+
+  constexpr int numKeyframes = 7;
+  const Mn::Quaternion rotation =
+      Mn::Quaternion::rotation(Mn::Deg(30.f), Mn::Vector3::yAxis()) *
+      Mn::Quaternion::rotation(Mn::Deg(-70.f), Mn::Vector3::xAxis());
+
+  esp::gfx::replay::Recorder recorder;
+  ASSERT_TRUE(recorder.startStreamingKeyframesToFile(filepath, 3));
+  auto* node = &recordGraph.getRootNode().createChild();
+  recorder.onLoadRenderAsset(info);
+  recorder.onCreateRenderAssetInstance(node, creation);
+  for (int i = 0; i < numKeyframes; ++i) {
+    node->setTranslation(Mn::Vector3(0.1f * i, -2.f, 100.f));
+    node->setRotation(rotation);
+    node->setSemanticId(i);
+    recorder.addUserTransformToKeyframe("camera", Mn::Vector3(0.123f, 4.f, 5.f),
+                                        rotation);
+    recorder.saveKeyframe();
+    // full chunks are flushed as keyframes are saved
+    EXPECT_EQ(recorder.debugGetSavedKeyframes().size(), size_t((i + 1) % 3));
+  }
+  EXPECT_TRUE(recorder.stopStreamingKeyframesToFile());
+  EXPECT_TRUE(recorder.debugGetSavedKeyframes().empty());
+
+  esp::gfx::replay::KeyframeReader reader(filepath);
+  ASSERT_TRUE(reader.isValid());
+  EXPECT_EQ(reader.getNumKeyframes(), numKeyframes);
+  EXPECT_EQ(reader.getNumChunks(), 3);
+  EXPECT_EQ(reader.getChunkOfKeyframe(5), 1);
+  EXPECT_EQ(reader.getFirstKeyframeOfChunk(2), 6);
+
+  std::vector<esp::gfx::replay::Keyframe> keyframes;
+  ASSERT_TRUE(reader.readChunk(0, keyframes));
+  ASSERT_EQ(keyframes.size(), 3u);
+  ASSERT_EQ(keyframes[0].loads.size(), 1u);
+  EXPECT_EQ(keyframes[0].loads[0].filepath, info.filepath);
+  EXPECT_EQ(keyframes[0].loads[0].virtualUnitToMeters, 0.5f);
+  ASSERT_EQ(keyframes[0].creations.size(), 1u);
+  const auto& readCreation = keyframes[0].creations[0].second;
+  EXPECT_EQ(readCreation.filepath, creation.filepath);
+  ASSERT_TRUE(readCreation.scale);
+  EXPECT_EQ(*readCreation.scale, Mn::Vector3(2.f, 2.f, 2.f));
+  EXPECT_TRUE(readCreation.isRGBD());
+  EXPECT_FALSE(readCreation.isSemantic());
+  EXPECT_EQ(readCreation.lightSetupKey, "lights");
+
+  // play back, creating plain nodes in place of render asset instances
+  int numCreated = 0;
+  esp::gfx::replay::Player player(
+      [&](const esp::assets::AssetInfo&,
+          const esp::assets::RenderAssetInstanceCreationInfo&) {
+        ++numCreated;
+        return &playGraph.getRootNode().createChild();
+      });
+  ASSERT_TRUE(player.readKeyframesFromFile(filepath));
+  ASSERT_EQ(player.getNumKeyframes(), numKeyframes);
+  for (const int keyframeIndex : {6, 1, 4}) {
+    player.setKeyframeIndex(keyframeIndex);
+    const auto* instanceNode = static_cast<const esp::scene::SceneNode*>(
+        playGraph.getRootNode().children().last());
+    ASSERT_TRUE(instanceNode);
+    const Mn::Vector3 expected(0.1f * keyframeIndex, -2.f, 100.f);
+    EXPECT_LT((instanceNode->translation() - expected).length(), 1.0e-4f);
+    // q and -q are the same rotation
+    EXPECT_GT(std::abs(Mn::Math::dot(instanceNode->rotation(), rotation)),
+              0.99999f);
+    EXPECT_EQ(instanceNode->getSemanticId(), keyframeIndex);
+
+    Mn::Vector3 userTranslation;
+    Mn::Quaternion userRotation;
+    ASSERT_TRUE(
+        player.getUserTransform("camera", &userTranslation, &userRotation));
+    // user transforms are stored at full precision
+    EXPECT_EQ(userTranslation, Mn::Vector3(0.123f, 4.f, 5.f));
+    EXPECT_EQ(userRotation, rotation);
+  }
+  // one creation, then again after seeking backward cleared the frame
+  EXPECT_EQ(numCreated, 2);
+
+  // a file written after stopping the stream is self-contained
+  const std::string nextFilepath =
+      Cr::Utility::Directory::join(TEST_ASSETS, "gfx_replay_test_next.bin");
+  recorder.saveKeyframe();
+  EXPECT_TRUE(recorder.writeSavedKeyframesToFile(nextFilepath));
+  esp::gfx::replay::KeyframeReader nextReader(nextFilepath);
+  ASSERT_TRUE(nextReader.isValid());
+  ASSERT_TRUE(nextReader.readChunk(0, keyframes));
+  ASSERT_EQ(keyframes.size(), 1u);
+  EXPECT_EQ(keyframes[0].loads.size(), 1u);
+  EXPECT_EQ(keyframes[0].creations.size(), 1u);
+  EXPECT_EQ(keyframes[0].stateUpdates.size(), 1u);
+
+  Cr::Utility::Directory::rm(filepath);
+  Cr::Utility::Directory::rm(nextFilepath);
+}
+
+// seek back and forth using snapshots, reusing live instance nodes
+TEST(GfxReplayTest, playerSeekWithSnapshots) {
+  esp::scene::SceneGraph sceneGraph;
+  auto& rootNode = sceneGraph.getRootNode();
+  auto countChildren = [&]() {
+    int count = 0;
+    for (auto* child = rootNode.children().first(); child;
+         child = child->nextSibling()) {
+      ++count;
+    }
+    return count;
+  };
+  const int initialNumChildren = countChildren();
+
+  std::map<std::string, std::vector<esp::scene::SceneNode*>> createdNodes;
+  esp::gfx::replay::Player player(
+      [&](const esp::assets::AssetInfo&,
+          const esp::assets::RenderAssetInstanceCreationInfo& creation) {
+        auto* node = &rootNode.createChild();
+        createdNodes[creation.filepath].push_back(node);
+        return node;
+      });
+  player.setSnapshotInterval(4);
+
+  esp::assets::AssetInfo infoA;
+  infoA.filepath = "a.glb";
+  esp::assets::AssetInfo infoB;
+  infoB.filepath = "b.glb";
+  esp::assets::RenderAssetInstanceCreationInfo::Flags flags;
+  esp::assets::RenderAssetInstanceCreationInfo creationA(
+      infoA.filepath, Corrade::Containers::NullOpt, flags, "");
+  esp::assets::RenderAssetInstanceCreationInfo creationB(
+      infoB.filepath, Corrade::Containers::NullOpt, flags, "");
+  auto makeState = [](float x) {
+    return esp::gfx::replay::RenderAssetInstanceState{
+        {Mn::Vector3(x, 0.f, 0.f), Mn::Quaternion(Mn::Math::IdentityInit)},
+        esp::ID_UNDEFINED};
+  };
+
+  // instance A moves every keyframe, instance B is live in keyframes 10-14
+  constexpr int numKeyframes = 20;
+  std::vector<esp::gfx::replay::Keyframe> keyframes(numKeyframes);
+  keyframes[0].loads = {infoA, infoB};
+  keyframes[0].creations.emplace_back(0, creationA);
+  keyframes[10].creations.emplace_back(1, creationB);
+  keyframes[10].stateUpdates.emplace_back(1, makeState(-1.f));
+  keyframes[15].deletions.push_back(1);
+  for (int i = 0; i < numKeyframes; ++i) {
+    keyframes[i].stateUpdates.emplace_back(0, makeState(float(i)));
+  }
+  player.debugSetKeyframes(std::move(keyframes));
+
+  // a long jump forward skips creating B, which is no longer live
+  player.setKeyframeIndex(19);
+  ASSERT_EQ(createdNodes["a.glb"].size(), 1u);
+  EXPECT_EQ(createdNodes["b.glb"].size(), 0u);
+  esp::scene::SceneNode* nodeA = createdNodes["a.glb"][0];
+  EXPECT_EQ(nodeA->translation(), Mn::Vector3(19.f, 0.f, 0.f));
+  EXPECT_EQ(countChildren(), initialNumChildren + 1);
+
+  // seeking backward keeps A's node and creates B
+  player.setKeyframeIndex(12);
+  EXPECT_EQ(player.getKeyframeIndex(), 12);
+  EXPECT_EQ(createdNodes["a.glb"].size(), 1u);
+  ASSERT_EQ(createdNodes["b.glb"].size(), 1u);
+  EXPECT_EQ(nodeA->translation(), Mn::Vector3(12.f, 0.f, 0.f));
+  EXPECT_EQ(createdNodes["b.glb"][0]->translation(),
+            Mn::Vector3(-1.f, 0.f, 0.f));
+  EXPECT_EQ(countChildren(), initialNumChildren + 2);
+
+  // B is deleted when seeking to before its creation
+  player.setKeyframeIndex(3);
+  EXPECT_EQ(createdNodes["a.glb"].size(), 1u);
+  EXPECT_EQ(nodeA->translation(), Mn::Vector3(3.f, 0.f, 0.f));
+  EXPECT_EQ(countChildren(), initialNumChildren + 1);
+
+  // steps forward apply keyframes directly, or start from a later snapshot
+  player.setKeyframeIndex(5);
+  player.setKeyframeIndex(6);
+  EXPECT_EQ(nodeA->translation(), Mn::Vector3(6.f, 0.f, 0.f));
+  player.setKeyframeIndex(11);
+  EXPECT_EQ(createdNodes["a.glb"].size(), 1u);
+  EXPECT_EQ(createdNodes["b.glb"].size(), 2u);
+  EXPECT_EQ(nodeA->translation(), Mn::Vector3(11.f, 0.f, 0.f));
+
+  player.setKeyframeIndex(-1);
+  EXPECT_EQ(countChildren(), initialNumChildren);
+}
+
+// Render a recorded replay headlessly from the cameras saved with it
+TEST(GfxReplayTest, replayRenderer) {
+  const std::string boxFile =
+      Cr::Utility::Directory::join(TEST_ASSETS, "objects/transform_box.glb");
+  const std::string replayFilepath =
+      Cr::Utility::Directory::join(TEST_ASSETS, "gfx_replay_render_test.bin");
+  const std::string outputDirectory =
+      Cr::Utility::Directory::join(TEST_ASSETS, "gfx_replay_render_test");
+
+  {
+    esp::scene::SceneGraph sceneGraph;
+    esp::gfx::replay::Recorder recorder;
+    ASSERT_TRUE(recorder.startStreamingKeyframesToFile(replayFilepath));
+    esp::assets::RenderAssetInstanceCreationInfo creation(
+        boxFile, Cr::Containers::NullOpt, {}, "");
+    recorder.onLoadRenderAsset(esp::assets::AssetInfo::fromPath(boxFile));
+    auto* node = &sceneGraph.getRootNode().createChild();
+    recorder.onCreateRenderAssetInstance(node, creation);
+    // "front" looks at the box, "back" looks away from it
+    for (int i = 0; i < 2; ++i) {
+      recorder.addUserTransformToKeyframe("front", Mn::Vector3(0.f, 0.f, 3.f),
+                                          Mn::Quaternion{});
+      recorder.addUserTransformToKeyframe(
+          "back", Mn::Vector3(0.f, 0.f, 3.f),
+          Mn::Quaternion::rotation(Mn::Deg(180.f), Mn::Vector3::yAxis()));
+      recorder.saveKeyframe();
+    }
+    ASSERT_TRUE(recorder.stopStreamingKeyframesToFile());
+  }
+
+  esp::gfx::replay::ReplayRendererConfiguration cfg;
+  cfg.imageSize = {64, 48};
+  // no context is current, so this also covers creating one on the default
+  // device, as on CI machines without a GPU
+  cfg.gpuDeviceId = -1;
+  esp::gfx::replay::ReplayRenderer replayRenderer(cfg);
+  // cameras missing from the replay are skipped
+  ASSERT_TRUE(replayRenderer.renderReplay(
+      replayFilepath, {"front", "back", "missing"}, outputDirectory));
+  EXPECT_EQ(replayRenderer.getNumRenderedImages(), 4);
+
+  Cr::PluginManager::Manager<Mn::Trade::AbstractImporter> manager;
+  Cr::Containers::Pointer<Mn::Trade::AbstractImporter> importer =
+      manager.loadAndInstantiate("PngImporter");
+  ASSERT_TRUE(importer);
+  auto centerPixel = [&](const std::string& filename) {
+    const std::string filepath =
+        Cr::Utility::Directory::join(outputDirectory, filename);
+    EXPECT_TRUE(importer->openFile(filepath));
+    Cr::Containers::Optional<Mn::Trade::ImageData2D> image =
+        importer->image2D(0);
+    EXPECT_TRUE(image);
+    if (!image) {
+      return Mn::Color4ub{};
+    }
+    EXPECT_EQ(image->size(), cfg.imageSize);
+    const Mn::Color4ub pixel = image->pixels<Mn::Color4ub>()[24][32];
+    importer->close();
+    Cr::Utility::Directory::rm(filepath);
+    return pixel;
+  };
+  const Mn::Color4ub black{0, 0, 0, 255};
+  EXPECT_NE(centerPixel("gfx_replay_render_test.front.00000.png"), black);
+  EXPECT_NE(centerPixel("gfx_replay_render_test.front.00001.png"), black);
+  EXPECT_EQ(centerPixel("gfx_replay_render_test.back.00000.png"), black);
+  EXPECT_EQ(centerPixel("gfx_replay_render_test.back.00001.png"), black);
+  EXPECT_FALSE(Cr::Utility::Directory::exists(Cr::Utility::Directory::join(
+      outputDirectory, "gfx_replay_render_test.missing.00000.png")));
+
+  // a replay that can't be read renders nothing
+  EXPECT_FALSE(replayRenderer.renderReplay(
+      Cr::Utility::Directory::join(TEST_ASSETS, "no_such_replay.bin"),
+      {"front"}, outputDirectory));
+  EXPECT_EQ(replayRenderer.getNumRenderedImages(), 4);
+
+  Cr::Utility::Directory::rm(outputDirectory);
+  Cr::Utility::Directory::rm(replayFilepath);
+}
@@ -2,13 +2,20 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <Corrade/Containers/Optional.h>
 #include <Corrade/Utility/Directory.h>
+#include <Magnum/Math/Constants.h>
+#include <Magnum/Math/Range.h>
+#include <algorithm>
+#include <cmath>
 #include <gtest/gtest.h>
 #include <string>
 
 #include "esp/sim/Simulator.h"
 
+#include "esp/assets/RenderAssetInstanceCreationInfo.h"
 #include "esp/assets/ResourceManager.h"
+#include "esp/gfx/replay/Recorder.h"
 #include "esp/scene/SceneManager.h"
 
 #include "esp/physics/PhysicsManager.h"
@@ -47,13 +54,14 @@ class PhysicsManagerTest : public testing::Test {
         metadataMediator_->getPhysicsAttributesManager();
   };
 
-  void initStage(const std::string stageFile) {
+  void initStage(const std::string stageFile, int numThreads = 1) {
     auto& sceneGraph = sceneManager_.getSceneGraph(sceneID_);
     auto& rootNode = sceneGraph.getRootNode();
 
     // construct appropriate physics attributes based on config file
     auto physicsManagerAttributes =
         physicsAttributesManager_->createObject(physicsConfigFile, true);
+    physicsManagerAttributes->setNumThreads(numThreads);
     auto stageAttributesMgr = metadataMediator_->getStageAttributesManager();
     if (physicsManagerAttributes != nullptr) {
       stageAttributesMgr->setCurrPhysicsManagerAttributesHandle(
@@ -358,6 +366,54 @@ TEST_F(PhysicsManagerTest, BulletCompoundShapeMargins) {
     ASSERT_EQ(AabbOb2, objectGroundTruth);
   }
 }
+
+TEST_F(PhysicsManagerTest, BulletCollisionHullMaxVertices) {
+  // test that addObject reduces collision hulls to the template's budget
+  LOG(INFO) << "Starting physics test: BulletCollisionHullMaxVertices";
+
+  std::string objectFile =
+      Cr::Utility::Directory::join(dataDir, "test_assets/objects/sphere.glb");
+
+  initStage(objectFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() ==
+      PhysicsManager::PhysicsSimulationLibrary::BULLET) {
+    ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+    ObjectAttributes->setRenderAssetHandle(objectFile);
+    ObjectAttributes->setJoinCollisionMeshes(false);
+
+    auto objectAttributesManager =
+        metadataMediator_->getObjectAttributesManager();
+    objectAttributesManager->registerObject(ObjectAttributes, objectFile);
+
+    // get a reference to the stored template to edit
+    ObjectAttributes::ptr objectTemplate =
+        objectAttributesManager->getObjectCopyByHandle(objectFile);
+
+    esp::physics::BulletPhysicsManager* bPhysManager =
+        static_cast<esp::physics::BulletPhysicsManager*>(physicsManager_.get());
+
+    // the exact hull
+    int objectId = physicsManager_->addObject(objectFile, nullptr);
+    const int numExactVertices =
+        bPhysManager->getMaxConvexHullVertices(objectId);
+    ASSERT_GT(numExactVertices, 24);
+
+    // a budget below the exact hull
+    objectTemplate->setCollisionHullMaxVertices(24);
+    objectAttributesManager->registerObject(objectTemplate);
+    objectId = physicsManager_->addObject(objectFile, nullptr);
+    ASSERT_LE(bPhysManager->getMaxConvexHullVertices(objectId), 24);
+    ASSERT_GT(bPhysManager->getMaxConvexHullVertices(objectId), 6);
+
+    // budgets too small for a solid hull are raised to the six axis support
+    // points
+    objectTemplate->setCollisionHullMaxVertices(2);
+    objectAttributesManager->registerObject(objectTemplate);
+    objectId = physicsManager_->addObject(objectFile, nullptr);
+    ASSERT_EQ(bPhysManager->getMaxConvexHullVertices(objectId), 6);
+  }
+}
 #endif
 
 TEST_F(PhysicsManagerTest, ConfigurableScaling) {
@@ -862,3 +918,805 @@ TEST_F(PhysicsManagerTest, TestRemoveSleepingSupport) {
     }
   }
 }
+
+TEST_F(PhysicsManagerTest, MovedObjectIds) {
+  // test that only objects moved by a step are reported and synced
+  LOG(INFO) << "Starting physics test: MovedObjectIds";
+
+  std::string stageFile = "NONE";
+
+  initStage(stageFile);
+  auto& drawables = sceneManager_.getSceneGraph(sceneID_).getDrawables();
+  std::string cubeHandle = metadataMediator_->getObjectAttributesManager()
+                               ->getObjectHandlesBySubstring("cubeSolid")[0];
+
+  // a static support with a cube resting on it
+  const int supportId = physicsManager_->addObject(cubeHandle, &drawables);
+  const int cubeId = physicsManager_->addObject(cubeHandle, &drawables);
+  physicsManager_->setTranslation(cubeId, Mn::Vector3(0, 0.2, 0));
+  physicsManager_->setObjectMotionType(supportId,
+                                       esp::physics::MotionType::STATIC);
+
+  // velocity controlled objects move every step
+  const int controlledId = physicsManager_->addObject(cubeHandle, &drawables);
+  physicsManager_->setTranslation(controlledId, Mn::Vector3(5.0, 0, 0));
+  physicsManager_->setObjectMotionType(controlledId,
+                                       esp::physics::MotionType::KINEMATIC);
+  auto velControl = physicsManager_->getVelocityControl(controlledId);
+  velControl->controllingLinVel = true;
+  velControl->linVel = Mn::Vector3(0, 0, 1.0);
+
+  physicsManager_->stepPhysics(0.1);
+  std::vector<int> moved = physicsManager_->getMovedObjectIds();
+  ASSERT_NE(std::find(moved.begin(), moved.end(), controlledId), moved.end());
+  ASSERT_EQ(std::find(moved.begin(), moved.end(), supportId), moved.end());
+
+  velControl->controllingLinVel = false;
+  physicsManager_->stepPhysics(0.1);
+  ASSERT_EQ(std::find(physicsManager_->getMovedObjectIds().begin(),
+                      physicsManager_->getMovedObjectIds().end(), controlledId),
+            physicsManager_->getMovedObjectIds().end());
+
+  // We need dynamics to test sleeping.
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::NONE) {
+    moved = physicsManager_->getMovedObjectIds();
+    ASSERT_NE(std::find(moved.begin(), moved.end(), cubeId), moved.end());
+
+    // once the cube settles and falls asleep it is no longer synced
+    while (physicsManager_->getWorldTime() < 4.0) {
+      physicsManager_->stepPhysics(0.1);
+    }
+    ASSERT(!physicsManager_->isActive(cubeId));
+    physicsManager_->stepPhysics(0.1);
+    ASSERT_TRUE(physicsManager_->getMovedObjectIds().empty());
+
+    // waking it up reports it again
+    physicsManager_->applyImpulse(cubeId, Mn::Vector3(0, 1.0, 0),
+                                  Mn::Vector3());
+    physicsManager_->stepPhysics(0.1);
+    moved = physicsManager_->getMovedObjectIds();
+    ASSERT_EQ(moved, std::vector<int>{cubeId});
+
+    // removed objects are dropped from the moved set
+    physicsManager_->removeObject(cubeId);
+    ASSERT_TRUE(physicsManager_->getMovedObjectIds().empty());
+  }
+}
+
+TEST_F(PhysicsManagerTest, TestCastRays) {
+  // test that batched raycasts report the closest hit of castRay
+  LOG(INFO) << "Starting physics test: TestCastRays";
+
+  std::string stageFile =
+      Cr::Utility::Directory::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile = Cr::Utility::Directory::join(
+      dataDir, "test_assets/objects/transform_box.glb");
+
+  initStage(stageFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::NONE) {
+    ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+    ObjectAttributes->setRenderAssetHandle(objectFile);
+    ObjectAttributes->setMargin(0.0);
+    auto objectAttributesManager =
+        metadataMediator_->getObjectAttributesManager();
+    objectAttributesManager->registerObject(ObjectAttributes, objectFile);
+
+    // two static 2x2x2 boxes resting 0.1 above the ground plane
+    int objectId0 = physicsManager_->addObject(objectFile, nullptr);
+    int objectId1 = physicsManager_->addObject(objectFile, nullptr);
+    physicsManager_->setTranslation(objectId0, Magnum::Vector3{0, 1.1, 0});
+    physicsManager_->setTranslation(objectId1, Magnum::Vector3{2.2, 1.1, 0});
+    physicsManager_->setObjectMotionType(objectId0,
+                                         esp::physics::MotionType::STATIC);
+    physicsManager_->setObjectMotionType(objectId1,
+                                         esp::physics::MotionType::STATIC);
+    // refresh the broadphase bounds
+    physicsManager_->stepPhysics(0.1);
+
+    // a grid of downward rays, followed by one upward ray which misses
+    const int gridSize = 16;
+    const int numRays = gridSize * gridSize + 1;
+    Eigen::RowMatrixXf origins(numRays, 3);
+    Eigen::RowMatrixXf directions(numRays, 3);
+    for (int i = 0; i < gridSize * gridSize; ++i) {
+      origins.row(i) << -1.5f + 0.3f * (i % gridSize), 5.0f,
+          -1.5f + 0.2f * (i / gridSize);
+      directions.row(i) << 0, -1, 0;
+    }
+    origins.row(numRays - 1) << 0, 5, 0;
+    directions.row(numRays - 1) << 0, 1, 0;
+
+    Eigen::VectorXf hitDistances(numRays);
+    Eigen::RowMatrixXf hitNormals(numRays, 3);
+    Eigen::VectorXi hitObjectIds(numRays);
+    ASSERT_TRUE(physicsManager_->castRays(origins, directions, 100.0,
+                                          hitDistances, hitNormals,
+                                          hitObjectIds));
+
+    for (int i = 0; i < numRays; ++i) {
+      esp::geo::Ray ray{
+          Magnum::Vector3{origins(i, 0), origins(i, 1), origins(i, 2)},
+          Magnum::Vector3{directions(i, 0), directions(i, 1),
+                          directions(i, 2)}};
+      esp::physics::RaycastResults results = physicsManager_->castRay(ray);
+      if (!results.hasHits()) {
+        ASSERT_TRUE(std::isinf(hitDistances[i]));
+        ASSERT_EQ(hitObjectIds[i], esp::ID_UNDEFINED);
+        continue;
+      }
+      const esp::physics::RayHitInfo& hit = results.hits.front();
+      ASSERT_NEAR(hitDistances[i], hit.rayDistance, 1e-4);
+      ASSERT_EQ(hitObjectIds[i], hit.objectId);
+      ASSERT_NEAR(hitNormals(i, 1), hit.normal.y(), 1e-4);
+    }
+
+    // the ray through the center of box 0 stops at its top face
+    const int centerRay = gridSize / 2 * gridSize + 5;
+    ASSERT_EQ(hitObjectIds[centerRay], objectId0);
+    ASSERT_NEAR(hitDistances[centerRay], 2.9, 1e-4);
+    ASSERT_TRUE(std::isinf(hitDistances[numRays - 1]));
+
+    // mismatched output shapes are rejected
+    Eigen::VectorXi tooFewIds(numRays - 1);
+    ASSERT_FALSE(physicsManager_->castRays(
+        origins, directions, 100.0, hitDistances, hitNormals, tooFewIds));
+  }
+}
+
+TEST_F(PhysicsManagerTest, PreAddContactTestBatch) {
+  // test that batched placement probes agree with individual probes
+  LOG(INFO) << "Starting physics test: PreAddContactTestBatch";
+
+  std::string stageFile =
+      Cr::Utility::Directory::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile = Cr::Utility::Directory::join(
+      dataDir, "test_assets/objects/transform_box.glb");
+
+  initStage(stageFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::NONE) {
+    ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+    ObjectAttributes->setRenderAssetHandle(objectFile);
+    ObjectAttributes->setMargin(0.0);
+    auto objectAttributesManager =
+        metadataMediator_->getObjectAttributesManager();
+    objectAttributesManager->registerObject(ObjectAttributes, objectFile);
+
+    // a 2x2x2 box resting 0.1 above the ground plane
+    int objectId = physicsManager_->addObject(objectFile, nullptr);
+    physicsManager_->setTranslation(objectId, Magnum::Vector3{0, 1.1, 0});
+    ASSERT_NE(physicsManager_->addContactTestObject(objectFile),
+              esp::ID_UNDEFINED);
+
+    std::vector<Magnum::Vector3> translations{
+        {-2.2, 1.1, 0},  // free
+        {-2.2, 0.9, 0},  // in the floor
+        {1.1, 1.1, 0},   // in the box
+        {0, 5.0, 0},     // above the box
+    };
+    std::vector<bool> inContact =
+        physicsManager_->preAddContactTestBatch(objectFile, translations);
+    ASSERT_EQ(inContact, (std::vector<bool>{false, true, true, false}));
+    for (size_t i = 0; i < translations.size(); ++i) {
+      ASSERT_EQ(inContact[i], physicsManager_->preAddContactTest(
+                                  objectFile, translations[i]));
+    }
+
+    // rotating the free candidate by 45 degrees lowers its corner into the
+    // floor
+    std::vector<Magnum::Quaternion> rotations(
+        translations.size(), Magnum::Quaternion::rotation(
+                                 Magnum::Deg(45.0f), Magnum::Vector3::zAxis()));
+    inContact = physicsManager_->preAddContactTestBatch(
+        objectFile, translations, rotations);
+    ASSERT_TRUE(inContact[0]);
+
+    // mismatched rotations are rejected
+    rotations.pop_back();
+    inContact = physicsManager_->preAddContactTestBatch(
+        objectFile, translations, rotations);
+    ASSERT_EQ(inContact, std::vector<bool>(translations.size(), false));
+  }
+}
+
+TEST_F(PhysicsManagerTest, BulkRigidStates) {
+  // test that bulk state accessors agree with the per-object ones
+  LOG(INFO) << "Starting physics test: BulkRigidStates";
+
+  std::string stageFile =
+      Cr::Utility::Directory::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile = Cr::Utility::Directory::join(
+      dataDir, "test_assets/objects/transform_box.glb");
+
+  initStage(stageFile);
+
+  ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+  ObjectAttributes->setRenderAssetHandle(objectFile);
+  auto objectAttributesManager =
+      metadataMediator_->getObjectAttributesManager();
+  objectAttributesManager->registerObject(ObjectAttributes, objectFile);
+
+  const int numObjects = 4;
+  Eigen::VectorXi objectIds(numObjects);
+  for (int i = 0; i < numObjects; ++i) {
+    objectIds[i] = physicsManager_->addObject(objectFile, nullptr);
+    physicsManager_->setObjectMotionType(objectIds[i],
+                                         esp::physics::MotionType::KINEMATIC);
+  }
+
+  // set poses in reverse order, with unnormalized quaternions
+  Eigen::RowMatrixXf states(numObjects, 7);
+  for (int i = 0; i < numObjects; ++i) {
+    states.row(i) << 3.0f * i, 2.0f, -1.0f * i, 0.0f, 2.0f, 0.0f, 2.0f;
+  }
+  ASSERT_TRUE(physicsManager_->setRigidStates(objectIds.reverse(), states));
+  for (int i = 0; i < numObjects; ++i) {
+    const int objectId = objectIds[numObjects - 1 - i];
+    ASSERT_EQ(physicsManager_->getTranslation(objectId),
+              Magnum::Vector3(3.0f * i, 2.0f, -1.0f * i));
+    ASSERT_LT((physicsManager_->getRotation(objectId).vector() -
+               Magnum::Vector3(0.0f, std::sqrt(0.5f), 0.0f))
+                  .length(),
+              1e-5);
+  }
+
+  Eigen::RowMatrixXf readStates(numObjects, 7);
+  ASSERT_TRUE(physicsManager_->getRigidStates(objectIds, readStates));
+  for (int i = 0; i < numObjects; ++i) {
+    const Magnum::Vector3 translation =
+        physicsManager_->getTranslation(objectIds[i]);
+    const Magnum::Quaternion rotation =
+        physicsManager_->getRotation(objectIds[i]);
+    ASSERT_EQ(readStates(i, 0), translation.x());
+    ASSERT_EQ(readStates(i, 2), translation.z());
+    ASSERT_EQ(readStates(i, 4), rotation.vector().y());
+    ASSERT_EQ(readStates(i, 6), rotation.scalar());
+  }
+
+  // invalid IDs and mismatched shapes write nothing
+  Eigen::VectorXi badIds = objectIds;
+  badIds[1] = 1000;
+  readStates.setZero();
+  ASSERT_FALSE(physicsManager_->getRigidStates(badIds, readStates));
+  ASSERT_TRUE(readStates.isZero());
+  Eigen::RowMatrixXf badStates(numObjects, 6);
+  ASSERT_FALSE(physicsManager_->getRigidStates(objectIds, badStates));
+
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::NONE) {
+    // velocities only apply to dynamic objects
+    physicsManager_->setObjectMotionType(objectIds[0],
+                                         esp::physics::MotionType::DYNAMIC);
+    Eigen::RowMatrixXf velocities(numObjects, 6);
+    for (int i = 0; i < numObjects; ++i) {
+      velocities.row(i) << 1.0f, 0.0f, 0.0f, 0.0f, 0.5f, 0.0f;
+    }
+    ASSERT_TRUE(physicsManager_->setVelocities(objectIds, velocities));
+    ASSERT_EQ(physicsManager_->getLinearVelocity(objectIds[0]),
+              Magnum::Vector3(1.0f, 0.0f, 0.0f));
+    ASSERT_EQ(physicsManager_->getAngularVelocity(objectIds[0]),
+              Magnum::Vector3(0.0f, 0.5f, 0.0f));
+
+    Eigen::RowMatrixXf readVelocities(numObjects, 6);
+    ASSERT_TRUE(physicsManager_->getVelocities(objectIds, readVelocities));
+    ASSERT_TRUE(readVelocities.row(0).isApprox(velocities.row(0)));
+    ASSERT_TRUE(readVelocities.bottomRows(numObjects - 1).isZero());
+  }
+}
+
+TEST_F(PhysicsManagerTest, MultithreadedDeterminism) {
+  // test that stepping with several threads is reproducible
+  LOG(INFO) << "Starting physics test: MultithreadedDeterminism";
+
+  std::string stageFile =
+      Cr::Utility::Directory::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile = Cr::Utility::Directory::join(
+      dataDir, "test_assets/objects/transform_box.glb");
+
+  // a pile of 2x2x2 boxes. Toppling piles have contacts change every step,
+  // otherwise the boxes settle in aligned stacks.
+  const int gridSize = 3;
+  const int numLayers = 3;
+  const int numObjects = gridSize * gridSize * numLayers;
+  const auto simulatePile = [&](int numThreads, bool topple) {
+    sceneID_ = sceneManager_.initSceneGraph();
+    initStage(stageFile, numThreads);
+    ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+    ObjectAttributes->setRenderAssetHandle(objectFile);
+    metadataMediator_->getObjectAttributesManager()->registerObject(
+        ObjectAttributes, objectFile);
+
+    Eigen::VectorXi objectIds(numObjects);
+    for (int i = 0; i < numObjects; ++i) {
+      const int layer = i / (gridSize * gridSize);
+      const float offset = !topple ? 0.0f : (layer % 2) ? 0.7f : -0.7f;
+      objectIds[i] = physicsManager_->addObject(objectFile, nullptr);
+      physicsManager_->setTranslation(
+          objectIds[i],
+          Magnum::Vector3{2.5f * (i % gridSize) + offset, 1.5f + 2.5f * layer,
+                          2.5f * ((i / gridSize) % gridSize) + offset});
+    }
+    physicsManager_->stepPhysics(3.0);
+
+    Eigen::RowMatrixXf states(numObjects, 7);
+    physicsManager_->getRigidStates(objectIds, states);
+    return states;
+  };
+
+  const Eigen::RowMatrixXf singleThreaded = simulatePile(1, true);
+  if (physicsManager_->getPhysicsSimulationLibrary() ==
+      PhysicsManager::PhysicsSimulationLibrary::NONE) {
+    return;
+  }
+  const Eigen::RowMatrixXf multithreaded = simulatePile(4, true);
+  const Eigen::RowMatrixXf repeated = simulatePile(4, true);
+  ASSERT_TRUE(multithreaded == repeated);
+  // the result doesn't depend on the number of workers either
+  const Eigen::RowMatrixXf twoThreads = simulatePile(2, true);
+  ASSERT_TRUE(multithreaded == twoThreads);
+
+  // a single thread steps a different world and solver, so toppling piles
+  // diverge, but settled stacks agree
+  const Eigen::RowMatrixXf singleThreadedStacks = simulatePile(1, false);
+  const Eigen::RowMatrixXf multithreadedStacks = simulatePile(4, false);
+  ASSERT_LT((singleThreadedStacks - multithreadedStacks).cwiseAbs().maxCoeff(),
+            1e-2);
+
+  // both worlds settle the pile on the ground plane
+  for (int i = 0; i < numObjects; ++i) {
+    ASSERT_GT(singleThreaded(i, 1), 0.9f);
+    ASSERT_GT(multithreaded(i, 1), 0.9f);
+    ASSERT_LT(multithreaded(i, 1), 1.5f + 2.5f * numLayers);
+  }
+}
+
+TEST_F(PhysicsManagerTest, SaveRestoreState) {
+  // test that restoring a saved state reproduces the world and its future
+  LOG(INFO) << "Starting physics test: SaveRestoreState";
+
+  std::string stageFile =
+      Cr::Utility::Directory::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile = Cr::Utility::Directory::join(
+      dataDir, "test_assets/objects/transform_box.glb");
+
+  initStage(stageFile);
+  ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+  ObjectAttributes->setRenderAssetHandle(objectFile);
+  metadataMediator_->getObjectAttributesManager()->registerObject(
+      ObjectAttributes, objectFile);
+
+  const int numObjects = 3;
+  Eigen::VectorXi objectIds(numObjects);
+  for (int i = 0; i < numObjects; ++i) {
+    objectIds[i] = physicsManager_->addObject(objectFile, nullptr);
+    physicsManager_->setTranslation(objectIds[i],
+                                    Magnum::Vector3{4.0f * i, 2.0f + i, 0.0f});
+    physicsManager_->setRotation(
+        objectIds[i], Magnum::Quaternion::rotation(Magnum::Deg(30.0f * i),
+                                                   Magnum::Vector3::xAxis()));
+  }
+  const bool hasDynamics = physicsManager_->getPhysicsSimulationLibrary() !=
+                           PhysicsManager::PhysicsSimulationLibrary::NONE;
+  physicsManager_->stepPhysics(0.5);
+
+  Eigen::RowMatrixXf savedStates(numObjects, 7);
+  Eigen::RowMatrixXf savedVelocities(numObjects, 6);
+  physicsManager_->getRigidStates(objectIds, savedStates);
+  physicsManager_->getVelocities(objectIds, savedVelocities);
+  const double savedTime = physicsManager_->getWorldTime();
+  esp::physics::PhysicsState::ptr state = physicsManager_->saveState();
+  ASSERT_EQ(state->getObjectIds().size(), size_t(numObjects));
+  ASSERT_EQ(state->getWorldTime(), savedTime);
+
+  // simulate one future, disturbing the world along the way
+  physicsManager_->setObjectMotionType(objectIds[2],
+                                       esp::physics::MotionType::KINEMATIC);
+  physicsManager_->setTranslation(objectIds[2], {0.0f, 5.0f, 5.0f});
+  physicsManager_->stepPhysics(1.0);
+
+  // restore reproduces the saved state exactly
+  const esp::physics::MotionType savedMotionType =
+      hasDynamics ? esp::physics::MotionType::DYNAMIC
+                  : esp::physics::MotionType::KINEMATIC;
+  Eigen::RowMatrixXf future(numObjects, 7);
+  for (int branch = 0; branch < 2; ++branch) {
+    ASSERT_TRUE(physicsManager_->restoreState(*state));
+    ASSERT_EQ(physicsManager_->getWorldTime(), savedTime);
+    ASSERT_EQ(physicsManager_->getObjectMotionType(objectIds[2]),
+              savedMotionType);
+    Eigen::RowMatrixXf states(numObjects, 7);
+    Eigen::RowMatrixXf velocities(numObjects, 6);
+    physicsManager_->getRigidStates(objectIds, states);
+    physicsManager_->getVelocities(objectIds, velocities);
+    ASSERT_TRUE(states == savedStates);
+    ASSERT_TRUE(velocities == savedVelocities);
+
+    // undisturbed branches agree with each other
+    physicsManager_->stepPhysics(1.0);
+    Eigen::RowMatrixXf branchStates(numObjects, 7);
+    physicsManager_->getRigidStates(objectIds, branchStates);
+    if (branch == 0) {
+      future = branchStates;
+    } else {
+      ASSERT_TRUE(branchStates.isApprox(future, 1e-4));
+    }
+  }
+
+  // objects added later are left alone
+  const int addedId = physicsManager_->addObject(objectFile, nullptr);
+  physicsManager_->setTranslation(addedId, {-4.0f, 3.0f, 0.0f});
+  const Magnum::Vector3 addedTranslation =
+      physicsManager_->getTranslation(addedId);
+  ASSERT_TRUE(physicsManager_->restoreState(*state));
+  ASSERT_EQ(physicsManager_->getTranslation(addedId), addedTranslation);
+
+  // states of removed objects can't be restored, even if their ID is reused
+  physicsManager_->removeObject(objectIds[1]);
+  ASSERT_FALSE(physicsManager_->restoreState(*state));
+  const int recycledId = physicsManager_->addObject(objectFile, nullptr);
+  ASSERT_EQ(recycledId, objectIds[1]);
+  ASSERT_FALSE(physicsManager_->restoreState(*state));
+  ASSERT_TRUE(physicsManager_->restoreState(*physicsManager_->saveState()));
+
+  // nor into a new world, even if it reuses the same address and object IDs
+  initStage(stageFile);
+  for (int i = 0; i < numObjects; ++i) {
+    ASSERT_EQ(physicsManager_->addObject(objectFile, nullptr), objectIds[i]);
+  }
+  ASSERT_FALSE(physicsManager_->restoreState(*state));
+}
+
+TEST_F(PhysicsManagerTest, ObjectPool) {
+  // test that pooled objects are reused and come back as freshly added
+  LOG(INFO) << "Starting physics test: ObjectPool";
+
+  std::string stageFile =
+      Cr::Utility::Directory::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile = Cr::Utility::Directory::join(
+      dataDir, "test_assets/objects/transform_box.glb");
+
+  initStage(stageFile);
+  auto& drawables = sceneManager_.getSceneGraph(sceneID_).getDrawables();
+  ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+  ObjectAttributes->setRenderAssetHandle(objectFile);
+  metadataMediator_->getObjectAttributesManager()->registerObject(
+      ObjectAttributes, objectFile);
+
+  // pooled objects are hidden and out of the world
+  const size_t numDrawables = drawables.size();
+  const int capacity = 3;
+  ASSERT_TRUE(
+      physicsManager_->preallocateObjects(objectFile, capacity, &drawables));
+  ASSERT_EQ(physicsManager_->getNumPooledObjects(objectFile), capacity);
+  ASSERT_EQ(physicsManager_->getNumRigidObjects(), 0);
+  ASSERT_EQ(drawables.size(), numDrawables);
+
+  std::vector<int> objectIds;
+  for (int i = 0; i < capacity; ++i) {
+    objectIds.push_back(physicsManager_->addObject(objectFile, &drawables));
+  }
+  ASSERT_EQ(physicsManager_->getNumPooledObjects(objectFile), 0);
+  ASSERT_GT(drawables.size(), numDrawables);
+  const esp::physics::MotionType initialMotionType =
+      physicsManager_->getObjectMotionType(objectIds[0]);
+  const double initialFriction =
+      physicsManager_->getFrictionCoefficient(objectIds[0]);
+
+  // modify the objects, then return them to the pool. Only the first one
+  // changes how its body is built.
+  physicsManager_->setObjectMotionType(objectIds[0],
+                                       esp::physics::MotionType::KINEMATIC);
+  for (int objectId : objectIds) {
+    physicsManager_->setTranslation(objectId, {1.0f, 2.0f, 3.0f});
+    physicsManager_->setLinearVelocity(objectId, {1.0f, 0.0f, 0.0f});
+    physicsManager_->setFrictionCoefficient(objectId, 0.123);
+    physicsManager_->getVelocityControl(objectId)->controllingLinVel = true;
+    physicsManager_->removeObject(objectId);
+  }
+  ASSERT_EQ(physicsManager_->getNumPooledObjects(objectFile), capacity);
+  ASSERT_EQ(drawables.size(), numDrawables);
+
+  // reused objects are reset
+  objectIds.clear();
+  for (int i = 0; i < capacity + 1; ++i) {
+    objectIds.push_back(physicsManager_->addObject(objectFile, &drawables));
+    ASSERT_EQ(physicsManager_->getTranslation(objectIds.back()),
+              Magnum::Vector3());
+    ASSERT_EQ(physicsManager_->getObjectMotionType(objectIds.back()),
+              initialMotionType);
+    ASSERT_EQ(physicsManager_->getFrictionCoefficient(objectIds.back()),
+              initialFriction);
+    ASSERT_EQ(physicsManager_->getLinearVelocity(objectIds.back()),
+              Magnum::Vector3());
+    ASSERT_FALSE(physicsManager_->getVelocityControl(objectIds.back())
+                     ->controllingLinVel);
+  }
+  ASSERT_EQ(physicsManager_->getNumPooledObjects(objectFile), 0);
+  ASSERT_EQ(physicsManager_->getNumRigidObjects(), capacity + 1);
+
+  // reused objects simulate normally
+  physicsManager_->setTranslation(objectIds[0], {0.0f, 3.0f, 0.0f});
+  physicsManager_->stepPhysics(1.0);
+  if (initialMotionType == esp::physics::MotionType::DYNAMIC) {
+    ASSERT_LT(physicsManager_->getTranslation(objectIds[0]).y(), 2.0f);
+  }
+
+  // the pool only holds up to its capacity
+  for (int objectId : objectIds) {
+    physicsManager_->removeObject(objectId);
+  }
+  ASSERT_EQ(physicsManager_->getNumPooledObjects(objectFile), capacity);
+
+  // objects with other drawables are instanced anew
+  const int unpooledId = physicsManager_->addObject(objectFile, nullptr);
+  ASSERT_NE(unpooledId, esp::ID_UNDEFINED);
+  ASSERT_EQ(physicsManager_->getNumPooledObjects(objectFile), capacity);
+
+  physicsManager_->clearObjectPools();
+  ASSERT_EQ(physicsManager_->getNumPooledObjects(objectFile), 0);
+  ASSERT_EQ(drawables.size(), numDrawables);
+}
+
+TEST_F(PhysicsManagerTest, ObjectPoolReplay) {
+  // test that pooling doesn't change what a replay recorder sees
+  LOG(INFO) << "Starting physics test: ObjectPoolReplay";
+
+  std::string stageFile =
+      Cr::Utility::Directory::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile = Cr::Utility::Directory::join(
+      dataDir, "test_assets/objects/transform_box.glb");
+  const esp::assets::RenderAssetInstanceCreationInfo creation(
+      objectFile, Cr::Containers::NullOpt, {}, "");
+
+  struct Recording {
+    std::vector<esp::gfx::replay::Keyframe> keyframes;
+    std::vector<int> existingObjectIds;
+  };
+  const auto recordObjects = [&](bool pooled) {
+    sceneID_ = sceneManager_.initSceneGraph();
+    initStage(stageFile);
+    auto& drawables = sceneManager_.getSceneGraph(sceneID_).getDrawables();
+    ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+    ObjectAttributes->setRenderAssetHandle(objectFile);
+    metadataMediator_->getObjectAttributesManager()->registerObject(
+        ObjectAttributes, objectFile);
+    if (pooled) {
+      EXPECT_TRUE(
+          physicsManager_->preallocateObjects(objectFile, 3, &drawables));
+    }
+
+    Recording recording;
+    esp::gfx::replay::Recorder recorder;
+    const auto addRecordedObject = [&](const Magnum::Vector3& translation) {
+      const int numInstances = recorder.getNumInstances();
+      const int objectId = physicsManager_->addObject(objectFile, &drawables);
+      physicsManager_->setTranslation(objectId, translation);
+      // record new instances as ResourceManager would, reused objects record
+      // theirs again themselves
+      if (recorder.getNumInstances() == numInstances) {
+        recorder.onCreateRenderAssetInstance(
+            &physicsManager_->getObjectSceneNode(objectId), creation);
+      }
+      return objectId;
+    };
+    const int objectId0 = addRecordedObject({1.0f, 0.0f, 0.0f});
+    const int objectId1 = addRecordedObject({2.0f, 0.0f, 0.0f});
+    recorder.saveKeyframe();
+
+    // the removed object leaves the replay, even if its node is pooled
+    physicsManager_->removeObject(objectId0);
+    recorder.saveKeyframe();
+
+    // a reused object enters the replay again
+    const int objectId2 = addRecordedObject({3.0f, 0.0f, 0.0f});
+    recorder.saveKeyframe();
+    recording.existingObjectIds = physicsManager_->getExistingObjectIDs();
+    std::sort(recording.existingObjectIds.begin(),
+              recording.existingObjectIds.end());
+
+    physicsManager_->removeObject(objectId1);
+    physicsManager_->removeObject(objectId2);
+    recorder.saveKeyframe();
+    recording.keyframes = recorder.debugGetSavedKeyframes();
+    EXPECT_EQ(recorder.getNumInstances(), 0);
+    if (pooled) {
+      // recorded objects are pooled too
+      EXPECT_EQ(physicsManager_->getNumPooledObjects(objectFile), 3);
+    }
+    return recording;
+  };
+
+  const Recording unpooled = recordObjects(false);
+  const Recording pooled = recordObjects(true);
+  ASSERT_EQ(pooled.existingObjectIds, unpooled.existingObjectIds);
+  ASSERT_EQ(pooled.keyframes.size(), unpooled.keyframes.size());
+  ASSERT_EQ(unpooled.keyframes[1].deletions.size(), 1);
+  ASSERT_EQ(unpooled.keyframes[3].deletions.size(), 2);
+  for (size_t i = 0; i < pooled.keyframes.size(); ++i) {
+    const esp::gfx::replay::Keyframe& pooledKeyframe = pooled.keyframes[i];
+    const esp::gfx::replay::Keyframe& unpooledKeyframe = unpooled.keyframes[i];
+    ASSERT_EQ(pooledKeyframe.creations.size(),
+              unpooledKeyframe.creations.size());
+    for (size_t j = 0; j < pooledKeyframe.creations.size(); ++j) {
+      ASSERT_EQ(pooledKeyframe.creations[j].first,
+                unpooledKeyframe.creations[j].first);
+    }
+    ASSERT_EQ(pooledKeyframe.deletions, unpooledKeyframe.deletions);
+    ASSERT_EQ(pooledKeyframe.stateUpdates, unpooledKeyframe.stateUpdates);
+  }
+}
+
+#ifdef ESP_BUILD_WITH_BULLET
+TEST(BulletCollisionCacheTest, ConvexHullReduction) {
+  using esp::physics::BulletCollisionCache;
+  LOG(INFO) << "Starting physics test: ConvexHullReduction";
+
+  const size_t maxVertices = 64;
+
+  // a dense unit sphere with its center as an interior point
+  std::vector<Magnum::Vector3> points{Magnum::Vector3{0.0f}};
+  for (int i = 0; i < 40; ++i) {
+    const float theta = Magnum::Constants::pi() * (i + 0.5f) / 40;
+    for (int j = 0; j < 80; ++j) {
+      const float phi = 2 * Magnum::Constants::pi() * j / 80;
+      points.emplace_back(std::sin(theta) * std::cos(phi), std::cos(theta),
+                          std::sin(theta) * std::sin(phi));
+    }
+  }
+  // the poles, so that the y extent is exact
+  points.emplace_back(0.0f, 1.0f, 0.0f);
+  points.emplace_back(0.0f, -1.0f, 0.0f);
+
+  // the exact hull drops the interior point
+  std::vector<Magnum::Vector3> exactHull =
+      BulletCollisionCache::reduceConvexHull(points, 0);
+  ASSERT_LT(exactHull.size(), points.size());
+  ASSERT_GT(exactHull.size(), maxVertices);
+  for (const auto& v : exactHull) {
+    ASSERT_NEAR(v.length(), 1.0, 1e-4);
+  }
+
+  // the reduced hull respects the budget and keeps the bounding box
+  std::vector<Magnum::Vector3> hull =
+      BulletCollisionCache::reduceConvexHull(points, maxVertices);
+  ASSERT_LE(hull.size(), maxVertices);
+  ASSERT_GT(hull.size(), maxVertices / 2);
+  Magnum::Range3D pointsBounds, hullBounds;
+  for (const auto& v : points) {
+    pointsBounds = Magnum::Math::join(pointsBounds, Magnum::Range3D{v, v});
+  }
+  for (const auto& v : hull) {
+    hullBounds = Magnum::Math::join(hullBounds, Magnum::Range3D{v, v});
+    ASSERT_NEAR(v.length(), 1.0, 1e-4);
+  }
+  ASSERT_LT((pointsBounds.min() - hullBounds.min()).length(), 1e-4);
+  ASSERT_LT((pointsBounds.max() - hullBounds.max()).length(), 1e-4);
+
+  // hulls round trip through the on-disk cache of another instance
+  const std::string cacheDir = Cr::Utility::Directory::join(
+      Cr::Utility::Directory::tmp(), "PhysicsTest-hull-cache");
+  const auto clearCacheDir = [&cacheDir]() {
+    for (const std::string& file : Cr::Utility::Directory::list(
+             cacheDir, Cr::Utility::Directory::Flag::SkipDotAndDotDot)) {
+      Cr::Utility::Directory::rm(Cr::Utility::Directory::join(cacheDir, file));
+    }
+    Cr::Utility::Directory::rm(cacheDir);
+  };
+  clearCacheDir();
+  {
+    BulletCollisionCache cache{cacheDir};
+    ASSERT_EQ(cache.getConvexHull(points, maxVertices), hull);
+  }
+  std::vector<std::string> cacheFiles = Cr::Utility::Directory::list(
+      cacheDir, Cr::Utility::Directory::Flag::SkipDotAndDotDot);
+  ASSERT_EQ(cacheFiles.size(), 1);
+  {
+    BulletCollisionCache cache{cacheDir};
+    ASSERT_EQ(cache.getConvexHull(points, maxVertices), hull);
+    // a different budget is a different entry
+    ASSERT_EQ(cache.getConvexHull(points, 0), exactHull);
+  }
+  clearCacheDir();
+}
+
+TEST(BulletCollisionCacheTest, TriangleMeshBvhRoundTrip) {
+  using esp::physics::BulletCollisionCache;
+  LOG(INFO) << "Starting physics test: TriangleMeshBvhRoundTrip";
+
+  // a bumpy height field, so that rays hit at varying depths
+  const int gridSize = 32;
+  std::vector<Magnum::Vector3> positions;
+  std::vector<Magnum::UnsignedInt> indices;
+  for (int i = 0; i <= gridSize; ++i) {
+    for (int j = 0; j <= gridSize; ++j) {
+      positions.emplace_back(i, std::sin(0.5f * i) * std::cos(0.3f * j), j);
+    }
+  }
+  for (int i = 0; i < gridSize; ++i) {
+    for (int j = 0; j < gridSize; ++j) {
+      const Magnum::UnsignedInt v = i * (gridSize + 1) + j;
+      indices.insert(indices.end(), {v, v + 1, v + gridSize + 1, v + 1,
+                                     v + gridSize + 2, v + gridSize + 1});
+    }
+  }
+  btIndexedMesh bulletMesh;
+  bulletMesh.m_numTriangles = indices.size() / 3;
+  bulletMesh.m_triangleIndexBase =
+      reinterpret_cast<const unsigned char*>(indices.data());
+  bulletMesh.m_triangleIndexStride = 3 * sizeof(Magnum::UnsignedInt);
+  bulletMesh.m_numVertices = positions.size();
+  bulletMesh.m_vertexBase =
+      reinterpret_cast<const unsigned char*>(positions.data());
+  bulletMesh.m_vertexStride = sizeof(Magnum::Vector3);
+  bulletMesh.m_indexType = PHY_INTEGER;
+  bulletMesh.m_vertexType = PHY_FLOAT;
+  btTriangleIndexVertexArray indexedVertexArray;
+  indexedVertexArray.addIndexedMesh(bulletMesh, PHY_INTEGER);
+  uint64_t meshHash = BulletCollisionCache::hashBytes(
+      positions.data(), positions.size() * sizeof(Magnum::Vector3));
+  meshHash = BulletCollisionCache::hashBytes(
+      indices.data(), indices.size() * sizeof(Magnum::UnsignedInt), meshHash);
+
+  const btVector3 scaling{0.5, 2.0, 0.5};
+  const auto castRays = [&](btBvhTriangleMeshShape& shape) {
+    btCollisionObject object;
+    object.setCollisionShape(&shape);
+    std::vector<btScalar> hitFractions;
+    for (int i = 0; i < gridSize; ++i) {
+      const btVector3 from{0.25f + 0.5f * i, 10.0f, 0.4f * i};
+      const btVector3 to = from - btVector3{0, 20.0f, 0};
+      btCollisionWorld::ClosestRayResultCallback callback(from, to);
+      btCollisionWorld::rayTestSingle(
+          btTransform{btQuaternion::getIdentity(), from},
+          btTransform{btQuaternion::getIdentity(), to}, &object, &shape,
+          btTransform::getIdentity(), callback);
+      EXPECT_TRUE(callback.hasHit());
+      hitFractions.push_back(callback.m_closestHitFraction);
+    }
+    return hitFractions;
+  };
+
+  // reference: the shape building its own BVH
+  btBvhTriangleMeshShape referenceShape(&indexedVertexArray, true, false);
+  referenceShape.btTriangleMeshShape::setLocalScaling(scaling);
+  referenceShape.buildOptimizedBvh();
+  const std::vector<btScalar> referenceHits = castRays(referenceShape);
+
+  const std::string cacheDir = Cr::Utility::Directory::join(
+      Cr::Utility::Directory::tmp(), "PhysicsTest-bvh-cache");
+  const auto clearCacheDir = [&cacheDir]() {
+    for (const std::string& file : Cr::Utility::Directory::list(
+             cacheDir, Cr::Utility::Directory::Flag::SkipDotAndDotDot)) {
+      Cr::Utility::Directory::rm(Cr::Utility::Directory::join(cacheDir, file));
+    }
+    Cr::Utility::Directory::rm(cacheDir);
+  };
+  clearCacheDir();
+
+  // built and written by one instance, loaded from disk by another
+  for (int pass = 0; pass < 2; ++pass) {
+    BulletCollisionCache cache{cacheDir};
+    btBvhTriangleMeshShape shape(&indexedVertexArray, true, false);
+    shape.btTriangleMeshShape::setLocalScaling(scaling);
+    BulletCollisionCache::TriangleMeshBvh::ptr bvh =
+        cache.getTriangleMeshBvh(shape, meshHash);
+    ASSERT_NE(bvh->get(), nullptr);
+    // shapes with the same mesh and scaling share the BVH
+    btBvhTriangleMeshShape otherShape(&indexedVertexArray, true, false);
+    otherShape.btTriangleMeshShape::setLocalScaling(scaling);
+    ASSERT_EQ(cache.getTriangleMeshBvh(otherShape, meshHash), bvh);
+
+    shape.setOptimizedBvh(bvh->get(), scaling);
+    ASSERT_EQ(castRays(shape), referenceHits);
+    ASSERT_EQ(Cr::Utility::Directory::list(
+                  cacheDir, Cr::Utility::Directory::Flag::SkipDotAndDotDot)
+                  .size(),
+              1);
+  }
+  clearCacheDir();
+}
+#endif
@@ -5,8 +5,12 @@
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Utility/Directory.h>
 #include <Magnum/EigenIntegration/Integration.h>
+#include <Magnum/GL/Texture.h>
+#include <Magnum/Image.h>
 #include <Magnum/Math/Range.h>
+#include <Magnum/PixelFormat.h>
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <string>
 
 #include "esp/assets/RenderAssetInstanceCreationInfo.h"
@@ -116,3 +120,102 @@ TEST(ResourceManagerTest, loadAndCreateRenderAssetInstance) {
       info, creation, &sceneManager_, tempIDs);
   ASSERT(node);
 }
+
+// Load an asset on several threads and compare it to a serial load
+TEST(ResourceManagerTest, parallelLoadRenderAsset) {
+  esp::gfx::WindowlessContext::uptr context_ =
+      esp::gfx::WindowlessContext::create_unique(0);
+
+  std::shared_ptr<esp::gfx::Renderer> renderer_ = esp::gfx::Renderer::create();
+
+  auto MM = MetadataMediator::create();
+  ResourceManager serialResourceManager(MM);
+  ResourceManager parallelResourceManager(MM);
+  EXPECT_EQ(parallelResourceManager.getNumLoadingThreads(), 1);
+  parallelResourceManager.setNumLoadingThreads(4);
+  EXPECT_EQ(parallelResourceManager.getNumLoadingThreads(), 4);
+
+  std::string boxFile =
+      Cr::Utility::Directory::join(TEST_ASSETS, "objects/transform_box.glb");
+  const esp::assets::AssetInfo info = esp::assets::AssetInfo::fromPath(boxFile);
+  ASSERT_TRUE(serialResourceManager.loadRenderAsset(info));
+  ASSERT_TRUE(parallelResourceManager.loadRenderAsset(info));
+
+  // transform_box.glb has 6 meshes, imported on different threads
+  const auto& serialMetaData = serialResourceManager.getMeshMetaData(boxFile);
+  const auto& parallelMetaData =
+      parallelResourceManager.getMeshMetaData(boxFile);
+  EXPECT_EQ(parallelMetaData.meshIndex, serialMetaData.meshIndex);
+  EXPECT_EQ(parallelMetaData.textureIndex, serialMetaData.textureIndex);
+
+  esp::assets::MeshData::uptr serialBox =
+      serialResourceManager.createJoinedCollisionMesh(boxFile);
+  esp::assets::MeshData::uptr parallelBox =
+      parallelResourceManager.createJoinedCollisionMesh(boxFile);
+  ASSERT_EQ(parallelBox->vbo.size(), serialBox->vbo.size());
+  for (size_t vix = 0; vix < serialBox->vbo.size(); vix++) {
+    ASSERT_EQ(parallelBox->vbo[vix], serialBox->vbo[vix]);
+  }
+  EXPECT_EQ(parallelBox->ibo, serialBox->ibo);
+}
+
+TEST(ResourceManagerTest, parallelLoadTexturedRenderAsset) {
+  esp::gfx::WindowlessContext::uptr context_ =
+      esp::gfx::WindowlessContext::create_unique(0);
+
+  std::shared_ptr<esp::gfx::Renderer> renderer_ = esp::gfx::Renderer::create();
+
+  auto MM = MetadataMediator::create();
+  ResourceManager serialResourceManager(MM);
+  ResourceManager parallelResourceManager(MM);
+  // <= 0 uses the shared pool
+  parallelResourceManager.setNumLoadingThreads(0);
+  if (parallelResourceManager.getNumLoadingThreads() < 2) {
+    parallelResourceManager.setNumLoadingThreads(2);
+  }
+
+  // orange.glb has one mesh and one texture, loaded on different threads
+  std::string orangeFile =
+      Cr::Utility::Directory::join(TEST_ASSETS, "objects/orange.glb");
+  const esp::assets::AssetInfo info =
+      esp::assets::AssetInfo::fromPath(orangeFile);
+  ASSERT_TRUE(serialResourceManager.loadRenderAsset(info));
+  ASSERT_TRUE(parallelResourceManager.loadRenderAsset(info));
+
+  const auto& serialMetaData =
+      serialResourceManager.getMeshMetaData(orangeFile);
+  const auto& parallelMetaData =
+      parallelResourceManager.getMeshMetaData(orangeFile);
+  EXPECT_EQ(parallelMetaData.meshIndex, serialMetaData.meshIndex);
+  ASSERT_EQ(parallelMetaData.textureIndex, serialMetaData.textureIndex);
+  ASSERT_EQ(serialMetaData.textureIndex.second,
+            serialMetaData.textureIndex.first);
+
+  const int textureID = serialMetaData.textureIndex.first;
+  std::shared_ptr<Mn::GL::Texture2D> serialTexture =
+      serialResourceManager.getTexture(textureID);
+  std::shared_ptr<Mn::GL::Texture2D> parallelTexture =
+      parallelResourceManager.getTexture(textureID);
+  ASSERT_TRUE(serialTexture);
+  ASSERT_TRUE(parallelTexture);
+#ifndef MAGNUM_TARGET_GLES
+  Mn::Image2D serialImage =
+      serialTexture->image(0, Mn::Image2D{Mn::PixelFormat::RGBA8Unorm});
+  Mn::Image2D parallelImage =
+      parallelTexture->image(0, Mn::Image2D{Mn::PixelFormat::RGBA8Unorm});
+  ASSERT_EQ(parallelImage.size(), serialImage.size());
+  ASSERT_GT(serialImage.size().product(), 0);
+  EXPECT_TRUE(std::equal(serialImage.data().begin(), serialImage.data().end(),
+                         parallelImage.data().begin()));
+#endif
+
+  esp::assets::MeshData::uptr serialOrange =
+      serialResourceManager.createJoinedCollisionMesh(orangeFile);
+  esp::assets::MeshData::uptr parallelOrange =
+      parallelResourceManager.createJoinedCollisionMesh(orangeFile);
+  ASSERT_EQ(parallelOrange->vbo.size(), serialOrange->vbo.size());
+  for (size_t vix = 0; vix < serialOrange->vbo.size(); vix++) {
+    ASSERT_EQ(parallelOrange->vbo[vix], serialOrange->vbo[vix]);
+  }
+  EXPECT_EQ(parallelOrange->ibo, serialOrange->ibo);
+}
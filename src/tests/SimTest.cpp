@@ -3,13 +3,18 @@
 // LICENSE file in the root directory of this source tree.
 
 #include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/Utility/Directory.h>
+#include <Corrade/Utility/FormatStl.h>
 #include <Magnum/DebugTools/CompareImage.h>
 #include <Magnum/EigenIntegration/Integration.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/Magnum.h>
+#include <Magnum/Math/Range.h>
 #include <Magnum/PixelFormat.h>
+#include <cmath>
 #include <string>
 
 #include "esp/assets/ResourceManager.h"
@@ -58,16 +63,29 @@ const std::string physicsConfigFile =
 const std::string screenshotDir =
     Cr::Utility::Directory::join(TEST_ASSETS, "screenshots/");
 
+constexpr struct {
+  const char* name;
+  int numDynamic;
+  int numKinematic;
+  int numStatic;
+  int numThreads;
+} StepManyObjectsBenchmarkData[]{
+    {"1000 dynamic", 1000, 0, 0, 1},
+    {"1000 dynamic, 4 threads", 1000, 0, 0, 4},
+    {"100 dynamic, 900 static", 100, 0, 900, 1},
+    {"1000 velocity controlled kinematic", 0, 1000, 0, 1}};
+
 struct SimTest : Cr::TestSuite::Tester {
   explicit SimTest();
 
   Simulator::uptr getSimulator(
       const std::string& scene,
-      const std::string& sceneLightingKey = MetadataMediator::NO_LIGHT_KEY) {
+      const std::string& sceneLightingKey = MetadataMediator::NO_LIGHT_KEY,
+      const std::string& physicsConfig = physicsConfigFile) {
     SimulatorConfiguration simConfig{};
     simConfig.activeSceneID = scene;
     simConfig.enablePhysics = true;
-    simConfig.physicsConfigFile = physicsConfigFile;
+    simConfig.physicsConfigFile = physicsConfig;
     simConfig.sceneLightSetup = sceneLightingKey;
 
     auto sim = Simulator::create_unique(simConfig);
@@ -97,8 +115,12 @@ struct SimTest : Cr::TestSuite::Tester {
   void updateObjectLightSetupRGBAObservation();
   void multipleLightingSetupsRGBAObservation();
   void recomputeNavmeshWithStaticObjects();
+  void updateNavmeshWithStaticObjects();
   void loadingObjectTemplates();
   void buildingPrimAssetObjectTemplates();
+  void objectRegistry();
+
+  void benchmarkStepManyObjects();
 
   // TODO: remove outlier pixels from image and lower maxThreshold
   const Magnum::Float maxThreshold = 255.f;
@@ -122,8 +144,12 @@ SimTest::SimTest() {
             &SimTest::updateObjectLightSetupRGBAObservation,
             &SimTest::multipleLightingSetupsRGBAObservation,
             &SimTest::recomputeNavmeshWithStaticObjects,
+            &SimTest::updateNavmeshWithStaticObjects,
             &SimTest::loadingObjectTemplates,
-            &SimTest::buildingPrimAssetObjectTemplates});
+            &SimTest::buildingPrimAssetObjectTemplates,
+            &SimTest::objectRegistry});
+  addInstancedBenchmarks({&SimTest::benchmarkStepManyObjects}, 10,
+                         Cr::Containers::arraySize(StepManyObjectsBenchmarkData));
   // clang-format on
 }
 
@@ -440,6 +466,59 @@ void SimTest::recomputeNavmeshWithStaticObjects() {
       simulator->getPathFinder()->isNavigable(randomNavPoint + offset, 0.2));
 }
 
+void SimTest::updateNavmeshWithStaticObjects() {
+  Corrade::Utility::Debug()
+      << "Starting Test : updateNavmeshWithStaticObjects ";
+  auto simulator = getSimulator(skokloster);
+  auto objectAttribsMgr = simulator->getObjectAttributesManager();
+  esp::nav::PathFinder& pathFinder = *simulator->getPathFinder();
+
+  // only tiled navmeshes can be updated
+  esp::nav::NavMeshSettings navMeshSettings;
+  navMeshSettings.setDefaults();
+  navMeshSettings.tiled = true;
+  CORRADE_VERIFY(simulator->recomputeNavMesh(pathFinder, navMeshSettings));
+  const float area = pathFinder.getNavigableArea();
+
+  esp::vec3f randomNavPoint = pathFinder.getRandomNavigablePoint();
+  while (pathFinder.distanceToClosestObstacle(randomNavPoint) < 1.0 ||
+         randomNavPoint[1] > 1.0) {
+    randomNavPoint = pathFinder.getRandomNavigablePoint();
+  }
+
+  auto objs = objectAttribsMgr->getObjectHandlesBySubstring("nested_box");
+  int objectID = simulator->addObjectByHandle(objs[0]);
+  simulator->setTranslation(Magnum::Vector3{randomNavPoint}, objectID);
+  simulator->setObjectMotionType(esp::physics::MotionType::STATIC, objectID);
+  const Magnum::Vector3 objectPoint{randomNavPoint};
+  const Magnum::Range3D region{objectPoint - Magnum::Vector3{1.0f},
+                               objectPoint + Magnum::Vector3{1.0f}};
+
+  // static objects are ignored unless included, as in recomputeNavMesh
+  CORRADE_VERIFY(simulator->updateNavMesh(pathFinder, region));
+  CORRADE_VERIFY(pathFinder.isNavigable(randomNavPoint, 0.1));
+
+  CORRADE_VERIFY(simulator->updateNavMesh(pathFinder, region, true));
+  CORRADE_VERIFY(!pathFinder.isNavigable(randomNavPoint, 0.1));
+  CORRADE_COMPARE_AS(pathFinder.getNavigableArea(), area,
+                     Cr::TestSuite::Compare::Less);
+
+  // the same as recomputing the whole navmesh with the object
+  esp::nav::PathFinder recomputed;
+  CORRADE_VERIFY(
+      simulator->recomputeNavMesh(recomputed, navMeshSettings, true));
+  CORRADE_COMPARE_WITH(
+      pathFinder.getNavigableArea(), recomputed.getNavigableArea(),
+      Cr::TestSuite::Compare::around(1e-3f * recomputed.getNavigableArea()));
+
+  // removing the object and updating again restores the navmesh
+  simulator->removeObject(objectID);
+  CORRADE_VERIFY(simulator->updateNavMesh(pathFinder, region, true));
+  CORRADE_VERIFY(pathFinder.isNavigable(randomNavPoint, 0.1));
+  CORRADE_COMPARE_WITH(pathFinder.getNavigableArea(), area,
+                       Cr::TestSuite::Compare::around(1e-3f * area));
+}
+
 void SimTest::loadingObjectTemplates() {
   Corrade::Utility::Debug() << "Starting Test : loadingObjectTemplates ";
   auto simulator = getSimulator(planeStage);
@@ -643,6 +722,106 @@ void SimTest::buildingPrimAssetObjectTemplates() {
 
 }  // SimTest::buildingPrimAssetObjectTemplates
 
+void SimTest::objectRegistry() {
+  auto simulator = getSimulator(planeStage);
+  auto objs = simulator->getObjectAttributesManager()
+                  ->getObjectHandlesBySubstring("nested_box");
+  CORRADE_VERIFY(!objs.empty());
+
+  std::vector<int> objectIDs;
+  for (int i = 0; i < 8; ++i) {
+    objectIDs.push_back(simulator->addObjectByHandle(objs[0]));
+    simulator->setTranslation({2.0f * i, 0.5f, 0.0f}, objectIDs.back());
+    simulator->setObjectMotionType(esp::physics::MotionType::KINEMATIC,
+                                   objectIDs.back());
+  }
+  // removals from the middle move other objects in the dense storage
+  simulator->removeObject(objectIDs[1]);
+  simulator->removeObject(objectIDs[4]);
+  objectIDs.erase(objectIDs.begin() + 4);
+  objectIDs.erase(objectIDs.begin() + 1);
+  CORRADE_COMPARE_AS(simulator->getExistingObjectIDs(), objectIDs,
+                     Cr::TestSuite::Compare::Container);
+
+  // IDs still address the right objects, and only the velocity controlled
+  // kinematic object moves
+  const int movingID = objectIDs.back();
+  const int staticID = objectIDs.front();
+  simulator->setObjectMotionType(esp::physics::MotionType::STATIC, staticID);
+  auto staticVelControl = simulator->getObjectVelocityControl(staticID);
+  staticVelControl->controllingLinVel = true;
+  staticVelControl->linVel = {0.0f, 1.0f, 0.0f};
+  auto velControl = simulator->getObjectVelocityControl(movingID);
+  velControl->controllingLinVel = true;
+  velControl->linVel = {0.0f, 1.0f, 0.0f};
+  const Mn::Vector3 movingStart = simulator->getTranslation(movingID);
+  const Mn::Vector3 staticStart = simulator->getTranslation(staticID);
+  simulator->stepWorld(1.0);
+  CORRADE_COMPARE(simulator->getTranslation(movingID),
+                  movingStart + Mn::Vector3{0.0f, 1.0f, 0.0f});
+  CORRADE_COMPARE(simulator->getTranslation(staticID), staticStart);
+  CORRADE_COMPARE(simulator->getTranslation(objectIDs[2]),
+                  (Mn::Vector3{2.0f * 3, 0.5f, 0.0f}));
+
+  // recycled IDs are reused without disturbing the others
+  const int newID = simulator->addObjectByHandle(objs[0]);
+  CORRADE_COMPARE(newID, 4);
+  CORRADE_COMPARE(simulator->getExistingObjectIDs().size(),
+                  objectIDs.size() + 1);
+  CORRADE_COMPARE(simulator->getTranslation(objectIDs[2]),
+                  (Mn::Vector3{2.0f * 3, 0.5f, 0.0f}));
+}  // SimTest::objectRegistry
+
+void SimTest::benchmarkStepManyObjects() {
+  auto&& data = StepManyObjectsBenchmarkData[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+
+  // the testing physics config with the requested number of threads
+  const std::string physicsConfig = Cr::Utility::Directory::join(
+      Cr::Utility::Directory::tmp(), "SimTest-step.physics_config.json");
+  CORRADE_VERIFY(Cr::Utility::Directory::writeString(
+      physicsConfig, Cr::Utility::formatString(R"({{
+    "physics_simulator": "bullet",
+    "timestep": 0.0041666666,
+    "gravity": [0,-9.8,0],
+    "friction_coefficient": 0.4,
+    "restitution_coefficient": 0.1,
+    "num_threads": {}
+}})",
+                                               data.numThreads)));
+  auto simulator = getSimulator(planeStage, MetadataMediator::NO_LIGHT_KEY,
+                                physicsConfig);
+  auto objs = simulator->getObjectAttributesManager()
+                  ->getObjectHandlesBySubstring("nested_box");
+  CORRADE_VERIFY(!objs.empty());
+
+  // spread the objects over a grid, so that contacts don't dominate
+  const int numObjects = data.numDynamic + data.numKinematic + data.numStatic;
+  const int gridSize = std::ceil(std::sqrt(numObjects));
+  for (int i = 0; i < numObjects; ++i) {
+    const int objectID = simulator->addObjectByHandle(objs[0]);
+    simulator->setTranslation(
+        {2.0f * (i % gridSize), 1.0f, 2.0f * (i / gridSize)}, objectID);
+    if (i < data.numDynamic) {
+      continue;
+    }
+    if (i < data.numDynamic + data.numKinematic) {
+      simulator->setObjectMotionType(esp::physics::MotionType::KINEMATIC,
+                                     objectID);
+      auto velControl = simulator->getObjectVelocityControl(objectID);
+      velControl->controllingAngVel = true;
+      velControl->angVel = {0.0f, 1.0f, 0.0f};
+    } else {
+      simulator->setObjectMotionType(esp::physics::MotionType::STATIC,
+                                     objectID);
+    }
+  }
+
+  CORRADE_BENCHMARK(10) { simulator->stepWorld(1.0 / 60.0); }
+  CORRADE_COMPARE(int(simulator->getExistingObjectIDs().size()), numObjects);
+  Cr::Utility::Directory::rm(physicsConfig);
+}  // SimTest::benchmarkStepManyObjects
+
 }  // namespace
 
 CORRADE_TEST_MAIN(SimTest)